@@ -14,471 +14,743 @@
 // Include necessary Windows headers for GUI and file operations
 
 #include <windows.h>
+#include <commctrl.h>
 #include <shlobj.h>
 #include <shlwapi.h>
 #include <tchar.h>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <iostream>
+#include <vector>
 #include "resource.h"
+#include "core/IniDocument.h"
+#include "core/ControlChannel.h"
+#include "core/AssetPrefetch.h"
+#include "core/ControlService.h"
+#include "core/EditBuffer.h"
+#include "core/EditHistory.h"
+#include "core/TextFile.h"
+#include "core/SettingsCli.h"
+#include "core/LauncherSettings.h"
+#include "core/ProfileStore.h"
+#include "core/IniDiff.h"
+#include "core/InstallVerifier.h"
+#include "core/LauncherController.h"
+#include "core/FileWatcher.h"
+#include "core/GameSession.h"
+#include "core/Platform.h"
+#include "core/DisplayModes.h"
+#include "core/SettingBindings.h"
+#include "core/SettingsValidator.h"
+#include "core/SnapshotStore.h"
+#include "core/Startup.h"
+#include "core/SteamLibrary.h"
+#include "core/Trace.h"
 
 
 // Link required libraries for Windows functionality
 #pragma comment(lib, "shlwapi.lib")
 #pragma comment(lib, "shell32.lib")
-
-// Define an ID for the language combo box (because every pirate needs a unique ID)
-#define ID_LANG_COMBO 2001 
+#pragma comment(lib, "comctl32.lib")
+
+// System menu entry that writes the trace file (system menu IDs keep their low four bits clear)
+#define IDM_WRITE_TRACE 0x0010
+#define IDM_RESTORE_AFTER_SESSION 0x0040
+#define IDM_VERIFY_INSTALL 0x0050
+#define IDM_PREFETCH_AT_START 0x0060
+
+// Tray icon menu entries (resident mode)
+#define IDM_TRAY_SHOW 0x0020
+#define IDM_TRAY_EXIT 0x0030
+
+// The launcher's own window messages, WM_APP + n. MessageSpanName traces each under its own name, so a message
+// added here is traced without another list to keep in step (and a reused number won't compile)
+#define LAUNCHER_MESSAGES(X)                                                                                        \
+    X(WM_SETTINGS_FILE_CHANGED, 1) /* Posted by the settings.ini watcher thread */                                  \
+    X(WM_DISPLAY_MODES_READY, 2)   /* Posted by the display mode catalog worker */                                  \
+    X(WM_LAUNCH_FAILED, 3)         /* Posted by the launch worker; lParam is a new std::string with the error */    \
+    X(WM_SNAPSHOT_DONE, 4)         /* Posted by the launch worker; lParam is a new std::string, empty on success */ \
+    X(WM_CONTROL_LAUNCH, 5)        /* Posted by a control client's thread for "launch" */                           \
+    X(WM_TRAYICON, 6)              /* The tray icon's callback; lParam is the mouse message */                      \
+    X(WM_VERIFY_DONE, 7)           /* wParam is 1 if every file matched; lParam is a new std::string, the report */ \
+    X(WM_PREFETCH_PROGRESS, 8)     /* Posted by the prefetch worker; wParam is the percent read, lParam the state */\
+    X(WM_SESSION_LOG_FAILED, 9)    /* Posted by the game supervisor; lParam is a new std::string with the error */
+
+enum LauncherMessage : UINT {
+#define LAUNCHER_MESSAGE_ID(name, offset) name = WM_APP + offset,
+    LAUNCHER_MESSAGES(LAUNCHER_MESSAGE_ID)
+#undef LAUNCHER_MESSAGE_ID
+};
 
 // Define a version number for the application (because pirates love to keep track of their loot)
 #ifndef VERSION
 #define VERSION "vUnknown"
 #endif
 
+// Where MISE_TRACE asked for the trace to go; empty when tracing is off
+std::string tracePath;
+
 const std::string windowTitle = "Monkey Launcher - " VERSION " by Curvez 2025"; // Window title with version number
 
 // Declare global variables for UI elements (because pirates don't like surprises)
 HWND hLaunchBtn, hSaveBtn, hEditBox, 
-        hIniPathLabel, hIniPathTextLabel, hResetBtn, hLangCombo, hExitBtn,
-        hResolutionCombo, hSaveReminderLabel,
-        hSubtitlesCheckbox, hShadersCheckbox;
+        hIniPathLabel, hIniPathTextLabel, hResetBtn, hExitBtn,
+        hSaveReminderLabel, hDiagnosticsLabel,
+        hProfileCombo, hApplyProfileBtn, hSaveProfileBtn,
+        hSnapshotCheck, hSnapshotCombo, hRestoreSnapshotBtn;
+
+// One window per row of settingBindings (core/SettingBindings.h), plus the caption left of each slider
+HWND settingControls[settingBindingCount];
+HWND settingCaptions[settingBindingCount];
+
+// The window for a setting control id (GetDlgItem without asking the window manager)
+HWND SettingControl(int controlId) {
+    const SettingBinding* binding = FindSettingBinding(controlId);
+    return binding ? settingControls[binding - settingBindings] : NULL;
+}
 
 // Track whether additional options are visible (like a treasure map hidden in plain sight)
 bool optionsVisible = false; 
 std::string gamePath, iniPath;
 
-// Function to get the path to the settings.ini file
-// "That's the second biggest path I've ever seen!"
-std::string GetINIPath() {
-    char appdata[MAX_PATH];
-    if (SUCCEEDED(SHGetFolderPathA(NULL, CSIDL_APPDATA, NULL, 0, appdata))) {
-        std::string path = std::string(appdata) + "\\LucasArts\\The Secret of Monkey Island Special Edition\\settings.ini";
-        return path;
-    }
-    return ""; // Return an empty string if the path can't be found (like a treasure chest with no gold)
-}
+// Who's watching settings.ini for changes
+FileWatcher settingsWatcher;
+
+// Named settings profiles, read from profiles.dat next to settings.ini
+ProfileStore profileStore;
+
+// Backups of the game's data folder (settings.ini and the saves), listed newest first in the backup combo
+std::vector<SnapshotInfo> snapshotList;
 
-// Function to read the content of a file
-// "Never pay more than 20 pieces of eight for a file reader!"
-std::string ReadFile(const std::string& path) {
-    std::ifstream file(path);
-    if (!file) return "[Failed to open file]"; // If the file can't be opened, we raise the Jolly Roger
-    std::stringstream ss;
-    ss << file.rdbuf();
-    return ss.str();
+// Every mode the monitors support, enumerated off the UI thread; the combo shows the fixed list until it's ready
+DisplayModeCatalog displayModes(CreateSystemDisplayModeProvider());
+
+// Read the whole edit box into a string, however long it is
+std::string GetEditBoxText() {
+    MISE_TRACE_SCOPE("GetWindowTextA");
+    std::string text(GetWindowTextLengthA(hEditBox), '\0');
+    if (!text.empty()) {
+        text.resize(GetWindowTextA(hEditBox, &text[0], (int)text.size() + 1));
+    }
+    return text;
 }
 
-// Normalize Windows newlines (\r\n) to Unix-style newlines (\n)
-// "You fight like a dairy farmer!" - "How appropriate, you normalize like a cow!"
-std::string normalizeWindowsNewlines(const std::string& text) {
-    std::string result;
-    size_t len = text.length();
-    for (size_t i = 0; i < len; ++i) {
-        if (text[i] == '\r') {
-            if (i + 1 < len && text[i + 1] == '\n') {
-                result += '\n';
-                ++i; // Skip \n
-            } else {
-                result += '\n'; // Handle lone \r
-            }
-        } else {
-            result += text[i];
+// The real edit box behind the EditBuffer interface
+// Edits go in through EM_REPLACESEL, so the caret and scroll position survive them (undo is editSession's job)
+class Win32EditBuffer : public EditBuffer {
+public:
+    explicit Win32EditBuffer(HWND& hwnd) : hwnd_(hwnd) {}
+
+    std::string Text() const override { return GetEditBoxText(); }
+
+    void Replace(size_t start, size_t end, std::string_view text) override {
+        MISE_TRACE_SCOPE("EM_REPLACESEL");
+        DWORD selStart = 0, selEnd = 0;
+        SendMessageA(hwnd_, EM_GETSEL, (WPARAM)&selStart, (LPARAM)&selEnd);
+        int firstLine = (int)SendMessageA(hwnd_, EM_GETFIRSTVISIBLELINE, 0, 0);
+
+        std::string replacement(text); // EM_REPLACESEL wants a terminated string
+        SendMessageA(hwnd_, EM_SETSEL, start, end);
+        SendMessageA(hwnd_, EM_REPLACESEL, FALSE, (LPARAM)replacement.c_str());
+
+        // Put the user's selection back, shifted if it sat after the edit
+        auto shift = [&](size_t pos) -> size_t {
+            if (pos >= end) return pos + text.size() - (end - start);
+            return pos > start ? start + text.size() : pos;
+        };
+        SendMessageA(hwnd_, EM_SETSEL, shift(selStart), shift(selEnd));
+        int scrolledBy = (int)SendMessageA(hwnd_, EM_GETFIRSTVISIBLELINE, 0, 0) - firstLine;
+        if (scrolledBy != 0) {
+            SendMessageA(hwnd_, EM_LINESCROLL, 0, -scrolledBy);
         }
     }
-    return result;
-}
 
-// Function to write content to a file
-// "This is the second biggest file writer I've ever seen!"
-bool WriteFile(const std::string& path, const std::string& contentFromEditBox) {
-    // Normalize \r\n to \n before saving (because pirates like consistency)
-    std::string normalized = normalizeWindowsNewlines(contentFromEditBox);
+private:
+    HWND& hwnd_;
+};
+
+// Checks run once typing pauses; the diagnostics line is red for errors, amber for warnings
+bool diagnosticsAreErrors = false;     // The diagnostics line shows an error rather than a warning
+#define IDT_VALIDATE 1                 // Timer that runs the validator
+const UINT validateDelayMs = 150;
+#define IDT_JOURNAL 2                  // Timer that compacts the journal of unsaved edits
+const UINT journalDelayMs = 2000;
+
+// The launcher window as the controller sees it (core/LauncherController.h)
+class Win32LauncherView : public LauncherView {
+public:
+    Win32LauncherView() : editBox_(hEditBox) {}
+
+    EditBuffer& TextBox() override { return editBox_; }
+
+    int ControlValue(const SettingBinding& binding) override {
+        HWND control = settingControls[&binding - settingBindings];
+        switch (binding.widget) {
+            case WidgetKind::CheckBox: return SendMessageA(control, BM_GETCHECK, 0, 0) == BST_CHECKED;
+            case WidgetKind::ComboBox: return (int)SendMessageA(control, CB_GETCURSEL, 0, 0);
+            case WidgetKind::Slider:   return (int)SendMessageA(control, TBM_GETPOS, 0, 0);
+        }
+        return 0;
+    }
 
-    std::ofstream file(path, std::ios::binary); // Binary avoids Windows auto newline conversion
-    if (!file) return false; // If the file can't be opened, abandon ship!
+    void SetControlValue(const SettingBinding& binding, int value) override {
+        HWND control = settingControls[&binding - settingBindings];
+        switch (binding.widget) {
+            case WidgetKind::CheckBox: SendMessageA(control, BM_SETCHECK, value ? BST_CHECKED : BST_UNCHECKED, 0); break;
+            case WidgetKind::ComboBox: SendMessageA(control, CB_SETCURSEL, value, 0); break; // -1 leaves it empty
+            case WidgetKind::Slider:   SendMessageA(control, TBM_SETPOS, TRUE, value); break;
+        }
+    }
 
-    file << normalized;
-    return true;
-}
+    void SetResolutionItems(const std::vector<ResolutionChoice>& choices) override {
+        HWND resolutionCombo = SettingControl(resolutionControlId);
+        SendMessageA(resolutionCombo, CB_RESETCONTENT, 0, 0);
+        for (const ResolutionChoice& choice : choices) {
+            SendMessageA(resolutionCombo, CB_ADDSTRING, 0, (LPARAM)choice.label.c_str());
+        }
+    }
 
-// Helper function to trim whitespace and line-ending characters
-// "That's the cleanest trim I've ever seen on a pirate!"
-std::string Trim(const std::string& str) {
-    size_t start = str.find_first_not_of(" \t\r\n");
-    size_t end = str.find_last_not_of(" \t\r\n");
-    return (start == std::string::npos || end == std::string::npos) ? "" : str.substr(start, end - start + 1);
-}
+    void ShowSaveReminder(bool show) override {
+        ShowWindow(hSaveReminderLabel, show ? SW_SHOW : SW_HIDE);
+    }
 
-// Load settings from the INI file into the edit box
-// "This is the second biggest settings loader I've ever seen!"
-void LoadSettingsToEditBox() {
-    std::string content = ReadFile(iniPath);
-    std::string formattedContent;
-    for (char c : content) {
-        if (c == '\n') {
-            formattedContent += "\r\n";
-        } else {
-            formattedContent += c;
+    void ShowDiagnostic(const std::string& text, bool isError) override {
+        if (text.empty()) {
+            ShowWindow(hDiagnosticsLabel, SW_HIDE);
+            return;
         }
+        diagnosticsAreErrors = isError;
+        SetWindowTextA(hDiagnosticsLabel, text.c_str());
+        ShowWindow(hDiagnosticsLabel, SW_SHOW);
     }
-    SetWindowTextA(hEditBox, formattedContent.c_str());
 
-    // Update the language combo box
-    size_t langPos = content.find("language=");
-    if (langPos != std::string::npos) {
-        int langValue = content[langPos + 9] - '0'; // Extract the language value
-        SendMessageA(hLangCombo, CB_SETCURSEL, langValue, 0);
+    void ValidationDue() override {
+        SetTimer(GetParent(hEditBox), IDT_VALIDATE, validateDelayMs, NULL);
     }
 
-    // Update the resolution combo box
-    size_t resPos = content.find("resolution=");
-    size_t windowedPos = content.find("windowed=");
-    if (resPos != std::string::npos && windowedPos != std::string::npos) {
-        // Extract the resolution value
-        size_t resStart = resPos + 11; // "resolution=" is 11 characters long
-        size_t resEnd = content.find("\r", resStart); // Find the end of the line (before \r)
-        if (resEnd == std::string::npos) {
-            resEnd = content.find("\n", resStart); // Fallback to \n if \r is not found
-        }
-        if (resEnd == std::string::npos) {
-            resEnd = content.length(); // If no line ending is found, use the end of the content
-        }
-        std::string resolutionValue = content.substr(resStart, resEnd - resStart);
-
-        // Trim the resolution value
-        resolutionValue = Trim(resolutionValue);
-
-        // Extract the windowed value
-        bool isWindowed = content[windowedPos + 9] == '1'; // "windowed=" is 9 characters long
-
-        // Match the resolution and windowed values to the combo box items
-        int selectedIndex = -1;
-        if (!isWindowed && resolutionValue == "3840x2160") {
-            selectedIndex = 1; // "4K UHD  - Full Screen (3840x2160)"
-        } else if (isWindowed && resolutionValue == "3840x2160") {
-            selectedIndex = 2; // "4K UHD  - Windowed    (3840x2160)"
-        } else if (!isWindowed && resolutionValue == "2560x1440") {
-            selectedIndex = 3; // "QHD/2K  - Full Screen (2560x1440)"
-        } else if (isWindowed && resolutionValue == "2560x1440") {
-            selectedIndex = 4; // "QHD/2K  - Windowed    (2560x1440)"
-        } else if (!isWindowed && resolutionValue == "1920x1080") {
-            selectedIndex = 5; // "1080p   - Full Screen (1920x1080)"
-        } else if (isWindowed && resolutionValue == "1920x1080") {
-            selectedIndex = 6; // "1080p   - Windowed    (1920x1080)"
-        }
+    void JournalDue() override {
+        SetTimer(GetParent(hEditBox), IDT_JOURNAL, journalDelayMs, NULL);
+    }
 
-        // Select the appropriate item in the combo box
-        // "You fight like a dairy farmer!" - "How appropriate, you select like a cow!"
-        if (selectedIndex != -1) {
-            SendMessageA(hResolutionCombo, CB_SETCURSEL, selectedIndex, 0);
-        } else {
-            SendMessageA(hResolutionCombo, CB_SETCURSEL, -1, 0); // Leave empty if not found
+    ViewAnswer Ask(const std::string& title, const std::string& question, bool canCancel) override {
+        UINT type = canCancel ? MB_YESNOCANCEL | MB_ICONQUESTION : MB_YESNO | MB_ICONWARNING;
+        switch (MessageBoxA(GetParent(hEditBox), question.c_str(), title.c_str(), type)) {
+            case IDYES: return ViewAnswer::Yes;
+            case IDNO:  return ViewAnswer::No;
+            default:    return ViewAnswer::Cancel;
         }
-    }    //else {
-        // Show a message box if keys are missing (debugging purposes)
-        // "That's the second biggest missing key I've ever seen!"
-        // MessageBoxA(NULL, "Missing resolution or windowed keys in INI file.", "Debug", MB_OK);
-        //}
-
-    // Update the shaders checkbox
-    // "Shaders? What shaders? Oh, those shaders!"
-    size_t shadersPos = content.find("shaders=");
-    if (shadersPos != std::string::npos) {
-        bool shadersEnabled = content[shadersPos + 8] == '1';
-        SendMessageA(hShadersCheckbox, BM_SETCHECK, shadersEnabled ? BST_CHECKED : BST_UNCHECKED, 0);
-    }
-
-    // Update the subtitles checkbox
-    // "Subtitles: Because sometimes pirates mumble."
-    size_t subtitlesPos = content.find("subtitles=");
-    if (subtitlesPos != std::string::npos) {
-        bool subtitlesEnabled = content[subtitlesPos + 10] == '1';
-        SendMessageA(hSubtitlesCheckbox, BM_SETCHECK, subtitlesEnabled ? BST_CHECKED : BST_UNCHECKED, 0);
     }
+
+    void ShowError(const std::string& title, const std::string& message) override {
+        MessageBoxA(GetParent(hEditBox), message.c_str(), title.c_str(), MB_ICONERROR);
+    }
+
+    void Beep() override { MessageBeep(MB_OK); }
+
+private:
+    Win32EditBuffer editBox_;
+};
+
+std::string GetDesktopResolution();
+
+// Everything the settings controls, the edit box, Save, Reset and undo do; the window only passes the clicks on
+// "Can I take that back? Ctrl+Z, matey."
+Win32LauncherView launcherView;
+LauncherController controller(launcherView, [] { return GetDesktopResolution(); });
+
+// MISE_RECORD=session.uirec writes this run's interactions down for MISEBench --replay (core/UiRecording.h)
+std::string recordPath;
+UiRecording uiRecording;
+
+// Refill the profile combo box from the store, keeping whatever name is typed in it
+void RefreshProfileCombo() {
+    std::string typed(GetWindowTextLengthA(hProfileCombo), '\0');
+    if (!typed.empty()) {
+        typed.resize(GetWindowTextA(hProfileCombo, &typed[0], (int)typed.size() + 1));
+    }
+    SendMessageA(hProfileCombo, CB_RESETCONTENT, 0, 0);
+    for (std::string_view name : profileStore.Names()) {
+        SendMessageA(hProfileCombo, CB_ADDSTRING, 0, (LPARAM)std::string(name).c_str());
+    }
+    SetWindowTextA(hProfileCombo, typed.c_str());
 }
 
-// Save settings from the edit box to the INI file
-// "This is the second biggest save button I've ever seen!"
-void SaveSettingsFromEditBox() {
-    char buffer[8192];
-    GetWindowTextA(hEditBox, buffer, sizeof(buffer));
-    WriteFile(iniPath, buffer);
+// The profile name currently selected or typed in the profile combo box
+std::string GetProfileName() {
+    std::string name(GetWindowTextLengthA(hProfileCombo), '\0');
+    if (!name.empty()) {
+        name.resize(GetWindowTextA(hProfileCombo, &name[0], (int)name.size() + 1));
+    }
+    return std::string(Trim(name));
 }
 
-// Reset settings to default values
-// "Resetting to defaults: It's like finding buried treasure!"
-void ResetToDefaults() {
-    const char* defaultSettings =
-        "[localization]\r\n"
-        "language=0\r\n"
-        "[display]\r\n"
-        "windowed=0\r\n"
-        "shaders=1\r\n"
-        "resolution=3840x2160\r\n"
-        "[audio]\r\n"
-        "music=70\r\n"
-        "voice=80\r\n"
-        "sfx=70\r\n"
-        "subtitles=1\r\n";
-
-    // Reset the edit box to default settings
-    SetWindowTextA(hEditBox, defaultSettings);
-
-    // Reset the language combo box to English (index 0)
-    SendMessageA(hLangCombo, CB_SETCURSEL, 0, 0);
-
-    // Reset the resolution combo box to 4K Full Screen (index 0)
-    SendMessageA(hResolutionCombo, CB_SETCURSEL, 1, 0);
-    SendMessageA(hSubtitlesCheckbox, BM_SETCHECK, BST_CHECKED, 0); // Default: checked
-    SendMessageA(hShadersCheckbox, BM_SETCHECK, BST_CHECKED, 0);   // Default: checked
+// Show the named profile and save it, as one step Undo takes back (unsaved edits included)
+void ApplyProfile(HWND hwnd) {
+    MISE_TRACE_SCOPE("ApplyProfile");
+    std::string name = GetProfileName();
+    std::string_view settings;
+    if (!profileStore.Find(name, settings)) {
+        MessageBoxA(hwnd, ("There is no profile named \"" + name + "\".").c_str(), "Profiles", MB_ICONERROR);
+        return;
+    }
+    // The controller asks about errors and disk changes and reports a failed write itself
+    controller.ApplyProfile(settings);
 }
 
-// Launch the game executable
-// "Launching the game: It's like setting sail for Monkey Island!"
-void LaunchGame() {
-    // Retrieve the Steam installation path from the registry
-    char steamPath[MAX_PATH] = {0};
-    HKEY hKey;
+// Store whatever is in the edit box (saved or not) under the typed name
+void SaveProfile(HWND hwnd) {
+    std::string name = GetProfileName();
+    if (name.empty()) {
+        MessageBoxA(hwnd, "Type a name for the profile in the box first.", "Profiles", MB_ICONWARNING);
+        return;
+    }
+    std::string error;
+    if (!profileStore.Put(name, normalizeWindowsNewlines(controller.Text()), error)) {
+        MessageBoxA(hwnd, ("The profile was not saved.\n" + error).c_str(), "Error", MB_ICONERROR);
+        return;
+    }
+    RefreshProfileCombo();
+}
 
-    if (RegOpenKeyExA(HKEY_CURRENT_USER, "Software\\Valve\\Steam", 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
-        DWORD pathSize = sizeof(steamPath);
-        if (RegQueryValueExA(hKey, "SteamExe", nullptr, nullptr, (LPBYTE)steamPath, &pathSize) != ERROR_SUCCESS) {
-            MessageBoxA(NULL, "Failed to retrieve Steam path from the registry.", "Error", MB_ICONERROR);
-            RegCloseKey(hKey);
-            return;
-        }
+// Where settings.ini and Steam are, and how the game gets started (core/Platform.h)
+std::unique_ptr<GamePlatform> platform = CreateSystemPlatform();
+
+// The launcher's own choices (back up on launch, restore after playing) live in the registry, not in settings.ini
+const char* const launcherRegistryKey = "Software\\MISELauncher";
+
+DWORD ReadLauncherValue(const char* name, DWORD fallback) {
+    HKEY hKey;
+    DWORD value = fallback, size = sizeof(value);
+    if (RegOpenKeyExA(HKEY_CURRENT_USER, launcherRegistryKey, 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
+        if (RegQueryValueExA(hKey, name, nullptr, nullptr, (LPBYTE)&value, &size) != ERROR_SUCCESS) value = fallback;
         RegCloseKey(hKey);
-    } else {
-        MessageBoxA(NULL, "Failed to open Steam registry key.", "Error", MB_ICONERROR);
-        return;
     }
+    return value;
+}
 
-    // Ensure the Steam path is valid
-    if (strlen(steamPath) == 0) {
-        MessageBoxA(NULL, "Steam path is empty. Ensure Steam is installed.", "Error", MB_ICONERROR);
-        return;
+void WriteLauncherValue(const char* name, DWORD value) {
+    HKEY hKey;
+    if (RegCreateKeyExA(HKEY_CURRENT_USER, launcherRegistryKey, 0, NULL, REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, NULL) == ERROR_SUCCESS) {
+        RegSetValueExA(hKey, name, 0, REG_DWORD, (const BYTE*)&value, sizeof(value));
+        RegCloseKey(hKey);
     }
+}
 
-    // Construct the command to launch the game via Steam
-    std::string command = std::string(steamPath) + " steam://launch/32360";
+// Back up the folder settings.ini lives in, keeping the newest defaultSnapshotKeep backups
+// "Never leave port without a spare map."
+bool TakeSnapshot(std::string& error) {
+    MISE_TRACE_SCOPE("TakeSnapshot");
+    SnapshotStore store(SnapshotStorePath(iniPath), SnapshotExcludedFiles(iniPath));
+    std::string id;
+    SnapshotStats stats;
+    return store.Take(SnapshotSourceDir(iniPath), id, stats, error) && store.Prune(defaultSnapshotKeep, error);
+}
 
-    // Launch the game using ShellExecuteA
-    HINSTANCE result = ShellExecuteA(NULL, "open", steamPath, "steam://launch/32360", NULL, SW_SHOWNORMAL);
+// Watches the game from launch to exit; each session's summary is added to sessions.log next to settings.ini
+GameSupervisor gameSupervisor(CreateSystemProcessMonitor());
+
+// Start watching for the game, unless the last launch's session is still going
+void StartSessionSupervisor(HWND hwnd) {
+    SessionOptions options;
+    options.exeName = gameExecutable;
+    options.iniPath = iniPath;
+    options.intervalMs = ReadLauncherValue("SessionSampleIntervalMs", options.intervalMs);
+    options.restoreSettings = ReadLauncherValue("RestoreSettingsAfterSession", 0) != 0;
+    gameSupervisor.Start(options, [hwnd](const SessionSummary& summary) {
+        if (!summary.found) return; // The launch failed, or Steam never got as far as the game
+        std::string error;
+        if (!AppendSessionLog(iniPath, summary, error)) {
+            PostMessageA(hwnd, WM_SESSION_LOG_FAILED, 0, (LPARAM)new std::string(error));
+        }
+        // A restored settings.ini comes back into the edit box through the file watcher
+    });
+}
 
-    // Check for errors without casting to int
-    if (reinterpret_cast<intptr_t>(result) <= 32) {
-        MessageBoxA(NULL, "Failed to launch the game via Steam. Ensure Steam is installed and running.", "Error", MB_ICONERROR);
+// Reads the game's big data files into the file cache while the window is up, so they load from memory after
+// Launch; progress shows in the title bar
+AssetPrefetcher assetPrefetcher;
+
+void StartPrefetch(HWND hwnd) {
+    PrefetchOptions options;
+    options.maxBytesPerSecond = (uint64_t)ReadLauncherValue("PrefetchMaxMBPerSecond", 0) << 20;
+    assetPrefetcher.Start(
+        [](std::string& error) {
+            SteamAppInstall install;
+            return platform->FindGameInstall(install, error) ? install.installPath : std::string();
+        },
+        options,
+        [hwnd](const PrefetchProgress& progress) {
+            PostMessageA(hwnd, WM_PREFETCH_PROGRESS, progress.Percent(), (LPARAM)progress.state);
+        });
+}
+
+// One launch at a time, off the UI thread; failures come back as WM_LAUNCH_FAILED
+std::thread launchWorker;
+std::atomic<bool> launchRunning{false};
+
+// Launch the game executable from the GUI
+void LaunchGame(HWND hwnd) {
+    if (launchRunning.exchange(true)) return; // Already on its way, ignore the double click
+    if (launchWorker.joinable()) launchWorker.join();
+    assetPrefetcher.Stop(); // The game reads its files itself now; a second reader would only make the disk seek
+    SetWindowTextA(hwnd, windowTitle.c_str()); // Clears the last session's log failure, if there was one
+    bool snapshot = SendMessageA(hSnapshotCheck, BM_GETCHECK, 0, 0) == BST_CHECKED;
+    launchWorker = std::thread([hwnd, snapshot] {
+        std::string error;
+        if (snapshot) {
+            // A failed backup is reported, but doesn't keep anyone from playing
+            TakeSnapshot(error);
+            PostMessageA(hwnd, WM_SNAPSHOT_DONE, 0, (LPARAM)new std::string(error));
+            error.clear();
+        }
+        // Watching starts first, so settings.ini as the launcher left it is what a restore goes back to
+        bool supervising = !gameSupervisor.IsRunning();
+        if (supervising) StartSessionSupervisor(hwnd);
+        if (!platform->LaunchGame(error)) {
+            if (supervising) gameSupervisor.Stop();
+            PostMessageA(hwnd, WM_LAUNCH_FAILED, 0, (LPARAM)new std::string(error));
+        }
+        launchRunning = false;
+    });
+    //Disable the message box for successful launch
+    //MessageBoxA(NULL, "Game launched successfully via Steam!", "Info", MB_OK);
+}
+
+// Check the install folder against install.manifest, off the UI thread; the report comes back as WM_VERIFY_DONE
+std::thread verifyWorker;
+std::atomic<bool> verifyRunning{false};
+
+void VerifyGameFiles(HWND hwnd) {
+    if (verifyRunning.exchange(true)) return; // Still checking
+    if (verifyWorker.joinable()) verifyWorker.join();
+    verifyWorker = std::thread([hwnd] {
+        SteamAppInstall install;
+        InstallReport report;
+        std::string error;
+        bool checked = platform->FindGameInstall(install, error) &&
+                       CheckInstall(install.installPath, install.buildId, InstallManifestPath(iniPath), InstallCheckOptions(),
+                                    report, error);
+        std::string text = checked ? InstallReportText(report, 20) : "The game's files could not be checked.\n" + error;
+        PostMessageA(hwnd, WM_VERIFY_DONE, checked && report.Ok(), (LPARAM)new std::string(text));
+        verifyRunning = false;
+    });
+}
+
+// Refill the backup combo box from the store, newest first
+void RefreshSnapshotCombo() {
+    std::string error;
+    SnapshotStore(SnapshotStorePath(iniPath)).List(snapshotList, error);
+    SendMessageA(hSnapshotCombo, CB_RESETCONTENT, 0, 0);
+    for (const SnapshotInfo& snapshot : snapshotList) {
+        SendMessageA(hSnapshotCombo, CB_ADDSTRING, 0, (LPARAM)SnapshotLabel(snapshot).c_str());
+    }
+    SendMessageA(hSnapshotCombo, CB_SETCURSEL, 0, 0);
+}
+
+// Put the data folder back the way the chosen backup found it, backing up the current files first
+void RestoreSnapshot(HWND hwnd) {
+    LRESULT selected = SendMessageA(hSnapshotCombo, CB_GETCURSEL, 0, 0);
+    if (selected == CB_ERR || (size_t)selected >= snapshotList.size()) {
+        MessageBoxA(hwnd, "There is no backup to restore yet.", "Backups", MB_ICONWARNING);
+        return;
+    }
+    if (launchRunning) return; // The launch worker may be taking a backup right now
+    const SnapshotInfo snapshot = snapshotList[selected];
+    std::string question = "Put settings.ini and the saves back the way they were at " + SnapshotLabel(snapshot) +
+                           "?\n\nThe files as they are now are backed up first, so this can be undone.";
+    if (MessageBoxA(hwnd, question.c_str(), "Backups", MB_YESNO | MB_ICONQUESTION) != IDYES) return;
+
+    MISE_TRACE_SCOPE("RestoreSnapshot");
+    std::string error;
+    RestoreStats restored;
+    if (!TakeSnapshot(error)) {
+        MessageBoxA(hwnd, ("Nothing was restored: the current files could not be backed up.\n" + error).c_str(), "Error", MB_ICONERROR);
+    } else if (!SnapshotStore(SnapshotStorePath(iniPath), SnapshotExcludedFiles(iniPath))
+                    .Restore(snapshot.id, SnapshotSourceDir(iniPath), restored, error)) {
+        std::string what = restored.failed.empty() ? "The backup was not restored.\n"
+                                                   : std::to_string(restored.filesWritten) + " files were restored, but ";
+        MessageBoxA(hwnd, (what + error).c_str(), "Error", MB_ICONERROR);
     } else {
-        //Disable the message box for successful launch
-        //MessageBoxA(NULL, "Game launched successfully via Steam!", "Info", MB_OK);
+        // settings.ini itself comes back into the edit box through the file watcher
+        std::string summary = std::to_string(restored.filesWritten) + " files restored, " +
+                              std::to_string(restored.filesUnchanged) + " already matched.";
+        if (restored.filesNotInSnapshot > 0) {
+            summary += "\n" + std::to_string(restored.filesNotInSnapshot) + " files not in the snapshot were left alone.";
+        }
+        MessageBoxA(hwnd, summary.c_str(), "Backups", MB_OK);
     }
+    RefreshSnapshotCombo();
 }
 
+// Resident mode (--resident): the window starts hidden behind a tray icon, and other programs drive the
+// launcher through the control channel instead of starting a process per change
+bool residentMode = false;
+NOTIFYICONDATAA trayIcon = {};
+ControlServer controlServer;
+std::unique_ptr<ControlService> controlService;
+
+// Listen for control requests; they're answered on the channel's threads, so only "launch" comes back here
+bool StartControlChannel(HWND hwnd, std::string& error) {
+    ControlHooks hooks;
+    hooks.launchGame = [hwnd](std::string&) {
+        PostMessageA(hwnd, WM_CONTROL_LAUNCH, 0, 0); // Failures are reported like a click on Launch Game
+        return true;
+    };
+    controlService = std::make_unique<ControlService>(iniPath, hooks);
+    controlService->Load(error);
+    return controlServer.Start(DefaultControlEndpoint(), [](std::string_view request) { return controlService->Handle(request); }, error);
+}
+
+void AddTrayIcon(HWND hwnd, HINSTANCE hInst) {
+    trayIcon.cbSize = sizeof(trayIcon);
+    trayIcon.hWnd = hwnd;
+    trayIcon.uID = 1;
+    trayIcon.uFlags = NIF_MESSAGE | NIF_ICON | NIF_TIP;
+    trayIcon.uCallbackMessage = WM_TRAYICON;
+    trayIcon.hIcon = LoadIcon(hInst, MAKEINTRESOURCE(IDI_MYICON));
+    lstrcpynA(trayIcon.szTip, windowTitle.c_str(), sizeof(trayIcon.szTip));
+    Shell_NotifyIconA(NIM_ADD, &trayIcon);
+}
+
+// Left click brings the window back; right click offers Show and Exit
+void OnTrayIcon(HWND hwnd, LPARAM mouseMessage) {
+    if (mouseMessage == WM_LBUTTONUP) {
+        ShowWindow(hwnd, SW_SHOW);
+        SetForegroundWindow(hwnd);
+    } else if (mouseMessage == WM_RBUTTONUP) {
+        HMENU menu = CreatePopupMenu();
+        AppendMenuA(menu, MF_STRING, IDM_TRAY_SHOW, "Show");
+        AppendMenuA(menu, MF_SEPARATOR, 0, NULL);
+        AppendMenuA(menu, MF_STRING, IDM_TRAY_EXIT, "Exit");
+        POINT cursor;
+        GetCursorPos(&cursor);
+        SetForegroundWindow(hwnd); // Or the menu won't close when clicked away from
+        int command = TrackPopupMenu(menu, TPM_RIGHTBUTTON | TPM_BOTTOMALIGN | TPM_RETURNCMD, cursor.x, cursor.y, 0, hwnd, NULL);
+        DestroyMenu(menu);
+        if (command == IDM_TRAY_SHOW) {
+            OnTrayIcon(hwnd, WM_LBUTTONUP);
+        } else if (command == IDM_TRAY_EXIT) {
+            DestroyWindow(hwnd);
+            PostQuitMessage(0);
+        }
+    }
+}
 
 // Function to get the current desktop resolution (primary display)
+// "I'm looking for the biggest screen on this island!"
 std::string GetDesktopResolution() {
-    DEVMODE devMode = {};
-    devMode.dmSize = sizeof(DEVMODE);
+    // The catalog already read it on its worker thread
+    std::shared_ptr<const DisplayModeSnapshot> snapshot = displayModes.Snapshot();
+    if (snapshot && snapshot->current.width > 0) {
+        return snapshot->current.Resolution();
+    }
 
-    // Get the current display settings for the primary monitor
-    if (EnumDisplaySettings(NULL, ENUM_CURRENT_SETTINGS, &devMode)) {
-        int width = devMode.dmPelsWidth;
-        int height = devMode.dmPelsHeight;
-        return std::to_string(width) + "x" + std::to_string(height);
+    // Still enumerating (or it failed), so ask directly for the primary monitor
+    std::string resolution = platform->DesktopResolution();
+    if (!resolution.empty()) {
+        return resolution;
     }
 
     MessageBoxA(NULL, "Failed to retrieve desktop resolution. Using default resolution.", "Error", MB_ICONERROR);
     return "1920x1080";
 }
 
+// Function to refill the resolution combo with what the display-mode catalog found
+void FillResolutionCombo() {
+    std::shared_ptr<const DisplayModeSnapshot> snapshot = displayModes.Snapshot();
+    controller.SetResolutions(snapshot ? snapshot->resolutions : std::vector<DisplayMode>());
+}
+
+// Ctrl+Z undoes, Ctrl+Y or Ctrl+Shift+Z redoes, wherever the focus is in the window
+bool HandleHistoryKey(WPARAM key) {
+    if (!(GetKeyState(VK_CONTROL) & 0x8000)) return false;
+    if (key == 'Z') {
+        if (GetKeyState(VK_SHIFT) & 0x8000) {
+            controller.Redo();
+        } else {
+            controller.Undo();
+        }
+    } else if (key == 'Y') {
+        controller.Redo();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Check boxes and slider captions sit on the window background like the labels do
+bool IsSettingLabel(HWND hwnd) {
+    for (size_t i = 0; i < settingBindingCount; ++i) {
+        if (hwnd == settingCaptions[i] || (hwnd == settingControls[i] && settingBindings[i].widget == WidgetKind::CheckBox)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Span names for the messages WndProc handles; everything else goes to DefWindowProc untraced
+const char* MessageSpanName(UINT msg) {
+    switch (msg) {
+        case WM_COMMAND: return "WM_COMMAND";
+        case WM_HSCROLL: return "WM_HSCROLL";
+#define LAUNCHER_MESSAGE_SPAN(name, offset) case name: return #name;
+        LAUNCHER_MESSAGES(LAUNCHER_MESSAGE_SPAN)
+#undef LAUNCHER_MESSAGE_SPAN
+        case WM_TIMER: return "WM_TIMER";
+        case WM_DISPLAYCHANGE: return "WM_DISPLAYCHANGE";
+        case WM_CTLCOLORSTATIC: return "WM_CTLCOLORSTATIC";
+        case WM_PAINT: return "WM_PAINT";
+        case WM_SYSCOMMAND: return "WM_SYSCOMMAND";
+        default: return nullptr;
+    }
+}
+
 // Window procedure for handling messages
 // "Handling messages: It's like deciphering a pirate's map!"
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    TraceSpan messageSpan(MessageSpanName(msg));
     switch (msg) {
         case WM_COMMAND:
-            if ((HWND)lParam == hEditBox && HIWORD(wParam) == EN_CHANGE) {
-                // Show the "Remember to save!" label
-                ShowWindow(hSaveReminderLabel, SW_SHOW);
+            if ((HWND)lParam == hEditBox && HIWORD(wParam) == EN_CHANGE && !controller.UpdatingTextBox()) {
+                controller.TextEdited(GetEditBoxText()); // The user typed something
             }
-            if ((HWND)lParam == hResolutionCombo && HIWORD(wParam) == CBN_SELCHANGE) { // Handle resolution change
-                // Get the selected resolution
-                char resolution[64];
-                int selected = SendMessageA(hResolutionCombo, CB_GETCURSEL, 0, 0);
-                SendMessageA(hResolutionCombo, CB_GETLBTEXT, selected, (LPARAM)resolution);
-
-                if (strcmp(resolution, "Autodetect/Recommend Resolution") == 0) {
-                    // Autodetect the desktop resolution
-                    std::string desktopResolution = GetDesktopResolution();
-
-                    // Update the resolution and windowed fields in the edit box
-                    char buffer[8192];
-                    GetWindowTextA(hEditBox, buffer, sizeof(buffer));
-                    std::string content(buffer);
-
-                    // Update the resolution field
-                    size_t pos = content.find("resolution=");
-                    if (pos != std::string::npos) {
-                        size_t start = pos + 11; // "resolution=" is 11 characters long
-                        size_t end = content.find("\r\n", start);
-                        content.replace(start, end - start, desktopResolution);
-                    }
-
-                    // Set windowed mode to 0 (default to fullscreen for autodetect)
-                    pos = content.find("windowed=");
-                    if (pos != std::string::npos) {
-                        size_t start = pos + 9; // "windowed=" is 9 characters long
-                        size_t end = content.find("\r\n", start);
-                        content.replace(start, end - start, "0");
-                    }
-
-                    // Update the edit box with the new content
-                    SetWindowTextA(hEditBox, content.c_str());
-                    ShowWindow(hSaveReminderLabel, SW_SHOW);
-
-                    // Optionally, show a message box to confirm the change
-                    //MessageBoxA(hwnd, ("Resolution set to " + desktopResolution + "\nFull Screen").c_str(), "Autodetect Resolution", MB_OK);
-                } else {
-                    // Handle other resolution options (existing logic)
-                    bool isWindowed = strstr(resolution, "Windowed") != nullptr;
-                    std::string resolutionValue;
-                    const char* start = strchr(resolution, '(');
-                    const char* end = strchr(resolution, ')');
-                    if (start && end && start < end) {
-                        resolutionValue = std::string(start + 1, end - start - 1);
-                    }
-
-                    // Update the resolution and windowed fields in the edit box
-                    char buffer[8192];
-                    GetWindowTextA(hEditBox, buffer, sizeof(buffer));
-                    std::string content(buffer);
-
-                    size_t pos = content.find("resolution=");
-                    if (pos != std::string::npos) {
-                        size_t start = pos + 11;
-                        size_t end = content.find("\r\n", start);
-                        content.replace(start, end - start, resolutionValue);
-                    }
-
-                    pos = content.find("windowed=");
-                    if (pos != std::string::npos) {
-                        size_t start = pos + 9;
-                        size_t end = content.find("\r\n", start);
-                        content.replace(start, end - start, isWindowed ? "1" : "0");
-                    }
-
-                    SetWindowTextA(hEditBox, content.c_str());
-                    ShowWindow(hSaveReminderLabel, SW_SHOW);
-                }
+            if (const SettingBinding* binding = FindSettingBinding(LOWORD(wParam))) { // A settings control
+                bool changed = binding->widget == WidgetKind::CheckBox ? HIWORD(wParam) == BN_CLICKED
+                                                                        : HIWORD(wParam) == CBN_SELCHANGE;
+                if (changed) controller.ControlChanged(binding->controlId);
+
             } else if ((HWND)lParam == hLaunchBtn) { // Launch the game
-                LaunchGame();
+                MISE_TRACE_SCOPE("Command.Launch");
+                LaunchGame(hwnd);
             
             } else if ((HWND)lParam == hSaveBtn) { // Save settings
-                SaveSettingsFromEditBox();
-                //MessageBoxA(hwnd, "Settings saved.", "Info", MB_OK);
+                controller.Save();
 
-                // Hide the "Remember to save!" label
-                ShowWindow(hSaveReminderLabel, SW_HIDE);
-            
             } else if ((HWND)lParam == hResetBtn) { // Reset to defaults
-                ResetToDefaults();
-                //MessageBoxA(hwnd, "Defaults restored. Don't forget to save!", "Info", MB_OK);
-                ShowWindow(hSaveReminderLabel, SW_SHOW);
+                controller.Reset();
             
+            } else if ((HWND)lParam == hApplyProfileBtn) { // Apply the chosen profile
+                MISE_TRACE_SCOPE("Command.ApplyProfile");
+                ApplyProfile(hwnd);
+
+            } else if ((HWND)lParam == hSaveProfileBtn) { // Save the edit box as a profile
+                MISE_TRACE_SCOPE("Command.SaveProfile");
+                SaveProfile(hwnd);
+
+            } else if ((HWND)lParam == hSnapshotCheck && HIWORD(wParam) == BN_CLICKED) { // Back up before launch, or not
+                WriteLauncherValue("SnapshotBeforeLaunch", SendMessageA(hSnapshotCheck, BM_GETCHECK, 0, 0) == BST_CHECKED);
+
+            } else if ((HWND)lParam == hRestoreSnapshotBtn) { // Restore the chosen backup
+                MISE_TRACE_SCOPE("Command.RestoreSnapshot");
+                RestoreSnapshot(hwnd);
+
             } else if ((HWND)lParam == hExitBtn) { // Exit the application
                 DestroyWindow(hwnd);  // Destroy the window
                 PostQuitMessage(0);   // Exit the message loop
+            }
+            break;
 
-            } else if ((HWND)lParam == hResolutionCombo && HIWORD(wParam) == CBN_SELCHANGE) { // Handle resolution change
-                // Get the selected resolution
-                char resolution[64];
-                int selected = SendMessageA(hResolutionCombo, CB_GETCURSEL, 0, 0);
-                SendMessageA(hResolutionCombo, CB_GETLBTEXT, selected, (LPARAM)resolution);
-                // Determine if the selection is Full Screen or Windowed
-                bool isWindowed = strstr(resolution, "Windowed") != nullptr;
-                // Extract the resolution value (e.g., "3840x2160")
-                std::string resolutionValue;
-                const char* start = strchr(resolution, '(');
-                const char* end = strchr(resolution, ')');
-                if (start && end && start < end) {
-                    resolutionValue = std::string(start + 1, end - start - 1);
-                }
-                // Update the resolution and windowed fields in the edit box
-                char buffer[8192];
-                GetWindowTextA(hEditBox, buffer, sizeof(buffer));
-                std::string content(buffer);
-                // Update the resolution field
-                size_t pos = content.find("resolution=");
-                if (pos != std::string::npos) {
-                    size_t start = pos + 11; // "resolution=" is 11 characters long
-                    size_t end = content.find("\r\n", start);
-                    content.replace(start, end - start, resolutionValue);
-                }
-                // Update the windowed field
-                pos = content.find("windowed=");
-                if (pos != std::string::npos) {
-                    size_t start = pos + 9; // "windowed=" is 9 characters long
-                    size_t end = content.find("\r\n", start);
-                    content.replace(start, end - start, isWindowed ? "1" : "0");
-                }
-                SetWindowTextA(hEditBox, content.c_str()); // Update the edit box with the new content
-                ShowWindow(hSaveReminderLabel, SW_SHOW);
-
-            } else if (LOWORD(wParam) == ID_LANG_COMBO && HIWORD(wParam) == CBN_SELCHANGE) { // Handle language change
-                int selected = SendMessageA(hLangCombo, CB_GETCURSEL, 0, 0);
-                char buffer[8192];
-                GetWindowTextA(hEditBox, buffer, sizeof(buffer));
-                std::string content(buffer);
-                size_t pos = content.find("language=");
-                if (pos != std::string::npos) {
-                size_t start = pos + 9;  // "language=" is 9 characters long
-                size_t end = start + 1;  // The language number is 1 character long
-                content.replace(start, end - start, std::to_string(selected));
-                }
-                SetWindowTextA(hEditBox, content.c_str());
-                ShowWindow(hSaveReminderLabel, SW_SHOW);
-
-            } else if ((HWND)lParam == hSubtitlesCheckbox) { // Handle subtitles checkbox
-                // Toggle subtitles setting
-                bool isChecked = SendMessageA(hSubtitlesCheckbox, BM_GETCHECK, 0, 0) == BST_CHECKED;
-                char buffer[8192];
-                GetWindowTextA(hEditBox, buffer, sizeof(buffer));
-                std::string content(buffer);
-                size_t pos = content.find("subtitles=");
-                if (pos != std::string::npos) {
-                    size_t start = pos + 10; // "subtitles=" is 10 characters long
-                    size_t end = content.find("\r\n", start);
-                    content.replace(start, end - start, isChecked ? "1" : "0");
-                }
-                SetWindowTextA(hEditBox, content.c_str());
-                ShowWindow(hSaveReminderLabel, SW_SHOW);
-
-            } else if ((HWND)lParam == hShadersCheckbox) { // Handle shaders checkbox
-                // Toggle shaders setting
-                bool isChecked = SendMessageA(hShadersCheckbox, BM_GETCHECK, 0, 0) == BST_CHECKED;
-                char buffer[8192];
-                GetWindowTextA(hEditBox, buffer, sizeof(buffer));
-                std::string content(buffer);
-                size_t pos = content.find("shaders=");
-                if (pos != std::string::npos) {
-                    size_t start = pos + 8; // "shaders=" is 8 characters long
-                    size_t end = content.find("\r\n", start);
-                    content.replace(start, end - start, isChecked ? "1" : "0");
-                }
-                SetWindowTextA(hEditBox, content.c_str());
-                ShowWindow(hSaveReminderLabel, SW_SHOW);
+        case WM_HSCROLL:
+            // Sliders report every step of a drag; the setting is written once, when it's let go
+            if (lParam && LOWORD(wParam) == TB_ENDTRACK) {
+                const SettingBinding* binding = FindSettingBinding(GetDlgCtrlID((HWND)lParam));
+                if (binding && binding->widget == WidgetKind::Slider) controller.ControlChanged(binding->controlId);
+            }
+            return 0;
+
+        case WM_SETTINGS_FILE_CHANGED:
+            controller.FileChanged();
+            if (controlService) controlService->FileChanged();
+            return 0;
+
+        case WM_CONTROL_LAUNCH:
+            LaunchGame(hwnd);
+            return 0;
+
+        case WM_TRAYICON:
+            OnTrayIcon(hwnd, lParam);
+            return 0;
+
+        case WM_LAUNCH_FAILED: {
+            std::unique_ptr<std::string> error((std::string*)lParam);
+            MessageBoxA(hwnd, error->c_str(), "Error", MB_ICONERROR);
+            return 0;
+        }
+
+        case WM_DISPLAY_MODES_READY:
+            FillResolutionCombo();
+            return 0;
+
+        case WM_PREFETCH_PROGRESS:
+            if ((PrefetchState)lParam == PrefetchState::Running) {
+                SetWindowTextA(hwnd, (windowTitle + " - loading game files " + std::to_string(wParam) + "%").c_str());
+            } else {
+                SetWindowTextA(hwnd, windowTitle.c_str());
+            }
+            return 0;
+
+        case WM_SESSION_LOG_FAILED: {
+            // Not worth a message box after the game has closed; the title bar says it until the next launch
+            std::unique_ptr<std::string> error((std::string*)lParam);
+            SetWindowTextA(hwnd, (windowTitle + " - the session was not logged: " + *error).c_str());
+            return 0;
+        }
+
+        case WM_VERIFY_DONE: {
+            std::unique_ptr<std::string> report((std::string*)lParam);
+            MessageBoxA(hwnd, report->c_str(), "Verify Game Files", wParam ? MB_ICONINFORMATION : MB_ICONWARNING);
+            return 0;
+        }
+
+        case WM_SNAPSHOT_DONE: {
+            std::unique_ptr<std::string> error((std::string*)lParam);
+            RefreshSnapshotCombo();
+            if (!error->empty()) {
+                MessageBoxA(hwnd, ("The saves were not backed up before launch.\n" + *error).c_str(), "Backups", MB_ICONWARNING);
+            }
+            return 0;
+        }
+
+        case WM_TIMER:
+            if (wParam == IDT_VALIDATE) {
+                KillTimer(hwnd, IDT_VALIDATE);
+                controller.Validate();
+                return 0;
+            }
+            if (wParam == IDT_JOURNAL) {
+                KillTimer(hwnd, IDT_JOURNAL);
+                controller.CompactJournal();
+                return 0;
             }
             break;
 
+        case WM_DISPLAYCHANGE:
+            // A monitor was plugged in or changed mode; the cached list is no longer the truth
+            displayModes.Invalidate([hwnd] { PostMessageA(hwnd, WM_DISPLAY_MODES_READY, 0, 0); });
+            return 0;
+
         case WM_CTLCOLORSTATIC: {
             HDC hdcStatic = (HDC)wParam;
             HWND hStatic = (HWND)lParam;
 
+            if (hStatic == hDiagnosticsLabel) {
+                // Opaque, since its text changes while the window is up
+                SetTextColor(hdcStatic, diagnosticsAreErrors ? RGB(200, 0, 0) : RGB(170, 100, 0));
+                SetBkColor(hdcStatic, GetSysColor(COLOR_WINDOW));
+                return (LRESULT)GetSysColorBrush(COLOR_WINDOW);
+            }
             if (
                 hStatic == hSaveReminderLabel ||
                 hStatic == hIniPathLabel ||
                 hStatic == hIniPathTextLabel ||
-                hStatic == hSubtitlesCheckbox ||
-                hStatic == hShadersCheckbox
+                hStatic == hSnapshotCheck ||
+                IsSettingLabel(hStatic)
             ) {
                 if (hStatic == hSaveReminderLabel) {
                     SetTextColor(hdcStatic, RGB(255, 0, 0)); // Red text for the reminder
@@ -488,6 +760,9 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 SetBkMode(hdcStatic, TRANSPARENT); // Transparent background for all
                 return (LRESULT)GetStockObject(NULL_BRUSH);
             }
+            if (const SettingBinding* binding = FindSettingBinding(GetDlgCtrlID(hStatic))) {
+                if (binding->widget == WidgetKind::Slider) return (LRESULT)GetSysColorBrush(COLOR_WINDOW); // Trackbar channel background
+            }
             // For all other static controls, use the default background.
             break;
         }
@@ -504,7 +779,49 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             SetCursor(LoadCursor(NULL, IDC_ARROW));
             return TRUE;
 
+        case WM_SYSCOMMAND:
+            if ((wParam & 0xFFF0) == IDM_WRITE_TRACE) {
+                std::string traceError;
+                if (WriteChromeTrace(tracePath, traceError)) {
+                    MessageBoxA(hwnd, ("Trace written to\n" + tracePath).c_str(), "Trace", MB_OK);
+                } else {
+                    MessageBoxA(hwnd, ("The trace was not written.\n" + traceError).c_str(), "Trace", MB_ICONERROR);
+                }
+                return 0;
+            }
+            if ((wParam & 0xFFF0) == IDM_PREFETCH_AT_START) {
+                bool prefetch = ReadLauncherValue("PrefetchOnStart", 0) == 0;
+                WriteLauncherValue("PrefetchOnStart", prefetch);
+                CheckMenuItem(GetSystemMenu(hwnd, FALSE), IDM_PREFETCH_AT_START, prefetch ? MF_CHECKED : MF_UNCHECKED);
+                if (prefetch) {
+                    StartPrefetch(hwnd);
+                } else {
+                    assetPrefetcher.Stop();
+                }
+                return 0;
+            }
+            if ((wParam & 0xFFF0) == IDM_VERIFY_INSTALL) {
+                VerifyGameFiles(hwnd);
+                return 0;
+            }
+            if ((wParam & 0xFFF0) == IDM_RESTORE_AFTER_SESSION) {
+                bool restore = ReadLauncherValue("RestoreSettingsAfterSession", 0) == 0;
+                WriteLauncherValue("RestoreSettingsAfterSession", restore);
+                CheckMenuItem(GetSystemMenu(hwnd, FALSE), IDM_RESTORE_AFTER_SESSION, restore ? MF_CHECKED : MF_UNCHECKED);
+                return 0;
+            }
+            return DefWindowProc(hwnd, msg, wParam, lParam);
+
+        case WM_ENDSESSION:
+            // Logging off or shutting down: the process ends without the message loop finishing
+            if (wParam) controller.CompactJournal();
+            return 0;
+
         case WM_CLOSE:
+            if (residentMode) {
+                ShowWindow(hwnd, SW_HIDE); // Back to the tray; Exit (button or tray menu) really quits
+                return 0;
+            }
             DestroyWindow(hwnd);  // Destroy the window
             PostQuitMessage(0);   // Exit the message loop
             break;
@@ -515,14 +832,60 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     return 0;
 }
 
+// Run the headless command-line mode, printing to the console we were started from
+// "Look behind you, a headless monkey!"
+int RunCommandLine(const std::vector<std::string>& args) {
+    // A -mwindows program has no console of its own; borrow the parent's if there is one
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        freopen("CONOUT$", "w", stdout);
+        freopen("CONOUT$", "w", stderr);
+    }
+
+    CliHooks hooks;
+    hooks.iniPath = [] { return platform->SettingsPath(); };
+    hooks.launchGame = [](std::string& error) { return platform->LaunchGame(error); };
+    hooks.findInstall = [](SteamAppInstall& install, std::string& error) { return platform->FindGameInstall(install, error); };
+    int status = RunSettingsCli(args, hooks, std::cout, std::cerr);
+
+    std::string traceError;
+    if (!tracePath.empty() && !WriteChromeTrace(tracePath, traceError)) {
+        std::cerr << "Failed to write trace: " << traceError << "\n";
+    }
+    return status;
+}
+
 // Entry point
 // "This is the second biggest entry point I've ever seen!"
 int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int nCmdShow) {
-    iniPath = GetINIPath();
-    if (iniPath.empty()) {
-        MessageBoxA(NULL, "settings.ini file not found!", "Error", MB_ICONERROR);
-        return 1;
+    // MISE_TRACE=trace.json records spans for this run (see core/Trace.h)
+    tracePath = EnableTracingFromEnvironment();
+
+    // Command-line mode: no window class, no fonts, no controls, just edit and go
+    std::vector<std::string> args(__argv + 1, __argv + __argc);
+    auto resident = std::find(args.begin(), args.end(), "--resident");
+    if (resident != args.end()) {
+        residentMode = true;
+        args.erase(resident);
     }
+    if (IsCliInvocation(args)) {
+        return RunCommandLine(args);
+    }
+
+    // Trackbars live in comctl32
+    INITCOMMONCONTROLSEX commonControls = {sizeof(commonControls), ICC_BAR_CLASSES};
+    InitCommonControlsEx(&commonControls);
+
+    // Slow lookups and file I/O run on workers while this thread builds the window; joined before the first paint
+    TaskGraph startup;
+    StartupState startupState;
+    StartupHooks startupHooks;
+    startupHooks.iniPath = [] { return platform->SettingsPath(); };
+    startupHooks.steamRoot = [](std::string& steamRoot, std::string& error) {
+        std::string steamExe;
+        return platform->SteamPaths(steamRoot, steamExe, error);
+    };
+    StartupTasks startupTasks = AddStartupTasks(startup, startupState, startupHooks, profileStore, platform->Locator(), displayModes);
+    startup.Start(3);
 
     // Construct the window title with the version number
     //const std::string windowTitle = std::string("Monkey Launcher - by Curvez 2025 " VERSION "").c_str();
@@ -540,7 +903,7 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int nCmdShow) {
     HWND hwnd = CreateWindowExA(
         0, CLASS_NAME, windowTitle.c_str(),
         WS_CAPTION | WS_SYSMENU | WS_MINIMIZEBOX,
-        CW_USEDEFAULT, CW_USEDEFAULT, 792, 480, // Adjusted window size
+        CW_USEDEFAULT, CW_USEDEFAULT, 792, 595, // Adjusted window size (room for the volume, profile and backup rows)
         NULL, NULL, hInst, NULL
     );
 
@@ -562,61 +925,99 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int nCmdShow) {
         DEFAULT_QUALITY, DEFAULT_PITCH | FF_SWISS, "Segoe UI Emoji"
     );
 
+    startup.Wait(startupTasks.iniPath);
+    iniPath = startupState.iniPath;
+    if (iniPath.empty()) {
+        DestroyWindow(hwnd);
+        MessageBoxA(NULL, "settings.ini file not found!", "Error", MB_ICONERROR);
+        return 1;
+    }
+    controller.SetIniPath(iniPath);
+
     hIniPathTextLabel = CreateWindowA("STATIC", "Settings INI Path:", WS_VISIBLE | WS_CHILD, 20, 20, 120, 20, hwnd, NULL, hInst, NULL);
     hIniPathLabel = CreateWindowA("STATIC", iniPath.c_str(), WS_VISIBLE | WS_CHILD | SS_LEFT | SS_NOPREFIX, 150, 20, 600, 40, hwnd, NULL, hInst, NULL);
     SendMessageA(hIniPathLabel, WM_SETFONT, (WPARAM)hFontSmall, TRUE);
 
+    // Problems found in the edit box, shown just above it
+    hDiagnosticsLabel = CreateWindowA("STATIC", "", WS_CHILD | SS_LEFT | SS_NOPREFIX, 20, 60, 740, 18, hwnd, NULL, hInst, NULL);
+    SendMessageA(hDiagnosticsLabel, WM_SETFONT, (WPARAM)hFontSmall, TRUE);
+
     hEditBox = CreateWindowA("EDIT", "", WS_VISIBLE | WS_CHILD | WS_BORDER | ES_MULTILINE | ES_AUTOVSCROLL | WS_VSCROLL,
                              20, 80, 740, 250, hwnd, NULL, hInst, NULL); // Text box remains at y = 80
     SendMessageA(hEditBox, WM_SETFONT, (WPARAM)hFontLarge, TRUE);
+    SendMessageA(hEditBox, EM_SETLIMITTEXT, 0, 0); // No 32K typing limit on big files
+
+    // Settings controls, one per row of settingBindings; the resolutions are added once the startup graph has listed the display modes
+    for (size_t i = 0; i < settingBindingCount; ++i) {
+        const SettingBinding& binding = settingBindings[i];
+        HMENU controlId = (HMENU)(INT_PTR)binding.controlId;
+        HWND control = NULL;
+        switch (binding.widget) {
+            case WidgetKind::ComboBox:
+                control = CreateWindowA("COMBOBOX", "", WS_VISIBLE | WS_CHILD | CBS_DROPDOWNLIST | CBS_HASSTRINGS | WS_VSCROLL,
+                                        binding.x, binding.y, binding.width, binding.height, hwnd, controlId, hInst, NULL);
+                for (int item = 0; item < binding.itemCount; ++item) {
+                    SendMessageA(control, CB_ADDSTRING, 0, (LPARAM)binding.items[item]);
+                }
+                break;
+            case WidgetKind::CheckBox:
+                control = CreateWindowA("BUTTON", binding.label, WS_VISIBLE | WS_CHILD | BS_AUTOCHECKBOX,
+                                        binding.x, binding.y, binding.width, binding.height, hwnd, controlId, hInst, NULL);
+                SendMessageA(control, BM_SETCHECK, BST_CHECKED, 0); // Default value: checked
+                break;
+            case WidgetKind::Slider: {
+                const int captionWidth = 55;
+                settingCaptions[i] = CreateWindowA("STATIC", binding.label, WS_VISIBLE | WS_CHILD | SS_LEFT,
+                                                   binding.x, binding.y + 5, captionWidth, binding.height - 5, hwnd, NULL, hInst, NULL);
+                SendMessageA(settingCaptions[i], WM_SETFONT, (WPARAM)hFontLarge, TRUE);
+                control = CreateWindowA(TRACKBAR_CLASSA, "", WS_VISIBLE | WS_CHILD | WS_TABSTOP | TBS_HORZ | TBS_NOTICKS,
+                                        binding.x + captionWidth, binding.y, binding.width - captionWidth, binding.height,
+                                        hwnd, controlId, hInst, NULL);
+                SendMessageA(control, TBM_SETRANGE, TRUE, MAKELPARAM(0, 100));
+                SendMessageA(control, TBM_SETPAGESIZE, 0, 10);
+                break;
+            }
+        }
+        SendMessageA(control, WM_SETFONT, (WPARAM)hFontLarge, TRUE);
+        settingControls[i] = control;
+    }
 
-    hLangCombo = CreateWindowA("COMBOBOX", "", WS_VISIBLE | WS_CHILD | CBS_DROPDOWNLIST | CBS_HASSTRINGS | WS_VSCROLL,
-                               20, 340, 200, 150, hwnd, (HMENU)ID_LANG_COMBO, hInst, NULL); // Moved closer to the text box
-    SendMessageA(hLangCombo, WM_SETFONT, (WPARAM)hFontLarge, TRUE);
-
-    SendMessageA(hLangCombo, CB_ADDSTRING, 0, (LPARAM)"English");
-    SendMessageA(hLangCombo, CB_ADDSTRING, 0, (LPARAM)"French");
-    SendMessageA(hLangCombo, CB_ADDSTRING, 0, (LPARAM)"Italian");
-    SendMessageA(hLangCombo, CB_ADDSTRING, 0, (LPARAM)"German");
-    SendMessageA(hLangCombo, CB_ADDSTRING, 0, (LPARAM)"Spanish");
-
-    // Create the resolution combo box
-    hResolutionCombo = CreateWindowA("COMBOBOX", "", WS_VISIBLE | WS_CHILD | CBS_DROPDOWNLIST | CBS_HASSTRINGS | WS_VSCROLL,
-                                     240, 340, 300, 230, hwnd, NULL, hInst, NULL); // Same y position as language combo box
-    SendMessageA(hResolutionCombo, WM_SETFONT, (WPARAM)hFontLarge, TRUE);
-
-    // Add resolutions to the combo box
-    SendMessageA(hResolutionCombo, CB_ADDSTRING, 0, (LPARAM)"Autodetect/Recommend Resolution");
-    SendMessageA(hResolutionCombo, CB_ADDSTRING, 0, (LPARAM)"4K UHD  - Full Screen (3840x2160)");
-    SendMessageA(hResolutionCombo, CB_ADDSTRING, 0, (LPARAM)"4K UHD  - Windowed    (3840x2160)");
-    SendMessageA(hResolutionCombo, CB_ADDSTRING, 0, (LPARAM)"QHD/2K  - Full Screen (2560x1440)");
-    SendMessageA(hResolutionCombo, CB_ADDSTRING, 0, (LPARAM)"QHD/2K  - Windowed    (2560x1440)");
-    SendMessageA(hResolutionCombo, CB_ADDSTRING, 0, (LPARAM)"Full HD - Full Screen (1920x1080)");
-    SendMessageA(hResolutionCombo, CB_ADDSTRING, 0, (LPARAM)"Full HD - Windowed    (1920x1080)");
-
-    // Subtitles checkbox
-    hSubtitlesCheckbox = CreateWindowA("BUTTON", "Enable Subtitles", WS_VISIBLE | WS_CHILD | BS_AUTOCHECKBOX,
-                                       20, 365, 200, 30, hwnd, NULL, hInst, NULL); // Moved to y = 385
-    SendMessageA(hSubtitlesCheckbox, WM_SETFONT, (WPARAM)hFontLarge, TRUE);
-    SendMessageA(hSubtitlesCheckbox, BM_SETCHECK, BST_CHECKED, 0); // Default value: checked
-
-    // Shaders checkbox
-    hShadersCheckbox = CreateWindowA("BUTTON", "Enable Shaders", WS_VISIBLE | WS_CHILD | BS_AUTOCHECKBOX,
-                                     240, 365, 200, 30, hwnd, NULL, hInst, NULL); // Moved to y = 385
-    SendMessageA(hShadersCheckbox, WM_SETFONT, (WPARAM)hFontLarge, TRUE);
-    SendMessageA(hShadersCheckbox, BM_SETCHECK, BST_CHECKED, 0); // Default value: checked
-
-    hLaunchBtn = CreateWindowW(L"BUTTON", L"🙊 Launch Game", WS_VISIBLE | WS_CHILD, 20, 405, 150, 30, hwnd, NULL, hInst, NULL); 
+    hLaunchBtn = CreateWindowW(L"BUTTON", L"🙊 Launch Game", WS_VISIBLE | WS_CHILD, 20, 440, 150, 30, hwnd, NULL, hInst, NULL); 
     SendMessageW(hLaunchBtn, WM_SETFONT, (WPARAM)hFontEmoji, TRUE);
 
-    hSaveBtn = CreateWindowW(L"BUTTON", L"🙈 Save Settings", WS_VISIBLE | WS_CHILD, 205, 405, 150, 30, hwnd, NULL, hInst, NULL); 
+    hSaveBtn = CreateWindowW(L"BUTTON", L"🙈 Save Settings", WS_VISIBLE | WS_CHILD, 205, 440, 150, 30, hwnd, NULL, hInst, NULL); 
     SendMessageW(hSaveBtn, WM_SETFONT, (WPARAM)hFontEmoji, TRUE);
 
-    hResetBtn = CreateWindowW(L"BUTTON", L"🙉 Reset Defaults", WS_VISIBLE | WS_CHILD, 390, 405, 150, 30, hwnd, NULL, hInst, NULL); 
+    hResetBtn = CreateWindowW(L"BUTTON", L"🙉 Reset Defaults", WS_VISIBLE | WS_CHILD, 390, 440, 150, 30, hwnd, NULL, hInst, NULL); 
     SendMessageW(hResetBtn, WM_SETFONT, (WPARAM)hFontEmoji, TRUE);
     
+    // Profile row, under Reset Defaults: type or pick a name, then apply or save it
+    hProfileCombo = CreateWindowA("COMBOBOX", "", WS_VISIBLE | WS_CHILD | CBS_DROPDOWN | CBS_HASSTRINGS | WS_VSCROLL,
+                                  20, 480, 335, 200, hwnd, NULL, hInst, NULL);
+    SendMessageA(hProfileCombo, WM_SETFONT, (WPARAM)hFontLarge, TRUE);
+
+    hApplyProfileBtn = CreateWindowW(L"BUTTON", L"🗺 Apply Profile", WS_VISIBLE | WS_CHILD, 390, 480, 150, 30, hwnd, NULL, hInst, NULL);
+    SendMessageW(hApplyProfileBtn, WM_SETFONT, (WPARAM)hFontEmoji, TRUE);
+
+    hSaveProfileBtn = CreateWindowW(L"BUTTON", L"💾 Save as Profile", WS_VISIBLE | WS_CHILD, 610, 480, 150, 30, hwnd, NULL, hInst, NULL);
+    SendMessageW(hSaveProfileBtn, WM_SETFONT, (WPARAM)hFontEmoji, TRUE);
+
+    // Backup row: back up the data folder on launch, or pick a backup and restore it
+    hSnapshotCheck = CreateWindowA("BUTTON", "Backup on launch", WS_VISIBLE | WS_CHILD | BS_AUTOCHECKBOX,
+                                   20, 520, 180, 30, hwnd, NULL, hInst, NULL);
+    SendMessageA(hSnapshotCheck, WM_SETFONT, (WPARAM)hFontLarge, TRUE);
+    SendMessageA(hSnapshotCheck, BM_SETCHECK, ReadLauncherValue("SnapshotBeforeLaunch", 0) ? BST_CHECKED : BST_UNCHECKED, 0);
+
+    hSnapshotCombo = CreateWindowA("COMBOBOX", "", WS_VISIBLE | WS_CHILD | CBS_DROPDOWNLIST | CBS_HASSTRINGS | WS_VSCROLL,
+                                   205, 520, 335, 200, hwnd, NULL, hInst, NULL);
+    SendMessageA(hSnapshotCombo, WM_SETFONT, (WPARAM)hFontSmall, TRUE);
+
+    hRestoreSnapshotBtn = CreateWindowW(L"BUTTON", L"⏪ Restore Backup", WS_VISIBLE | WS_CHILD, 610, 520, 150, 30, hwnd, NULL, hInst, NULL);
+    SendMessageW(hRestoreSnapshotBtn, WM_SETFONT, (WPARAM)hFontEmoji, TRUE);
+
+
     // Exit button
-    hExitBtn = CreateWindowW(L"BUTTON", L"❌ Exit!", WS_VISIBLE | WS_CHILD , 610, 405, 150, 30, hwnd, NULL, hInst, NULL);
+    hExitBtn = CreateWindowW(L"BUTTON", L"❌ Exit!", WS_VISIBLE | WS_CHILD , 610, 440, 150, 30, hwnd, NULL, hInst, NULL);
     SendMessageW(hExitBtn, WM_SETFONT, (WPARAM)hFontEmoji, TRUE);
     
     // Create a label for the Save Reminder
@@ -629,16 +1030,80 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int nCmdShow) {
 
         
 
-    LoadSettingsToEditBox();
+    // Everything the workers read is needed from here on. Each task is its own span under MISE_TRACE;
+    // this one shows how long window creation was left waiting for them
+    {
+        MISE_TRACE_SCOPE("Startup.WaitAll");
+        startup.WaitAll();
+    }
+
+    if (!startupState.profilesOpened) {
+        MessageBoxA(hwnd, ("Saved profiles could not be loaded.\n" + startupState.profileError).c_str(), "Profiles", MB_ICONWARNING);
+    }
+    RefreshProfileCombo();
+    RefreshSnapshotCombo();
+    if (const char* record = std::getenv("MISE_RECORD")) recordPath = record;
+    if (!recordPath.empty()) controller.SetRecording(&uiRecording);
+    controller.ShowLoaded(std::move(startupState.settings));
+    controller.Session().History().Clear(); // The file as loaded is as far back as undo goes
+    controller.Validate();
+    controller.StartJournal(ChangeJournalPath(iniPath)); // Offers back what a crash or closing without saving left unsaved
+    FillResolutionCombo();
+
+    // Follow outside changes to settings.ini; the watcher thread only posts a message, all work happens here
+    std::string watchError;
+    settingsWatcher.Start(iniPath, 250, [hwnd] { PostMessageA(hwnd, WM_SETTINGS_FILE_CHANGED, 0, 0); }, watchError);
+
+    // Put settings.ini back after each game session if the game changed it
+    AppendMenuA(GetSystemMenu(hwnd, FALSE), MF_STRING | (ReadLauncherValue("RestoreSettingsAfterSession", 0) ? MF_CHECKED : MF_UNCHECKED),
+                IDM_RESTORE_AFTER_SESSION, "Restore Settings After Playing");
+    AppendMenuA(GetSystemMenu(hwnd, FALSE), MF_STRING, IDM_VERIFY_INSTALL, "Verify Game Files");
+    // Warm the file cache with the game's data files, so the game loads faster once it's launched
+    AppendMenuA(GetSystemMenu(hwnd, FALSE), MF_STRING | (ReadLauncherValue("PrefetchOnStart", 0) ? MF_CHECKED : MF_UNCHECKED),
+                IDM_PREFETCH_AT_START, "Preload Game Files");
+    if (ReadLauncherValue("PrefetchOnStart", 0)) StartPrefetch(hwnd);
+    if (!tracePath.empty()) {
+        AppendMenuA(GetSystemMenu(hwnd, FALSE), MF_STRING, IDM_WRITE_TRACE, "Write Trace Now");
+    }
+
+    if (residentMode) {
+        std::string controlError;
+        if (!StartControlChannel(hwnd, controlError)) {
+            MessageBoxA(hwnd, ("Resident mode could not start.\n" + controlError).c_str(), "Error", MB_ICONERROR);
+            DestroyWindow(hwnd);
+            settingsWatcher.Stop();
+            return 1;
+        }
+        AddTrayIcon(hwnd, hInst);
+        nCmdShow = SW_HIDE; // Until the tray icon is clicked
+    }
+
     ShowWindow(hwnd, nCmdShow);
     UpdateWindow(hwnd);
 
     MSG msg = {};
     while (GetMessage(&msg, NULL, 0, 0)) {
+        if (msg.message == WM_KEYDOWN && HandleHistoryKey(msg.wParam)) {
+            continue; // Our undo, not the edit box's own single step
+        }
         TranslateMessage(&msg);
         DispatchMessage(&msg);
     }
 
+    controller.CompactJournal(); // Unsaved edits are still there next time
+    assetPrefetcher.Stop();
+    controlServer.Stop();
+    if (residentMode) Shell_NotifyIconA(NIM_DELETE, &trayIcon);
+    settingsWatcher.Stop();
+    displayModes.Wait();
+    if (launchWorker.joinable()) launchWorker.join();
+    if (verifyWorker.joinable()) verifyWorker.join();
+    gameSupervisor.Stop(); // Still logs what it saw of a game that's running on without us
+
+    std::string traceError;
+    if (!tracePath.empty()) WriteChromeTrace(tracePath, traceError);
+    std::string recordError;
+    if (!recordPath.empty()) WriteUiRecording(recordPath, uiRecording, recordError);
     DeleteObject(hFontLarge); // Clean up font object
     DeleteObject(hFontSmall); // Clean up font object
     DeleteObject(hFontEmoji); // Clean up button font
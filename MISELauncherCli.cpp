@@ -0,0 +1,105 @@
+/*
+ * MISELauncherCli.cpp
+ * The launcher without a window, for Linux (where the game runs under
+ * Proton) and anywhere else the Win32 GUI doesn't build. It's the same
+ * command-line mode as MISELauncher.exe, with settings.ini and Steam found
+ * by core/Platform.h, so there's no Wine to start just to change a setting.
+ *
+ *   MISELauncher --set display.resolution=2560x1440 --launch
+ *   MISELauncher --resident      (serve the control channel until Ctrl+C)
+ *
+ * "I've got a headless monkey, and it runs on penguins."
+ */
+
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+#include "core/ControlChannel.h"
+#include "core/ControlService.h"
+#include "core/FileWatcher.h"
+#include "core/Platform.h"
+#include "core/SettingsCli.h"
+#include "core/Trace.h"
+
+namespace {
+
+// Answer control requests until SIGINT or SIGTERM, following outside changes to settings.ini meanwhile
+int RunResident(GamePlatform& platform) {
+    // Blocked before any thread starts, so every thread inherits the mask and sigwait is the only one to see them
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+    std::string iniPath = platform.SettingsPath();
+    if (iniPath.empty()) {
+        std::cerr << "settings.ini file not found: the game's Proton prefix is in none of the Steam libraries.\n";
+        return 1;
+    }
+
+    ControlHooks hooks;
+    hooks.launchGame = [&platform](std::string& error) { return platform.LaunchGame(error); };
+    ControlService service(iniPath, hooks);
+    std::string error;
+    if (!service.Load(error)) std::cerr << "Warning: " << error << "\n";
+
+    FileWatcher watcher;
+    std::string watchError;
+    watcher.Start(iniPath, 250, [&service] { service.FileChanged(); }, watchError);
+
+    ControlServer server;
+    std::string endpoint = DefaultControlEndpoint();
+    if (!server.Start(endpoint, [&service](std::string_view request) { return service.Handle(request); }, error)) {
+        std::cerr << "Resident mode could not start: " << error << "\n";
+        return 1;
+    }
+    std::cout << "Listening on " << endpoint << " for " << iniPath << std::endl;
+
+    int received = 0;
+    sigwait(&stopSignals, &received);
+    server.Stop();
+    watcher.Stop();
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // MISE_TRACE=trace.json records spans for this run (see core/Trace.h)
+    std::string tracePath = EnableTracingFromEnvironment();
+    std::unique_ptr<GamePlatform> platform = CreateSystemPlatform();
+
+    // --resident on its own serves the control channel; with other options it's ignored, as in the GUI
+    std::vector<std::string> args(argv + 1, argv + argc);
+    auto resident = std::find(args.begin(), args.end(), "--resident");
+    bool residentMode = resident != args.end();
+    if (residentMode) args.erase(resident);
+
+    int status;
+    if (residentMode && !IsCliInvocation(args)) {
+        status = RunResident(*platform);
+    } else {
+        // There is no window to open, so no options means --help
+        if (!IsCliInvocation(args)) args.push_back("--help");
+        CliHooks hooks;
+        hooks.iniPath = [&platform] { return platform->SettingsPath(); };
+        hooks.launchGame = [&platform](std::string& error) { return platform->LaunchGame(error); };
+        hooks.findInstall = [&platform](SteamAppInstall& install, std::string& error) {
+            return platform->FindGameInstall(install, error);
+        };
+        status = RunSettingsCli(args, hooks, std::cout, std::cerr);
+    }
+
+    std::string traceError;
+    if (!tracePath.empty() && !WriteChromeTrace(tracePath, traceError)) {
+        std::cerr << "Failed to write trace: " << traceError << "\n";
+    }
+    return status;
+}
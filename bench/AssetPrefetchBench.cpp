@@ -0,0 +1,127 @@
+/*
+ * AssetPrefetchBench.cpp
+ * Prefetching a fixture install folder: four 16 MB archives and 200 small
+ * files, all in the OS cache already, which is what it costs to prefetch
+ * again when there's nothing left to gain (planning plus a cached read).
+ *
+ * MISEBench --prefetch-cold [GB] generates an install of that many
+ * gigabytes (1 by default) and, on Linux with the files dropped from the
+ * cache first, times the game's side of it: reading every archive start
+ * to end, once cold and once after PrefetchAssets warmed the cache, and
+ * times a prefetch held to 128 MB/s; it exits with 1 if prefetching didn't
+ * make the read faster. That the throttle and the memory cutoff hold is
+ * MISETests' job (tests/AssetPrefetchTest.cpp).
+ */
+
+#include "Bench.h"
+
+#include "../core/AssetPrefetch.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// An install folder: 'archiveCount' archives of archiveSize plus 'smallCount' files too small to prefetch
+struct PrefetchFixture {
+    BenchScratchDir scratch;
+    std::string dir = scratch.Path();
+    std::vector<std::string> archives;
+    uint64_t bytes = 0;
+
+    PrefetchFixture(const char* name, size_t archiveCount, uint64_t archiveSize, size_t smallCount) : scratch(name) {
+        for (size_t i = 0; i < archiveCount; ++i) {
+            archives.push_back((fs::path(dir) / "Data" / ("Archive" + std::to_string(i) + ".pak")).string());
+            WriteBenchNoise(archives.back(), archiveSize, i);
+            bytes += archiveSize;
+        }
+        for (size_t i = 0; i < smallCount; ++i) {
+            WriteBenchNoise((fs::path(dir) / "Audio" / ("cue" + std::to_string(i) + ".xwb")).string(), 32 << 10, 1000 + i);
+        }
+    }
+    bool DropFromCache() const {
+        bool dropped = true;
+        for (const std::string& archive : archives) dropped = DropFileFromCache(archive) && dropped;
+        return dropped;
+    }
+};
+
+PrefetchFixture& Fixture() {
+    static PrefetchFixture fixture("mise_bench_prefetch", 4, 16 << 20, 200);
+    return fixture;
+}
+
+// What the game does at load: every archive read start to end; seconds
+double ReadArchives(const PrefetchFixture& fixture) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<char> piece(1 << 20);
+    uint64_t read = 0;
+    for (const std::string& archive : fixture.archives) {
+        FILE* file = std::fopen(archive.c_str(), "rb");
+        if (!file) continue;
+        while (size_t length = std::fread(piece.data(), 1, piece.size(), file)) read += length;
+        std::fclose(file);
+    }
+    DoNotOptimize(read);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PrintRead(const char* what, double seconds, uint64_t bytes) {
+    std::printf("%-36s %8.2f s %9.1f MB/s\n", what, seconds, seconds > 0 ? bytes / seconds / (1 << 20) : 0.0);
+}
+
+} // namespace
+
+MISE_BENCH(AssetPrefetch, Warm) {
+    PrefetchFixture& fixture = Fixture();
+    std::atomic<bool> stop{false};
+    PrefetchOptions options;
+    options.minFileSize = 1 << 20;
+    options.memoryReserve = 0;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        PrefetchProgress progress = PrefetchAssets(fixture.dir, options, stop, nullptr);
+        DoNotOptimize(progress.bytesDone);
+    }
+}
+
+int MeasurePrefetch(double gigabytes) {
+    const uint64_t archiveSize = 256 << 20;
+    uint64_t total = static_cast<uint64_t>(gigabytes * (1ull << 30));
+    size_t archiveCount = static_cast<size_t>(std::max<uint64_t>(1, total / archiveSize));
+    std::printf("Writing %zu archives of 256 MB and 500 small files...\n", archiveCount);
+    PrefetchFixture fixture("mise_bench_prefetch_large", archiveCount, archiveSize, 500);
+    std::printf("%s: %.2f GB\n\n", fixture.dir.c_str(), fixture.bytes / double(1ull << 30));
+
+    bool cold = fixture.DropFromCache();
+    double coldRead = ReadArchives(fixture);
+    PrintRead(cold ? "Game read, cold" : "Game read (cache not dropped)", coldRead, fixture.bytes);
+
+    fixture.DropFromCache();
+    std::atomic<bool> stop{false};
+    PrefetchOptions options;
+    options.progressEveryMs = 100;
+    size_t reports = 0;
+    PrefetchProgress progress = PrefetchAssets(fixture.dir, options, stop, [&reports](const PrefetchProgress&) { ++reports; });
+    PrintRead("Prefetch", progress.elapsedMs / 1000.0, progress.bytesDone);
+    std::printf("  %s; %zu progress reports\n", PrefetchSummary(progress).c_str(), reports);
+    double warmRead = ReadArchives(fixture);
+    PrintRead("Game read, after prefetch", warmRead, fixture.bytes);
+
+    PrefetchOptions throttled = options;
+    throttled.maxBytesPerSecond = 128 << 20;
+    progress = PrefetchAssets(fixture.dir, throttled, stop, nullptr);
+    PrintRead("Prefetch, held to 128 MB/s", progress.elapsedMs / 1000.0, progress.bytesDone);
+
+    bool faster = !cold || warmRead < coldRead;
+    std::printf("\nGame read %.2f s cold, %.2f s after prefetch (%.1fx)\n", coldRead, warmRead,
+                warmRead > 0 ? coldRead / warmRead : 0.0);
+    std::printf("Prefetch made the read faster: %s\n", cold ? (faster ? "yes" : "NO") : "not measured");
+    return faster ? 0 : 1;
+}
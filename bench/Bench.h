@@ -0,0 +1,88 @@
+/*
+ * Bench.h
+ * A pocket-sized benchmark harness for the portable core.
+ * "How much wood could a woodchuck chuck? Let's time it."
+ *
+ * Each MISE_BENCH body gets an iteration count and runs the operation that
+ * many times; the harness grows the count until a run takes long enough to
+ * trust, then reports nanoseconds per operation.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+using BenchFunction = std::function<void(size_t iterations)>;
+
+// Adds a benchmark to the global list; called by MISE_BENCH at static-init time
+bool RegisterBench(const char* group, const char* name, BenchFunction function);
+
+// Heap allocations (operator new) so far in this process; MISEBench counts every one
+uint64_t BenchAllocationCount();
+
+// Call after per-run setup so only the loop that follows is timed
+void ResetBenchTimer();
+
+// Keeps the optimizer from throwing away a result we want to measure
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+#define MISE_BENCH_CONCAT_(a, b) a##b
+#define MISE_BENCH_CONCAT(a, b) MISE_BENCH_CONCAT_(a, b)
+
+#define MISE_BENCH(group, name)                                                   \
+    static void MISE_BENCH_CONCAT(Bench_, MISE_BENCH_CONCAT(group, name))(size_t); \
+    static const bool MISE_BENCH_CONCAT(benchRegistered_, MISE_BENCH_CONCAT(group, name)) = \
+        RegisterBench(#group, #name, MISE_BENCH_CONCAT(Bench_, MISE_BENCH_CONCAT(group, name))); \
+    static void MISE_BENCH_CONCAT(Bench_, MISE_BENCH_CONCAT(group, name))(size_t iterations)
+
+// A scratch folder in the temp directory named "<name>_<pid>", so two MISEBench runs at once never share
+// one; emptied when made, removed with everything in it when destroyed
+class BenchScratchDir {
+public:
+    explicit BenchScratchDir(const std::string& name);
+    ~BenchScratchDir();
+    BenchScratchDir(const BenchScratchDir&) = delete;
+    BenchScratchDir& operator=(const BenchScratchDir&) = delete;
+
+    const std::string& Path() const { return path_; }
+
+    // Path() joined with a '/'-separated relative path
+    std::string operator/(const std::string& relative) const;
+
+private:
+    std::string path_;
+};
+
+// size bytes of noise at path (its folders created), written in 1 MB pieces; binary, so not through TextFile
+void WriteBenchNoise(const std::string& path, uint64_t size, uint64_t seed);
+
+// Drop a file's pages from the OS cache so the next read comes from the disk; false where that can't be done
+bool DropFileFromCache(const std::string& path);
+
+// Synthetic settings.ini text: the real four sections plus 'extraSections'
+// filler sections of 'keysPerSection' keys, with \r\n line endings
+std::string MakeSyntheticIni(size_t extraSections, size_t keysPerSection);
+
+// MISEBench --replay: replays each recorded session 'rounds' times and prints
+// per-interaction latency percentiles; 1 if a recording's expectations failed
+int ReplayUiSessions(const std::vector<std::string>& paths, unsigned rounds);
+
+// MISEBench --install-throughput: generates an install folder of 'gigabytes' and times recording
+// and checking it, cold and warm; 1 if the manifest couldn't be recorded
+int MeasureInstallThroughput(double gigabytes);
+
+// MISEBench --prefetch-cold: times reading a generated install of 'gigabytes' cold and after a
+// prefetch, and a throttled prefetch; 1 if prefetching didn't make the read faster
+int MeasurePrefetch(double gigabytes);
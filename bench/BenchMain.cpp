@@ -0,0 +1,210 @@
+// BenchMain.cpp
+// Runs every registered benchmark, or only those whose "group/name"
+// contains one of the filters given on the command line.
+//
+//   MISEBench --replay session.uirec... [--rounds N]
+// replays recorded launcher sessions instead (bench/UiReplayBench.cpp), and
+//   MISEBench --install-throughput [GB]
+// times install checks on a generated tree of that size (bench/InstallVerifierBench.cpp), and
+//   MISEBench --prefetch-cold [GB]
+// times reading a generated install cold and after a prefetch (bench/AssetPrefetchBench.cpp).
+//
+// Build (from the repo root):
+//   g++ -std=c++17 -O2 bench/*.cpp core/*.cpp -o MISEBench
+
+#include "Bench.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <random>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+
+struct BenchEntry {
+    std::string name;
+    BenchFunction function;
+};
+
+std::vector<BenchEntry>& Registry() {
+    static std::vector<BenchEntry> registry;
+    return registry;
+}
+
+std::chrono::steady_clock::time_point benchStart;
+
+double RunOnce(const BenchFunction& function, size_t iterations) {
+    benchStart = std::chrono::steady_clock::now();
+    function(iterations);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - benchStart).count();
+}
+
+} // namespace
+
+// Every allocation in the process goes through here, so replays can say how many an interaction made
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(size ? size : 1)) return block;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+    std::free(block);
+}
+
+uint64_t BenchAllocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void ResetBenchTimer() {
+    benchStart = std::chrono::steady_clock::now();
+}
+
+bool RegisterBench(const char* group, const char* name, BenchFunction function) {
+    Registry().push_back({std::string(group) + "/" + name, std::move(function)});
+    return true;
+}
+
+std::string MakeSyntheticIni(size_t extraSections, size_t keysPerSection) {
+    std::string text =
+        "[localization]\r\n"
+        "language=0\r\n"
+        "[display]\r\n"
+        "windowed=0\r\n"
+        "shaders=1\r\n"
+        "resolution=3840x2160\r\n"
+        "[audio]\r\n"
+        "music=70\r\n"
+        "voice=80\r\n"
+        "sfx=70\r\n"
+        "subtitles=1\r\n";
+    for (size_t s = 0; s < extraSections; ++s) {
+        text += "; filler section " + std::to_string(s) + "\r\n";
+        text += "[extra" + std::to_string(s) + "]\r\n";
+        for (size_t k = 0; k < keysPerSection; ++k) {
+            text += "key" + std::to_string(k) + " = value " + std::to_string(s * keysPerSection + k) + "  \r\n";
+        }
+    }
+    return text;
+}
+
+BenchScratchDir::BenchScratchDir(const std::string& name) {
+#ifdef _WIN32
+    int pid = _getpid();
+#else
+    int pid = static_cast<int>(getpid());
+#endif
+    path_ = (std::filesystem::temp_directory_path() / (name + "_" + std::to_string(pid))).string();
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+    std::filesystem::create_directories(path_, error);
+}
+
+BenchScratchDir::~BenchScratchDir() {
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+}
+
+std::string BenchScratchDir::operator/(const std::string& relative) const {
+    return (std::filesystem::path(path_) / std::filesystem::path(relative)).string();
+}
+
+void WriteBenchNoise(const std::string& path, uint64_t size, uint64_t seed) {
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::mt19937_64 random(seed);
+    std::vector<uint64_t> piece((1 << 20) / sizeof(uint64_t));
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return;
+    for (uint64_t written = 0; written < size;) {
+        for (uint64_t& word : piece) word = random();
+        size_t length = static_cast<size_t>(std::min<uint64_t>(size - written, piece.size() * sizeof(uint64_t)));
+        std::fwrite(piece.data(), 1, length, file);
+        written += length;
+    }
+    std::fclose(file);
+}
+
+bool DropFileFromCache(const std::string& path) {
+#ifdef __linux__
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    fdatasync(fd);
+    bool dropped = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return dropped;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && std::string(argv[1]) == "--replay") {
+        std::vector<std::string> sessions;
+        unsigned rounds = 200;
+        for (int i = 2; i < argc; ++i) {
+            if (std::string(argv[i]) == "--rounds" && i + 1 < argc) {
+                rounds = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            } else {
+                sessions.push_back(argv[i]);
+            }
+        }
+        return ReplayUiSessions(sessions, rounds);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--install-throughput") {
+        return MeasureInstallThroughput(argc >= 3 ? std::atof(argv[2]) : 2.0);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--prefetch-cold") {
+        return MeasurePrefetch(argc >= 3 ? std::atof(argv[2]) : 1.0);
+    }
+
+    const double minSeconds = 0.2;
+    for (const BenchEntry& entry : Registry()) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; ++i) {
+            selected = entry.name.find(argv[i]) != std::string::npos;
+        }
+        if (!selected) continue;
+
+        // Grow the iteration count until one run is long enough to measure
+        size_t iterations = 1;
+        double seconds = RunOnce(entry.function, iterations);
+        while (seconds < minSeconds && iterations < (size_t(1) << 30)) {
+            iterations *= seconds > 0 ? std::min<size_t>(100, static_cast<size_t>(minSeconds / seconds) + 1) : 100;
+            seconds = RunOnce(entry.function, iterations);
+        }
+        std::printf("%-48s %12zu iters %14.1f ns/op\n", entry.name.c_str(), iterations, seconds * 1e9 / iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * ChangeJournalBench.cpp
+ * What keeping unsaved edits safe costs. AppendKeystroke is one typed
+ * character going into the journal; FullRewrite is what protecting it by
+ * saving would cost instead (an atomic rewrite of the whole file, flushed
+ * to disk), and Compact is the rewrite the journal does once typing pauses.
+ * Recover reads back and replays a journal of 1000 edits, as at startup.
+ * Recovery from torn and damaged journals is checked in
+ * tests/ChangeJournalTest.cpp.
+ */
+
+#include "Bench.h"
+
+#include "../core/AtomicFile.h"
+#include "../core/ChangeJournal.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+// A journal of 'edits' random edits to a synthetic settings.ini
+struct JournalFixture {
+    std::string path;
+
+    JournalFixture(const std::string& journalPath, size_t edits) : path(journalPath) {
+        std::mt19937 random(32360);
+        std::string text = MakeSyntheticIni(4, 10);
+        ChangeJournal journal;
+        journal.Start(path, text);
+        for (size_t i = 0; i < edits; ++i) {
+            size_t start = random() % (text.size() + 1);
+            size_t removed = std::min<size_t>(random() % 3, text.size() - start);
+            std::string inserted = random() % 4 == 0 ? "" : std::string(1 + random() % (i % 10 == 0 ? 40 : 2), char('a' + random() % 26));
+            text.replace(start, removed, inserted);
+            journal.Append(start, removed, inserted);
+        }
+        journal.Close();
+    }
+};
+
+void Append(size_t iterations, std::string_view inserted) {
+    BenchScratchDir scratch("mise_bench_journal");
+    std::string path = scratch / "settings.ini.journal";
+    ChangeJournal journal;
+    journal.Start(path, MakeSyntheticIni(0, 0));
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        DoNotOptimize(journal.Append(100, 0, inserted));
+    }
+    journal.MarkClean("");
+}
+
+void Compact(size_t iterations, size_t extraSections) {
+    BenchScratchDir scratch("mise_bench_journal");
+    std::string path = scratch / "settings.ini.journal";
+    std::string text = MakeSyntheticIni(extraSections, 20);
+    ChangeJournal journal;
+    journal.Start(path, text);
+    std::string error;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        text[text.size() - 3] = char('0' + i % 10);
+        journal.Append(text.size() - 3, 1, std::string_view(text).substr(text.size() - 3, 1));
+        DoNotOptimize(journal.Compact(text, error));
+    }
+    journal.MarkClean("");
+}
+
+void FullRewrite(size_t iterations, size_t extraSections) {
+    BenchScratchDir scratch("mise_bench_journal");
+    std::string path = scratch / "settings.ini";
+    std::string text = MakeSyntheticIni(extraSections, 20);
+    std::string error;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        text[text.size() - 3] = char('0' + i % 10);
+        DoNotOptimize(WriteFileAtomic(path, text, error));
+    }
+}
+
+} // namespace
+
+MISE_BENCH(ChangeJournal, AppendKeystroke) { Append(iterations, "x"); }
+MISE_BENCH(ChangeJournal, AppendPaste) { Append(iterations, std::string(200, 'x')); }
+MISE_BENCH(ChangeJournal, CompactSmall) { Compact(iterations, 0); }
+MISE_BENCH(ChangeJournal, CompactLarge) { Compact(iterations, 200); }
+MISE_BENCH(ChangeJournal, FullRewriteSmall) { FullRewrite(iterations, 0); }
+MISE_BENCH(ChangeJournal, FullRewriteLarge) { FullRewrite(iterations, 200); }
+
+MISE_BENCH(ChangeJournal, Recover) {
+    BenchScratchDir scratch("mise_bench_journal");
+    JournalFixture fixture(scratch / "settings.ini.journal", 1000);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        JournalContents contents;
+        std::string error;
+        ReadChangeJournal(fixture.path, contents, error);
+        DoNotOptimize(contents.text.size());
+    }
+}
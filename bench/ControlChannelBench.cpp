@@ -0,0 +1,111 @@
+/*
+ * ControlChannelBench.cpp
+ * The resident launcher's control channel, in process: a server on a
+ * private endpoint over a fixture settings.ini, and clients that keep one
+ * connection open the way a front-end would. One op is one request and
+ * its response. Handle is the service alone, without the transport; the
+ * RoundTrip cases add the socket (or pipe) and two thread wake-ups. With
+ * four clients asking at once, an op is one request out of all of them,
+ * so the number stays comparable with a single client's.
+ */
+
+#include "Bench.h"
+
+#include "../core/ControlChannel.h"
+#include "../core/ControlService.h"
+#include "../core/TextFile.h"
+
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct ControlFixture {
+    std::string root, endpoint;
+    std::unique_ptr<ControlService> service;
+    ControlServer server;
+    ControlFixture() {
+        root = (fs::temp_directory_path() / "mise_bench_control").string();
+        fs::remove_all(root);
+        fs::create_directories(root);
+        std::string iniPath = (fs::path(root) / "settings.ini").string();
+        WriteFile(iniPath, MakeSyntheticIni(0, 0));
+#ifdef _WIN32
+        endpoint = "\\\\.\\pipe\\mise_bench_control";
+#else
+        endpoint = (fs::path(root) / "control.sock").string();
+#endif
+        std::string error;
+        service = std::make_unique<ControlService>(iniPath, ControlHooks());
+        service->Load(error);
+        server.Start(endpoint, [this](std::string_view request) { return service->Handle(request); }, error);
+    }
+    ~ControlFixture() {
+        server.Stop();
+        fs::remove_all(root);
+    }
+};
+
+ControlFixture& Fixture() {
+    static ControlFixture fixture;
+    return fixture;
+}
+
+void RoundTrips(size_t iterations, size_t clients, const char* request) {
+    ControlFixture& fixture = Fixture();
+    std::vector<std::thread> threads;
+    ResetBenchTimer();
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&fixture, iterations, clients, request, c] {
+            ControlClient client;
+            std::string response, error;
+            if (!client.Connect(fixture.endpoint, error)) return;
+            for (size_t i = c; i < iterations; i += clients) {
+                client.Request(request, response, error);
+                DoNotOptimize(response);
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+}
+
+} // namespace
+
+MISE_BENCH(ControlChannel, HandleGet) {
+    ControlFixture& fixture = Fixture();
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        std::string response = fixture.service->Handle("get display.resolution");
+        DoNotOptimize(response);
+    }
+}
+
+MISE_BENCH(ControlChannel, HandleSet) {
+    ControlFixture& fixture = Fixture();
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        std::string response = fixture.service->Handle(i % 2 ? "set audio.music=40" : "set audio.music=60");
+        DoNotOptimize(response);
+    }
+}
+
+MISE_BENCH(ControlChannel, RoundTripPing) { RoundTrips(iterations, 1, "ping"); }
+MISE_BENCH(ControlChannel, RoundTripGet) { RoundTrips(iterations, 1, "get display.resolution"); }
+MISE_BENCH(ControlChannel, RoundTripSet) { RoundTrips(iterations, 1, "set audio.music=50"); }
+MISE_BENCH(ControlChannel, RoundTripGet4Clients) { RoundTrips(iterations, 4, "get display.resolution"); }
+
+MISE_BENCH(ControlChannel, ConnectAndPing) {
+    ControlFixture& fixture = Fixture();
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        ControlClient client;
+        std::string response, error;
+        client.Connect(fixture.endpoint, error);
+        client.Request("ping", response, error);
+        DoNotOptimize(response);
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * DisplayModesBench.cpp
+ * Display-mode catalog costs with a fake provider: sort and dedup of a
+ * multi-monitor mode dump, building the combo entries, and a whole
+ * background enumeration from Refresh to published snapshot.
+ */
+
+#include "Bench.h"
+
+#include "../core/DisplayModes.h"
+
+#include <condition_variable>
+
+namespace {
+
+// What each monitor reports: every size at several refresh rates and bit depths,
+// listed once per monitor and once per bit depth, smallest first
+std::vector<DisplayMode> MakeMonitorModes(int monitors) {
+    static const int sizes[][2] = {
+        {640, 480}, {800, 600}, {1024, 768}, {1280, 720}, {1280, 1024}, {1366, 768}, {1600, 900},
+        {1680, 1050}, {1920, 1080}, {1920, 1200}, {2560, 1080}, {2560, 1440}, {3440, 1440}, {3840, 2160},
+    };
+    static const int rates[] = {24, 30, 50, 59, 60, 75, 100, 120, 144, 165};
+    const int bitDepths = 3;
+
+    std::vector<DisplayMode> modes;
+    for (int monitor = 0; monitor < monitors; ++monitor) {
+        for (const auto& size : sizes) {
+            for (int rate : rates) {
+                for (int depth = 0; depth < bitDepths; ++depth) modes.push_back({size[0], size[1], rate});
+            }
+        }
+    }
+    return modes;
+}
+
+void SortModes(size_t iterations, int monitors) {
+    const std::vector<DisplayMode> raw = MakeMonitorModes(monitors);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        std::vector<DisplayMode> modes = raw;
+        SortDisplayModes(modes);
+        DoNotOptimize(DistinctResolutions(modes));
+    }
+}
+
+void BuildChoices(size_t iterations) {
+    std::vector<DisplayMode> modes = MakeMonitorModes(3);
+    SortDisplayModes(modes);
+    const std::vector<DisplayMode> resolutions = DistinctResolutions(modes);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(BuildResolutionChoices(resolutions));
+}
+
+// Invalidate, let the worker enumerate, wait for its ready callback
+void CatalogRoundTrip(size_t iterations) {
+    DisplayModeCatalog catalog(std::make_unique<FakeDisplayModeProvider>(MakeMonitorModes(3), DisplayMode{2560, 1440, 144}));
+    std::mutex mutex;
+    std::condition_variable ready;
+    size_t published = 0;
+    auto onReady = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++published;
+        ready.notify_one();
+    };
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        catalog.Invalidate(onReady);
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&] { return published == i + 1; });
+    }
+    catalog.Wait();
+    DoNotOptimize(catalog.Snapshot());
+}
+
+// What the UI thread pays once the catalog is warm: a snapshot pointer copy
+void CachedLookup(size_t iterations) {
+    DisplayModeCatalog catalog(std::make_unique<FakeDisplayModeProvider>(MakeMonitorModes(3), DisplayMode{2560, 1440, 144}));
+    catalog.Refresh(nullptr);
+    catalog.Wait();
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(catalog.Snapshot()->current.width);
+}
+
+} // namespace
+
+MISE_BENCH(DisplayModes, SortOneMonitor) { SortModes(iterations, 1); }
+MISE_BENCH(DisplayModes, SortThreeMonitors) { SortModes(iterations, 3); }
+MISE_BENCH(DisplayModes, BuildChoices) { BuildChoices(iterations); }
+MISE_BENCH(DisplayModes, CatalogRoundTrip) { CatalogRoundTrip(iterations); }
+MISE_BENCH(DisplayModes, CachedLookup) { CachedLookup(iterations); }
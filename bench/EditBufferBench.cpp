@@ -0,0 +1,55 @@
+/*
+ * EditBufferBench.cpp
+ * Patching one value vs. rewriting the whole edit box, as the text grows.
+ */
+
+#include "Bench.h"
+
+#include "../core/EditBuffer.h"
+#include "../core/IniDocument.h"
+
+namespace {
+
+// Toggle shaders= the way the checkbox handler does, patching only the value
+void ToggleWithSplice(size_t iterations, size_t extraSections) {
+    IniDocument doc(MakeSyntheticIni(extraSections, 20));
+    MemoryEditBuffer buffer(doc.Text());
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        ApplySplice(buffer, doc.Set("display", "shaders", (i & 1) ? "1" : "0"));
+    }
+    DoNotOptimize(buffer.View());
+}
+
+// The old way: rewrite the whole buffer after every change
+void ToggleWithFullRewrite(size_t iterations, size_t extraSections) {
+    IniDocument doc(MakeSyntheticIni(extraSections, 20));
+    MemoryEditBuffer buffer(doc.Text());
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        doc.Set("display", "shaders", (i & 1) ? "1" : "0");
+        buffer.Replace(0, buffer.View().size(), doc.Text());
+    }
+    DoNotOptimize(buffer.View());
+}
+
+// Diff-based sync between two full texts (what Reset Defaults uses)
+void DiffSync(size_t iterations, size_t extraSections) {
+    std::string before = MakeSyntheticIni(extraSections, 20);
+    std::string after = before;
+    after[after.size() / 2] ^= 1;
+    MemoryEditBuffer buffer(before);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        SyncEditBuffer(buffer, (i & 1) ? after : before, (i & 1) ? before : after);
+    }
+    DoNotOptimize(buffer.View());
+}
+
+} // namespace
+
+MISE_BENCH(EditBuffer, SpliceSmall) { ToggleWithSplice(iterations, 0); }
+MISE_BENCH(EditBuffer, SpliceLarge) { ToggleWithSplice(iterations, 500); }
+MISE_BENCH(EditBuffer, FullRewriteSmall) { ToggleWithFullRewrite(iterations, 0); }
+MISE_BENCH(EditBuffer, FullRewriteLarge) { ToggleWithFullRewrite(iterations, 500); }
+MISE_BENCH(EditBuffer, DiffSyncLarge) { DiffSync(iterations, 500); }
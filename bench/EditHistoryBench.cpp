@@ -0,0 +1,102 @@
+/*
+ * EditHistoryBench.cpp
+ * The piece table against a plain string for scattered edits as the text
+ * grows, a long typing session through EditSession (diff, record, merge),
+ * undoing and redoing a deep history, and recording under a tight memory
+ * limit, where the oldest steps are forgotten on every edit.
+ */
+
+#include "Bench.h"
+
+#include "../core/EditHistory.h"
+
+#include <random>
+
+namespace {
+
+// Small edits spread over the whole text, the same sequence for both buffers
+void ScatteredEditsPieceTable(size_t iterations, size_t extraSections) {
+    PieceTable buffer(MakeSyntheticIni(extraSections, 20));
+    std::mt19937 rng(14);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t start = rng() % (buffer.Size() + 1);
+        buffer.Replace(start, start + rng() % 3, (i & 1) ? "x" : "yz");
+    }
+    DoNotOptimize(buffer.Size());
+}
+
+void ScatteredEditsString(size_t iterations, size_t extraSections) {
+    MemoryEditBuffer buffer(MakeSyntheticIni(extraSections, 20));
+    std::mt19937 rng(14);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t start = rng() % (buffer.View().size() + 1);
+        buffer.Replace(start, start + rng() % 3, (i & 1) ? "x" : "yz");
+    }
+    DoNotOptimize(buffer.View().size());
+}
+
+// One keystroke per iteration, reported by the view the way EN_CHANGE does:
+// a word typed mid-file, then backspaced away again, so the text keeps its size
+void Typing(size_t iterations, size_t extraSections) {
+    std::string text = MakeSyntheticIni(extraSections, 20);
+    MemoryEditBuffer view(text);
+    EditSession session(&view);
+    session.Reset(text);
+    const size_t caret = text.size() / 2;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t typed = i % 16;
+        if (typed < 8) {
+            text.insert(caret + typed, 1, 'a');
+        } else {
+            text.erase(caret + 15 - typed, 1);
+        }
+        session.ViewChanged(text);
+    }
+    DoNotOptimize(session.History().UndoCount());
+}
+
+// Build a history of control edits, then time walking all the way back and forward again
+void UndoRedo(size_t iterations) {
+    const size_t depth = 1000;
+    std::string text = MakeSyntheticIni(50, 20);
+    EditSession session;
+    session.Reset(text);
+    std::mt19937 rng(14);
+    for (size_t i = 0; i < depth; ++i) {
+        size_t start = rng() % (session.Document().Size() + 1);
+        session.Replace(start, start + 4, "value");
+    }
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; i += 2 * depth) {
+        while (session.Undo()) {}
+        while (session.Redo()) {}
+    }
+    DoNotOptimize(session.Document().Size());
+}
+
+// Every edit pushes the history over a 16 KiB limit, so the oldest step goes each time
+void CappedHistory(size_t iterations) {
+    EditSession session(nullptr, 16 << 10);
+    session.Reset(MakeSyntheticIni(50, 20));
+    std::mt19937 rng(14);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t start = rng() % (session.Document().Size() + 1);
+        session.Replace(start, start + 8, "resolution=3840x2160");
+    }
+    DoNotOptimize(session.History().MemoryUsage());
+}
+
+} // namespace
+
+MISE_BENCH(EditHistory, ScatteredPieceTableSmall) { ScatteredEditsPieceTable(iterations, 0); }
+MISE_BENCH(EditHistory, ScatteredPieceTableLarge) { ScatteredEditsPieceTable(iterations, 5000); }
+MISE_BENCH(EditHistory, ScatteredStringSmall) { ScatteredEditsString(iterations, 0); }
+MISE_BENCH(EditHistory, ScatteredStringLarge) { ScatteredEditsString(iterations, 5000); }
+MISE_BENCH(EditHistory, TypingSmall) { Typing(iterations, 0); }
+MISE_BENCH(EditHistory, TypingLarge) { Typing(iterations, 500); }
+MISE_BENCH(EditHistory, UndoRedoDeep) { UndoRedo(iterations); }
+MISE_BENCH(EditHistory, CappedHistory) { CappedHistory(iterations); }
@@ -0,0 +1,70 @@
+/*
+ * FleetApplyBench.cpp
+ * Fleet mode over a generated corpus: 500 user profiles, each with its own
+ * settings.ini, found through a glob. One op is the whole fleet. Changed
+ * flips the music volume every run so every file is rewritten (atomically,
+ * with a flush each); Unchanged is the same template again, which costs a
+ * read and a parse per file. Glob is only the directory walk.
+ */
+
+#include "Bench.h"
+
+#include "../core/FleetApply.h"
+#include "../core/TextFile.h"
+
+#include <filesystem>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr size_t profileCount = 500;
+
+struct FleetFixture {
+    BenchScratchDir root{"mise_bench_fleet"};
+    std::string glob = root / "Users/*/AppData/Roaming/LucasArts/*/settings.ini";
+    FleetFixture() {
+        for (size_t i = 0; i < profileCount; ++i) {
+            fs::path dir = fs::path(root.Path()) / "Users" / ("player" + std::to_string(i)) / "AppData" / "Roaming" / "LucasArts" /
+                           "The Secret of Monkey Island Special Edition";
+            fs::create_directories(dir);
+            WriteFile((dir / "settings.ini").string(), MakeSyntheticIni(2, 10));
+        }
+    }
+};
+
+const FleetFixture& Fixture() {
+    static const FleetFixture fixture;
+    return fixture;
+}
+
+void Apply(size_t iterations, unsigned jobs, bool change) {
+    const FleetFixture& fixture = Fixture();
+    FleetTargets targets;
+    targets.globs.push_back(fixture.glob);
+    std::vector<SettingOverride> overrides = {{"audio", "music", "40"}, {"localization", "language", "3"}};
+    ApplyFleet(overrides, targets, jobs, nullptr);  // Every file at the template's values to start with
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        if (change) overrides[0].value = i % 2 ? "40" : "60";
+        FleetSummary summary = ApplyFleet(overrides, targets, jobs, nullptr);
+        DoNotOptimize(summary.changed);
+    }
+}
+
+} // namespace
+
+MISE_BENCH(FleetApply, Changed1Job) { Apply(iterations, 1, true); }
+MISE_BENCH(FleetApply, Changed4Jobs) { Apply(iterations, 4, true); }
+MISE_BENCH(FleetApply, Unchanged1Job) { Apply(iterations, 1, false); }
+MISE_BENCH(FleetApply, Unchanged4Jobs) { Apply(iterations, 4, false); }
+
+MISE_BENCH(FleetApply, Glob) {
+    const FleetFixture& fixture = Fixture();
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t found = 0;
+        ExpandGlob(fixture.glob, [&found](const std::string&) { ++found; });
+        DoNotOptimize(found);
+    }
+}
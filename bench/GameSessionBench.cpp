@@ -0,0 +1,121 @@
+/*
+ * GameSessionBench.cpp
+ * What watching the game costs. Push is one sample into the ring. Sample
+ * and FindProcess go through the system monitor against a stand-in game: a
+ * copy of the sleep binary named MISE.exe, started as a child process, so
+ * FindProcess walks every process the way it will while Steam starts the
+ * real one. ShortSession is a whole supervised session of a stand-in that
+ * lives 50 ms, sampled every 5 ms, from launch to summary. The stand-ins
+ * need fork/exec and /proc, so those cases only run on Linux.
+ */
+
+#include "Bench.h"
+
+#include "../core/GameSession.h"
+#include "../core/LauncherSettings.h"
+
+#include <filesystem>
+#include <future>
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+namespace fs = std::filesystem;
+
+#ifdef __linux__
+
+struct StandInFixture {
+    BenchScratchDir root{"mise_bench_session"};
+    std::string program = root / gameExecutable;
+    StandInFixture() { fs::copy_file("/bin/sleep", program); }
+
+    // Start the stand-in game for 'seconds' (a sleep argument, so "0.05" works)
+    pid_t Start(const char* seconds) const {
+        pid_t pid = fork();
+        if (pid == 0) {
+            execl(program.c_str(), program.c_str(), seconds, static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        return pid;
+    }
+};
+
+const StandInFixture& Fixture() {
+    static const StandInFixture fixture;
+    return fixture;
+}
+
+// A stand-in that lives as long as the benchmark case does
+struct RunningStandIn {
+    pid_t pid;
+    RunningStandIn() : pid(Fixture().Start("600")) {
+        // Until exec has happened the child still looks like us
+        std::unique_ptr<ProcessMonitor> monitor = CreateSystemProcessMonitor();
+        while (monitor->FindProcess(gameExecutable) != static_cast<uint32_t>(pid)) usleep(1000);
+    }
+    ~RunningStandIn() {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+};
+
+#endif
+
+} // namespace
+
+MISE_BENCH(GameSession, Push) {
+    SampleRing ring(1800);
+    ProcessSample sample;
+    for (size_t i = 0; i < iterations; ++i) {
+        sample.elapsedMs = static_cast<int64_t>(i);
+        ring.Push(sample);
+    }
+    DoNotOptimize(ring.Newest());
+}
+
+#ifdef __linux__
+
+MISE_BENCH(GameSession, Sample) {
+    RunningStandIn standIn;
+    std::unique_ptr<ProcessMonitor> monitor = CreateSystemProcessMonitor();
+    ProcessSample sample;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        bool running = monitor->Sample(static_cast<uint32_t>(standIn.pid), sample);
+        DoNotOptimize(running);
+    }
+}
+
+MISE_BENCH(GameSession, FindProcess) {
+    RunningStandIn standIn;
+    std::unique_ptr<ProcessMonitor> monitor = CreateSystemProcessMonitor();
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        uint32_t pid = monitor->FindProcess(gameExecutable);
+        DoNotOptimize(pid);
+    }
+}
+
+MISE_BENCH(GameSession, ShortSession) {
+    const StandInFixture& fixture = Fixture();
+    for (size_t i = 0; i < iterations; ++i) {
+        GameSupervisor supervisor(CreateSystemProcessMonitor());
+        SessionOptions options;
+        options.exeName = gameExecutable;
+        options.intervalMs = 5;
+        options.findTimeoutMs = 5000;
+        std::promise<SessionSummary> ended;
+        supervisor.Start(options, [&ended](const SessionSummary& summary) { ended.set_value(summary); });
+        pid_t pid = fixture.Start("0.05");
+        SessionSummary summary = ended.get_future().get();
+        waitpid(pid, nullptr, 0);
+        DoNotOptimize(summary.samples);
+    }
+}
+
+#endif
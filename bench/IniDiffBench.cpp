@@ -0,0 +1,44 @@
+/*
+ * IniDiffBench.cpp
+ * What a live reload costs: the hash-only "nothing changed" path, and a
+ * real change diffed and spliced into the edit box document.
+ */
+
+#include "Bench.h"
+
+#include "../core/IniDiff.h"
+#include "../core/TextFile.h"
+
+namespace {
+
+void ReloadUnchanged(size_t iterations, size_t extraSections) {
+    std::string disk = normalizeWindowsNewlines(MakeSyntheticIni(extraSections, 20));
+    SettingsBaseline baseline;
+    baseline.Reset(disk);
+    std::vector<IniKeyChange> changes;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(baseline.Update(disk, changes));
+}
+
+// The game flips one volume setting; push it into a \r\n edit box document
+void ReloadOneKey(size_t iterations, size_t extraSections) {
+    std::string before = normalizeWindowsNewlines(MakeSyntheticIni(extraSections, 20));
+    std::string after = before;
+    after.replace(after.find("music=70"), 8, "music=35");
+    SettingsBaseline baseline;
+    baseline.Reset(before);
+    IniDocument editBox(toWindowsNewlines(before));
+    std::vector<IniKeyChange> changes;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        baseline.Update((i & 1) ? before : after, changes);
+        DoNotOptimize(ApplyIniChanges(editBox, changes));
+    }
+}
+
+} // namespace
+
+MISE_BENCH(IniDiff, UnchangedTypical) { ReloadUnchanged(iterations, 8); }
+MISE_BENCH(IniDiff, UnchangedLarge) { ReloadUnchanged(iterations, 500); }
+MISE_BENCH(IniDiff, OneKeyTypical) { ReloadOneKey(iterations, 8); }
+MISE_BENCH(IniDiff, OneKeyLarge) { ReloadOneKey(iterations, 500); }
@@ -0,0 +1,66 @@
+/*
+ * IniDocumentBench.cpp
+ * Parse, serialize, update and normalize on a real-sized settings.ini,
+ * a typical hand-edited one, and a 10 MB stress file.
+ */
+
+#include "Bench.h"
+
+#include "../core/IniDocument.h"
+#include "../core/TextFile.h"
+
+namespace {
+
+const std::string& Corpus(int size) {
+    static const std::string small = MakeSyntheticIni(0, 0);
+    static const std::string typical = MakeSyntheticIni(8, 12);
+    static const std::string huge = MakeSyntheticIni(5000, 60); // ~10 MB
+    return size == 0 ? small : (size == 1 ? typical : huge);
+}
+
+void Parse(size_t iterations, int size) {
+    Corpus(size);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        IniDocument doc(Corpus(size));
+        DoNotOptimize(doc.Entries().size());
+    }
+}
+
+// What Save does with the document: \r\n text in, file bytes out
+void Serialize(size_t iterations, int size) {
+    IniDocument doc(Corpus(size));
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(normalizeWindowsNewlines(doc.Text()));
+}
+
+// One combo-box change: look up the key, splice the value
+void Update(size_t iterations, int size) {
+    IniDocument doc(Corpus(size));
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        DoNotOptimize(doc.Set("display", "resolution", (i & 1) ? "2560x1440" : "1920x1080"));
+    }
+}
+
+// What Load does before parsing: file bytes in, \r\n text out
+void Normalize(size_t iterations, int size) {
+    std::string unix = normalizeWindowsNewlines(Corpus(size));
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(toWindowsNewlines(unix));
+}
+
+} // namespace
+
+MISE_BENCH(IniDocument, ParseSmall) { Parse(iterations, 0); }
+MISE_BENCH(IniDocument, ParseTypical) { Parse(iterations, 1); }
+MISE_BENCH(IniDocument, Parse10MB) { Parse(iterations, 2); }
+MISE_BENCH(IniDocument, SerializeSmall) { Serialize(iterations, 0); }
+MISE_BENCH(IniDocument, SerializeTypical) { Serialize(iterations, 1); }
+MISE_BENCH(IniDocument, Serialize10MB) { Serialize(iterations, 2); }
+MISE_BENCH(IniDocument, UpdateSmall) { Update(iterations, 0); }
+MISE_BENCH(IniDocument, UpdateTypical) { Update(iterations, 1); }
+MISE_BENCH(IniDocument, Update10MB) { Update(iterations, 2); }
+MISE_BENCH(IniDocument, NormalizeSmall) { Normalize(iterations, 0); }
+MISE_BENCH(IniDocument, NormalizeTypical) { Normalize(iterations, 1); }
+MISE_BENCH(IniDocument, Normalize10MB) { Normalize(iterations, 2); }
@@ -0,0 +1,82 @@
+/*
+ * IniMergeBench.cpp
+ * What saving costs now that a save merges with the disk. Merge is the
+ * three-way merge alone: the user changed the resolution and the game
+ * changed two volumes while the launcher was open. The Save cases are the
+ * whole GUI save, atomic write included (and a second write to put the
+ * fixture back, so mostly write time): SaveDiskUntouched is the usual
+ * save, where nobody else wrote the file and a hash stands in for the
+ * diff; SaveDiskChanged adds the parse and merge. SaveIdentical is a save
+ * whose merge matches the disk, which reads but never writes.
+ */
+
+#include "Bench.h"
+
+#include "../core/IniMerge.h"
+#include "../core/TextFile.h"
+
+#include <filesystem>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct MergeCase {
+    std::string base, ours, theirs;
+    explicit MergeCase(size_t extraSections) {
+        base = normalizeWindowsNewlines(MakeSyntheticIni(extraSections, 20));
+        ours = base;
+        ours.replace(ours.find("resolution=3840x2160"), 20, "resolution=2560x1440");
+        theirs = base;
+        theirs.replace(theirs.find("music=70"), 8, "music=35");
+        theirs.replace(theirs.find("voice=80"), 8, "voice=60");
+    }
+};
+
+void Merge(size_t iterations, size_t extraSections) {
+    MergeCase merge(extraSections);
+    IniDocument base(merge.base), ours(merge.ours), theirs(merge.theirs);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        IniMerge result = MergeIniDocuments(base, ours, theirs, IniConflictChoice::KeepOurs);
+        DoNotOptimize(result.taken.size());
+    }
+}
+
+// Save ours over a file that holds 'disk', as the GUI does, rewriting the file before each save
+void Save(size_t iterations, const std::string& base, const std::string& ours, const std::string& disk) {
+    std::string path = (fs::temp_directory_path() / "mise_bench_merge.ini").string();
+    SettingsBaseline baseline;
+    baseline.Reset(base);
+    IniDocument edits(ours);
+    WriteFile(path, disk);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        std::string diskBytes;
+        IniMerge merge = MergeWithDisk(path, baseline, edits, IniConflictChoice::KeepOurs, diskBytes);
+        SaveResult saved = SaveMergedSettings(path, merge.merged, diskBytes);
+        if (saved.status == SaveStatus::Written) WriteFile(path, disk);  // Put the disk back for the next round
+        DoNotOptimize(saved.status);
+    }
+    fs::remove(path);
+}
+
+} // namespace
+
+MISE_BENCH(IniMerge, MergeTypical) { Merge(iterations, 8); }
+MISE_BENCH(IniMerge, MergeLarge) { Merge(iterations, 500); }
+
+MISE_BENCH(IniMerge, SaveDiskUntouched) {
+    MergeCase merge(8);
+    Save(iterations, merge.base, merge.ours, merge.base);
+}
+
+MISE_BENCH(IniMerge, SaveDiskChanged) {
+    MergeCase merge(8);
+    Save(iterations, merge.base, merge.ours, merge.theirs);
+}
+
+MISE_BENCH(IniMerge, SaveIdentical) {
+    MergeCase merge(8);
+    Save(iterations, merge.base, merge.base, merge.theirs);
+}
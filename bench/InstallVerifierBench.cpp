@@ -0,0 +1,164 @@
+/*
+ * InstallVerifierBench.cpp
+ * Checking a fixture install folder against its manifest: three 24 MB
+ * archives, two of 6 MB and 300 small files, about 90 MB, all in the OS
+ * cache. FastPath is the everyday check (nothing changed, so nothing is
+ * read); Full reads and hashes every byte, on one thread and on all of
+ * them; Build records the manifest in the first place. HashBlock is the
+ * hash alone over one 4 MB block, for MB/s.
+ *
+ * MISEBench --install-throughput [GB] does the same against a generated
+ * tree of that many gigabytes (2 by default), on Linux with the files
+ * dropped from the cache first so the cold numbers are the disk's. That
+ * the checks find damage is MISETests' job (tests/InstallVerifierTest.cpp).
+ */
+
+#include "Bench.h"
+
+#include "../core/InstallVerifier.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// An install folder: 'archives' big files of archiveSize plus 'smallFiles' of 1 to 64 KB
+struct InstallFixture {
+    BenchScratchDir scratch;
+    std::string dir = scratch.Path();
+    std::vector<std::string> archives;
+    std::vector<std::string> smallFiles;
+    uint64_t bytes = 0;
+
+    InstallFixture(const char* name, size_t archiveCount, uint64_t archiveSize, size_t smallCount) : scratch(name) {
+        for (size_t i = 0; i < archiveCount; ++i) {
+            archives.push_back("Data/Archive" + std::to_string(i) + ".pak");
+            WriteBenchNoise((fs::path(dir) / archives.back()).string(), archiveSize, i);
+            bytes += archiveSize;
+        }
+        std::mt19937 random(32360);
+        for (size_t i = 0; i < smallCount; ++i) {
+            smallFiles.push_back("Audio/" + std::to_string(i % 12) + "/cue" + std::to_string(i) + ".xwb");
+            uint64_t size = 1024 + random() % (63 << 10);
+            WriteBenchNoise((fs::path(dir) / smallFiles.back()).string(), size, 1000 + i);
+            bytes += size;
+        }
+    }
+};
+
+struct SmallFixture : InstallFixture {
+    InstallManifest manifest;
+    SmallFixture() : InstallFixture("mise_bench_install", 3, 24 << 20, 300) {
+        WriteBenchNoise((fs::path(dir) / "Data/Small0.pak").string(), 6 << 20, 50);
+        WriteBenchNoise((fs::path(dir) / "Data/Small1.pak").string(), 6 << 20, 51);
+        InstallReport report;
+        std::string error;
+        BuildInstallManifest(dir, "1", InstallCheckOptions(), manifest, report, error);
+    }
+};
+
+SmallFixture& Fixture() {
+    static SmallFixture fixture;
+    return fixture;
+}
+
+void Verify(size_t iterations, bool full, unsigned threads) {
+    SmallFixture& fixture = Fixture();
+    InstallCheckOptions options;
+    options.full = full;
+    options.threads = threads;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        InstallReport report;
+        std::string error;
+        VerifyInstall(fixture.dir, fixture.manifest, options, report, error);
+        DoNotOptimize(report.bytesHashed);
+    }
+}
+
+bool DropTreeFromCache(const InstallFixture& fixture) {
+    bool dropped = true;
+    for (const std::string& file : fixture.archives) dropped = DropFileFromCache((fs::path(fixture.dir) / file).string()) && dropped;
+    for (const std::string& file : fixture.smallFiles) dropped = DropFileFromCache((fs::path(fixture.dir) / file).string()) && dropped;
+    return dropped;
+}
+
+void PrintRun(const char* what, const InstallReport& report) {
+    double seconds = report.elapsedMs / 1000.0;
+    std::printf("%-36s %8.2f s %9.1f MB/s  %5zu files read, %5zu skipped\n", what, seconds,
+                seconds > 0 ? report.bytesHashed / seconds / (1 << 20) : 0.0, report.filesHashed, report.filesSkipped);
+}
+
+} // namespace
+
+MISE_BENCH(InstallVerifier, HashBlock) {
+    std::string block(installBlockSize, 'x');
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(DigestChunk(block));
+}
+
+MISE_BENCH(InstallVerifier, FastPath) { Verify(iterations, false, 0); }
+MISE_BENCH(InstallVerifier, FullOneThread) { Verify(iterations, true, 1); }
+MISE_BENCH(InstallVerifier, FullAllThreads) { Verify(iterations, true, 0); }
+
+MISE_BENCH(InstallVerifier, Build) {
+    SmallFixture& fixture = Fixture();
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        InstallManifest manifest;
+        InstallReport report;
+        std::string error;
+        BuildInstallManifest(fixture.dir, "1", InstallCheckOptions(), manifest, report, error);
+        DoNotOptimize(manifest.files.size());
+    }
+}
+
+int MeasureInstallThroughput(double gigabytes) {
+    const uint64_t archiveSize = 512 << 20;
+    uint64_t total = static_cast<uint64_t>(gigabytes * (1ull << 30));
+    size_t archiveCount = static_cast<size_t>(std::max<uint64_t>(1, total / archiveSize));
+    std::printf("Writing %zu archives of 512 MB and 2000 small files...\n", archiveCount);
+    InstallFixture fixture("mise_bench_install_large", archiveCount, archiveSize, 2000);
+    std::printf("%s: %.2f GB, %u hardware threads\n\n", fixture.dir.c_str(), fixture.bytes / double(1ull << 30),
+                std::thread::hardware_concurrency());
+
+    InstallManifest manifest;
+    InstallReport report;
+    InstallCheckOptions full;
+    full.full = true;
+    std::string error;
+    bool cold = DropTreeFromCache(fixture);
+    if (!BuildInstallManifest(fixture.dir, "1", full, manifest, report, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    PrintRun(cold ? "Build, cold" : "Build (cache not dropped)", report);
+
+    InstallCheckOptions oneThread = full;
+    oneThread.threads = 1;
+    report = InstallReport();
+    VerifyInstall(fixture.dir, manifest, oneThread, report, error);
+    PrintRun("Full check, warm, 1 thread", report);
+    report = InstallReport();
+    VerifyInstall(fixture.dir, manifest, full, report, error);
+    PrintRun("Full check, warm, all threads", report);
+    if (DropTreeFromCache(fixture)) {
+        report = InstallReport();
+        VerifyInstall(fixture.dir, manifest, oneThread, report, error);
+        PrintRun("Full check, cold, 1 thread", report);
+        DropTreeFromCache(fixture);
+        report = InstallReport();
+        VerifyInstall(fixture.dir, manifest, full, report, error);
+        PrintRun("Full check, cold, all threads", report);
+    }
+    report = InstallReport();
+    VerifyInstall(fixture.dir, manifest, InstallCheckOptions(), report, error);
+    PrintRun("Fast path, nothing changed", report);
+    return 0;
+}
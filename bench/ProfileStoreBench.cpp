@@ -0,0 +1,65 @@
+/*
+ * ProfileStoreBench.cpp
+ * Opening, listing and looking up profiles in a store with many entries.
+ */
+
+#include "Bench.h"
+
+#include "../core/ProfileStore.h"
+
+#include <filesystem>
+
+namespace {
+
+// A store with 'count' profiles, built once and removed at exit
+struct StoreFixture {
+    std::string path;
+    explicit StoreFixture(size_t count) {
+        path = (std::filesystem::temp_directory_path() / ("mise_bench_profiles_" + std::to_string(count) + ".dat")).string();
+        std::filesystem::remove(path);
+        ProfileStore store;
+        std::string error;
+        store.Open(path, error);
+        for (size_t i = 0; i < count; ++i) {
+            store.Put("profile " + std::to_string(i), MakeSyntheticIni(0, 0), error);
+        }
+    }
+    ~StoreFixture() { std::filesystem::remove(path); }
+};
+
+const std::string& StorePath() {
+    static const StoreFixture fixture(500);
+    return fixture.path;
+}
+
+} // namespace
+
+MISE_BENCH(ProfileStore, Open) {
+    const std::string& path = StorePath();
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        ProfileStore store;
+        std::string error;
+        DoNotOptimize(store.Open(path, error));
+    }
+}
+
+MISE_BENCH(ProfileStore, Find) {
+    ProfileStore store;
+    std::string error;
+    store.Open(StorePath(), error);
+    std::string name = "profile 250";
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        std::string_view settings;
+        DoNotOptimize(store.Find(name, settings));
+    }
+}
+
+MISE_BENCH(ProfileStore, List) {
+    ProfileStore store;
+    std::string error;
+    store.Open(StorePath(), error);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(store.Names());
+}
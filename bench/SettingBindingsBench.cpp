@@ -0,0 +1,67 @@
+/*
+ * SettingBindingsBench.cpp
+ * Finding the row for a control notification: the table's id index against
+ * the if/else chain of handle compares WM_COMMAND used to walk, and the
+ * section/key lookup a settings.ini reload does for each changed key.
+ */
+
+#include "Bench.h"
+
+#include "../core/SettingBindings.h"
+
+namespace {
+
+// Every control id WM_COMMAND sees: the settings, then the buttons (created without ids)
+constexpr int commandIds[] = {2001, 2002, 2003, 2004, 2005, 2006, 2007, 0, 0, 0};
+constexpr size_t commandIdCount = sizeof(commandIds) / sizeof(commandIds[0]);
+
+// The old dispatch shape: one compare per control until one matches
+const SettingBinding* FindByChain(int controlId) {
+    if (controlId == languageControlId) return &settingBindings[0];
+    else if (controlId == resolutionControlId) return &settingBindings[1];
+    else if (controlId == subtitlesControlId) return &settingBindings[2];
+    else if (controlId == shadersControlId) return &settingBindings[3];
+    else if (controlId == musicVolumeControlId) return &settingBindings[4];
+    else if (controlId == voiceVolumeControlId) return &settingBindings[5];
+    else if (controlId == sfxVolumeControlId) return &settingBindings[6];
+    return nullptr;
+}
+
+} // namespace
+
+MISE_BENCH(SettingBindings, DispatchById) {
+    for (size_t i = 0; i < iterations; ++i) {
+        int controlId = commandIds[i % commandIdCount];
+        DoNotOptimize(controlId);
+        DoNotOptimize(FindSettingBinding(controlId));
+    }
+}
+
+MISE_BENCH(SettingBindings, DispatchByChain) {
+    for (size_t i = 0; i < iterations; ++i) {
+        int controlId = commandIds[i % commandIdCount];
+        DoNotOptimize(controlId);
+        DoNotOptimize(FindByChain(controlId));
+    }
+}
+
+MISE_BENCH(SettingBindings, FindBySectionKey) {
+    for (size_t i = 0; i < iterations; ++i) {
+        DoNotOptimize(FindSettingBinding("Audio", i % 2 ? "sfx" : "subtitles"));
+    }
+}
+
+// Read and re-encode every bound key, as Reset Defaults does through SyncAllControls
+MISE_BENCH(SettingBindings, ReadAllValues) {
+    IniDocument doc;
+    doc.Parse(MakeSyntheticIni(8, 20));
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        for (const SettingBinding& binding : settingBindings) {
+            int value = 0;
+            if (binding.codec != SettingCodec::Resolution && ReadBindingValue(binding, doc, value)) {
+                DoNotOptimize(FormatBindingValue(binding, value));
+            }
+        }
+    }
+}
@@ -0,0 +1,34 @@
+/*
+ * SettingsCliBench.cpp
+ * Cost of one headless --set/--get round-trip against a real file.
+ */
+
+#include "Bench.h"
+
+#include "../core/SettingsCli.h"
+#include "../core/TextFile.h"
+
+#include <filesystem>
+#include <sstream>
+
+namespace {
+
+void RunCli(size_t iterations, const std::vector<std::string>& args) {
+    std::string path = (std::filesystem::temp_directory_path() / "mise_bench_settings.ini").string();
+    WriteFile(path, MakeSyntheticIni(0, 0));
+
+    CliHooks hooks;
+    hooks.iniPath = [&path] { return path; };
+    std::ostringstream out, err;
+    for (size_t i = 0; i < iterations; ++i) {
+        out.str("");
+        DoNotOptimize(RunSettingsCli(args, hooks, out, err));
+    }
+    std::filesystem::remove(path);
+}
+
+} // namespace
+
+MISE_BENCH(SettingsCli, GetOne) { RunCli(iterations, {"--get", "display.resolution"}); }
+MISE_BENCH(SettingsCli, SetUnchanged) { RunCli(iterations, {"--set", "display.resolution=3840x2160"}); }
+MISE_BENCH(SettingsCli, SetAndDump) { RunCli(iterations, {"--set", "localization.language=3", "--set", "localization.language=0", "--dump"}); }
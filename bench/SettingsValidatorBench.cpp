@@ -0,0 +1,73 @@
+/*
+ * SettingsValidatorBench.cpp
+ * What one keystroke costs the validator as settings.ini grows: the edit is
+ * noted and only its line is checked again, so Keystroke should stay flat
+ * from a small file to a huge one. FullCheck is the same file validated
+ * from scratch, which is what every keystroke would cost otherwise.
+ */
+
+#include "Bench.h"
+
+#include "../core/SettingsValidator.h"
+
+namespace {
+
+// Retype the music volume in the middle of the file, one digit per iteration
+void Keystroke(size_t iterations, size_t extraSections) {
+    std::string text = MakeSyntheticIni(extraSections, 20);
+    size_t value = text.find("music=") + 6;
+    PieceTable document(text);
+    SettingsValidator validator;
+    validator.Reset(text);
+    size_t checked = 0;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        const char digit[] = {static_cast<char>('0' + i % 10), 0};
+        document.Replace(value, value + 1, digit);
+        validator.Edit(value, 1, digit);
+        checked += validator.Revalidate(document);
+    }
+    DoNotOptimize(checked);
+    DoNotOptimize(validator.ErrorCount());
+}
+
+// Typing a new line and deleting it again: the line list itself changes size
+void NewLine(size_t iterations, size_t extraSections) {
+    std::string text = MakeSyntheticIni(extraSections, 20);
+    size_t at = text.find("[audio]");
+    PieceTable document(text);
+    SettingsValidator validator;
+    validator.Reset(text);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        if (i & 1) {
+            document.Replace(at, at + 9, "");
+            validator.Edit(at, 9, "");
+        } else {
+            document.Replace(at, at, "sfx=200\r\n");
+            validator.Edit(at, 0, "sfx=200\r\n");
+        }
+        validator.Revalidate(document);
+    }
+    DoNotOptimize(validator.ErrorCount());
+}
+
+void FullCheck(size_t iterations, size_t extraSections) {
+    std::string text = MakeSyntheticIni(extraSections, 20);
+    SettingsValidator validator;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        validator.Reset(text);
+        DoNotOptimize(validator.WarningCount());
+    }
+}
+
+} // namespace
+
+MISE_BENCH(SettingsValidator, KeystrokeSmall) { Keystroke(iterations, 0); }
+MISE_BENCH(SettingsValidator, KeystrokeLarge) { Keystroke(iterations, 500); }
+MISE_BENCH(SettingsValidator, KeystrokeHuge) { Keystroke(iterations, 10000); }
+MISE_BENCH(SettingsValidator, NewLineSmall) { NewLine(iterations, 0); }
+MISE_BENCH(SettingsValidator, NewLineHuge) { NewLine(iterations, 10000); }
+MISE_BENCH(SettingsValidator, FullCheckSmall) { FullCheck(iterations, 0); }
+MISE_BENCH(SettingsValidator, FullCheckLarge) { FullCheck(iterations, 500); }
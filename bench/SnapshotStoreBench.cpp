@@ -0,0 +1,111 @@
+/*
+ * SnapshotStoreBench.cpp
+ * Backing up a fixture data folder: settings.ini and 40 saves of 256 KB.
+ * First is a backup into an empty store (every file chunked, hashed and
+ * written; the store is emptied inside the loop, so that's timed too), on
+ * one thread and on all of them. Repeat is the same folder again, which
+ * the size/time check answers without reading a byte; OneSaveChanged is
+ * the usual case of a single slot overwritten since the last launch.
+ * Chunking is the chunker and hash alone over 4 MB, for MB/s.
+ */
+
+#include "Bench.h"
+
+#include "../core/SnapshotStore.h"
+#include "../core/TextFile.h"
+
+#include <chrono>
+#include <filesystem>
+#include <random>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr size_t saveCount = 40;
+constexpr size_t saveSize = 256 << 10;
+
+std::string RandomBytes(size_t size, uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::string bytes(size, '\0');
+    for (char& c : bytes) c = static_cast<char>(random());
+    return bytes;
+}
+
+struct SnapshotFixture {
+    BenchScratchDir root{"mise_bench_snapshot"};
+    std::string dataDir = root / "The Secret of Monkey Island Special Edition";
+    std::string storeDir = SnapshotStorePath((fs::path(dataDir) / "settings.ini").string());
+    SnapshotFixture() {
+        fs::create_directories(fs::path(dataDir) / "saves");
+        WriteFile((fs::path(dataDir) / "settings.ini").string(), MakeSyntheticIni(0, 0));
+        for (size_t i = 0; i < saveCount; ++i) WriteSave(i, 0);
+    }
+
+    // Save slot i, 'generation' times overwritten; each generation changes a few bytes in the middle
+    void WriteSave(size_t i, uint64_t generation) const {
+        std::string save = RandomBytes(saveSize, i);
+        std::string stamp = std::to_string(generation);
+        save.replace(saveSize / 2, stamp.size(), stamp);
+        std::string path = (fs::path(dataDir) / "saves" / ("slot" + std::to_string(i) + ".sav")).string();
+        WriteFile(path, save);
+        // Some file systems keep coarse times; make sure the change shows
+        fs::last_write_time(path, fs::file_time_type::clock::now() + std::chrono::seconds(generation));
+    }
+};
+
+const SnapshotFixture& Fixture() {
+    static const SnapshotFixture fixture;
+    return fixture;
+}
+
+void First(size_t iterations, unsigned threads) {
+    const SnapshotFixture& fixture = Fixture();
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        fs::remove_all(fixture.storeDir);
+        SnapshotStore store(fixture.storeDir);
+        std::string id, error;
+        SnapshotStats stats;
+        store.Take(fixture.dataDir, id, stats, error, threads);
+        DoNotOptimize(stats.bytesWritten);
+    }
+}
+
+void Again(size_t iterations, bool changeOneSave) {
+    const SnapshotFixture& fixture = Fixture();
+    fs::remove_all(fixture.storeDir);
+    SnapshotStore store(fixture.storeDir);
+    std::string id, error;
+    SnapshotStats stats;
+    store.Take(fixture.dataDir, id, stats, error);
+    static uint64_t generation = 0;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        if (changeOneSave) fixture.WriteSave(i % saveCount, ++generation);
+        store.Take(fixture.dataDir, id, stats, error);
+        if (i % 64 == 63) store.Prune(defaultSnapshotKeep, error);  // The launcher prunes after every backup
+        DoNotOptimize(stats.filesRead);
+    }
+}
+
+} // namespace
+
+MISE_BENCH(SnapshotStore, FirstOneThread) { First(iterations, 1); }
+MISE_BENCH(SnapshotStore, FirstAllThreads) { First(iterations, 0); }
+MISE_BENCH(SnapshotStore, Repeat) { Again(iterations, false); }
+MISE_BENCH(SnapshotStore, OneSaveChanged) { Again(iterations, true); }
+
+MISE_BENCH(SnapshotStore, Chunking) {
+    std::string data = RandomBytes(4 << 20, 42);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t start = 0;
+        uint64_t check = 0;
+        for (size_t end : FindChunkBoundaries(data)) {
+            check ^= DigestChunk(std::string_view(data).substr(start, end - start)).low;
+            start = end;
+        }
+        DoNotOptimize(check);
+    }
+}
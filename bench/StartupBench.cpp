@@ -0,0 +1,111 @@
+/*
+ * StartupBench.cpp
+ * Headless time-to-first-paint: the startup task graph against a fixture
+ * settings.ini, profile store and Steam tree, with the UI thread's window
+ * construction stood in for by a fixed delay. Serial runs every task and
+ * then builds the window; Parallel overlaps them the way WinMain does.
+ */
+
+#include "Bench.h"
+
+#include "../core/LauncherSettings.h"
+#include "../core/Startup.h"
+#include "../core/TextFile.h"
+
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// What creating the window, fonts and controls costs on a typical machine
+constexpr auto windowConstruction = std::chrono::milliseconds(3);
+
+// Display drivers take a while to list their modes; this one takes a fixed time
+class SlowDisplayModeProvider : public DisplayModeProvider {
+public:
+    std::vector<DisplayMode> EnumerateModes() override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return {{3840, 2160, 60}, {2560, 1440, 144}, {2560, 1440, 60}, {1920, 1080, 60}, {1920, 1080, 60}};
+    }
+    bool CurrentMode(DisplayMode& mode) override {
+        mode = {2560, 1440, 144};
+        return true;
+    }
+};
+
+struct StartupFixture {
+    std::string root, iniPath, steam;
+    StartupFixture() {
+        root = (fs::temp_directory_path() / "mise_bench_startup").string();
+        fs::remove_all(root);
+        fs::create_directories(root);
+        iniPath = (fs::path(root) / "settings.ini").string();
+        WriteFile(iniPath, MakeSyntheticIni(8, 20));
+
+        steam = (fs::path(root) / "steam").string();
+        std::string library = (fs::path(steam) / "steamapps").string();
+        fs::create_directories(fs::path(library) / "common");
+        WriteFile((fs::path(library) / "libraryfolders.vdf").string(),
+                  "\"libraryfolders\"\n{\n\t\"0\"\n\t{\n\t\t\"path\"\t\t\"" + steam + "\"\n\t\t\"apps\"\n\t\t{\n\t\t\t\"32360\"\t\t\"1\"\n\t\t}\n\t}\n}\n");
+        WriteFile((fs::path(library) / "appmanifest_32360.acf").string(),
+                  "\"AppState\"\n{\n\t\"appid\"\t\t\"32360\"\n\t\"installdir\"\t\t\"The Secret of Monkey Island Special Edition\"\n}\n");
+    }
+    ~StartupFixture() { fs::remove_all(root); }
+};
+
+const StartupFixture& Fixture() {
+    static const StartupFixture fixture;
+    return fixture;
+}
+
+void RunStartup(size_t iterations, bool parallel) {
+    const StartupFixture& fixture = Fixture();
+    StartupHooks hooks;
+    hooks.iniPath = [&fixture] { return fixture.iniPath; };
+    hooks.steamRoot = [&fixture](std::string& steamRoot, std::string&) {
+        steamRoot = fixture.steam;
+        return true;
+    };
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        // A fresh process: nothing cached yet
+        ProfileStore profiles;
+        SteamAppLocator locator;
+        DisplayModeCatalog displayModes(std::make_unique<SlowDisplayModeProvider>());
+        TaskGraph graph;
+        StartupState state;
+        AddStartupTasks(graph, state, hooks, profiles, locator, displayModes);
+
+        if (parallel) {
+            graph.Start(3);
+            std::this_thread::sleep_for(windowConstruction);
+            graph.WaitAll();
+        } else {
+            graph.RunSerial();
+            std::this_thread::sleep_for(windowConstruction);
+        }
+        DoNotOptimize(state.settings.document.Text().size());
+    }
+}
+
+} // namespace
+
+MISE_BENCH(Startup, Serial) { RunStartup(iterations, false); }
+MISE_BENCH(Startup, Parallel) { RunStartup(iterations, true); }
+
+// Just the graph machinery: five empty tasks with the startup's dependency shape
+MISE_BENCH(Startup, GraphOverhead) {
+    for (size_t i = 0; i < iterations; ++i) {
+        TaskGraph graph;
+        TaskGraph::TaskId first = graph.Add("a", [] {});
+        graph.Add("b", [] {}, {first});
+        graph.Add("c", [] {}, {first});
+        graph.Add("d", [] {});
+        graph.Add("e", [] {});
+        graph.Start(3);
+        graph.WaitAll();
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * SteamLibraryBench.cpp
+ * Finding the game's install folder in a fixture Steam tree: reading the
+ * library list and manifest from scratch, versus the cached locator that
+ * only stats two files. FindProtonPrefixes is the Linux backend's search
+ * for the game's settings.ini, run on every command-line invocation.
+ */
+
+#include "Bench.h"
+
+#include "../core/LauncherSettings.h"
+#include "../core/SteamLibrary.h"
+#include "../core/TextFile.h"
+#include "../core/Vdf.h"
+
+#include <filesystem>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// <root>/steam plus 'libraries' extra library folders; the game (and its Proton prefix) lives in the last one,
+// and a user with a big localconfig.vdf has launch options set for it
+struct SteamFixture {
+    std::string root, steam;
+    explicit SteamFixture(int libraries) {
+        root = (fs::temp_directory_path() / "mise_bench_steam").string();
+        fs::remove_all(root);
+        steam = (fs::path(root) / "steam").string();
+        fs::create_directories(fs::path(steam) / "steamapps");
+
+        std::string folders = "\"libraryfolders\"\n{\n\t\"contentstatsid\"\t\t\"123\"\n";
+        folders += "\t\"0\"\n\t{\n\t\t\"path\"\t\t\"" + steam + "\"\n\t\t\"apps\"\n\t\t{\n\t\t\t\"228980\"\t\t\"1000\"\n\t\t}\n\t}\n";
+        for (int i = 1; i <= libraries; ++i) {
+            std::string library = (fs::path(root) / ("library" + std::to_string(i))).string();
+            fs::create_directories(fs::path(library) / "steamapps" / "common");
+            folders += "\t\"" + std::to_string(i) + "\"\n\t{\n\t\t\"path\"\t\t\"" + library + "\"\n\t\t\"apps\"\n\t\t{\n";
+            for (int app = 0; app < 50; ++app) folders += "\t\t\t\"" + std::to_string(400000 + i * 100 + app) + "\"\t\t\"5000\"\n";
+            if (i == libraries) {
+                folders += "\t\t\t\"" + std::to_string(gameAppId) + "\"\t\t\"2500000000\"\n";
+                fs::create_directories(ProtonPrefixPath(library, gameAppId));
+                WriteFile((fs::path(library) / "steamapps" / ("appmanifest_" + std::to_string(gameAppId) + ".acf")).string(),
+                          "\"AppState\"\n{\n\t\"appid\"\t\t\"32360\"\n\t\"name\"\t\t\"The Secret of Monkey Island: Special Edition\"\n"
+                          "\t\"installdir\"\t\t\"The Secret of Monkey Island Special Edition\"\n\t\"StateFlags\"\t\t\"4\"\n}\n");
+            }
+            folders += "\t\t}\n\t}\n";
+        }
+        folders += "}\n";
+        WriteFile((fs::path(steam) / "steamapps" / "libraryfolders.vdf").string(), folders);
+
+        fs::create_directories(fs::path(steam) / "userdata" / "1234" / "config");
+        std::string config = "\"UserLocalConfigStore\"\n{\n\t\"Software\"\n\t{\n\t\t\"Valve\"\n\t\t{\n\t\t\t\"Steam\"\n\t\t\t{\n\t\t\t\t\"apps\"\n\t\t\t\t{\n";
+        for (int app = 0; app < 2000; ++app) {
+            config += "\t\t\t\t\t\"" + std::to_string(500000 + app) + "\"\n\t\t\t\t\t{\n\t\t\t\t\t\t\"LastPlayed\"\t\t\"1700000000\"\n"
+                      "\t\t\t\t\t\t\"Playtime\"\t\t\"42\"\n\t\t\t\t\t}\n";
+        }
+        config += "\t\t\t\t\t\"32360\"\n\t\t\t\t\t{\n\t\t\t\t\t\t\"LaunchOptions\"\t\t\"%command% -windowed\"\n\t\t\t\t\t}\n";
+        config += "\t\t\t\t}\n\t\t\t}\n\t\t}\n\t}\n}\n";
+        WriteFile((fs::path(steam) / "userdata" / "1234" / "config" / "localconfig.vdf").string(), config);
+    }
+    ~SteamFixture() { fs::remove_all(root); }
+};
+
+const SteamFixture& Fixture() {
+    static const SteamFixture fixture(8);
+    return fixture;
+}
+
+} // namespace
+
+MISE_BENCH(SteamLibrary, ReadLibraryFolders) {
+    const std::string& steam = Fixture().steam;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        std::string error;
+        DoNotOptimize(ReadSteamLibraryFolders(steam, error));
+    }
+}
+
+MISE_BENCH(SteamLibrary, FindAppUncached) {
+    const std::string& steam = Fixture().steam;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        SteamAppInstall install;
+        std::string error;
+        DoNotOptimize(FindSteamApp(steam, gameAppId, install, error));
+    }
+}
+
+MISE_BENCH(SteamLibrary, LocateCached) {
+    const std::string& steam = Fixture().steam;
+    SteamAppLocator locator;
+    SteamAppInstall install;
+    std::string error;
+    locator.Locate(steam, gameAppId, install, error);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(locator.Locate(steam, gameAppId, install, error));
+}
+
+MISE_BENCH(SteamLibrary, ReadLaunchOptions) {
+    const std::string& steam = Fixture().steam;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(ReadSteamLaunchOptions(steam, gameAppId));
+}
+
+MISE_BENCH(SteamLibrary, FindProtonPrefixes) {
+    const std::string& steam = Fixture().steam;
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(FindProtonPrefixes(steam, gameAppId));
+}
@@ -0,0 +1,137 @@
+/*
+ * TextFileBench.cpp
+ * The old char-at-a-time text helpers against the current ones,
+ * on a multi-megabyte synthetic settings.ini.
+ */
+
+#include "Bench.h"
+
+#include "../core/TextFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// The helpers as they were before the string_view/memchr rewrite
+namespace legacy {
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return "[Failed to open file]";
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+std::string normalizeWindowsNewlines(const std::string& text) {
+    std::string result;
+    size_t len = text.length();
+    for (size_t i = 0; i < len; ++i) {
+        if (text[i] == '\r') {
+            if (i + 1 < len && text[i + 1] == '\n') {
+                result += '\n';
+                ++i;
+            } else {
+                result += '\n';
+            }
+        } else {
+            result += text[i];
+        }
+    }
+    return result;
+}
+
+std::string toWindowsNewlines(const std::string& content) {
+    std::string formattedContent;
+    for (char c : content) {
+        if (c == '\n') {
+            formattedContent += "\r\n";
+        } else {
+            formattedContent += c;
+        }
+    }
+    return formattedContent;
+}
+
+std::string Trim(const std::string& str) {
+    size_t start = str.find_first_not_of(" \t\r\n");
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return (start == std::string::npos || end == std::string::npos) ? "" : str.substr(start, end - start + 1);
+}
+
+} // namespace legacy
+
+// About 4 MB of \r\n text
+const std::string& LargeWindowsText() {
+    static const std::string text = MakeSyntheticIni(2000, 60);
+    return text;
+}
+
+const std::string& LargeUnixText() {
+    static const std::string text = normalizeWindowsNewlines(LargeWindowsText());
+    return text;
+}
+
+// Written once, removed when the benchmark exits
+struct LargeFixture {
+    std::string path = (std::filesystem::temp_directory_path() / "mise_bench_large.ini").string();
+    LargeFixture() { std::ofstream(path, std::ios::binary) << LargeUnixText(); }
+    ~LargeFixture() { std::filesystem::remove(path); }
+};
+
+const std::string& LargeFile() {
+    static const LargeFixture fixture;
+    return fixture.path;
+}
+
+// Trim every line, the way a caller would when walking the file
+template <typename TrimFunction>
+size_t TrimAllLines(const std::string& text, TrimFunction trim) {
+    size_t total = 0, start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        total += trim(text.substr(start, end - start)).size();
+        start = end + 1;
+    }
+    return total;
+}
+
+} // namespace
+
+MISE_BENCH(TextFile, ReadLegacy) {
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(legacy::ReadFile(LargeFile()));
+}
+MISE_BENCH(TextFile, ReadSized) {
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(ReadFile(LargeFile()));
+}
+MISE_BENCH(TextFile, NormalizeLegacy) {
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(legacy::normalizeWindowsNewlines(LargeWindowsText()));
+}
+MISE_BENCH(TextFile, NormalizeMemchr) {
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(normalizeWindowsNewlines(LargeWindowsText()));
+}
+MISE_BENCH(TextFile, ToWindowsLegacy) {
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(legacy::toWindowsNewlines(LargeUnixText()));
+}
+MISE_BENCH(TextFile, ToWindowsMemchr) {
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(toWindowsNewlines(LargeUnixText()));
+}
+MISE_BENCH(TextFile, TrimLegacy) {
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(TrimAllLines(LargeUnixText(), [](const std::string& s) { return legacy::Trim(s); }));
+}
+MISE_BENCH(TextFile, TrimView) {
+    for (size_t i = 0; i < iterations; ++i) {
+        const std::string& text = LargeUnixText();
+        size_t total = 0, start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) end = text.size();
+            total += Trim(std::string_view(text).substr(start, end - start)).size();
+            start = end + 1;
+        }
+        DoNotOptimize(total);
+    }
+}
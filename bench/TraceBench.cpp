@@ -0,0 +1,61 @@
+/*
+ * TraceBench.cpp
+ * What a span costs: with tracing off (the normal case), with it on, with
+ * several threads recording at once, and what dumping a full ring costs.
+ */
+
+#include "Bench.h"
+
+#include "../core/Trace.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+void RecordSpans(size_t iterations, bool enabled) {
+    EnableTracing(enabled);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) {
+        MISE_TRACE_SCOPE("Bench.Span");
+        DoNotOptimize(i);
+    }
+    EnableTracing(false);
+}
+
+} // namespace
+
+MISE_BENCH(Trace, SpanDisabled) { RecordSpans(iterations, false); }
+MISE_BENCH(Trace, SpanEnabled) { RecordSpans(iterations, true); }
+
+// Per-thread rings mean four writers shouldn't slow each other down; reported per span
+MISE_BENCH(Trace, SpanEnabledFourThreads) {
+    const size_t threadCount = 4;
+    const size_t perThread = iterations / threadCount + 1;
+    EnableTracing(true);
+    ResetBenchTimer();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([perThread] {
+            for (size_t i = 0; i < perThread; ++i) {
+                MISE_TRACE_SCOPE("Bench.ThreadSpan");
+                DoNotOptimize(i);
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    EnableTracing(false);
+}
+
+// Serialize one full ring to Chrome JSON
+MISE_BENCH(Trace, DumpFullRing) {
+    ClearTrace();
+    EnableTracing(true);
+    for (size_t i = 0; i < traceRingCapacity; ++i) {
+        MISE_TRACE_SCOPE("Bench.Dump");
+    }
+    EnableTracing(false);
+    ResetBenchTimer();
+    for (size_t i = 0; i < iterations; ++i) DoNotOptimize(ChromeTraceJson());
+    ClearTrace();
+}
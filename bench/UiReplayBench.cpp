@@ -0,0 +1,95 @@
+/*
+ * UiReplayBench.cpp
+ * Recorded launcher sessions from bench/sessions, replayed headless
+ * through the same LauncherController the window uses. Each recording is
+ * one benchmark (ns/op is the whole session, writing the scratch
+ * settings.ini included), and MISEBench --replay prints per-interaction
+ * latency percentiles and allocations instead:
+ *
+ *   MISEBench --replay bench/sessions/everyday.uirec --rounds 500
+ *
+ * A recording's expect lines are checked on every replay, so --replay
+ * fails (exit 1) when a change makes a session end up somewhere else.
+ */
+
+#include "Bench.h"
+
+#include "../core/UiReplay.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+// CMake points this at the source tree; a hand build runs from the repo root
+#ifndef MISE_BENCH_SESSIONS_DIR
+#define MISE_BENCH_SESSIONS_DIR "bench/sessions"
+#endif
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string ScratchIniPath() {
+    return (fs::temp_directory_path() / "mise_bench_uireplay.ini").string();
+}
+
+bool RegisterSessionBenches() {
+    std::error_code ec;
+    std::vector<fs::path> sessions;
+    for (const fs::directory_entry& entry : fs::directory_iterator(MISE_BENCH_SESSIONS_DIR, ec)) {
+        if (entry.path().extension() == ".uirec") sessions.push_back(entry.path());
+    }
+    std::sort(sessions.begin(), sessions.end());
+    for (const fs::path& session : sessions) {
+        std::string path = session.string();
+        RegisterBench("UiReplay", session.stem().string().c_str(), [path](size_t iterations) {
+            UiRecording recording;
+            std::string error;
+            if (!ReadUiRecording(path, recording, error)) return;
+            UiReplayOptions options;
+            options.iniPath = ScratchIniPath();
+            ResetBenchTimer();
+            for (size_t i = 0; i < iterations; ++i) {
+                UiReplayResult result = ReplayUiRecording(recording, options);
+                DoNotOptimize(result.text.size());
+            }
+        });
+    }
+    return true;
+}
+
+const bool sessionsRegistered = RegisterSessionBenches();
+
+} // namespace
+
+int ReplayUiSessions(const std::vector<std::string>& paths, unsigned rounds) {
+    bool allPassed = true;
+    UiReplayOptions options;
+    options.iniPath = ScratchIniPath();
+    options.allocationCount = BenchAllocationCount;
+    for (const std::string& path : paths) {
+        UiRecording recording;
+        std::string error;
+        if (!ReadUiRecording(path, recording, error)) {
+            std::fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+            allPassed = false;
+            continue;
+        }
+
+        std::vector<UiEventTiming> timings;
+        UiReplayResult result;
+        for (unsigned round = 0; round < std::max(rounds, 1u); ++round) {
+            result = ReplayUiRecording(recording, options);
+            timings.insert(timings.end(), result.timings.begin(), result.timings.end());
+        }
+        std::printf("%s (%u rounds)\n%s", path.c_str(), std::max(rounds, 1u), FormatUiLatencyTable(SummarizeUiTimings(timings)).c_str());
+        for (const std::string& failure : result.failures) {
+            std::printf("  FAILED %s\n", failure.c_str());
+        }
+        std::printf("\n");
+        allPassed = allPassed && result.ok;
+    }
+    std::error_code ec;
+    fs::remove(options.iniPath, ec);
+    return allPassed ? 0 : 1;
+}
@@ -1,7 +1,9 @@
 #PowerShell script build.ps1
 # Read the version from version.txt
 $VERSION = Get-Content -Path "version.txt" -Raw
+# Sources that make up the launcher (the portable core lives in core/)
+$SOURCES = @("MISELauncher.cpp") + (Get-ChildItem -Path "core" -Filter *.cpp | ForEach-Object { "core/$($_.Name)" })
 # Compile the program with the version number
-g++ MISELauncher.cpp resource.res -DVERSION="`"$VERSION`"" -mwindows -lole32 -luuid -lshlwapi -lshell32 -o MISELauncher.exe -static
+g++ -std=c++17 $SOURCES resource.res -DVERSION="`"$VERSION`"" -mwindows -lole32 -luuid -lshlwapi -lshell32 -lcomctl32 -o MISELauncher.exe -static
 # Optionally, push the release to GitHub
 Write-Host "Compiled Monkey Launcher with version $VERSION"
\ No newline at end of file
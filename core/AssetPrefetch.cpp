@@ -0,0 +1,339 @@
+/*
+ * AssetPrefetch.cpp
+ * "The early pirate gets the grog."
+ */
+
+#include "AssetPrefetch.h"
+
+#include "TextFile.h"
+#include "Trace.h"
+#include "WorkStealing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t segmentSize = 16 << 20;  // A unit of work: one hint, then read through
+constexpr size_t pieceSize = 1 << 20;       // One read
+constexpr uint64_t memoryCheckEvery = 64 << 20;
+
+struct PlannedFile {
+    std::string path;
+    uint64_t size = 0;
+};
+
+#ifdef __linux__
+// A /proc file's text (they all say they're empty, so it's read until it ends); empty if it can't be opened
+std::string ReadProcFile(const char* path) {
+    std::string text;
+    if (FILE* file = std::fopen(path, "r")) {
+        char chunk[4096];
+        size_t got;
+        while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) text.append(chunk, got);
+        std::fclose(file);
+    }
+    return text;
+}
+#endif
+
+// Memory that is free or only holds cached files (which the OS gives up first), and whether the system
+// says it's short of memory already. False where neither can be read; there's no cutoff there
+bool ReadMemoryState(const PrefetchOptions& options, uint64_t& available, bool& underPressure) {
+    underPressure = false;
+    if (options.readMemory) return options.readMemory(available, underPressure);
+#ifdef _WIN32
+    MEMORYSTATUSEX status = {};
+    status.dwLength = sizeof(status);
+    if (!GlobalMemoryStatusEx(&status)) return false;
+    available = status.ullAvailPhys;
+    underPressure = status.dwMemoryLoad >= 90;
+    return true;
+#elif defined(__linux__)
+    return ParseLinuxMemoryState(ReadProcFile("/proc/meminfo"), ReadProcFile("/proc/pressure/memory"), available, underPressure);
+#else
+    (void)available;
+    return false;
+#endif
+}
+
+// Hint that [offset, offset + length) of path will be read, then read it in pieces; onRead gets each piece's
+// size and returns false to stop. False if the file couldn't be opened or read
+template <typename OnRead>
+bool ReadSegment(const std::string& path, uint64_t offset, uint64_t length, std::vector<char>& buffer, OnRead onRead) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);  // Read-ahead for the whole handle
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(offset);
+    bool ok = SetFilePointerEx(file, position, NULL, FILE_BEGIN) != 0;
+    while (ok && length > 0) {
+        DWORD got = 0;
+        ok = ReadFile(file, buffer.data(), static_cast<DWORD>(std::min<uint64_t>(length, buffer.size())), &got, NULL) != 0;
+        if (!ok || got == 0 || !onRead(got)) break;
+        length -= got;
+    }
+    CloseHandle(file);
+    return ok;
+#elif defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    // The kernel starts reading the whole segment now and reads further ahead than usual for what follows
+    posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+    bool ok = true;
+    while (length > 0) {
+        ssize_t got = pread(fd, buffer.data(), static_cast<size_t>(std::min<uint64_t>(length, buffer.size())),
+                            static_cast<off_t>(offset));
+        if (got < 0 && errno == EINTR) continue;
+        ok = got >= 0;
+        if (got <= 0 || !onRead(static_cast<size_t>(got))) break;
+        offset += static_cast<uint64_t>(got);
+        length -= static_cast<uint64_t>(got);
+    }
+    close(fd);
+    return ok;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file.seekg(static_cast<std::streamoff>(offset))) return false;
+    while (length > 0) {
+        file.read(buffer.data(), static_cast<std::streamsize>(std::min<uint64_t>(length, buffer.size())));
+        size_t got = static_cast<size_t>(file.gcount());
+        if (got == 0 || !onRead(got)) break;
+        length -= got;
+    }
+    return !file.bad();
+#endif
+}
+
+// The files worth reading, biggest first, as many as fit in memory that can spare them
+std::vector<PlannedFile> PlanPrefetch(const std::string& installDir, const PrefetchOptions& options, bool& trimmed,
+                                      std::string& error) {
+    MISE_TRACE_SCOPE("PlanPrefetch");
+    std::vector<PlannedFile> files;
+    std::error_code ec;
+    fs::path root(installDir);
+    if (!fs::is_directory(root, ec)) {
+        error = installDir + " is not a folder";
+        return files;
+    }
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        std::error_code entryError;
+        if (!it->is_regular_file(entryError)) continue;
+        uint64_t size = it->file_size(entryError);
+        if (!entryError && size >= options.minFileSize) files.push_back({it->path().string(), size});
+    }
+    std::sort(files.begin(), files.end(), [](const PlannedFile& a, const PlannedFile& b) { return a.size > b.size; });
+
+    trimmed = false;
+    uint64_t available = 0;
+    bool underPressure = false;
+    if (!ReadMemoryState(options, available, underPressure)) return files;
+    uint64_t budget = underPressure || available <= options.memoryReserve ? 0 : available - options.memoryReserve;
+    std::vector<PlannedFile> fitting;
+    for (PlannedFile& file : files) {
+        if (file.size > budget) {
+            trimmed = true;  // A smaller one further down may still fit
+            continue;
+        }
+        budget -= file.size;
+        fitting.push_back(std::move(file));
+    }
+    return fitting;
+}
+
+uint64_t ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
+PrefetchProgress PrefetchAssets(const std::string& installDir, const PrefetchOptions& options, const std::atomic<bool>& stop,
+                                const PrefetchCallback& onProgress) {
+    MISE_TRACE_SCOPE("PrefetchAssets");
+    auto start = std::chrono::steady_clock::now();
+    PrefetchProgress progress;
+    bool trimmed = false;
+    std::vector<PlannedFile> files = PlanPrefetch(installDir, options, trimmed, progress.error);
+    if (!progress.error.empty()) {
+        progress.state = PrefetchState::Failed;
+        if (onProgress) onProgress(progress);
+        return progress;
+    }
+
+    // Segments of a file next to each other, so a worker mostly reads one file front to back
+    struct Segment {
+        size_t file;
+        uint64_t offset;
+    };
+    std::vector<Segment> segments;
+    std::vector<std::atomic<size_t>> segmentsLeft(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        size_t count = static_cast<size_t>((files[i].size + segmentSize - 1) / segmentSize);
+        for (size_t k = 0; k < count; ++k) segments.push_back({i, k * segmentSize});
+        segmentsLeft[i] = count;
+        progress.bytes += files[i].size;
+    }
+    progress.files = files.size();
+    progress.state = PrefetchState::Running;
+
+    unsigned workers = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<char>> buffers(workers, std::vector<char>(pieceSize));
+    std::atomic<uint64_t> bytesDone{0};
+    std::atomic<size_t> filesDone{0};
+    std::atomic<uint64_t> nextMemoryCheck{memoryCheckEvery};
+    std::atomic<bool> lowMemory{false};
+    std::mutex reportMutex;
+    uint64_t lastReportMs = 0;
+
+    auto snapshot = [&] {
+        PrefetchProgress now = progress;
+        now.bytesDone = bytesDone;
+        now.filesDone = filesDone;
+        now.elapsedMs = ElapsedMs(start);
+        return now;
+    };
+    // Called after every piece: keeps to the rate limit, watches memory and reports now and then
+    auto afterPiece = [&](size_t got) {
+        uint64_t done = bytesDone += got;
+        if (options.maxBytesPerSecond) {
+            auto due = start + std::chrono::milliseconds(done * 1000 / options.maxBytesPerSecond);
+            if (due > std::chrono::steady_clock::now()) std::this_thread::sleep_until(due);
+        }
+        uint64_t check = nextMemoryCheck;
+        if (done >= check && nextMemoryCheck.compare_exchange_strong(check, done + memoryCheckEvery)) {
+            uint64_t available = 0;
+            bool underPressure = false;
+            if (ReadMemoryState(options, available, underPressure) && (underPressure || available < options.memoryReserve)) {
+                lowMemory = true;
+            }
+        }
+        if (onProgress && options.progressEveryMs) {
+            std::unique_lock<std::mutex> lock(reportMutex, std::try_to_lock);
+            if (lock && ElapsedMs(start) >= lastReportMs + options.progressEveryMs) {
+                lastReportMs = ElapsedMs(start);
+                onProgress(snapshot());
+            }
+        }
+        return !stop && !lowMemory;
+    };
+
+    RunWorkStealing(segments.size(), workers, [&](size_t index, unsigned worker) {
+        if (stop || lowMemory) return;  // Drain what's left without reading it
+        const Segment& segment = segments[index];
+        const PlannedFile& file = files[segment.file];
+        uint64_t length = std::min(segmentSize, file.size - segment.offset);
+        // A file that can't be read (gone, locked) is just not prefetched; the game will say what's wrong with it
+        uint64_t read = 0;
+        ReadSegment(file.path, segment.offset, length, buffers[worker], [&](size_t got) {
+            read += got;
+            return afterPiece(got);
+        });
+        if (read == length && --segmentsLeft[segment.file] == 0) ++filesDone;
+    });
+
+    progress = snapshot();
+    progress.state = stop ? PrefetchState::Stopped : lowMemory || trimmed ? PrefetchState::LowMemory : PrefetchState::Done;
+    if (onProgress) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        onProgress(progress);
+    }
+    return progress;
+}
+
+bool ParseLinuxMemoryState(std::string_view meminfo, std::string_view pressure, uint64_t& available, bool& underPressure) {
+    // Pressure stall information: "some avg10=12.34 avg60=... total=...", a percentage
+    double stalled = 0;
+    underPressure = std::sscanf(std::string(pressure.substr(0, pressure.find('\n'))).c_str(), "some avg10=%lf", &stalled) == 1 &&
+                    stalled > 10.0;
+    while (!meminfo.empty()) {
+        size_t end = meminfo.find('\n');
+        std::string line(meminfo.substr(0, end));
+        meminfo.remove_prefix(end == std::string_view::npos ? meminfo.size() : end + 1);
+        unsigned long long kb = 0;
+        if (std::sscanf(line.c_str(), "MemAvailable: %llu kB", &kb) == 1) {
+            available = static_cast<uint64_t>(kb) << 10;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string PrefetchSummary(const PrefetchProgress& progress) {
+    if (progress.state == PrefetchState::Failed) return "Game files were not prefetched: " + progress.error;
+    char seconds[32];
+    std::snprintf(seconds, sizeof(seconds), "%.1f s", progress.elapsedMs / 1000.0);
+    std::string text = "Read " + std::to_string(progress.filesDone) + (progress.filesDone == 1 ? " file, " : " files, ") +
+                       FormatBytes(progress.bytesDone) + " of " + FormatBytes(progress.bytes) + ", in " + seconds;
+    if (progress.state == PrefetchState::Stopped) text += " (stopped)";
+    if (progress.state == PrefetchState::LowMemory) text += " (stopped short: not enough free memory to hold more)";
+    return text;
+}
+
+bool AssetPrefetcher::Start(std::function<std::string(std::string& error)> findInstallDir, const PrefetchOptions& options,
+                            PrefetchCallback onProgress) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (progress_.state == PrefetchState::Running) return false;
+    if (worker_.joinable()) worker_.join();  // Finished; nothing to wait for
+    stop_ = false;
+    progress_ = PrefetchProgress();
+    progress_.state = PrefetchState::Running;
+    onProgress_ = std::move(onProgress);
+    worker_ = std::thread([this, findInstallDir = std::move(findInstallDir), options] {
+        MISE_TRACE_SCOPE("AssetPrefetcher");
+        PrefetchProgress failed;
+        std::string installDir = findInstallDir(failed.error);
+        if (installDir.empty()) {
+            failed.state = PrefetchState::Failed;
+            Report(failed);
+            return;
+        }
+        PrefetchAssets(installDir, options, stop_, [this](const PrefetchProgress& progress) { Report(progress); });
+    });
+    return true;
+}
+
+void AssetPrefetcher::Report(const PrefetchProgress& progress) {
+    PrefetchCallback onProgress;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        progress_ = progress;
+        onProgress = onProgress_;
+    }
+    if (onProgress) onProgress(progress);
+}
+
+void AssetPrefetcher::Stop() {
+    stop_ = true;
+    Wait();
+}
+
+void AssetPrefetcher::Wait() {
+    if (worker_.joinable()) worker_.join();
+}
+
+PrefetchProgress AssetPrefetcher::Progress() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return progress_;
+}
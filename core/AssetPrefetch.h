@@ -0,0 +1,108 @@
+/*
+ * AssetPrefetch.h
+ * Read the game's big data files into the OS file cache while the
+ * launcher is open, so the game finds them in memory instead of waiting
+ * on a spinning disk or a network share after Launch is clicked.
+ *
+ * Files of at least minFileSize under the install folder are read biggest
+ * first, in 16 MB segments spread over a couple of threads with
+ * RunWorkStealing. Each segment is announced to the OS first (WILLNEED
+ * and SEQUENTIAL on Linux, a sequential-scan handle on Windows) and then
+ * read through in 1 MB pieces that are thrown away; the cache keeps them.
+ * Reading can be held to maxBytesPerSecond so the machine stays usable.
+ *
+ * Memory-pressure cutoff: the cache only holds what fits in memory that
+ * is otherwise free, so no more than free memory minus memoryReserve is
+ * read (reading more would only push out what was read first), and
+ * reading stops as soon as free memory drops below the reserve or the
+ * system reports memory pressure (Linux PSI, the Windows memory load).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+enum class PrefetchState {
+    Idle,
+    Running,
+    Done,       // Every planned byte was read
+    Stopped,    // Stop() (the game is starting, the launcher is closing)
+    LowMemory,  // Planned or cut short by the memory-pressure cutoff
+    Failed,     // No install folder to read
+};
+
+struct PrefetchOptions {
+    uint64_t minFileSize = 4 << 20;           // Smaller files aren't where the load time goes
+    unsigned threads = 2;                     // Reads at once; more only make a spinning disk seek
+    uint64_t maxBytesPerSecond = 0;           // 0 = as fast as the disk goes
+    uint64_t memoryReserve = 1024ull << 20;   // Free memory prefetching leaves alone
+    unsigned progressEveryMs = 250;
+
+    // Free memory and whether the system is short of it, asked before planning and every 64 MB read; false if
+    // neither is known (no cutoff then). Empty asks the system; the tests hand in readings of their own
+    std::function<bool(uint64_t& available, bool& underPressure)> readMemory;
+};
+
+struct PrefetchProgress {
+    PrefetchState state = PrefetchState::Idle;
+    size_t files = 0;          // Planned; big files that didn't fit in memory aren't counted
+    size_t filesDone = 0;
+    uint64_t bytes = 0;
+    uint64_t bytesDone = 0;
+    uint64_t elapsedMs = 0;
+    std::string error;         // Why it Failed
+
+    unsigned Percent() const { return bytes ? static_cast<unsigned>(bytesDone * 100 / bytes) : 100; }
+};
+
+using PrefetchCallback = std::function<void(const PrefetchProgress&)>;
+
+// Prefetch installDir on the calling thread until done or 'stop' is set. onProgress (if any) runs every
+// progressEveryMs on one of the reading threads, and once more with the final state
+PrefetchProgress PrefetchAssets(const std::string& installDir, const PrefetchOptions& options, const std::atomic<bool>& stop,
+                                const PrefetchCallback& onProgress);
+
+// MemAvailable from /proc/meminfo, and whether /proc/pressure/memory says some task spent more than 10% of
+// the last 10 s waiting on memory; false if there's no MemAvailable line
+bool ParseLinuxMemoryState(std::string_view meminfo, std::string_view pressure, uint64_t& available, bool& underPressure);
+
+// "Read 2 files, 1.2 GB of 1.2 GB, in 3.4 s", with why it stopped when it didn't finish
+std::string PrefetchSummary(const PrefetchProgress& progress);
+
+// PrefetchAssets on a thread of its own
+class AssetPrefetcher {
+public:
+    AssetPrefetcher() = default;
+    ~AssetPrefetcher() { Stop(); }
+    AssetPrefetcher(const AssetPrefetcher&) = delete;
+    AssetPrefetcher& operator=(const AssetPrefetcher&) = delete;
+
+    // findInstallDir runs on the worker first (finding Steam's files is slow too); it returns an empty folder,
+    // with an error, if there's none. onProgress runs on the worker. False if a prefetch is already running
+    bool Start(std::function<std::string(std::string& error)> findInstallDir, const PrefetchOptions& options,
+               PrefetchCallback onProgress);
+
+    // Stop reading and join the worker; safe to call twice
+    void Stop();
+
+    // Block until the worker is done (the benchmark)
+    void Wait();
+
+    // The latest progress the worker reported
+    PrefetchProgress Progress() const;
+
+private:
+    void Report(const PrefetchProgress& progress);
+
+    std::thread worker_;
+    std::atomic<bool> stop_{false};
+    mutable std::mutex mutex_;
+    PrefetchProgress progress_;
+    PrefetchCallback onProgress_;
+};
@@ -0,0 +1,171 @@
+/*
+ * AtomicFile.cpp
+ * Temp file + flush + rename, with a Win32 and a POSIX flavor.
+ * "Never pay more than 20 pieces of eight for a half-written file!"
+ */
+
+#include "AtomicFile.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+uint64_t HashContent(std::string_view content) {
+    uint64_t hash = 1469598103934665603ull;
+    for (unsigned char c : content) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+namespace {
+
+// Temp files are created exclusively (never opened if they exist); a name that is taken is retried this often
+constexpr int tempNameAttempts = 16;
+
+// "<path>.<pid>.<n>.tmp", a new n for every write: two threads saving the same file at once (the window and
+// the control channel, say) each get a temp file of their own
+std::string NextTempPath(const std::string& path, unsigned long processId) {
+    static std::atomic<uint64_t> writes{0};
+    return path + "." + std::to_string(processId) + "." + std::to_string(writes.fetch_add(1)) + ".tmp";
+}
+
+} // namespace
+
+#ifdef _WIN32
+
+namespace {
+
+std::string LastErrorText(const std::string& what) {
+    return what + " (error " + std::to_string(GetLastError()) + ")";
+}
+
+} // namespace
+
+bool StageFileAtomic(const std::string& path, std::string_view content, std::string& tempPath, std::string& error) {
+    HANDLE file = INVALID_HANDLE_VALUE;
+    for (int attempt = 0; attempt < tempNameAttempts && file == INVALID_HANDLE_VALUE; ++attempt) {
+        tempPath = NextTempPath(path, GetCurrentProcessId());
+        file = CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE && GetLastError() != ERROR_FILE_EXISTS) break;
+    }
+    if (file == INVALID_HANDLE_VALUE) {
+        error = LastErrorText("Could not create a temporary file next to " + path);
+        return false;
+    }
+
+    bool ok = true;
+    size_t written = 0;
+    while (ok && written < content.size()) {
+        DWORD chunk = 0;
+        DWORD toWrite = static_cast<DWORD>(std::min<size_t>(content.size() - written, 1u << 30));
+        ok = ::WriteFile(file, content.data() + written, toWrite, &chunk, NULL) && chunk > 0;
+        written += chunk;
+    }
+    if (!ok) error = LastErrorText("Could not write the temporary file (is the disk full?)");
+    if (ok && !FlushFileBuffers(file)) {
+        ok = false;
+        error = LastErrorText("Could not flush the temporary file to disk");
+    }
+    CloseHandle(file);
+    if (!ok) DeleteFileA(tempPath.c_str());
+    return ok;
+}
+
+bool CommitStagedFile(const std::string& tempPath, const std::string& path, std::string& error) {
+    if (!MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        error = LastErrorText("Could not replace " + path);
+        DeleteFileA(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+#else
+
+namespace {
+
+std::string ErrnoText(const std::string& what) {
+    return what + " (" + std::strerror(errno) + ")";
+}
+
+} // namespace
+
+bool StageFileAtomic(const std::string& path, std::string_view content, std::string& tempPath, std::string& error) {
+    // Keep the permissions of the file we're replacing
+    mode_t mode = 0644;
+    struct stat existing;
+    if (stat(path.c_str(), &existing) == 0) mode = existing.st_mode & 07777;
+
+    int fd = -1;
+    for (int attempt = 0; attempt < tempNameAttempts && fd < 0; ++attempt) {
+        tempPath = NextTempPath(path, static_cast<unsigned long>(getpid()));
+        fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+        if (fd < 0 && errno != EEXIST) break;
+    }
+    if (fd < 0) {
+        error = ErrnoText("Could not create a temporary file next to " + path);
+        return false;
+    }
+
+    bool ok = true;
+    size_t written = 0;
+    while (ok && written < content.size()) {
+        ssize_t chunk = write(fd, content.data() + written, content.size() - written);
+        if (chunk < 0 && errno == EINTR) continue;
+        ok = chunk > 0;
+        if (ok) written += static_cast<size_t>(chunk);
+    }
+    if (!ok) error = ErrnoText("Could not write the temporary file (is the disk full?)");
+    if (ok && fsync(fd) != 0) {
+        ok = false;
+        error = ErrnoText("Could not flush the temporary file to disk");
+    }
+    if (close(fd) != 0 && ok) {
+        ok = false;
+        error = ErrnoText("Could not close the temporary file");
+    }
+    if (!ok) unlink(tempPath.c_str());
+    return ok;
+}
+
+bool CommitStagedFile(const std::string& tempPath, const std::string& path, std::string& error) {
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        error = ErrnoText("Could not replace " + path);
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    // Make the rename itself durable
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int dirFd = open(dir.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
+}
+
+#endif
+
+bool WriteFileAtomic(const std::string& path, std::string_view content, std::string& error) {
+    MISE_TRACE_SCOPE("WriteFileAtomic");
+    std::string tempPath;
+    return StageFileAtomic(path, content, tempPath, error) && CommitStagedFile(tempPath, path, error);
+}
@@ -0,0 +1,24 @@
+/*
+ * AtomicFile.h
+ * Crash-safe file replacement: write a temp file next to the target, flush
+ * it to disk, then rename it over the target in one step. A crash or a full
+ * disk leaves either the old file or the new one, never half of each.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Replace path with content atomically; on failure error says why and the target is untouched
+bool WriteFileAtomic(const std::string& path, std::string_view content, std::string& error);
+
+// WriteFileAtomic in two steps, for replacing several files together: StageFileAtomic writes and flushes the
+// temp file next to path (its name goes in stagedPath), CommitStagedFile renames it over path. A staged file
+// that won't be committed is simply deleted
+bool StageFileAtomic(const std::string& path, std::string_view content, std::string& stagedPath, std::string& error);
+bool CommitStagedFile(const std::string& stagedPath, const std::string& path, std::string& error);
+
+// 64-bit FNV-1a, good enough to tell "same bytes" from "different bytes" for a config file
+uint64_t HashContent(std::string_view content);
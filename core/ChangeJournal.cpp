@@ -0,0 +1,194 @@
+/*
+ * ChangeJournal.cpp
+ * "Dear diary: today I changed the music volume. Then the ship sank."
+ */
+
+#include "ChangeJournal.h"
+
+#include "AtomicFile.h"
+#include "PieceTable.h"
+#include "TextFile.h"
+#include "Trace.h"
+
+#include <cstring>
+
+namespace {
+
+const char journalMagic[8] = {'M', 'I', 'S', 'E', 'J', 'R', 'N', '1'};
+const size_t recordOverhead = 1 + 4 + 4;  // kind, payload length, check
+
+const char baseRecord = 'B';
+const char snapshotRecord = 'S';
+const char editRecord = 'E';
+
+uint32_t ReadU32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+void AppendU32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// kind, length, payload and the check over all three
+void AppendRecord(std::string& out, char kind, std::string_view payload) {
+    size_t start = out.size();
+    out += kind;
+    AppendU32(out, static_cast<uint32_t>(payload.size()));
+    out += payload;
+    AppendU32(out, static_cast<uint32_t>(HashContent(std::string_view(out).substr(start))));
+}
+
+std::string EditPayload(size_t start, size_t removed, std::string_view inserted) {
+    std::string payload;
+    payload.reserve(8 + inserted.size());
+    AppendU32(payload, static_cast<uint32_t>(start));
+    AppendU32(payload, static_cast<uint32_t>(removed));
+    payload += inserted;
+    return payload;
+}
+
+std::string JournalHeader(std::string_view base) {
+    std::string out(journalMagic, sizeof(journalMagic));
+    AppendRecord(out, baseRecord, base);
+    return out;
+}
+
+} // namespace
+
+void ChangeJournal::Start(const std::string& path, std::string text) {
+    path_ = path;
+    MarkClean(std::move(text));
+}
+
+void ChangeJournal::MarkClean(std::string text) {
+    Close();
+    if (!path_.empty()) std::remove(path_.c_str());  // Also a journal left by an earlier run
+    base_ = std::move(text);
+    exists_ = false;
+    failed_ = false;
+    pending_ = 0;
+    fileSize_ = 0;
+}
+
+bool ChangeJournal::OpenForAppend() {
+    file_ = std::fopen(path_.c_str(), exists_ ? "ab" : "wb");
+    if (!file_) return false;
+    if (!exists_) {
+        std::string header = JournalHeader(base_);
+        if (std::fwrite(header.data(), 1, header.size(), file_) != header.size()) return false;
+        exists_ = true;
+        fileSize_ = header.size();
+    }
+    return true;
+}
+
+bool ChangeJournal::Append(size_t start, size_t removed, std::string_view inserted) {
+    if (failed_ || path_.empty()) return false;
+    if (start > UINT32_MAX || removed > UINT32_MAX || inserted.size() > UINT32_MAX - 8) {
+        failed_ = true;  // Not a settings file any more; don't pretend to keep it
+        return false;
+    }
+    if (!file_ && !OpenForAppend()) {
+        Close();
+        failed_ = true;
+        return false;
+    }
+    std::string record;
+    AppendRecord(record, editRecord, EditPayload(start, removed, inserted));
+    // Handed to the OS straight away: a crash of ours after this returns can't lose it
+    if (std::fwrite(record.data(), 1, record.size(), file_) != record.size() || std::fflush(file_) != 0) {
+        Close();
+        failed_ = true;
+        return false;
+    }
+    ++pending_;
+    fileSize_ += record.size();
+    return true;
+}
+
+bool ChangeJournal::Compact(std::string_view text, std::string& error) {
+    MISE_TRACE_SCOPE("CompactJournal");
+    if (path_.empty() || (pending_ == 0 && !failed_)) return true;  // Nothing new since the last compaction
+    if (text == base_) {
+        MarkClean(std::move(base_));  // Back where it started (typed and undone, say)
+        return true;
+    }
+    std::string content = JournalHeader(base_);
+    AppendRecord(content, snapshotRecord, text);
+    Close();  // Windows won't rename over a file that is open
+    if (!WriteFileAtomic(path_, content, error)) {
+        return false;  // The appended records are still there; appending carries on after them
+    }
+    exists_ = true;
+    failed_ = false;
+    pending_ = 0;
+    fileSize_ = content.size();
+    return true;
+}
+
+void ChangeJournal::Close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool ReadChangeJournal(const std::string& path, JournalContents& contents, std::string& error) {
+    MISE_TRACE_SCOPE("ReadChangeJournal");
+    contents = JournalContents();
+    std::string data;
+    if (!ReadFileBytes(path, data)) {
+        error = "There is no journal at " + path;
+        return false;
+    }
+    if (data.size() < sizeof(journalMagic) || std::memcmp(data.data(), journalMagic, sizeof(journalMagic)) != 0) {
+        error = path + " is not a launcher journal";
+        return false;
+    }
+
+    PieceTable text;
+    bool haveBase = false;
+    size_t pos = sizeof(journalMagic);
+    while (data.size() - pos >= recordOverhead) {
+        const char* record = data.data() + pos;
+        uint32_t length = ReadU32(record + 1);
+        if (length > data.size() - pos - recordOverhead) break;  // Cut short
+        std::string_view checked(record, 5 + length);
+        if (ReadU32(record + 5 + length) != static_cast<uint32_t>(HashContent(checked))) break;  // Damaged
+        std::string_view payload = checked.substr(5);
+
+        char kind = record[0];
+        if (!haveBase) {
+            if (kind != baseRecord) break;
+            contents.base = std::string(payload);
+            text.Reset(contents.base);
+            haveBase = true;
+        } else if (kind == snapshotRecord) {
+            text.Reset(std::string(payload));
+            contents.edits = 0;
+        } else if (kind == editRecord && length >= 8) {
+            uint32_t start = ReadU32(payload.data());
+            uint32_t removed = ReadU32(payload.data() + 4);
+            if (start > text.Size() || removed > text.Size() - start) break;  // Not an edit of this text
+            text.Replace(start, start + removed, payload.substr(8));
+            ++contents.edits;
+        } else {
+            break;
+        }
+        pos += recordOverhead + length;
+    }
+
+    if (!haveBase) {
+        error = path + " is damaged before its first edit";
+        return false;
+    }
+    contents.text = text.Text();
+    contents.unreadableBytes = data.size() - pos;
+    return true;
+}
+
+std::string ChangeJournalPath(const std::string& iniPath) {
+    return iniPath + ".journal";
+}
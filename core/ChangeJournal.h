@@ -0,0 +1,85 @@
+/*
+ * ChangeJournal.h
+ * Unsaved edits kept safe without saving them. Every change to the text
+ * box is appended to settings.ini.journal as a small record, so closing
+ * the launcher (or it crashing) with the save reminder up loses nothing:
+ * the next start replays the journal and offers the edits back.
+ *
+ * An append is one buffered write handed to the OS, so it survives the
+ * launcher crashing (not the machine losing power) and costs about as much
+ * as the keystroke itself. Once typing pauses, and on exit, the journal is
+ * compacted: rewritten atomically as the starting text plus one snapshot
+ * of the current text. When the text is clean again (saved, or loaded
+ * afresh) the journal is removed.
+ *
+ * File layout (little-endian):
+ *   header   "MISEJRN1"
+ *   records  kind (1 byte), payload length (u32), payload, check (u32)
+ *
+ *   'B' base      the text the edits were made to (always first)
+ *   'S' snapshot  the whole text, replacing what came before
+ *   'E' edit      start (u32), removed (u32), inserted text
+ *
+ * The check is the low half of HashContent over kind, length and payload.
+ * Reading stops at the first record that is cut short or fails its check,
+ * so a torn write costs at most the edits after it.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+class ChangeJournal {
+public:
+    ChangeJournal() = default;
+    ~ChangeJournal() { Close(); }
+    ChangeJournal(const ChangeJournal&) = delete;
+    ChangeJournal& operator=(const ChangeJournal&) = delete;
+
+    // Journal edits made to text at path from now on; whatever journal was there is removed
+    void Start(const std::string& path, std::string text);
+
+    // The text is clean again (saved or reloaded): remove the journal and start over from text
+    void MarkClean(std::string text);
+
+    // One change to the text; the journal file is created with the first one.
+    // False if the file can't be written (the journal then stays off until the next MarkClean)
+    bool Append(size_t start, size_t removed, std::string_view inserted);
+
+    // Rewrite the journal as the base and text, atomically; a text that is the base again removes it
+    bool Compact(std::string_view text, std::string& error);
+
+    // Stop appending; the file stays for the next start to find
+    void Close();
+
+    const std::string& Path() const { return path_; }
+    size_t PendingEdits() const { return pending_; }  // Appended since the last compaction or MarkClean
+    uint64_t FileSize() const { return fileSize_; }    // Bytes in the journal file (0 when there is none)
+
+private:
+    bool OpenForAppend();
+
+    std::string path_;
+    std::string base_;
+    std::FILE* file_ = nullptr;
+    bool exists_ = false;  // The file holds a header and base record of ours
+    bool failed_ = false;  // A write failed; nothing more is appended until MarkClean
+    size_t pending_ = 0;
+    uint64_t fileSize_ = 0;
+};
+
+struct JournalContents {
+    std::string base;            // The text the edits were made to
+    std::string text;            // The text with every readable edit applied
+    size_t edits = 0;            // Edit records applied after the last snapshot (or the base)
+    size_t unreadableBytes = 0;  // A torn or damaged tail that was ignored
+};
+
+// Read and replay the journal at path. False if there is none, or nothing in it could be read
+bool ReadChangeJournal(const std::string& path, JournalContents& contents, std::string& error);
+
+// settings.ini.journal, next to settings.ini
+std::string ChangeJournalPath(const std::string& iniPath);
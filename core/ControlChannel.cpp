@@ -0,0 +1,436 @@
+/*
+ * ControlChannel.cpp
+ * "Ahoy there! Is anybody listening on this pipe?"
+ */
+
+#include "ControlChannel.h"
+
+#include "Trace.h"
+
+#include <cstdlib>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t maxRequestSize = 64 << 10;  // A request line longer than this ends the connection
+
+#ifdef _WIN32
+
+HANDLE AsHandle(intptr_t connection) { return reinterpret_cast<HANDLE>(connection); }
+intptr_t AsConnection(HANDLE handle) { return reinterpret_cast<intptr_t>(handle); }
+
+// The TOKEN_USER of process; its User.Sid points into the buffer
+bool ProcessUser(HANDLE process, std::vector<char>& tokenUser) {
+    HANDLE token;
+    if (!OpenProcessToken(process, TOKEN_QUERY, &token)) return false;
+    DWORD size = 0;
+    GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+    tokenUser.resize(size);
+    bool ok = size != 0 && GetTokenInformation(token, TokenUser, tokenUser.data(), size, &size);
+    CloseHandle(token);
+    return ok;
+}
+
+PSID UserSid(std::vector<char>& tokenUser) { return reinterpret_cast<TOKEN_USER*>(tokenUser.data())->User.Sid; }
+
+// The pipe name is easy to guess, so its DACL (the default one would also let in LocalSystem, the
+// Administrators group and whatever the creator's token adds) names only the user running the launcher
+HANDLE CreatePipeInstance(const std::string& endpoint, bool first) {
+    std::vector<char> user;
+    if (!ProcessUser(GetCurrentProcess(), user)) return INVALID_HANDLE_VALUE;
+    PSID sid = UserSid(user);
+    std::vector<char> acl(sizeof(ACL) + sizeof(ACCESS_ALLOWED_ACE) + GetLengthSid(sid));
+    PACL dacl = reinterpret_cast<PACL>(acl.data());
+    SECURITY_DESCRIPTOR descriptor;
+    if (!InitializeAcl(dacl, static_cast<DWORD>(acl.size()), ACL_REVISION) ||
+        !AddAccessAllowedAce(dacl, ACL_REVISION, GENERIC_ALL, sid) ||
+        !InitializeSecurityDescriptor(&descriptor, SECURITY_DESCRIPTOR_REVISION) ||
+        !SetSecurityDescriptorOwner(&descriptor, sid, FALSE) ||
+        !SetSecurityDescriptorDacl(&descriptor, TRUE, dacl, FALSE)) {
+        return INVALID_HANDLE_VALUE;
+    }
+    SECURITY_ATTRIBUTES attributes = {sizeof(attributes), &descriptor, FALSE};
+
+    DWORD openMode = PIPE_ACCESS_DUPLEX | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+    return CreateNamedPipeA(endpoint.c_str(), openMode, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                            PIPE_UNLIMITED_INSTANCES, 4096, 4096, 0, &attributes);
+}
+
+// Whether the process that created pipe runs as the same user we do. Anyone can create the pipe before the
+// launcher does, and a client would otherwise hand its requests to them
+bool ServerIsCurrentUser(HANDLE pipe) {
+    ULONG pid = 0;
+    if (!GetNamedPipeServerProcessId(pipe, &pid)) return false;
+    HANDLE server = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!server) return false;
+    std::vector<char> theirs, ours;
+    bool same = ProcessUser(server, theirs) && ProcessUser(GetCurrentProcess(), ours) && EqualSid(UserSid(theirs), UserSid(ours));
+    CloseHandle(server);
+    return same;
+}
+
+long ReadSome(intptr_t connection, char* buffer, size_t size) {
+    DWORD read = 0;
+    if (!ReadFile(AsHandle(connection), buffer, static_cast<DWORD>(size), &read, nullptr)) return -1;
+    return static_cast<long>(read);
+}
+
+bool WriteAll(intptr_t connection, const std::string& data) {
+    DWORD written = 0;
+    return WriteFile(AsHandle(connection), data.data(), static_cast<DWORD>(data.size()), &written, nullptr) && written == data.size();
+}
+
+void Wake(intptr_t connection) {
+    // Fails a ReadFile blocked on another thread; the handle stays open until that thread is joined
+    CancelIoEx(AsHandle(connection), nullptr);
+    DisconnectNamedPipe(AsHandle(connection));
+}
+
+void CloseConnection(intptr_t connection) { CloseHandle(AsHandle(connection)); }
+
+#else
+
+long ReadSome(intptr_t connection, char* buffer, size_t size) {
+    for (;;) {
+        ssize_t read = recv(static_cast<int>(connection), buffer, size, 0);
+        if (read < 0 && errno == EINTR) continue;
+        return static_cast<long>(read);
+    }
+}
+
+bool WriteAll(intptr_t connection, const std::string& data) {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;  // A client that went away is an error here, not a SIGPIPE
+#else
+    const int flags = 0;
+#endif
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t sent = send(static_cast<int>(connection), data.data() + done, data.size() - done, flags);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        done += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+void Wake(intptr_t connection) { shutdown(static_cast<int>(connection), SHUT_RDWR); }
+
+void CloseConnection(intptr_t connection) { close(static_cast<int>(connection)); }
+
+bool MakeAddress(const std::string& endpoint, sockaddr_un& address, std::string& error) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (endpoint.size() >= sizeof(address.sun_path)) {
+        error = "Control socket path is too long: " + endpoint;
+        return false;
+    }
+    std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+    return true;
+}
+
+int ConnectSocket(const sockaddr_un& address) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Whether the process listening on fd's other end runs as the same user we do; in /tmp anyone could have
+// bound the socket name first
+bool ServerIsCurrentUser(int fd) {
+#ifdef SO_PEERCRED
+    ucred peer;
+    socklen_t size = sizeof(peer);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &size) == 0 && peer.uid == getuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    return getpeereid(fd, &uid, &gid) == 0 && uid == getuid();
+#endif
+}
+
+#endif
+
+// Pull the first complete line out of buffer, without its newline
+bool TakeLine(std::string& buffer, std::string& line) {
+    size_t newline = buffer.find('\n');
+    if (newline == std::string::npos) return false;
+    line.assign(buffer, 0, newline);
+    buffer.erase(0, newline + 1);
+    return true;
+}
+
+} // namespace
+
+std::string DefaultControlEndpoint() {
+#ifdef _WIN32
+    char user[UNLEN + 1] = {};
+    DWORD size = sizeof(user);
+    if (!GetUserNameA(user, &size)) user[0] = '\0';
+    return std::string("\\\\.\\pipe\\MISELauncher-") + user;
+#else
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && *runtimeDir) return std::string(runtimeDir) + "/miselauncher.sock";
+    return "/tmp/miselauncher-" + std::to_string(getuid()) + ".sock";
+#endif
+}
+
+bool ControlServer::Start(const std::string& endpoint, Handler handler, std::string& error) {
+    if (IsRunning()) {
+        error = "The control channel is already open";
+        return false;
+    }
+#ifdef _WIN32
+    HANDLE pipe = CreatePipeInstance(endpoint, true);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        error = GetLastError() == ERROR_ACCESS_DENIED ? "Another launcher is already resident" : "Could not create " + endpoint;
+        return false;
+    }
+    listener_ = AsConnection(pipe);
+#else
+    sockaddr_un address;
+    if (!MakeAddress(endpoint, address, error)) return false;
+    int probe = ConnectSocket(address);
+    if (probe >= 0) {
+        close(probe);
+        error = "Another launcher is already resident";
+        return false;
+    }
+    unlink(endpoint.c_str());  // Left behind by a launcher that didn't get to clean up
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        error = std::string("Could not create the control socket: ") + std::strerror(errno);
+        return false;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || chmod(endpoint.c_str(), 0600) != 0 ||
+        listen(fd, 16) != 0) {
+        error = "Could not listen on " + endpoint + ": " + std::strerror(errno);
+        close(fd);
+        unlink(endpoint.c_str());
+        return false;
+    }
+    if (pipe(stopPipe_) != 0) {
+        error = std::string("Could not create the control socket: ") + std::strerror(errno);
+        close(fd);
+        unlink(endpoint.c_str());
+        return false;
+    }
+    listener_ = fd;
+#endif
+    endpoint_ = endpoint;
+    handler_ = std::move(handler);
+    stopping_ = false;
+    acceptThread_ = std::thread(&ControlServer::AcceptLoop, this);
+    return true;
+}
+
+void ControlServer::Stop() {
+    if (!IsRunning()) return;
+    stopping_ = true;
+#ifdef _WIN32
+    // The accept thread is blocked in ConnectNamedPipe; be the client it's waiting for
+    HANDLE wake = CreateFileA(endpoint_.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (wake != INVALID_HANDLE_VALUE) CloseHandle(wake);
+    acceptThread_.join();
+#else
+    char stop = 1;
+    while (write(stopPipe_[1], &stop, 1) < 0 && errno == EINTR) {
+    }
+    acceptThread_.join();
+    close(static_cast<int>(listener_));
+    unlink(endpoint_.c_str());
+    close(stopPipe_[0]);
+    close(stopPipe_[1]);
+    stopPipe_[0] = stopPipe_[1] = -1;
+#endif
+    listener_ = -1;
+    ReapClients(true);
+}
+
+void ControlServer::AcceptLoop() {
+    MISE_TRACE_SCOPE("ControlServer::AcceptLoop");
+#ifdef _WIN32
+    HANDLE pipe = AsHandle(listener_);
+    while (pipe != INVALID_HANDLE_VALUE) {
+        bool connected = ConnectNamedPipe(pipe, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED;
+        if (stopping_) {
+            CloseHandle(pipe);
+            break;
+        }
+        if (connected) {
+            ReapClients(false);
+            AddClient(AsConnection(pipe));
+            pipe = CreatePipeInstance(endpoint_, false);
+        } else {
+            DisconnectNamedPipe(pipe);  // The client gave up before we got to it; wait for the next one
+        }
+    }
+#else
+    int listener = static_cast<int>(listener_);
+    for (;;) {
+        pollfd fds[2] = {{listener, POLLIN, 0}, {stopPipe_[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents || stopping_) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+        fcntl(client, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        ReapClients(false);
+        AddClient(client);
+    }
+#endif
+}
+
+void ControlServer::AddClient(intptr_t connection) {
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    clients_.push_back(std::make_unique<Client>());
+    Client& client = *clients_.back();
+    client.connection = connection;
+    client.thread = std::thread(&ControlServer::Serve, this, std::ref(client));
+}
+
+void ControlServer::ReapClients(bool all) {
+    std::list<std::unique_ptr<Client>> finished;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex_);
+        for (auto it = clients_.begin(); it != clients_.end();) {
+            if (all || (*it)->done) {
+                if (all) Wake((*it)->connection);
+                finished.splice(finished.end(), clients_, it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& client : finished) {
+        client->thread.join();
+        CloseConnection(client->connection);
+    }
+}
+
+void ControlServer::Serve(Client& client) {
+    std::string buffer, line;
+    char chunk[4096];
+    while (!stopping_) {
+        long read = ReadSome(client.connection, chunk, sizeof(chunk));
+        if (read <= 0) break;
+        buffer.append(chunk, static_cast<size_t>(read));
+        bool ok = true;
+        while (ok && TakeLine(buffer, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            ok = WriteAll(client.connection, handler_(line) + "\n");
+        }
+        if (!ok) break;
+        if (buffer.size() > maxRequestSize) {
+            WriteAll(client.connection, "error Request too long\n");
+            break;
+        }
+    }
+    // Hang up now, so a client still writing sees it; the handle itself is closed when this thread is reaped
+#ifdef _WIN32
+    FlushFileBuffers(AsHandle(client.connection));
+    DisconnectNamedPipe(AsHandle(client.connection));
+#else
+    shutdown(static_cast<int>(client.connection), SHUT_RDWR);
+#endif
+    client.done = true;
+}
+
+bool ControlClient::Connect(const std::string& endpoint, std::string& error) {
+    Close();
+#ifdef _WIN32
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        HANDLE pipe = CreateFileA(endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (pipe != INVALID_HANDLE_VALUE) {
+            if (!ServerIsCurrentUser(pipe)) {
+                CloseHandle(pipe);
+                error = "Whatever is listening on " + endpoint + " isn't running as you; nothing was sent to it";
+                return false;
+            }
+            connection_ = AsConnection(pipe);
+            return true;
+        }
+        // Every instance busy means the server is between accepting one client and listening for the next
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeA(endpoint.c_str(), 2000)) break;
+    }
+#else
+    sockaddr_un address;
+    if (!MakeAddress(endpoint, address, error)) return false;
+    int fd = ConnectSocket(address);
+    if (fd >= 0) {
+        if (!ServerIsCurrentUser(fd)) {
+            close(fd);
+            error = "Whatever is listening on " + endpoint + " isn't running as you; nothing was sent to it";
+            return false;
+        }
+        connection_ = fd;
+        return true;
+    }
+#endif
+    error = "No resident launcher is listening on " + endpoint;
+    return false;
+}
+
+void ControlClient::Close() {
+    if (connection_ == -1) return;
+    CloseConnection(connection_);
+    connection_ = -1;
+    buffer_.clear();
+}
+
+bool ControlClient::Request(std::string_view request, std::string& response, std::string& error) {
+    if (connection_ == -1) {
+        error = "Not connected";
+        return false;
+    }
+    std::string line(request);
+    line += '\n';
+    if (!WriteAll(connection_, line)) {
+        error = "The launcher closed the connection";
+        return false;
+    }
+    char chunk[4096];
+    while (!TakeLine(buffer_, response)) {
+        long read = ReadSome(connection_, chunk, sizeof(chunk));
+        if (read <= 0) {
+            error = "The launcher closed the connection";
+            return false;
+        }
+        buffer_.append(chunk, static_cast<size_t>(read));
+    }
+    return true;
+}
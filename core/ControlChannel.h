@@ -0,0 +1,87 @@
+/*
+ * ControlChannel.h
+ * The local transport for ControlService: newline-terminated requests and
+ * responses over a named pipe on Windows or a Unix domain socket elsewhere.
+ * Only the current user's programs on this machine can connect, and a
+ * client only talks to a server running as the same user.
+ *
+ * The server accepts on one thread and gives each connected client a
+ * thread of its own, so a slow client never holds up the others (or the
+ * UI thread, which the server never touches). A client may send any
+ * number of requests over one connection.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// \\.\pipe\MISELauncher-<user> on Windows, $XDG_RUNTIME_DIR/miselauncher.sock (or /tmp/miselauncher-<uid>.sock) elsewhere
+std::string DefaultControlEndpoint();
+
+class ControlServer {
+public:
+    using Handler = std::function<std::string(std::string_view request)>;
+
+    ControlServer() = default;
+    ~ControlServer() { Stop(); }
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    // Listen on endpoint; handler answers each request line, on the client's thread.
+    // Fails if another launcher is already listening there
+    bool Start(const std::string& endpoint, Handler handler, std::string& error);
+
+    // Stop listening, disconnect every client and join all threads; safe to call twice
+    void Stop();
+
+    bool IsRunning() const { return acceptThread_.joinable(); }
+
+private:
+    struct Client {
+        intptr_t connection = -1;
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    void AcceptLoop();
+    void Serve(Client& client);
+    void AddClient(intptr_t connection);
+    void ReapClients(bool all);
+
+    std::string endpoint_;
+    Handler handler_;
+    std::thread acceptThread_;
+    std::atomic<bool> stopping_{false};
+    std::mutex clientsMutex_;
+    std::list<std::unique_ptr<Client>> clients_;
+    intptr_t listener_ = -1;    // The pipe instance waiting for a client, or the listening socket
+#ifndef _WIN32
+    int stopPipe_[2] = {-1, -1};
+#endif
+};
+
+class ControlClient {
+public:
+    ControlClient() = default;
+    ~ControlClient() { Close(); }
+    ControlClient(const ControlClient&) = delete;
+    ControlClient& operator=(const ControlClient&) = delete;
+
+    bool Connect(const std::string& endpoint, std::string& error);
+    void Close();
+
+    // Send one request line and wait for its response line
+    bool Request(std::string_view request, std::string& response, std::string& error);
+
+private:
+    intptr_t connection_ = -1;
+    std::string buffer_;  // Bytes received past the last response
+};
@@ -0,0 +1,141 @@
+/*
+ * ControlService.cpp
+ * "You fight like a dairy farmer! ...but you answer requests like a pirate."
+ */
+
+#include "ControlService.h"
+
+#include "IniMerge.h"
+#include "ProfileStore.h"
+#include "SettingsCli.h"
+#include "SettingsSchema.h"
+#include "TextFile.h"
+#include "Trace.h"
+
+namespace {
+
+std::string Error(std::string message) {
+    // One line per response, whatever the message says
+    for (char& c : message) {
+        if (c == '\n' || c == '\r') c = ' ';
+    }
+    return "error " + message;
+}
+
+} // namespace
+
+bool ControlService::Load(std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return LoadLocked(error);
+}
+
+bool ControlService::LoadLocked(std::string& error) {
+    std::string content;
+    if (!ReadTextFile(iniPath_, content)) {
+        doc_.Parse(std::string());
+        error = "Could not open " + iniPath_;
+        return false;
+    }
+    base_.Reset(content);
+    doc_.Parse(std::move(content));
+    unsaved_ = false;
+    return true;
+}
+
+void ControlService::FileChanged() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string error;
+    if (!unsaved_) LoadLocked(error);
+}
+
+bool ControlService::HasUnsavedChanges() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return unsaved_;
+}
+
+std::string ControlService::Handle(std::string_view request) {
+    MISE_TRACE_SCOPE("ControlService::Handle");
+    if (!request.empty() && request.back() == '\r') request.remove_suffix(1);
+    size_t space = request.find(' ');
+    std::string_view command = request.substr(0, space);
+    std::string_view argument = space == std::string_view::npos ? std::string_view() : Trim(request.substr(space + 1));
+
+    if (command == "ping") return "ok";
+    if (command == "get") return Get(argument);
+    if (command == "set") return Set(argument);
+    if (command == "profile") return ApplyProfile(argument);
+    if (command == "save") return Save();
+    if (command == "reload") {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string error;
+        return LoadLocked(error) ? "ok" : Error(error);
+    }
+    if (command == "launch") {
+        std::string saved = Save();
+        if (saved.compare(0, 2, "ok") != 0) return saved;
+        // Not under the lock: the launcher may take its time, and other requests shouldn't wait for it
+        std::string error;
+        if (!hooks_.launchGame) return Error("Launching the game is not supported here");
+        return hooks_.launchGame(error) ? "ok" : Error(error);
+    }
+    return Error("Unknown request '" + std::string(command) + "'");
+}
+
+std::string ControlService::Get(std::string_view name) {
+    std::string section, key;
+    if (!SplitSettingName(std::string(name), section, key)) return Error("get expects section.key");
+    std::lock_guard<std::mutex> lock(mutex_);
+    const IniEntry* entry = doc_.Find(section, key);
+    if (!entry) return Error(std::string(name) + " not found");
+    return "ok " + std::string(doc_.Value(*entry));
+}
+
+std::string ControlService::Set(std::string_view assignment) {
+    size_t eq = assignment.find('=');
+    std::string section, key;
+    if (eq == std::string_view::npos || !SplitSettingName(std::string(Trim(assignment.substr(0, eq))), section, key)) {
+        return Error("set expects section.key=value");
+    }
+    std::string_view value = Trim(assignment.substr(eq + 1));
+    if (!IsSingleLine(value)) return Error("set values can't have line breaks in them");
+    std::string problem;
+    const SettingSchema* schema = FindSettingSchema(section, key);
+    if (schema && !CheckSettingValue(*schema, value, problem)) return Error(problem);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool changed = doc_.Set(section, key, value).changed;
+    unsaved_ |= changed;
+    return changed ? "ok changed" : "ok unchanged";
+}
+
+std::string ControlService::ApplyProfile(std::string_view name) {
+    if (name.empty()) return Error("profile expects a profile name");
+    // Opened fresh each time, so a profile saved in the window a moment ago is there
+    ProfileStore profiles;
+    std::string error;
+    std::string_view settings;
+    if (!profiles.Open(ProfileStorePath(iniPath_), error)) return Error(error);
+    if (!profiles.Find(name, settings)) return Error("No profile named '" + std::string(name) + "'");
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    SaveResult saved = SaveSettingsFile(iniPath_, settings);
+    if (saved.status == SaveStatus::Failed) return Error(saved.error);
+    doc_.Parse(normalizeWindowsNewlines(settings));
+    base_.Reset(doc_.Text());
+    unsaved_ = false;
+    return "ok";
+}
+
+std::string ControlService::Save() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!unsaved_) return "ok unchanged";  // Also what keeps a file we couldn't read from being overwritten
+    // A request's set is the newest word on its key; keys only the disk changed are kept
+    std::string diskBytes;
+    IniMerge merge = MergeWithDisk(iniPath_, base_, doc_, IniConflictChoice::KeepOurs, diskBytes);
+    SaveResult saved = SaveMergedSettings(iniPath_, merge.merged, diskBytes);
+    if (saved.status == SaveStatus::Failed) return Error(saved.error);
+    doc_ = std::move(merge.merged);
+    base_.Reset(normalizeWindowsNewlines(doc_.Text()));
+    unsaved_ = false;
+    return saved.status == SaveStatus::Written ? "ok written" : "ok unchanged";
+}
@@ -0,0 +1,63 @@
+/*
+ * ControlService.h
+ * The resident launcher's request handler: settings.ini parsed once and
+ * kept in memory, answering one-line requests from other programs (a
+ * front-end menu, a script) in microseconds instead of a process start.
+ *
+ * Requests and responses are single lines of text:
+ *
+ *   ping                      ok
+ *   get section.key           ok <value>
+ *   set section.key=value     ok changed | ok unchanged    (checked against the schema)
+ *   profile name              ok                           (settings.ini becomes the profile, saved)
+ *   save                      ok written | ok unchanged    (merged with changes made on disk meanwhile)
+ *   reload                    ok                           (drops unsaved sets)
+ *   launch                    ok                           (saves pending sets first)
+ *
+ * and anything that fails answers "error <message>". Handle may be called
+ * from any number of threads at once; the transport is ControlChannel.
+ */
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "IniDiff.h"
+#include "IniDocument.h"
+
+struct ControlHooks {
+    std::function<bool(std::string& error)> launchGame;  // Start the game; fill error on failure
+};
+
+class ControlService {
+public:
+    ControlService(std::string iniPath, ControlHooks hooks) : iniPath_(std::move(iniPath)), hooks_(std::move(hooks)) {}
+
+    // Read settings.ini; false (with the document left empty) if it can't be opened
+    bool Load(std::string& error);
+
+    // settings.ini changed on disk: read it again, unless requests have set keys that aren't saved yet
+    void FileChanged();
+
+    // Answer one request line (without its newline)
+    std::string Handle(std::string_view request);
+
+    bool HasUnsavedChanges() const;
+
+private:
+    std::string Get(std::string_view name);
+    std::string Set(std::string_view assignment);
+    std::string ApplyProfile(std::string_view name);
+    std::string Save();
+    bool LoadLocked(std::string& error);
+
+    const std::string iniPath_;
+    const ControlHooks hooks_;
+    mutable std::mutex mutex_;
+    IniDocument doc_;
+    SettingsBaseline base_;  // settings.ini as last read or written, what the sets were made on top of
+    bool unsaved_ = false;
+};
@@ -0,0 +1,231 @@
+/*
+ * DisplayModes.cpp
+ * "Look behind you, a three-headed monitor!"
+ */
+
+#include "DisplayModes.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#endif
+
+namespace {
+
+// Modes smaller than this are VGA leftovers the game can't use
+constexpr int minimumWidth = 800;
+constexpr int minimumHeight = 600;
+
+#ifdef _WIN32
+
+class Win32DisplayModeProvider : public DisplayModeProvider {
+public:
+    std::vector<DisplayMode> EnumerateModes() override {
+        std::vector<DisplayMode> modes;
+        DISPLAY_DEVICEA device = {};
+        device.cb = sizeof(device);
+        for (DWORD deviceIndex = 0; EnumDisplayDevicesA(NULL, deviceIndex, &device, 0); ++deviceIndex) {
+            // Only monitors that are part of the desktop; mirroring drivers and unplugged outputs are skipped
+            if ((device.StateFlags & DISPLAY_DEVICE_ATTACHED_TO_DESKTOP) && !(device.StateFlags & DISPLAY_DEVICE_MIRRORING_DRIVER)) {
+                DEVMODEA devMode = {};
+                devMode.dmSize = sizeof(devMode);
+                for (DWORD modeIndex = 0; EnumDisplaySettingsA(device.DeviceName, modeIndex, &devMode); ++modeIndex) {
+                    modes.push_back({static_cast<int>(devMode.dmPelsWidth), static_cast<int>(devMode.dmPelsHeight),
+                                     static_cast<int>(devMode.dmDisplayFrequency)});
+                }
+            }
+            device = {};
+            device.cb = sizeof(device);
+        }
+        return modes;
+    }
+
+    bool CurrentMode(DisplayMode& mode) override {
+        DEVMODEA devMode = {};
+        devMode.dmSize = sizeof(devMode);
+        if (!EnumDisplaySettingsA(NULL, ENUM_CURRENT_SETTINGS, &devMode)) return false;
+        mode = {static_cast<int>(devMode.dmPelsWidth), static_cast<int>(devMode.dmPelsHeight),
+                static_cast<int>(devMode.dmDisplayFrequency)};
+        return true;
+    }
+};
+
+#elif defined(__linux__)
+
+// The kernel's view of the monitors, from /sys/class/drm; needs no X or Wayland connection, so it works headless too.
+// It has no refresh rates, and lists each connector's preferred mode first
+class DrmDisplayModeProvider : public DisplayModeProvider {
+public:
+    std::vector<DisplayMode> EnumerateModes() override {
+        std::vector<DisplayMode> modes;
+        for (const std::filesystem::path& connector : ConnectedConnectors()) ReadModes(connector, modes, SIZE_MAX);
+        return modes;
+    }
+
+    // The first connected monitor's preferred mode, which is what the desktop runs at unless someone changed it
+    bool CurrentMode(DisplayMode& mode) override {
+        for (const std::filesystem::path& connector : ConnectedConnectors()) {
+            std::vector<DisplayMode> modes;
+            if (ReadModes(connector, modes, 1)) {
+                mode = modes[0];
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    // card0-DP-1, card0-HDMI-A-1, ... with a monitor plugged in, in name order
+    static std::vector<std::filesystem::path> ConnectedConnectors() {
+        std::vector<std::filesystem::path> connectors;
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it("/sys/class/drm", ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->path().filename().string().find('-') == std::string::npos) continue; // card0 itself, renderD128
+            std::ifstream status(it->path() / "status");
+            std::string line;
+            if (std::getline(status, line) && line == "connected") connectors.push_back(it->path());
+        }
+        std::sort(connectors.begin(), connectors.end());
+        return connectors;
+    }
+
+    // Up to 'limit' progressive modes from the connector's "1920x1080" lines; false if it had none
+    static bool ReadModes(const std::filesystem::path& connector, std::vector<DisplayMode>& modes, size_t limit) {
+        std::ifstream file(connector / "modes");
+        std::string line;
+        size_t found = 0;
+        while (found < limit && std::getline(file, line)) {
+            DisplayMode mode;
+            char interlaced = 0;
+            int fields = std::sscanf(line.c_str(), "%dx%d%c", &mode.width, &mode.height, &interlaced);
+            if (fields < 2 || interlaced == 'i') continue;
+            modes.push_back(mode);
+            ++found;
+        }
+        return found > 0;
+    }
+};
+
+#endif
+
+} // namespace
+
+std::unique_ptr<DisplayModeProvider> CreateSystemDisplayModeProvider() {
+#ifdef _WIN32
+    return std::make_unique<Win32DisplayModeProvider>();
+#elif defined(__linux__)
+    return std::make_unique<DrmDisplayModeProvider>();
+#else
+    return std::make_unique<FakeDisplayModeProvider>();
+#endif
+}
+
+void SortDisplayModes(std::vector<DisplayMode>& modes) {
+    modes.erase(std::remove_if(modes.begin(), modes.end(), [](const DisplayMode& mode) {
+        return mode.width < minimumWidth || mode.height < minimumHeight;
+    }), modes.end());
+    std::sort(modes.begin(), modes.end(), [](const DisplayMode& a, const DisplayMode& b) {
+        long long areaA = 1LL * a.width * a.height, areaB = 1LL * b.width * b.height;
+        if (areaA != areaB) return areaA > areaB;
+        if (a.width != b.width) return a.width > b.width;
+        return a.refreshRate > b.refreshRate;
+    });
+    modes.erase(std::unique(modes.begin(), modes.end()), modes.end());
+}
+
+std::vector<DisplayMode> DistinctResolutions(const std::vector<DisplayMode>& sortedModes) {
+    std::vector<DisplayMode> resolutions;
+    for (const DisplayMode& mode : sortedModes) {
+        // Sorted input keeps every WxH together with its fastest refresh first
+        if (resolutions.empty() || resolutions.back().width != mode.width || resolutions.back().height != mode.height) {
+            resolutions.push_back(mode);
+        }
+    }
+    return resolutions;
+}
+
+std::vector<ResolutionChoice> BuildResolutionChoices(const std::vector<DisplayMode>& resolutions) {
+    if (resolutions.empty()) return DefaultResolutionChoices();
+
+    std::vector<ResolutionChoice> choices;
+    choices.reserve(1 + resolutions.size() * 2);
+    choices.push_back(DefaultResolutionChoices()[autodetectResolutionIndex]);
+    for (const DisplayMode& mode : resolutions) {
+        std::string resolution = mode.Resolution();
+        choices.push_back({ResolutionChoiceLabel(resolution, false), resolution, false});
+        choices.push_back({ResolutionChoiceLabel(resolution, true), resolution, true});
+    }
+    return choices;
+}
+
+void DisplayModeCatalog::Refresh(Callback onReady) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    onReady_ = std::move(onReady);
+    if (snapshot_ || busy_) return;
+    StartLocked();
+}
+
+void DisplayModeCatalog::Invalidate(Callback onReady) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    onReady_ = std::move(onReady);
+    snapshot_.reset();
+    ++generation_;
+    // A running worker notices the new generation and enumerates again instead of publishing
+    if (!busy_) StartLocked();
+}
+
+std::shared_ptr<const DisplayModeSnapshot> DisplayModeCatalog::Snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return snapshot_;
+}
+
+void DisplayModeCatalog::Wait() {
+    std::thread worker;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        worker = std::move(worker_);
+    }
+    if (worker.joinable()) worker.join();
+}
+
+void DisplayModeCatalog::StartLocked() {
+    // The previous worker has already published (busy_ is false), so this join doesn't wait on enumeration
+    if (worker_.joinable()) worker_.join();
+    busy_ = true;
+    worker_ = std::thread(&DisplayModeCatalog::Run, this);
+}
+
+void DisplayModeCatalog::Run() {
+    Callback onReady;
+    for (;;) {
+        unsigned generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            generation = generation_;
+        }
+
+        MISE_TRACE_SCOPE("DisplayModeCatalog::Build");
+        auto snapshot = std::make_shared<DisplayModeSnapshot>();
+        snapshot->modes = provider_->EnumerateModes();
+        SortDisplayModes(snapshot->modes);
+        snapshot->resolutions = DistinctResolutions(snapshot->modes);
+        if (!provider_->CurrentMode(snapshot->current)) snapshot->current = {};
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation == generation_) {
+            snapshot_ = std::move(snapshot);
+            busy_ = false;
+            onReady = onReady_;
+            break;
+        }
+    }
+    if (onReady) onReady();
+}
@@ -0,0 +1,120 @@
+/*
+ * DisplayModes.h
+ * Every resolution and refresh rate the attached monitors support, gathered
+ * once on a background thread and kept until Windows says the displays changed.
+ *
+ * Where the modes come from is a DisplayModeProvider: the real one walks
+ * EnumDisplayDevices/EnumDisplaySettings (or /sys/class/drm on Linux),
+ * FakeDisplayModeProvider hands back a fixed list so sorting and dedup can
+ * be benchmarked anywhere.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LauncherSettings.h"
+
+struct DisplayMode {
+    int width = 0;
+    int height = 0;
+    int refreshRate = 0;  // Hz; 0 or 1 means "hardware default"
+
+    bool operator==(const DisplayMode& other) const {
+        return width == other.width && height == other.height && refreshRate == other.refreshRate;
+    }
+    bool operator!=(const DisplayMode& other) const { return !(*this == other); }
+
+    std::string Resolution() const { return std::to_string(width) + "x" + std::to_string(height); }
+};
+
+// Source of raw (unsorted, possibly repeated) display modes
+class DisplayModeProvider {
+public:
+    virtual ~DisplayModeProvider() = default;
+
+    // Every mode of every monitor attached to the desktop, in whatever order the OS gives them
+    virtual std::vector<DisplayMode> EnumerateModes() = 0;
+
+    // The mode the primary monitor is running right now; false if it can't be read
+    virtual bool CurrentMode(DisplayMode& mode) = 0;
+};
+
+// Provider with a fixed answer, for benchmarks and machines without a display
+class FakeDisplayModeProvider : public DisplayModeProvider {
+public:
+    FakeDisplayModeProvider() = default;
+    FakeDisplayModeProvider(std::vector<DisplayMode> modes, DisplayMode current)
+        : modes_(std::move(modes)), current_(current) {}
+
+    std::vector<DisplayMode> EnumerateModes() override { ++enumerateCount_; return modes_; }
+    bool CurrentMode(DisplayMode& mode) override { mode = current_; return current_.width > 0; }
+
+    int EnumerateCount() const { return enumerateCount_; }
+
+private:
+    std::vector<DisplayMode> modes_;
+    DisplayMode current_;
+    std::atomic<int> enumerateCount_{0};
+};
+
+// The provider for this platform (Windows display APIs, the kernel's DRM connectors on Linux; an empty answer elsewhere)
+std::unique_ptr<DisplayModeProvider> CreateSystemDisplayModeProvider();
+
+// Biggest first (by pixel count, then width), fastest refresh first; exact repeats removed
+void SortDisplayModes(std::vector<DisplayMode>& modes);
+
+// One entry per WxH from an already sorted list, keeping its fastest refresh rate
+std::vector<DisplayMode> DistinctResolutions(const std::vector<DisplayMode>& sortedModes);
+
+// Combo box entries for the given resolutions: Autodetect, then a Full Screen/Windowed pair for each
+std::vector<ResolutionChoice> BuildResolutionChoices(const std::vector<DisplayMode>& resolutions);
+
+// What the catalog found, handed out as an immutable snapshot
+struct DisplayModeSnapshot {
+    std::vector<DisplayMode> modes;        // Sorted and deduplicated
+    std::vector<DisplayMode> resolutions;  // DistinctResolutions(modes)
+    DisplayMode current;                   // Primary monitor's current mode (width 0 if unknown)
+};
+
+// Builds the mode list off the UI thread and caches it until Invalidate()
+class DisplayModeCatalog {
+public:
+    using Callback = std::function<void()>;
+
+    explicit DisplayModeCatalog(std::unique_ptr<DisplayModeProvider> provider) : provider_(std::move(provider)) {}
+    ~DisplayModeCatalog() { Wait(); }
+    DisplayModeCatalog(const DisplayModeCatalog&) = delete;
+    DisplayModeCatalog& operator=(const DisplayModeCatalog&) = delete;
+
+    // Enumerate on a worker thread unless a current snapshot already exists;
+    // onReady runs on that worker once the new snapshot is published
+    void Refresh(Callback onReady);
+
+    // Forget the snapshot (display settings changed) and enumerate again
+    void Invalidate(Callback onReady);
+
+    // The latest snapshot, or null while the first enumeration is still running
+    std::shared_ptr<const DisplayModeSnapshot> Snapshot() const;
+
+    // Block until the worker is done (tests, benchmarks, shutdown)
+    void Wait();
+
+private:
+    void StartLocked();
+    void Run();
+
+    std::unique_ptr<DisplayModeProvider> provider_;
+    mutable std::mutex mutex_;
+    std::shared_ptr<const DisplayModeSnapshot> snapshot_;
+    Callback onReady_;
+    std::thread worker_;
+    bool busy_ = false;        // A worker is enumerating and hasn't published yet
+    unsigned generation_ = 0;  // Bumped by Invalidate so a stale worker can't publish
+};
@@ -0,0 +1,54 @@
+/*
+ * EditBuffer.cpp
+ * Minimal-range diff and sync for the settings text box.
+ * "I'm rubber, you're glue, only the changed bytes stick to you!"
+ */
+
+#include "EditBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+void MemoryEditBuffer::Replace(size_t start, size_t end, std::string_view text) {
+    start = std::min(start, text_.size());
+    end = std::min(std::max(end, start), text_.size());
+    text_.replace(start, end - start, text);
+    ++replaceCount_;
+    charsWritten_ += text.size();
+}
+
+TextDiff ComputeTextDiff(std::string_view before, std::string_view after) {
+    TextDiff diff;
+    const size_t limit = std::min(before.size(), after.size());
+
+    // Common prefix, compared a block at a time before narrowing down to the byte
+    size_t prefix = 0;
+    const size_t block = 64;
+    while (prefix + block <= limit && std::memcmp(before.data() + prefix, after.data() + prefix, block) == 0) {
+        prefix += block;
+    }
+    while (prefix < limit && before[prefix] == after[prefix]) ++prefix;
+
+    // Common suffix, never overlapping the prefix
+    size_t suffix = 0;
+    const size_t suffixLimit = limit - prefix;
+    while (suffix < suffixLimit && before[before.size() - 1 - suffix] == after[after.size() - 1 - suffix]) ++suffix;
+
+    diff.start = prefix;
+    diff.removed = before.size() - prefix - suffix;
+    diff.inserted = after.size() - prefix - suffix;
+    return diff;
+}
+
+bool SyncEditBuffer(EditBuffer& buffer, std::string_view before, std::string_view after) {
+    TextDiff diff = ComputeTextDiff(before, after);
+    if (diff.Empty()) return false;
+    buffer.Replace(diff.start, diff.start + diff.removed, after.substr(diff.start, diff.inserted));
+    return true;
+}
+
+bool ApplySplice(EditBuffer& buffer, const IniSplice& splice) {
+    if (!splice.changed) return false;
+    buffer.Replace(splice.offset, splice.offset + splice.removed, splice.inserted);
+    return true;
+}
@@ -0,0 +1,62 @@
+/*
+ * EditBuffer.h
+ * The settings text box, seen through a tiny interface so the launcher can
+ * patch only the bytes that changed instead of rewriting the whole control.
+ *
+ * The Win32 edit control implements this in MISELauncher.cpp; MemoryEditBuffer
+ * stands in for it anywhere there is no window (benchmarks, Linux builds).
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "IniDocument.h"
+
+class EditBuffer {
+public:
+    virtual ~EditBuffer() = default;
+
+    virtual std::string Text() const = 0;
+
+    // Replace the character range [start, end) with text, leaving everything else alone
+    virtual void Replace(size_t start, size_t end, std::string_view text) = 0;
+};
+
+// In-memory edit buffer that also counts what was written to it
+class MemoryEditBuffer : public EditBuffer {
+public:
+    MemoryEditBuffer() = default;
+    explicit MemoryEditBuffer(std::string text) : text_(std::move(text)) {}
+
+    std::string Text() const override { return text_; }
+    const std::string& View() const { return text_; }
+    void Replace(size_t start, size_t end, std::string_view text) override;
+
+    size_t ReplaceCount() const { return replaceCount_; }
+    size_t CharsWritten() const { return charsWritten_; }
+
+private:
+    std::string text_;
+    size_t replaceCount_ = 0;
+    size_t charsWritten_ = 0;
+};
+
+// The smallest single replacement that turns one text into another
+struct TextDiff {
+    size_t start = 0;     // First differing character
+    size_t removed = 0;   // Characters of the old text that go away
+    size_t inserted = 0;  // Characters of the new text that replace them (starting at start)
+
+    bool Empty() const { return removed == 0 && inserted == 0; }
+};
+
+// Common prefix and suffix are skipped; whatever remains in the middle is the diff
+TextDiff ComputeTextDiff(std::string_view before, std::string_view after);
+
+// Bring buffer from 'before' to 'after' with one replacement; false when they were equal
+bool SyncEditBuffer(EditBuffer& buffer, std::string_view before, std::string_view after);
+
+// Replay an IniDocument splice onto a buffer that held the same text before the edit
+bool ApplySplice(EditBuffer& buffer, const IniSplice& splice);
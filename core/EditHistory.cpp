@@ -0,0 +1,178 @@
+/*
+ * EditHistory.cpp
+ * "Can I take that back? No? Well, now you can."
+ */
+
+#include "EditHistory.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+
+size_t EditHistory::ChangeBytes(const TextChange& change) {
+    return sizeof(TextChange) + change.removed.size() + change.inserted.size();
+}
+
+void EditHistory::BeginStep(const char* name) {
+    if (depth_++ == 0) {
+        stepName_ = name;
+        stepOpen_ = false;
+        typingOpen_ = false;
+    }
+}
+
+void EditHistory::EndStep() {
+    if (depth_ > 0 && --depth_ == 0) stepOpen_ = false;
+}
+
+bool EditHistory::MergeTyping(TextChange& change) {
+    if (!typingOpen_ || undo_.empty() || undo_.back().changes.empty()) return false;
+    TextChange& last = undo_.back().changes.back();
+    if (last.removed.empty() && change.removed.empty() && change.start == last.start + last.inserted.size()) {
+        last.inserted += change.inserted;  // Typed the next character
+    } else if (last.inserted.empty() && change.inserted.empty() && change.start + change.removed.size() == last.start) {
+        last.removed.insert(0, change.removed);  // Backspace
+        last.start = change.start;
+    } else if (last.inserted.empty() && change.inserted.empty() && change.start == last.start) {
+        last.removed += change.removed;  // Delete
+    } else {
+        return false;
+    }
+    size_t bytes = change.removed.size() + change.inserted.size();
+    undo_.back().bytes += bytes;
+    memoryUsage_ += bytes;
+    return true;
+}
+
+void EditHistory::Record(TextChange change, bool typing) {
+    if (change.removed.empty() && change.inserted.empty()) return;
+    for (const Step& step : redo_) memoryUsage_ -= step.bytes;
+    redo_.clear();
+
+    bool endsLine = typing && change.inserted.find('\n') != std::string::npos;
+    if (depth_ > 0) {
+        if (!stepOpen_) {
+            undo_.push_back(Step{stepName_, false, {}, 0});
+            stepOpen_ = true;
+        }
+    } else if (!typing || !MergeTyping(change)) {
+        undo_.push_back(Step{typing ? "Typing" : "Edit", typing, {}, 0});
+    } else {
+        typingOpen_ = !endsLine;
+        Trim();
+        return;
+    }
+
+    size_t bytes = ChangeBytes(change);
+    Step& step = undo_.back();
+    step.changes.push_back(std::move(change));
+    step.bytes += bytes;
+    memoryUsage_ += bytes;
+    typingOpen_ = depth_ == 0 && typing && !endsLine;
+    Trim();
+}
+
+void EditHistory::Trim() {
+    // Forget the oldest steps first; a step in progress that alone is too big goes as well,
+    // and whatever it records from here on starts a new one
+    while (memoryUsage_ > memoryLimit_ && !undo_.empty()) {
+        memoryUsage_ -= undo_.front().bytes;
+        undo_.pop_front();
+        if (undo_.empty()) stepOpen_ = typingOpen_ = false;
+    }
+}
+
+bool EditHistory::Undo(EditBuffer& buffer) {
+    if (!CanUndo()) return false;
+    MISE_TRACE_SCOPE("EditHistory::Undo");
+    Step step = std::move(undo_.back());
+    undo_.pop_back();
+    for (auto change = step.changes.rbegin(); change != step.changes.rend(); ++change) {
+        buffer.Replace(change->start, change->start + change->inserted.size(), change->removed);
+    }
+    redo_.push_back(std::move(step));
+    typingOpen_ = false;
+    return true;
+}
+
+bool EditHistory::Redo(EditBuffer& buffer) {
+    if (!CanRedo()) return false;
+    MISE_TRACE_SCOPE("EditHistory::Redo");
+    Step step = std::move(redo_.back());
+    redo_.pop_back();
+    for (const TextChange& change : step.changes) {
+        buffer.Replace(change.start, change.start + change.removed.size(), change.inserted);
+    }
+    undo_.push_back(std::move(step));
+    typingOpen_ = false;
+    return true;
+}
+
+void EditHistory::Clear() {
+    undo_.clear();
+    redo_.clear();
+    memoryUsage_ = 0;
+    stepOpen_ = typingOpen_ = false;
+}
+
+void EditHistory::SetMemoryLimit(size_t memoryLimit) {
+    memoryLimit_ = memoryLimit;
+    // Redo steps are the first to go when the limit shrinks: they're the least likely to be wanted
+    while (memoryUsage_ > memoryLimit_ && !redo_.empty()) {
+        memoryUsage_ -= redo_.front().bytes;
+        redo_.erase(redo_.begin());
+    }
+    Trim();
+}
+
+EditSession::EditSession(EditBuffer* view, size_t historyLimit) : history_(historyLimit), view_(view) {}
+
+void EditSession::Replace(size_t start, size_t end, std::string_view text) {
+    start = std::min(start, text_.Size());
+    end = std::min(std::max(end, start), text_.Size());
+    TextChange change;
+    change.start = start;
+    change.removed = text_.Substr(start, end - start);
+    change.inserted = std::string(text);
+    text_.Replace(start, end, text);
+    if (view_) view_->Replace(start, end, text);
+    Changed(start, end - start, text);
+    history_.Record(std::move(change));
+}
+
+bool EditSession::ViewChanged(std::string_view viewText) {
+    TextDiff diff = text_.DiffTo(viewText);
+    if (diff.Empty()) return false;
+    TextChange change;
+    change.start = diff.start;
+    change.removed = text_.Substr(diff.start, diff.removed);
+    change.inserted = std::string(viewText.substr(diff.start, diff.inserted));
+    text_.Replace(diff.start, diff.start + diff.removed, change.inserted);
+    Changed(diff.start, diff.removed, change.inserted);
+    history_.Record(std::move(change), true);
+    return true;
+}
+
+void EditSession::Reset(std::string text) {
+    text_.Reset(std::move(text));
+    history_.Clear();
+}
+
+bool EditSession::Undo() {
+    Replay replay(*this);
+    return history_.Undo(replay);
+}
+
+bool EditSession::Redo() {
+    Replay replay(*this);
+    return history_.Redo(replay);
+}
+
+void EditSession::Replay::Replace(size_t start, size_t end, std::string_view text) {
+    size_t size = session_.text_.Size();
+    start = std::min(start, size);
+    end = std::min(std::max(end, start), size);
+    session_.text_.Replace(start, end, text);
+    if (session_.view_) session_.view_->Replace(start, end, text);
+    session_.Changed(start, end - start, text);
+}
@@ -0,0 +1,147 @@
+/*
+ * EditHistory.h
+ * Undo and redo for the settings text. Each step keeps only what it changed
+ * (where, the text that went away, the text that came in), never a copy of
+ * the document, and the whole history stays under a memory limit by
+ * forgetting its oldest steps.
+ *
+ * EditSession puts the pieces together: the launcher's PieceTable copy of the
+ * text, its history, and the view it's mirrored into (the Win32 edit box).
+ * Every change goes through the session, so every change can be undone.
+ */
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "EditBuffer.h"
+#include "PieceTable.h"
+
+// One replacement: [start, start + removed.size()) became inserted
+struct TextChange {
+    size_t start = 0;
+    std::string removed;
+    std::string inserted;
+};
+
+constexpr size_t defaultEditHistoryLimit = 4 << 20;
+
+class EditHistory {
+public:
+    explicit EditHistory(size_t memoryLimit = defaultEditHistoryLimit) : memoryLimit_(memoryLimit) {}
+
+    // Changes recorded between BeginStep and EndStep undo as one; nested steps join the outermost
+    void BeginStep(const char* name);
+    void EndStep();
+
+    // Record a change that has already been applied. Outside a step it's a step of its own,
+    // except typing, which runs on into the previous typing step until the line ends
+    void Record(TextChange change, bool typing = false);
+
+    // Apply the newest step's inverse (or the next redo) to buffer; false if there's none
+    bool Undo(EditBuffer& buffer);
+    bool Redo(EditBuffer& buffer);
+
+    bool CanUndo() const { return depth_ == 0 && !undo_.empty(); }
+    bool CanRedo() const { return depth_ == 0 && !redo_.empty(); }
+    const char* UndoName() const { return undo_.empty() ? nullptr : undo_.back().name; }
+    const char* RedoName() const { return redo_.empty() ? nullptr : redo_.back().name; }
+    size_t UndoCount() const { return undo_.size(); }
+    size_t RedoCount() const { return redo_.size(); }
+
+    void Clear();
+
+    // Bytes the recorded changes take; kept at or under the limit
+    size_t MemoryUsage() const { return memoryUsage_; }
+    size_t MemoryLimit() const { return memoryLimit_; }
+    void SetMemoryLimit(size_t memoryLimit);
+
+private:
+    struct Step {
+        const char* name = nullptr;
+        bool typing = false;
+        std::vector<TextChange> changes;
+        size_t bytes = 0;
+    };
+
+    static size_t ChangeBytes(const TextChange& change);
+    bool MergeTyping(TextChange& change);
+    void Trim();
+
+    std::deque<Step> undo_;
+    std::vector<Step> redo_;
+    size_t memoryUsage_ = 0;
+    size_t memoryLimit_;
+    int depth_ = 0;
+    const char* stepName_ = nullptr;
+    bool stepOpen_ = false;    // undo_.back() belongs to the step in progress
+    bool typingOpen_ = false;  // undo_.back() is typing that more typing may join
+};
+
+class EditSession : public EditBuffer {
+public:
+    // view mirrors the text (may be null); it must hold the same text as the session
+    explicit EditSession(EditBuffer* view = nullptr, size_t historyLimit = defaultEditHistoryLimit);
+
+    std::string Text() const override { return text_.Text(); }
+
+    // Apply a change to the text and the view, recording it
+    void Replace(size_t start, size_t end, std::string_view text) override;
+
+    // The view changed on its own (the user typed): record the difference as typing.
+    // False if viewText is what the session already holds
+    bool ViewChanged(std::string_view viewText);
+
+    // Take text as the new starting point: no history, view and listener untouched
+    void Reset(std::string text);
+
+    // Called after every change to the text, however it was made (an edit, typing, undo or redo)
+    using Listener = std::function<void(size_t start, size_t removed, std::string_view inserted)>;
+    void SetListener(Listener listener) { listener_ = std::move(listener); }
+
+    bool Undo();
+    bool Redo();
+
+    void BeginStep(const char* name) { history_.BeginStep(name); }
+    void EndStep() { history_.EndStep(); }
+
+    const PieceTable& Document() const { return text_; }
+    EditHistory& History() { return history_; }
+    const EditHistory& History() const { return history_; }
+
+private:
+    // Applies history replays to the text and view without recording them again
+    class Replay : public EditBuffer {
+    public:
+        explicit Replay(EditSession& session) : session_(session) {}
+        std::string Text() const override { return session_.Text(); }
+        void Replace(size_t start, size_t end, std::string_view text) override;
+    private:
+        EditSession& session_;
+    };
+
+    void Changed(size_t start, size_t removed, std::string_view inserted) {
+        if (listener_) listener_(start, removed, inserted);
+    }
+
+    PieceTable text_;
+    EditHistory history_;
+    EditBuffer* view_;
+    Listener listener_;
+};
+
+// Everything recorded while this is alive is one undo step
+class EditStep {
+public:
+    EditStep(EditSession& session, const char* name) : session_(session) { session_.BeginStep(name); }
+    ~EditStep() { session_.EndStep(); }
+    EditStep(const EditStep&) = delete;
+    EditStep& operator=(const EditStep&) = delete;
+
+private:
+    EditSession& session_;
+};
@@ -0,0 +1,212 @@
+/*
+ * FileWatcher.cpp
+ * "Look behind you, a three-headed file watcher!"
+ */
+
+#include "FileWatcher.h"
+
+#include <chrono>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void SplitPath(const std::string& path, std::string& directory, std::string& fileName) {
+    size_t slash = path.find_last_of("\\/");
+    directory = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    fileName = slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Milliseconds until the debounce deadline, never negative
+long long RemainingMs(Clock::time_point deadline) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    return left > 0 ? left : 0;
+}
+
+} // namespace
+
+#ifdef _WIN32
+
+bool FileWatcher::Start(const std::string& filePath, unsigned debounceMs, Callback onChange, std::string& error) {
+    Stop();
+    SplitPath(filePath, directory_, fileName_);
+    debounceMs_ = debounceMs;
+    onChange_ = std::move(onChange);
+
+    HANDLE dir = CreateFileA(directory_.c_str(), FILE_LIST_DIRECTORY,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                             FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (dir == INVALID_HANDLE_VALUE) {
+        error = "Could not watch " + directory_ + " (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    directoryHandle_ = dir;
+    stopEvent_ = CreateEventA(NULL, TRUE, FALSE, NULL);
+    stopping_ = false;
+    thread_ = std::thread(&FileWatcher::Run, this);
+    return true;
+}
+
+void FileWatcher::Stop() {
+    if (thread_.joinable()) {
+        stopping_ = true;
+        SetEvent(stopEvent_);
+        thread_.join();
+    }
+    if (directoryHandle_) CloseHandle(directoryHandle_);
+    if (stopEvent_) CloseHandle(stopEvent_);
+    directoryHandle_ = nullptr;
+    stopEvent_ = nullptr;
+}
+
+void FileWatcher::Run() {
+    // File names come back as UTF-16; settings.ini is plain ASCII so widening byte by byte is enough
+    std::wstring wantedName(fileName_.begin(), fileName_.end());
+
+    alignas(DWORD) char buffer[16 * 1024];
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    HANDLE handles[2] = {overlapped.hEvent, stopEvent_};
+
+    bool readPending = false;
+    bool changePending = false;
+    Clock::time_point deadline;
+
+    while (!stopping_) {
+        if (!readPending) {
+            ResetEvent(overlapped.hEvent);
+            readPending = ReadDirectoryChangesW(directoryHandle_, buffer, sizeof(buffer), FALSE,
+                                                FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE,
+                                                NULL, &overlapped, NULL) != 0;
+            if (!readPending) break; // The directory went away; nothing left to watch
+        }
+
+        DWORD timeout = changePending ? static_cast<DWORD>(RemainingMs(deadline)) : INFINITE;
+        DWORD woke = WaitForMultipleObjects(2, handles, FALSE, timeout);
+        if (woke == WAIT_OBJECT_0 + 1) break;
+
+        if (woke == WAIT_TIMEOUT) {
+            changePending = false;
+            onChange_();
+            continue;
+        }
+
+        DWORD bytes = 0;
+        readPending = false;
+        if (!GetOverlappedResult(directoryHandle_, &overlapped, &bytes, FALSE)) continue;
+
+        // bytes == 0 means the buffer overflowed; assume our file was part of it
+        bool ours = bytes == 0;
+        for (DWORD offset = 0; !ours && offset < bytes;) {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+            std::wstring name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            ours = _wcsicmp(name.c_str(), wantedName.c_str()) == 0;
+            if (info->NextEntryOffset == 0) break;
+            offset += info->NextEntryOffset;
+        }
+        if (ours) {
+            changePending = true;
+            deadline = Clock::now() + std::chrono::milliseconds(debounceMs_);
+        }
+    }
+
+    if (readPending) {
+        CancelIoEx(directoryHandle_, &overlapped);
+        DWORD bytes = 0;
+        GetOverlappedResult(directoryHandle_, &overlapped, &bytes, TRUE);
+    }
+    CloseHandle(overlapped.hEvent);
+}
+
+#else
+
+bool FileWatcher::Start(const std::string& filePath, unsigned debounceMs, Callback onChange, std::string& error) {
+    Stop();
+    SplitPath(filePath, directory_, fileName_);
+    debounceMs_ = debounceMs;
+    onChange_ = std::move(onChange);
+
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0 || pipe(stopPipe_) != 0) {
+        error = std::string("Could not start watching (") + std::strerror(errno) + ")";
+        Stop();
+        return false;
+    }
+    // Atomic saves show up as IN_MOVED_TO, in-place writes as IN_CLOSE_WRITE
+    if (inotify_add_watch(inotifyFd_, directory_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0) {
+        error = "Could not watch " + directory_ + " (" + std::strerror(errno) + ")";
+        Stop();
+        return false;
+    }
+    stopping_ = false;
+    thread_ = std::thread(&FileWatcher::Run, this);
+    return true;
+}
+
+void FileWatcher::Stop() {
+    if (thread_.joinable()) {
+        stopping_ = true;
+        char wake = 1;
+        ssize_t ignored = write(stopPipe_[1], &wake, 1);
+        (void)ignored;
+        thread_.join();
+    }
+    if (inotifyFd_ >= 0) close(inotifyFd_);
+    for (int& fd : stopPipe_) {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+    inotifyFd_ = -1;
+}
+
+void FileWatcher::Run() {
+    alignas(inotify_event) char buffer[16 * 1024];
+    bool changePending = false;
+    Clock::time_point deadline;
+
+    while (!stopping_) {
+        pollfd fds[2] = {{inotifyFd_, POLLIN, 0}, {stopPipe_[0], POLLIN, 0}};
+        int timeout = changePending ? static_cast<int>(RemainingMs(deadline)) : -1;
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) break;
+
+        if (ready == 0) {
+            changePending = false;
+            onChange_();
+            continue;
+        }
+
+        ssize_t length;
+        while ((length = read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                bool overflow = (event->mask & IN_Q_OVERFLOW) != 0;
+                if (overflow || (event->len > 0 && fileName_ == event->name)) {
+                    changePending = true;
+                    deadline = Clock::now() + std::chrono::milliseconds(debounceMs_);
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+}
+
+#endif
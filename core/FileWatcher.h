@@ -0,0 +1,50 @@
+/*
+ * FileWatcher.h
+ * Event-driven watch on a single file (settings.ini), with debouncing so a
+ * burst of writes from the game turns into one notification.
+ *
+ * Backends: ReadDirectoryChangesW on Windows, inotify on Linux. Neither
+ * polls; the worker thread sleeps until the OS says the directory changed.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+class FileWatcher {
+public:
+    using Callback = std::function<void()>;
+
+    FileWatcher() = default;
+    ~FileWatcher() { Stop(); }
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Watch filePath; onChange runs on the watcher thread once writes have been quiet for debounceMs
+    bool Start(const std::string& filePath, unsigned debounceMs, Callback onChange, std::string& error);
+
+    // Stop watching and join the worker thread; safe to call twice
+    void Stop();
+
+    bool IsRunning() const { return thread_.joinable(); }
+
+private:
+    void Run();
+
+    std::string directory_;
+    std::string fileName_;
+    unsigned debounceMs_ = 0;
+    Callback onChange_;
+    std::thread thread_;
+    std::atomic<bool> stopping_{false};
+#ifdef _WIN32
+    void* directoryHandle_ = nullptr;
+    void* stopEvent_ = nullptr;
+#else
+    int inotifyFd_ = -1;
+    int stopPipe_[2] = {-1, -1};
+#endif
+};
@@ -0,0 +1,278 @@
+/*
+ * FleetApply.cpp
+ * "A whole fleet of settings.ini files, and every one of them flying our colors."
+ */
+
+#include "FleetApply.h"
+
+#include "IniDocument.h"
+#include "TextFile.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr unsigned maxDefaultJobs = 8;
+
+#ifdef _WIN32
+const char* const pathSeparators = "\\/";
+#else
+const char* const pathSeparators = "/";
+#endif
+
+bool SameChar(char a, char b) {
+#ifdef _WIN32
+    // Windows file names don't care about case, so neither do its patterns
+    if (a >= 'A' && a <= 'Z') a = static_cast<char>(a - 'A' + 'a');
+    if (b >= 'A' && b <= 'Z') b = static_cast<char>(b - 'A' + 'a');
+#endif
+    return a == b;
+}
+
+// * and ? within one name
+bool MatchName(std::string_view pattern, std::string_view name) {
+    size_t p = 0, n = 0, starP = std::string_view::npos, starN = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || SameChar(pattern[p], name[n]))) {
+            ++p;
+            ++n;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starP = p++;
+            starN = n;
+        } else if (starP != std::string_view::npos) {
+            p = starP + 1;
+            n = ++starN;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+bool HasWildcard(std::string_view text) {
+    return text.find_first_of("*?") != std::string_view::npos;
+}
+
+void WalkGlob(const fs::path& at, const std::vector<std::string>& parts, size_t index,
+              const std::function<void(const std::string&)>& found) {
+    std::error_code ec;
+    if (index == parts.size()) {
+        if (fs::is_regular_file(at, ec)) found(at.string());
+        return;
+    }
+    const std::string& part = parts[index];
+    if (!HasWildcard(part)) {
+        WalkGlob(at / part, parts, index + 1, found);
+        return;
+    }
+    if (!fs::is_directory(at, ec)) return;
+    if (part == "**") {
+        WalkGlob(at, parts, index + 1, found);  // No folders at all
+        for (fs::directory_iterator it(at, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+            std::error_code entryError;
+            if (it->is_directory(entryError) && !it->is_symlink(entryError)) WalkGlob(it->path(), parts, index, found);
+        }
+        return;
+    }
+    for (fs::directory_iterator it(at, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec)) {
+        if (MatchName(part, it->path().filename().string())) WalkGlob(it->path(), parts, index + 1, found);
+    }
+}
+
+void AppendJsonString(std::string& out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+// Paths on their way from the producer to the workers; the producer waits while it's full
+class PathQueue {
+public:
+    explicit PathQueue(size_t capacity) : capacity_(capacity) {}
+
+    void Push(std::string path) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return paths_.size() < capacity_; });
+        paths_.push_back(std::move(path));
+        notEmpty_.notify_one();
+    }
+
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+    }
+
+    // False once the queue is closed and empty
+    bool Pop(std::string& path) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !paths_.empty() || closed_; });
+        if (paths_.empty()) return false;
+        path = std::move(paths_.front());
+        paths_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable notFull_, notEmpty_;
+    std::deque<std::string> paths_;
+    size_t capacity_;
+    bool closed_ = false;
+};
+
+} // namespace
+
+bool LoadFleetTemplate(const std::string& path, std::vector<SettingOverride>& overrides, std::string& error) {
+    std::string content;
+    if (!ReadTextFile(path, content)) {
+        error = "Could not open the template " + path;
+        return false;
+    }
+    IniDocument doc(std::move(content));
+    overrides.clear();
+    for (const IniEntry& entry : doc.Entries()) {
+        const IniSection& section = doc.Sections()[entry.section];
+        if (section.name.empty()) {
+            error = std::string(doc.Key(entry)) + " in the template is outside any [section]";
+            return false;
+        }
+        overrides.push_back({section.name, std::string(doc.Key(entry)), std::string(doc.Value(entry))});
+    }
+    if (overrides.empty()) {
+        error = "The template " + path + " has no settings in it";
+        return false;
+    }
+    return true;
+}
+
+FleetOutcome ApplyTemplateToFile(const std::string& path, const std::vector<SettingOverride>& overrides, std::string& error) {
+    MISE_TRACE_SCOPE("ApplyTemplateToFile");
+    std::string content;
+    if (!ReadTextFile(path, content)) {
+        error = "Could not open the file";
+        return FleetOutcome::Failed;
+    }
+    IniDocument doc(std::move(content));
+    bool changed = false;
+    for (const SettingOverride& setting : overrides) changed |= doc.Set(setting.section, setting.key, setting.value).changed;
+    if (!changed) return FleetOutcome::Unchanged;
+
+    SaveResult saved = SaveSettingsFile(path, doc.Text());
+    if (saved.status == SaveStatus::Failed) {
+        error = saved.error;
+        return FleetOutcome::Failed;
+    }
+    return saved.status == SaveStatus::Written ? FleetOutcome::Changed : FleetOutcome::Unchanged;
+}
+
+void ExpandGlob(const std::string& pattern, const std::function<void(const std::string& path)>& found) {
+    // The folders before the first wildcard are where the walk starts
+    size_t wildcard = pattern.find_first_of("*?");
+    if (wildcard == std::string::npos) {
+        std::error_code ec;
+        if (fs::is_regular_file(pattern, ec)) found(pattern);
+        return;
+    }
+    size_t rootEnd = pattern.find_last_of(pathSeparators, wildcard);
+    std::string root = rootEnd == std::string::npos ? "." : pattern.substr(0, rootEnd + 1);
+    std::vector<std::string> parts;
+    size_t start = rootEnd == std::string::npos ? 0 : rootEnd + 1;
+    while (start <= pattern.size()) {
+        size_t end = pattern.find_first_of(pathSeparators, start);
+        if (end == std::string::npos) end = pattern.size();
+        if (end > start) parts.push_back(pattern.substr(start, end - start));
+        start = end + 1;
+    }
+    WalkGlob(fs::path(root), parts, 0, found);
+}
+
+FleetSummary ApplyFleet(const std::vector<SettingOverride>& overrides, const FleetTargets& targets, unsigned jobs,
+                        const FleetReport& report) {
+    MISE_TRACE_SCOPE("ApplyFleet");
+    if (jobs == 0) jobs = std::min(maxDefaultJobs, std::max(1u, std::thread::hardware_concurrency()));
+    PathQueue queue(jobs * 4);
+    std::mutex reportMutex;
+    FleetSummary summary;
+    auto finish = [&](FleetFileResult result) {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        switch (result.outcome) {
+            case FleetOutcome::Changed: ++summary.changed; break;
+            case FleetOutcome::Unchanged: ++summary.unchanged; break;
+            case FleetOutcome::Failed: ++summary.failed; break;
+        }
+        if (report) report(result);
+    };
+
+    std::thread producer([&] {
+        MISE_TRACE_SCOPE("FleetTargets");
+        for (const std::string& listFile : targets.listFiles) {
+            std::ifstream list(listFile);
+            if (!list) {
+                finish({listFile, FleetOutcome::Failed, "Could not open the target list"});
+                continue;
+            }
+            for (std::string line; std::getline(list, line);) {
+                std::string_view path = Trim(line);
+                if (!path.empty() && path[0] != '#') queue.Push(std::string(path));
+            }
+        }
+        for (const std::string& glob : targets.globs) {
+            ExpandGlob(glob, [&queue](const std::string& path) { queue.Push(path); });
+        }
+        queue.Close();
+    });
+
+    std::vector<std::thread> workers;
+    for (unsigned worker = 0; worker < jobs; ++worker) {
+        workers.emplace_back([&] {
+            for (std::string path; queue.Pop(path);) {
+                FleetFileResult result;
+                result.outcome = ApplyTemplateToFile(path, overrides, result.error);
+                result.path = std::move(path);
+                finish(std::move(result));
+            }
+        });
+    }
+    producer.join();
+    for (std::thread& worker : workers) worker.join();
+    return summary;
+}
+
+std::string FleetResultJson(const FleetFileResult& result) {
+    static const char* const outcomeNames[] = {"changed", "unchanged", "failed"};
+    std::string json = "{\"path\":";
+    AppendJsonString(json, result.path);
+    json += ",\"result\":\"";
+    json += outcomeNames[static_cast<int>(result.outcome)];
+    json += '"';
+    if (!result.error.empty()) {
+        json += ",\"error\":";
+        AppendJsonString(json, result.error);
+    }
+    json += '}';
+    return json;
+}
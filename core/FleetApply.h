@@ -0,0 +1,70 @@
+/*
+ * FleetApply.h
+ * Fleet mode: apply one template of settings to many settings.ini files,
+ * e.g. every user profile on a machine or every machine on a share.
+ *
+ *   MISELauncher --fleet standard.ini --glob "C:\Users\*\AppData\Roaming\LucasArts\*\settings.ini"
+ *   MISELauncher --fleet standard.ini --targets machines.txt --jobs 4
+ *
+ * Each file goes through the same read -> IniDocument -> SaveSettingsFile
+ * path as the GUI and the single-file CLI, so untouched keys, comments and
+ * line order survive and identical content is never rewritten. Targets are
+ * streamed: a producer thread expands the globs and reads the lists into a
+ * small bounded queue that a fixed number of workers drain, so thousands of
+ * files never sit in memory at once. Every file is reported as it finishes.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+struct SettingOverride {
+    std::string section;
+    std::string key;
+    std::string value;
+};
+
+// Read the template: an ini file whose every key=value is an override
+bool LoadFleetTemplate(const std::string& path, std::vector<SettingOverride>& overrides, std::string& error);
+
+enum class FleetOutcome {
+    Changed,    // Written
+    Unchanged,  // Already had every value
+    Failed      // Left as it was; FleetFileResult::error says why
+};
+
+struct FleetFileResult {
+    std::string path;
+    FleetOutcome outcome = FleetOutcome::Failed;
+    std::string error;
+};
+
+// Where the targets come from; all of them are used
+struct FleetTargets {
+    std::vector<std::string> listFiles;  // Text files with one settings.ini path per line (# comments)
+    std::vector<std::string> globs;      // Patterns with * and ? in a name and ** for any depth of folders
+};
+
+struct FleetSummary {
+    size_t changed = 0;
+    size_t unchanged = 0;
+    size_t failed = 0;
+};
+
+// Called once per file, from the worker that did it, never two at a time
+using FleetReport = std::function<void(const FleetFileResult& result)>;
+
+// Apply overrides to one file
+FleetOutcome ApplyTemplateToFile(const std::string& path, const std::vector<SettingOverride>& overrides, std::string& error);
+
+// Apply overrides to every target on 'jobs' worker threads (0 = one per hardware thread, at most 8)
+FleetSummary ApplyFleet(const std::vector<SettingOverride>& overrides, const FleetTargets& targets, unsigned jobs,
+                        const FleetReport& report);
+
+// Every existing file matching pattern, handed to found as it's discovered
+void ExpandGlob(const std::string& pattern, const std::function<void(const std::string& path)>& found);
+
+// {"path":"...","result":"changed|unchanged|failed"}, plus "error" when it failed; one line of JSON
+std::string FleetResultJson(const FleetFileResult& result);
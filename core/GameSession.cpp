@@ -0,0 +1,404 @@
+/*
+ * GameSession.cpp
+ * "I'll be watching you, Guybrush. Every single CPU tick of you."
+ */
+
+#include "GameSession.h"
+
+#include "TextFile.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define PSAPI_VERSION 2  // GetProcessMemoryInfo from kernel32, no psapi.lib needed
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#elif defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t MillisecondsSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+uint64_t FileTimeValue(const FILETIME& time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+
+class Win32ProcessMonitor : public ProcessMonitor {
+public:
+    ~Win32ProcessMonitor() override { CloseProcess(); }
+
+    uint32_t FindProcess(const std::string& exeName) override {
+        HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+        if (snapshot == INVALID_HANDLE_VALUE) return 0;
+        uint32_t found = 0;
+        PROCESSENTRY32 entry = {};
+        entry.dwSize = sizeof(entry);
+        for (BOOL more = Process32First(snapshot, &entry); more && !found; more = Process32Next(snapshot, &entry)) {
+            if (EqualsIgnoreCase(entry.szExeFile, exeName)) found = entry.th32ProcessID;
+        }
+        CloseHandle(snapshot);
+        return found;
+    }
+
+    bool Sample(uint32_t pid, ProcessSample& sample) override {
+        // One handle for the whole session; it also keeps the pid from being reused under us
+        if (pid != pid_) {
+            CloseProcess();
+            process_ = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+            if (!process_) return false;
+            pid_ = pid;
+        }
+        DWORD exitCode = 0;
+        if (!GetExitCodeProcess(process_, &exitCode) || exitCode != STILL_ACTIVE) return false;
+
+        FILETIME created, exited, kernel, user;
+        if (GetProcessTimes(process_, &created, &exited, &kernel, &user)) {
+            sample.cpuTimeUs = (FileTimeValue(kernel) + FileTimeValue(user)) / 10;
+        }
+        PROCESS_MEMORY_COUNTERS memory = {};
+        if (GetProcessMemoryInfo(process_, &memory, sizeof(memory))) sample.workingSetBytes = memory.WorkingSetSize;
+        IO_COUNTERS io = {};
+        if (GetProcessIoCounters(process_, &io)) {
+            sample.readBytes = io.ReadTransferCount;
+            sample.writeBytes = io.WriteTransferCount;
+        }
+        return true;
+    }
+
+private:
+    void CloseProcess() {
+        if (process_) CloseHandle(process_);
+        process_ = NULL;
+        pid_ = 0;
+    }
+
+    HANDLE process_ = NULL;
+    uint32_t pid_ = 0;
+};
+
+#elif defined(__linux__)
+
+// Small /proc files in one read, without streams; false if the process (or the file) is gone
+bool ReadProcFile(const char* path, char* buffer, size_t size, size_t& length) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    ssize_t read = ::read(fd, buffer, size - 1);
+    close(fd);
+    if (read < 0) return false;
+    length = static_cast<size_t>(read);
+    buffer[length] = '\0';
+    return true;
+}
+
+class ProcProcessMonitor : public ProcessMonitor {
+public:
+    ProcProcessMonitor() : ticksPerSecond_(sysconf(_SC_CLK_TCK)), pageSize_(sysconf(_SC_PAGESIZE)) {}
+
+    uint32_t FindProcess(const std::string& exeName) override {
+        DIR* proc = opendir("/proc");
+        if (!proc) return 0;
+        uint32_t found = 0;
+        char path[64], cmdline[512];
+        while (dirent* entry = readdir(proc)) {
+            char* end = nullptr;
+            unsigned long pid = std::strtoul(entry->d_name, &end, 10);
+            if (pid == 0 || *end != '\0') continue;
+            // argv[0], which under Wine/Proton is the Windows path of the game's .exe
+            std::snprintf(path, sizeof(path), "/proc/%lu/cmdline", pid);
+            size_t length = 0;
+            if (!ReadProcFile(path, cmdline, sizeof(cmdline), length) || length == 0) continue;
+            std::string_view program(cmdline);
+            size_t slash = program.find_last_of("\\/");
+            if (slash != std::string_view::npos) program.remove_prefix(slash + 1);
+            if (EqualsIgnoreCase(program, exeName)) {
+                found = static_cast<uint32_t>(pid);
+                break;
+            }
+        }
+        closedir(proc);
+        return found;
+    }
+
+    bool Sample(uint32_t pid, ProcessSample& sample) override {
+        char path[64], text[2048];
+        size_t length = 0;
+        std::snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+        if (!ReadProcFile(path, text, sizeof(text), length)) return false;
+        // The name in parentheses may hold spaces or parentheses itself; the fields start after the last ')'
+        char* fields = std::strrchr(text, ')');
+        if (!fields) return false;
+        char state = 0;
+        unsigned long long utime = 0, stime = 0;
+        long long rss = 0;
+        // state ppid pgrp session tty tpgid flags minflt cminflt majflt cmajflt utime stime
+        // cutime cstime priority nice threads itrealvalue starttime vsize rss
+        if (std::sscanf(fields + 1, " %c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %*d %*d %*u %*u %lld",
+                        &state, &utime, &stime, &rss) != 4) {
+            return false;
+        }
+        if (state == 'Z' || state == 'X') return false;  // Exited; only the parent hasn't collected it yet
+        sample.cpuTimeUs = (utime + stime) * 1000000ull / static_cast<unsigned long long>(ticksPerSecond_);
+        sample.workingSetBytes = static_cast<uint64_t>(rss) * static_cast<uint64_t>(pageSize_);
+
+        // Every read and write call, cached or not, like Windows' transfer counts; unreadable for other users' processes
+        std::snprintf(path, sizeof(path), "/proc/%u/io", pid);
+        if (ReadProcFile(path, text, sizeof(text), length)) {
+            unsigned long long rchar = 0, wchar = 0;
+            if (std::sscanf(text, "rchar: %llu wchar: %llu", &rchar, &wchar) == 2) {
+                sample.readBytes = rchar;
+                sample.writeBytes = wchar;
+            }
+        }
+        return true;
+    }
+
+private:
+    const long ticksPerSecond_;
+    const long pageSize_;
+};
+
+#else
+
+class NullProcessMonitor : public ProcessMonitor {
+public:
+    uint32_t FindProcess(const std::string&) override { return 0; }
+    bool Sample(uint32_t, ProcessSample&) override { return false; }
+};
+
+#endif
+
+std::string FormatDuration(int64_t ms) {
+    int64_t seconds = ms / 1000;
+    char text[32];
+    if (seconds >= 3600) {
+        std::snprintf(text, sizeof(text), "%lldh %02lldm %02llds", static_cast<long long>(seconds / 3600),
+                      static_cast<long long>(seconds / 60 % 60), static_cast<long long>(seconds % 60));
+    } else {
+        std::snprintf(text, sizeof(text), "%lldm %02llds", static_cast<long long>(seconds / 60), static_cast<long long>(seconds % 60));
+    }
+    return text;
+}
+
+std::string LocalTimeNow() {
+    std::time_t now = std::time(nullptr);
+    std::tm parts = {};
+#ifdef _WIN32
+    localtime_s(&parts, &now);
+#else
+    localtime_r(&now, &parts);
+#endif
+    char text[32];
+    return std::string(text, std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &parts));
+}
+
+} // namespace
+
+std::unique_ptr<ProcessMonitor> CreateSystemProcessMonitor() {
+#ifdef _WIN32
+    return std::make_unique<Win32ProcessMonitor>();
+#elif defined(__linux__)
+    return std::make_unique<ProcProcessMonitor>();
+#else
+    return std::make_unique<NullProcessMonitor>();
+#endif
+}
+
+void SampleRing::Push(const ProcessSample& sample) {
+    samples_[next_] = sample;
+    next_ = (next_ + 1) % samples_.size();
+    if (count_ < samples_.size()) ++count_;
+}
+
+std::vector<ProcessSample> SampleRing::Samples() const {
+    std::vector<ProcessSample> samples;
+    samples.reserve(count_);
+    for (size_t i = 0; i < count_; ++i) samples.push_back((*this)[i]);
+    return samples;
+}
+
+std::string SessionSummaryText(const SessionSummary& summary) {
+    std::string text = LocalTimeNow() + "  ";
+    if (!summary.found) return text + "The game was not seen running after launch.\n";
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "Game (pid %u) played for %s%s\n", summary.pid, FormatDuration(summary.durationMs).c_str(),
+                  summary.complete ? "" : " (the launcher closed before the game did)");
+    text += line;
+    std::snprintf(line, sizeof(line), "  CPU %.1f%% average, %.1f%% peak; %s peak working set; %s read, %s written; %zu samples\n",
+                  summary.averageCpuPercent, summary.peakCpuPercent, FormatBytes(summary.peakWorkingSetBytes).c_str(),
+                  FormatBytes(summary.readBytes).c_str(), FormatBytes(summary.writeBytes).c_str(), summary.samples);
+    text += line;
+    if (!summary.settingsChanges.empty()) {
+        size_t count = summary.settingsChanges.size();
+        text += "  settings.ini: " + std::to_string(count) + (count == 1 ? " key" : " keys") + " changed during the session";
+        if (summary.settingsRestored) {
+            text += ", restored";
+        } else if (!summary.error.empty()) {
+            text += ", not restored: " + summary.error;
+        }
+        text += "\n";
+        for (const IniKeyChange& change : summary.settingsChanges) {
+            text += "    " + change.section + "." + change.key + ": ";
+            if (change.kind == IniKeyChange::Added) {
+                text += "added " + change.newValue;
+            } else if (change.kind == IniKeyChange::Removed) {
+                text += "removed (was " + change.oldValue + ")";
+            } else {
+                text += change.oldValue + " -> " + change.newValue;
+            }
+            text += "\n";
+        }
+    }
+    return text;
+}
+
+std::string SessionLogPath(const std::string& iniPath) {
+    size_t slash = iniPath.find_last_of("\\/");
+    return (slash == std::string::npos ? std::string() : iniPath.substr(0, slash + 1)) + "sessions.log";
+}
+
+bool AppendSessionLog(const std::string& iniPath, const SessionSummary& summary, std::string& error) {
+    std::string path = SessionLogPath(iniPath);
+    std::FILE* file = std::fopen(path.c_str(), "ab");
+    if (!file) {
+        error = "Could not open " + path;
+        return false;
+    }
+    std::string text = SessionSummaryText(summary);
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    written = std::fclose(file) == 0 && written;
+    if (!written) error = "Could not write " + path;
+    return written;
+}
+
+bool GameSupervisor::Start(const SessionOptions& options, Callback onEnd) {
+    std::string baseline;
+    if (!options.iniPath.empty()) ReadTextFile(options.iniPath, baseline);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return false;
+    if (worker_.joinable()) worker_.join();  // The last session's thread, already past its last use of the lock
+    running_ = true;
+    stopping_ = false;
+    ring_ = SampleRing(options.ringCapacity);
+    worker_ = std::thread(&GameSupervisor::Run, this, options, std::move(baseline), std::move(onEnd));
+    return true;
+}
+
+void GameSupervisor::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+bool GameSupervisor::IsRunning() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+std::vector<ProcessSample> GameSupervisor::Samples() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ring_.Samples();
+}
+
+bool GameSupervisor::WaitFor(unsigned ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return !wake_.wait_for(lock, std::chrono::milliseconds(ms), [this] { return stopping_; });
+}
+
+void GameSupervisor::Run(SessionOptions options, std::string baseline, Callback onEnd) {
+    MISE_TRACE_SCOPE("GameSupervisor::Run");
+    SessionSummary summary;
+    Clock::time_point launched = Clock::now();
+
+    // Steam may take a while (updates, cloud sync) before the game's process exists
+    uint32_t pid = 0;
+    while (!(pid = monitor_->FindProcess(options.exeName))) {
+        if (MillisecondsSince(launched) >= options.findTimeoutMs || !WaitFor(std::min(options.intervalMs, 500u))) break;
+    }
+
+    if (pid) {
+        summary.found = true;
+        summary.pid = pid;
+        Clock::time_point found = Clock::now();
+        ProcessSample sample, previous;
+        bool stopped = false;
+        while (monitor_->Sample(pid, sample)) {
+            sample.elapsedMs = MillisecondsSince(found);
+            if (summary.samples > 0 && sample.elapsedMs > previous.elapsedMs) {
+                double percent = (sample.cpuTimeUs - previous.cpuTimeUs) / 10.0 / static_cast<double>(sample.elapsedMs - previous.elapsedMs);
+                summary.peakCpuPercent = std::max(summary.peakCpuPercent, percent);
+            }
+            summary.peakWorkingSetBytes = std::max(summary.peakWorkingSetBytes, sample.workingSetBytes);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ring_.Push(sample);
+            }
+            ++summary.samples;
+            previous = sample;
+            if (!WaitFor(options.intervalMs)) {
+                stopped = true;
+                break;
+            }
+        }
+        summary.complete = !stopped;
+        summary.durationMs = MillisecondsSince(found);
+        summary.cpuTimeUs = previous.cpuTimeUs;
+        summary.readBytes = previous.readBytes;
+        summary.writeBytes = previous.writeBytes;
+        if (summary.durationMs > 0) summary.averageCpuPercent = summary.cpuTimeUs / 10.0 / static_cast<double>(summary.durationMs);
+    }
+
+    // Only once the game is gone: it writes settings.ini on exit, and might again after a restore
+    if (summary.complete && !options.iniPath.empty()) {
+        std::string current;
+        if (ReadTextFile(options.iniPath, current) && current != baseline) {
+            IniDocument before, after;
+            before.Parse(baseline);
+            after.Parse(std::move(current));
+            summary.settingsChanges = DiffIniDocuments(before, after);
+            if (options.restoreSettings && !summary.settingsChanges.empty()) {
+                SaveResult saved = SaveSettingsFile(options.iniPath, baseline);
+                summary.settingsRestored = saved.status != SaveStatus::Failed;
+                summary.error = saved.error;
+            }
+        }
+    }
+
+    if (onEnd) onEnd(summary);
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+}
@@ -0,0 +1,143 @@
+/*
+ * GameSession.h
+ * What happens after Launch: the supervisor finds the game's process once
+ * Steam has started it, samples its CPU time, working set and I/O every
+ * few seconds into a fixed-size ring, and when the game exits writes a
+ * session summary. It can also put settings.ini back the way the launcher
+ * left it if the game (or the player, in the game's menus) changed it.
+ *
+ * Where the numbers come from is a ProcessMonitor: Toolhelp and the process
+ * APIs on Windows, /proc on Linux (which is also where the game runs under
+ * Proton), so the supervisor can be run against any stand-in process.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IniDiff.h"
+
+// One reading of a process's counters; the counters are totals since the process started
+struct ProcessSample {
+    int64_t elapsedMs = 0;         // Since the supervisor found the process
+    uint64_t cpuTimeUs = 0;        // User plus kernel time
+    uint64_t workingSetBytes = 0;  // Resident memory right now
+    uint64_t readBytes = 0;
+    uint64_t writeBytes = 0;
+};
+
+// Source of process information
+class ProcessMonitor {
+public:
+    virtual ~ProcessMonitor() = default;
+
+    // Id of a running process whose executable is exeName (case doesn't matter), 0 if there is none
+    virtual uint32_t FindProcess(const std::string& exeName) = 0;
+
+    // Read pid's counters into sample (all but elapsedMs); false once the process has exited
+    virtual bool Sample(uint32_t pid, ProcessSample& sample) = 0;
+};
+
+// The monitor for this platform (Windows process APIs or /proc; one that never finds anything elsewhere)
+std::unique_ptr<ProcessMonitor> CreateSystemProcessMonitor();
+
+// The newest 'capacity' samples; older ones are overwritten, the session totals don't need them
+class SampleRing {
+public:
+    explicit SampleRing(size_t capacity) : samples_(capacity ? capacity : 1) {}
+
+    void Push(const ProcessSample& sample);
+    size_t Size() const { return count_; }
+    size_t Capacity() const { return samples_.size(); }
+    bool Empty() const { return count_ == 0; }
+
+    // i = 0 is the oldest sample still held
+    const ProcessSample& operator[](size_t i) const { return samples_[(next_ + samples_.size() - count_ + i) % samples_.size()]; }
+    const ProcessSample& Newest() const { return (*this)[count_ - 1]; }
+
+    // Oldest first
+    std::vector<ProcessSample> Samples() const;
+
+private:
+    std::vector<ProcessSample> samples_;
+    size_t next_ = 0;
+    size_t count_ = 0;
+};
+
+struct SessionOptions {
+    std::string exeName;              // The game's executable, e.g. gameExecutable
+    std::string iniPath;              // settings.ini; empty to leave the settings alone
+    unsigned intervalMs = 2000;       // Between samples
+    unsigned findTimeoutMs = 120000;  // How long Steam gets to start the game
+    size_t ringCapacity = 1800;       // An hour at the default interval
+    bool restoreSettings = false;     // Put settings.ini back as it was at launch if the session changed it
+};
+
+struct SessionSummary {
+    bool found = false;            // False if the game never showed up within findTimeoutMs
+    bool complete = false;         // The game exited (not the launcher stopping the supervisor)
+    uint32_t pid = 0;
+    int64_t durationMs = 0;
+    size_t samples = 0;
+    uint64_t cpuTimeUs = 0;
+    double averageCpuPercent = 0;  // Of one core, over the whole session
+    double peakCpuPercent = 0;     // Of one core, over one interval
+    uint64_t peakWorkingSetBytes = 0;
+    uint64_t readBytes = 0;
+    uint64_t writeBytes = 0;
+    std::vector<IniKeyChange> settingsChanges;  // What the session did to settings.ini
+    bool settingsRestored = false;
+    std::string error;                          // Why a restore failed
+};
+
+// A few lines of text for the session log
+std::string SessionSummaryText(const SessionSummary& summary);
+
+// sessions.log, next to settings.ini
+std::string SessionLogPath(const std::string& iniPath);
+
+// Add summary to the session log (SessionLogPath)
+bool AppendSessionLog(const std::string& iniPath, const SessionSummary& summary, std::string& error);
+
+// Watches one game session on a thread of its own
+class GameSupervisor {
+public:
+    using Callback = std::function<void(const SessionSummary& summary)>;
+
+    explicit GameSupervisor(std::unique_ptr<ProcessMonitor> monitor) : monitor_(std::move(monitor)) {}
+    ~GameSupervisor() { Stop(); }
+    GameSupervisor(const GameSupervisor&) = delete;
+    GameSupervisor& operator=(const GameSupervisor&) = delete;
+
+    // Start watching for the game; settings.ini as it is now is what a restore goes back to.
+    // onEnd runs on the supervisor's thread once the session is over. False if a session is already being watched
+    bool Start(const SessionOptions& options, Callback onEnd);
+
+    // Give up on the session (the launcher is closing); onEnd still runs, with complete = false
+    void Stop();
+
+    // Whether a session is being watched right now
+    bool IsRunning() const;
+
+    // The ring's samples so far, oldest first
+    std::vector<ProcessSample> Samples() const;
+
+private:
+    void Run(SessionOptions options, std::string baseline, Callback onEnd);
+    bool WaitFor(unsigned ms);  // False if Stop was called meanwhile
+
+    std::unique_ptr<ProcessMonitor> monitor_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread worker_;
+    bool running_ = false;
+    bool stopping_ = false;
+    SampleRing ring_{1};
+};
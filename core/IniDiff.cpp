@@ -0,0 +1,64 @@
+/*
+ * IniDiff.cpp
+ * "Spot the difference: one of these INI files has a three-headed monkey."
+ */
+
+#include "IniDiff.h"
+
+#include "AtomicFile.h"
+
+std::vector<IniKeyChange> DiffIniDocuments(const IniDocument& before, const IniDocument& after) {
+    std::vector<IniKeyChange> changes;
+    const auto& afterSections = after.Sections();
+    for (const IniEntry& entry : after.Entries()) {
+        const std::string& section = afterSections[entry.section].name;
+        std::string_view key = after.Key(entry);
+        std::string_view value = after.Value(entry);
+        const IniEntry* old = before.Find(section, key);
+        if (!old) {
+            changes.push_back({IniKeyChange::Added, section, std::string(key), "", std::string(value)});
+        } else if (before.Value(*old) != value) {
+            changes.push_back({IniKeyChange::Changed, section, std::string(key), std::string(before.Value(*old)), std::string(value)});
+        }
+    }
+
+    const auto& beforeSections = before.Sections();
+    for (const IniEntry& entry : before.Entries()) {
+        const std::string& section = beforeSections[entry.section].name;
+        std::string_view key = before.Key(entry);
+        if (!after.Has(section, key)) {
+            changes.push_back({IniKeyChange::Removed, section, std::string(key), std::string(before.Value(entry)), ""});
+        }
+    }
+    return changes;
+}
+
+std::vector<IniSplice> ApplyIniChanges(IniDocument& target, const std::vector<IniKeyChange>& changes) {
+    std::vector<IniSplice> splices;
+    for (const IniKeyChange& change : changes) {
+        IniSplice splice = change.kind == IniKeyChange::Removed
+                               ? target.Remove(change.section, change.key)
+                               : target.Set(change.section, change.key, change.newValue);
+        if (splice.changed) splices.push_back(std::move(splice));
+    }
+    return splices;
+}
+
+void SettingsBaseline::Reset(std::string_view diskText) {
+    document_.Parse(std::string(diskText));
+    hash_ = HashContent(diskText);
+    size_ = diskText.size();
+}
+
+bool SettingsBaseline::Update(std::string_view diskText, std::vector<IniKeyChange>& changes) {
+    changes.clear();
+    uint64_t hash = HashContent(diskText);
+    if (diskText.size() == size_ && hash == hash_) return false;
+
+    IniDocument fresh{std::string(diskText)};
+    changes = DiffIniDocuments(document_, fresh);
+    document_ = std::move(fresh);
+    hash_ = hash;
+    size_ = diskText.size();
+    return true;
+}
@@ -0,0 +1,50 @@
+/*
+ * IniDiff.h
+ * Key-level differences between two versions of settings.ini, so an
+ * outside change (the game rewriting the file on exit) can be pushed into
+ * the launcher one key at a time instead of reloading everything.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "IniDocument.h"
+
+struct IniKeyChange {
+    enum Kind { Added, Changed, Removed };
+    Kind kind = Changed;
+    std::string section;
+    std::string key;
+    std::string oldValue;  // Empty for Added
+    std::string newValue;  // Empty for Removed
+};
+
+// Every key whose value differs between before and after, in after's order (removals last)
+std::vector<IniKeyChange> DiffIniDocuments(const IniDocument& before, const IniDocument& after);
+
+// Apply changes to target; each splice is returned in order so an edit box can follow along
+std::vector<IniSplice> ApplyIniChanges(IniDocument& target, const std::vector<IniKeyChange>& changes);
+
+// The last settings.ini content the launcher knows is on disk (after a load or save)
+class SettingsBaseline {
+public:
+    // Remember diskText as the current on-disk state
+    void Reset(std::string_view diskText);
+
+    // Compare fresh disk content with the baseline and adopt it. Returns false without
+    // parsing anything when the content hash is unchanged (e.g. our own save).
+    bool Update(std::string_view diskText, std::vector<IniKeyChange>& changes);
+
+    const IniDocument& Document() const { return document_; }
+    uint64_t Hash() const { return hash_; }
+    size_t Size() const { return size_; }
+
+private:
+    IniDocument document_;
+    uint64_t hash_ = 0;
+    size_t size_ = 0;
+};
@@ -0,0 +1,242 @@
+/*
+ * IniDocument.cpp
+ * Section/key index over settings.ini text.
+ * "You fight like a dairy farmer!" - "How appropriate, you parse like a cow!"
+ */
+
+#include "IniDocument.h"
+
+#include "Trace.h"
+
+#include <cstring>
+#include <limits>
+
+namespace {
+
+bool IsBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+char LowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+void AppendLower(std::string& out, std::string_view text) {
+    for (char c : text) out += LowerAscii(c);
+}
+
+} // namespace
+
+std::string IniDocument::IndexKey(std::string_view section, std::string_view key) {
+    std::string result;
+    result.reserve(section.size() + key.size() + 1);
+    AppendLower(result, section);
+    result += '\n'; // Can never appear in a section or key name
+    AppendLower(result, key);
+    return result;
+}
+
+void IniDocument::Parse(std::string text) {
+    MISE_TRACE_SCOPE("IniDocument::Parse");
+    text_ = std::move(text);
+    sections_.clear();
+    entries_.clear();
+    index_.clear();
+
+    // Keys that come before the first [section] live in the unnamed global section
+    sections_.push_back({"", std::string::npos, 0});
+
+    const char* data = text_.data();
+    const size_t size = text_.size();
+    bool newlineDetected = false;
+    size_t lineStart = 0;
+
+    while (lineStart < size) {
+        const char* nl = static_cast<const char*>(std::memchr(data + lineStart, '\n', size - lineStart));
+        size_t next = nl ? static_cast<size_t>(nl - data) + 1 : size;
+        size_t lineEnd = nl ? static_cast<size_t>(nl - data) : size;
+        if (lineEnd > lineStart && data[lineEnd - 1] == '\r') --lineEnd;
+
+        if (nl && !newlineDetected) {
+            newline_ = (lineEnd < static_cast<size_t>(nl - data)) ? "\r\n" : "\n";
+            newlineDetected = true;
+        }
+
+        // Trim the line
+        size_t first = lineStart;
+        while (first < lineEnd && IsBlank(data[first])) ++first;
+        size_t last = lineEnd;
+        while (last > first && IsBlank(data[last - 1])) --last;
+
+        if (first == last || data[first] == ';' || data[first] == '#') {
+            // Blank line or comment: belongs to whatever section we're in, nothing to index
+        } else if (data[first] == '[') {
+            size_t close = first + 1;
+            while (close < last && data[close] != ']') ++close;
+            IniSection section;
+            section.name.assign(data + first + 1, close - first - 1);
+            section.headerStart = first;
+            section.bodyEnd = next;
+            sections_.push_back(std::move(section));
+        } else {
+            const char* eq = static_cast<const char*>(std::memchr(data + first, '=', last - first));
+            if (eq) {
+                size_t eqPos = static_cast<size_t>(eq - data);
+                size_t keyEnd = eqPos;
+                while (keyEnd > first && IsBlank(data[keyEnd - 1])) --keyEnd;
+                size_t valueStart = eqPos + 1;
+                while (valueStart < last && IsBlank(data[valueStart])) ++valueStart;
+
+                IniEntry entry;
+                entry.section = sections_.size() - 1;
+                entry.keyStart = first;
+                entry.keyLength = keyEnd - first;
+                entry.valueStart = valueStart;
+                entry.valueLength = last - valueStart;
+
+                // The first occurrence wins, same as GetPrivateProfileString
+                std::string key = IndexKey(sections_.back().name, std::string_view(data + first, entry.keyLength));
+                if (index_.emplace(std::move(key), entries_.size()).second) {
+                    entries_.push_back(entry);
+                }
+            }
+        }
+
+        // Every line (comment or not) extends the section it sits in
+        sections_.back().bodyEnd = next;
+        lineStart = next;
+    }
+}
+
+const IniEntry* IniDocument::Find(std::string_view section, std::string_view key) const {
+    auto it = index_.find(IndexKey(section, key));
+    return it == index_.end() ? nullptr : &entries_[it->second];
+}
+
+std::string_view IniDocument::Value(std::string_view section, std::string_view key) const {
+    const IniEntry* entry = Find(section, key);
+    return entry ? Value(*entry) : std::string_view();
+}
+
+bool IniDocument::GetInt(std::string_view section, std::string_view key, int& value) const {
+    const IniEntry* entry = Find(section, key);
+    return entry && ParseIniInt(Value(*entry), value);
+}
+
+bool IniDocument::GetBool(std::string_view section, std::string_view key, bool& value) const {
+    int number = 0;
+    if (!GetInt(section, key, number)) return false;
+    value = number != 0;
+    return true;
+}
+
+void IniDocument::ShiftAfter(size_t offset, long long delta) {
+    for (IniEntry& entry : entries_) {
+        if (entry.keyStart > offset) entry.keyStart += delta;
+        if (entry.valueStart > offset) entry.valueStart += delta;
+    }
+    for (IniSection& section : sections_) {
+        if (section.headerStart != std::string::npos && section.headerStart > offset) section.headerStart += delta;
+        if (section.bodyEnd > offset) section.bodyEnd += delta;
+    }
+}
+
+IniSplice IniDocument::Set(std::string_view section, std::string_view key, std::string_view value) {
+    IniSplice splice;
+    if (!IsSingleLine(section) || !IsSingleLine(key) || !IsSingleLine(value)) return splice;
+
+    if (IniEntry* entry = const_cast<IniEntry*>(Find(section, key))) {
+        if (Value(*entry) == value) return splice; // Nothing to do, nothing to repaint
+
+        splice.changed = true;
+        splice.offset = entry->valueStart;
+        splice.removed = entry->valueLength;
+        splice.inserted.assign(value);
+
+        text_.replace(entry->valueStart, entry->valueLength, value);
+        long long delta = static_cast<long long>(value.size()) - static_cast<long long>(entry->valueLength);
+        entry->valueLength = value.size();
+        if (delta != 0) ShiftAfter(entry->valueStart, delta);
+        return splice;
+    }
+
+    // Key is missing: add it after the last key of its section, or add the section itself
+    const std::string wanted = IndexKey(section, "");
+    size_t target = std::string::npos;
+    for (size_t i = 0; i < sections_.size(); ++i) {
+        if (IndexKey(sections_[i].name, "") == wanted) {
+            target = i;
+            break;
+        }
+    }
+
+    splice.changed = true;
+    if (target != std::string::npos) {
+        size_t anchor = sections_[target].headerStart == std::string::npos ? 0 : sections_[target].headerStart;
+        bool hasAnchor = sections_[target].headerStart != std::string::npos;
+        for (const IniEntry& entry : entries_) {
+            if (entry.section == target) {
+                anchor = entry.valueStart;
+                hasAnchor = true;
+            }
+        }
+        if (hasAnchor) {
+            size_t nl = text_.find('\n', anchor);
+            splice.offset = nl == std::string::npos ? text_.size() : nl + 1;
+        }
+        if (splice.offset > 0 && text_[splice.offset - 1] != '\n') splice.inserted = newline_;
+    } else {
+        splice.offset = text_.size();
+        if (!text_.empty() && text_.back() != '\n') splice.inserted = newline_;
+        splice.inserted.append("[").append(section).append("]").append(newline_);
+    }
+    splice.inserted.append(key).append("=").append(value).append(newline_);
+
+    std::string updated = text_;
+    updated.insert(splice.offset, splice.inserted);
+    Parse(std::move(updated)); // Rare path, a full re-index is fine here
+    return splice;
+}
+
+IniSplice IniDocument::Remove(std::string_view section, std::string_view key) {
+    IniSplice splice;
+    const IniEntry* entry = Find(section, key);
+    if (!entry) return splice;
+
+    size_t lineStart = text_.rfind('\n', entry->keyStart);
+    lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+    size_t lineEnd = text_.find('\n', entry->valueStart + entry->valueLength);
+    lineEnd = lineEnd == std::string::npos ? text_.size() : lineEnd + 1;
+
+    splice.changed = true;
+    splice.offset = lineStart;
+    splice.removed = lineEnd - lineStart;
+
+    std::string updated = text_;
+    updated.erase(lineStart, lineEnd - lineStart);
+    Parse(std::move(updated)); // Rare path, a full re-index is fine here
+    return splice;
+}
+
+bool ParseIniInt(std::string_view text, int& value) {
+    if (text.empty()) return false;
+    size_t i = 0;
+    bool negative = false;
+    if (text[0] == '-' || text[0] == '+') {
+        negative = text[0] == '-';
+        if (++i == text.size()) return false;
+    }
+    long long result = 0;
+    for (; i < text.size(); ++i) {
+        char c = text[i];
+        if (c < '0' || c > '9') return false;
+        result = result * 10 + (c - '0');
+        if (result > std::numeric_limits<int>::max()) return false;
+    }
+    value = static_cast<int>(negative ? -result : result);
+    return true;
+}
+
+bool IsSingleLine(std::string_view text) {
+    return text.find_first_of("\r\n") == std::string_view::npos;
+}
@@ -0,0 +1,94 @@
+/*
+ * IniDocument.h
+ * A parsed view of settings.ini that remembers where every key and value
+ * lives in the original text, so an update is one lookup and one splice.
+ *
+ * Comments, blank lines, ordering and line endings are kept exactly as
+ * they were; only the bytes of the changed value are touched.
+ * "I've got a key, I've got a section, and I've got a byte offset!"
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// One [section] header and the byte range it covers
+struct IniSection {
+    std::string name;
+    size_t headerStart = 0;  // Offset of '[' (npos for the implicit global section)
+    size_t bodyEnd = 0;      // Offset just past the last line that belongs to the section
+};
+
+// One key=value line; spans are byte offsets into IniDocument::Text()
+struct IniEntry {
+    size_t section = 0;      // Index into IniDocument::Sections()
+    size_t keyStart = 0;
+    size_t keyLength = 0;
+    size_t valueStart = 0;   // Trimmed value span
+    size_t valueLength = 0;
+};
+
+// Describes a single in-place edit of the document text
+struct IniSplice {
+    bool changed = false;
+    size_t offset = 0;       // Where the edit starts
+    size_t removed = 0;      // How many bytes were replaced
+    std::string inserted;    // What replaced them
+};
+
+class IniDocument {
+public:
+    IniDocument() = default;
+    explicit IniDocument(std::string text) { Parse(std::move(text)); }
+
+    // Replace the whole document and rebuild the section/key index
+    void Parse(std::string text);
+
+    const std::string& Text() const { return text_; }
+    const std::vector<IniSection>& Sections() const { return sections_; }
+    const std::vector<IniEntry>& Entries() const { return entries_; }
+
+    // Look up a key inside its own section (case-insensitive, like Windows INI files)
+    const IniEntry* Find(std::string_view section, std::string_view key) const;
+    bool Has(std::string_view section, std::string_view key) const { return Find(section, key) != nullptr; }
+
+    // Value of a key, or an empty view when the key is missing
+    std::string_view Value(std::string_view section, std::string_view key) const;
+    std::string_view Value(const IniEntry& entry) const { return std::string_view(text_).substr(entry.valueStart, entry.valueLength); }
+    std::string_view Key(const IniEntry& entry) const { return std::string_view(text_).substr(entry.keyStart, entry.keyLength); }
+
+    // Typed readers; return false when the key is missing or malformed
+    bool GetInt(std::string_view section, std::string_view key, int& value) const;
+    bool GetBool(std::string_view section, std::string_view key, bool& value) const;
+
+    // Set a value, splicing it into the existing line when the key exists.
+    // Missing keys are appended to their section (or a new section is added).
+    // A section, key or value with a line break in it would add lines of its own,
+    // so Set refuses it and returns an unchanged splice (see IsSingleLine).
+    IniSplice Set(std::string_view section, std::string_view key, std::string_view value);
+
+    // Delete a key's whole line; an unchanged splice if the key wasn't there
+    IniSplice Remove(std::string_view section, std::string_view key);
+
+    // The newline style the document was written with ("\r\n" or "\n")
+    const std::string& Newline() const { return newline_; }
+
+private:
+    static std::string IndexKey(std::string_view section, std::string_view key);
+    void ShiftAfter(size_t offset, long long delta);
+
+    std::string text_;
+    std::string newline_ = "\r\n";
+    std::vector<IniSection> sections_;
+    std::vector<IniEntry> entries_;
+    std::unordered_map<std::string, size_t> index_; // "section\nkey" -> entries_ index
+};
+
+// Parse a whole decimal integer (no trailing junk); "12" works, "1x" does not
+bool ParseIniInt(std::string_view text, int& value);
+
+// Whether text has no '\r' or '\n' in it, so it can go into one line of the file
+bool IsSingleLine(std::string_view text);
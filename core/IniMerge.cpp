@@ -0,0 +1,72 @@
+/*
+ * IniMerge.cpp
+ * "Two pirates, one treasure map, and nobody's X gets scrubbed out."
+ */
+
+#include "IniMerge.h"
+
+#include "AtomicFile.h"
+#include "Trace.h"
+
+IniMerge MergeIniDocuments(const IniDocument& base, const IniDocument& ours, const IniDocument& theirs, IniConflictChoice choice) {
+    MISE_TRACE_SCOPE("MergeIniDocuments");
+    IniMerge result;
+    result.merged = ours;
+    for (IniKeyChange& change : DiffIniDocuments(base, theirs)) {
+        // Each key the disk changed: taken if ours left it as it was, a conflict if ours changed it some other way
+        bool inBase = change.kind != IniKeyChange::Added;
+        bool inTheirs = change.kind != IniKeyChange::Removed;
+        const IniEntry* entry = ours.Find(change.section, change.key);
+        std::string_view oursValue = entry ? ours.Value(*entry) : std::string_view();
+
+        bool oursUnchanged = (entry != nullptr) == inBase && (!entry || oursValue == change.oldValue);
+        bool sameAsTheirs = (entry != nullptr) == inTheirs && (!entry || oursValue == change.newValue);
+        if (sameAsTheirs) continue;  // Both made the same change
+        if (!oursUnchanged) {
+            result.conflicts.push_back({change.section, change.key, change.oldValue, std::string(oursValue), change.newValue,
+                                        inBase, entry != nullptr, inTheirs});
+            if (choice == IniConflictChoice::KeepOurs) continue;
+        }
+        result.taken.push_back(std::move(change));
+    }
+    ApplyIniChanges(result.merged, result.taken);
+    return result;
+}
+
+IniMerge MergeWithDisk(const std::string& path, const SettingsBaseline& base, const IniDocument& ours, IniConflictChoice choice,
+                       std::string& diskBytes) {
+    diskBytes.clear();
+    if (!ReadFileBytes(path, diskBytes)) {
+        IniMerge result;
+        result.merged = ours;  // Nothing on disk to keep
+        return result;
+    }
+    std::string disk = normalizeWindowsNewlines(diskBytes);
+    if (disk.size() == base.Size() && HashContent(disk) == base.Hash()) {
+        IniMerge result;
+        result.merged = ours;  // Nobody else wrote the file: the usual case, and no diff needed
+        return result;
+    }
+    return MergeIniDocuments(base.Document(), ours, IniDocument(std::move(disk)), choice);
+}
+
+SaveResult SaveMergedSettings(const std::string& path, const IniDocument& merged, const std::string& diskBytes) {
+    MISE_TRACE_SCOPE("SaveMergedSettings");
+    SaveResult result;
+    std::string normalized = normalizeWindowsNewlines(merged.Text());
+    if (!diskBytes.empty() && normalized == diskBytes) {
+        result.status = SaveStatus::Unchanged;
+        return result;
+    }
+    result.status = WriteFileAtomic(path, normalized, result.error) ? SaveStatus::Written : SaveStatus::Failed;
+    return result;
+}
+
+std::string DescribeIniConflicts(const std::vector<IniMergeConflict>& conflicts) {
+    std::string text;
+    for (const IniMergeConflict& conflict : conflicts) {
+        text += conflict.section + "." + conflict.key + ": yours " + (conflict.inOurs ? conflict.oursValue : "(removed)") +
+                ", on disk " + (conflict.inTheirs ? conflict.theirsValue : "(removed)") + "\n";
+    }
+    return text;
+}
@@ -0,0 +1,54 @@
+/*
+ * IniMerge.h
+ * Saving without losing someone else's changes. The launcher's edits were
+ * made on top of the settings.ini it loaded (the base); if the game or
+ * another tool has written the file since, a key-level three-way merge of
+ * base, edits and disk keeps both: keys only the disk changed are taken
+ * from the disk, keys only the launcher changed are written, and keys both
+ * changed to different values are conflicts, settled one way or the other.
+ *
+ * The merge works on the edits' own text, so its comments and layout are
+ * what gets written. A merge that comes out identical to the disk isn't
+ * written at all.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "IniDiff.h"
+#include "TextFile.h"
+
+// A key both sides changed, to different values
+struct IniMergeConflict {
+    std::string section;
+    std::string key;
+    std::string baseValue, oursValue, theirsValue;
+    bool inBase = false, inOurs = false, inTheirs = false;  // A side that removed the key has no value
+};
+
+enum class IniConflictChoice {
+    KeepOurs,   // The launcher's value is written
+    TakeTheirs  // The value on disk stays
+};
+
+struct IniMerge {
+    IniDocument merged;                       // The edits, with the disk's changes applied
+    std::vector<IniKeyChange> taken;          // The disk's changes that were applied, in order
+    std::vector<IniMergeConflict> conflicts;  // Reported whichever way they were settled
+};
+
+// Three-way merge of key/value pairs; comments and layout come from ours
+IniMerge MergeIniDocuments(const IniDocument& base, const IniDocument& ours, const IniDocument& theirs, IniConflictChoice choice);
+
+// Merge ours with path as it is now. diskBytes gets the file's exact bytes (empty if it can't be read,
+// in which case ours is taken as is); a disk that still matches base skips the diff altogether
+IniMerge MergeWithDisk(const std::string& path, const SettingsBaseline& base, const IniDocument& ours, IniConflictChoice choice,
+                       std::string& diskBytes);
+
+// Write merged over path, unless diskBytes (from MergeWithDisk) already are exactly what would be written
+SaveResult SaveMergedSettings(const std::string& path, const IniDocument& merged, const std::string& diskBytes);
+
+// "display.windowed: yours 1, on disk 0" lines for telling someone about conflicts
+std::string DescribeIniConflicts(const std::vector<IniMergeConflict>& conflicts);
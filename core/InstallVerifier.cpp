@@ -0,0 +1,327 @@
+/*
+ * InstallVerifier.cpp
+ * "Count the doubloons before you set sail, not after the kraken's been at them."
+ */
+
+#include "InstallVerifier.h"
+
+#include "AtomicFile.h"
+#include "MappedFile.h"
+#include "TextFile.h"
+#include "Trace.h"
+#include "WorkStealing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char manifestMagic[] = "MISEINSTALL 1";
+
+struct ListedFile {
+    std::string path;
+    uint64_t size = 0;
+    int64_t modified = 0;
+};
+
+// Every regular file under installDir, sorted by path
+bool ListInstall(const std::string& installDir, std::vector<ListedFile>& files, std::string& error) {
+    MISE_TRACE_SCOPE("ListInstall");
+    files.clear();
+    std::error_code ec;
+    fs::path root(installDir);
+    if (!fs::is_directory(root, ec)) {
+        error = installDir + " is not a folder";
+        return false;
+    }
+    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        std::error_code entryError;
+        if (!it->is_regular_file(entryError)) continue;
+        ListedFile file;
+        file.path = it->path().lexically_relative(root).generic_string();
+        file.size = it->file_size(entryError);
+        file.modified = static_cast<int64_t>(it->last_write_time(entryError).time_since_epoch().count());
+        if (entryError || file.path.find('\n') != std::string::npos) continue;
+        files.push_back(std::move(file));
+    }
+    if (ec) {
+        error = "Could not list " + installDir + " (" + ec.message() + ")";
+        return false;
+    }
+    std::sort(files.begin(), files.end(), [](const ListedFile& a, const ListedFile& b) { return a.path < b.path; });
+    return true;
+}
+
+// Hash the files at 'paths' (with the sizes they were listed at) block by block on every thread.
+// An empty error means digests[i] is the file's hash
+void HashFiles(const std::string& installDir, const std::vector<const std::string*>& paths, const std::vector<uint64_t>& sizes,
+               uint64_t blockSize, unsigned threads, std::vector<ChunkDigest>& digests, std::vector<std::string>& errors,
+               std::atomic<uint64_t>& bytesHashed) {
+    MISE_TRACE_SCOPE("HashFiles");
+    // One unit per block, a file's blocks next to each other; an empty file is one empty block
+    struct Unit {
+        size_t file;
+        uint64_t offset;
+    };
+    std::vector<Unit> units;
+    std::vector<size_t> firstUnit(paths.size() + 1);
+    for (size_t i = 0; i < paths.size(); ++i) {
+        firstUnit[i] = units.size();
+        uint64_t blocks = std::max<uint64_t>(1, (sizes[i] + blockSize - 1) / blockSize);
+        for (uint64_t block = 0; block < blocks; ++block) units.push_back({i, block * blockSize});
+    }
+    firstUnit[paths.size()] = units.size();
+
+    std::vector<ChunkDigest> blockDigests(units.size());
+    std::vector<std::string> unitErrors(units.size());
+    RunWorkStealing(units.size(), threads, [&](size_t index, unsigned) {
+        const Unit& unit = units[index];
+        std::string path = (fs::path(installDir) / fs::path(*paths[unit.file])).string();
+        MappedFile mapped;
+        if (!mapped.OpenRange(path, unit.offset, static_cast<size_t>(blockSize), unitErrors[index])) return;
+        size_t expected = static_cast<size_t>(std::min<uint64_t>(blockSize, sizes[unit.file] - unit.offset));
+        if (mapped.Size() != expected) {
+            unitErrors[index] = "changed while it was being checked";
+            return;
+        }
+        blockDigests[index] = DigestChunk(mapped.View());
+        bytesHashed += mapped.Size();
+    });
+
+    digests.assign(paths.size(), ChunkDigest());
+    errors.assign(paths.size(), std::string());
+    std::string hashes;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        hashes.clear();
+        for (size_t unit = firstUnit[i]; unit < firstUnit[i + 1]; ++unit) {
+            if (!unitErrors[unit].empty()) {
+                errors[i] = unitErrors[unit];
+                break;
+            }
+            hashes.append(reinterpret_cast<const char*>(&blockDigests[unit].high), sizeof(uint64_t));
+            hashes.append(reinterpret_cast<const char*>(&blockDigests[unit].low), sizeof(uint64_t));
+        }
+        if (errors[i].empty()) digests[i] = DigestChunk(hashes);
+    }
+}
+
+uint64_t ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+std::string Seconds(uint64_t ms) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f s", ms / 1000.0);
+    return text;
+}
+
+} // namespace
+
+bool BuildInstallManifest(const std::string& installDir, const std::string& buildId, const InstallCheckOptions& options,
+                          InstallManifest& manifest, InstallReport& report, std::string& error) {
+    MISE_TRACE_SCOPE("BuildInstallManifest");
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ListedFile> listed;
+    if (!ListInstall(installDir, listed, error)) return false;
+
+    std::vector<const std::string*> paths;
+    std::vector<uint64_t> sizes;
+    for (const ListedFile& file : listed) {
+        paths.push_back(&file.path);
+        sizes.push_back(file.size);
+    }
+    std::vector<ChunkDigest> digests;
+    std::vector<std::string> errors;
+    std::atomic<uint64_t> bytesHashed{0};
+    HashFiles(installDir, paths, sizes, installBlockSize, options.threads, digests, errors, bytesHashed);
+
+    manifest = InstallManifest();
+    manifest.buildId = buildId;
+    manifest.created = static_cast<int64_t>(std::time(nullptr));
+    report.built = true;
+    for (size_t i = 0; i < listed.size(); ++i) {
+        if (!errors[i].empty()) {
+            // Nothing to compare against later; better no manifest than one missing a file
+            error = listed[i].path + ": " + errors[i];
+            return false;
+        }
+        manifest.files.push_back({listed[i].path, listed[i].size, listed[i].modified, digests[i]});
+        report.bytes += listed[i].size;
+    }
+    report.files = report.filesHashed = listed.size();
+    report.bytesHashed = bytesHashed;
+    report.elapsedMs = ElapsedMs(start);
+    return true;
+}
+
+bool VerifyInstall(const std::string& installDir, InstallManifest& manifest, const InstallCheckOptions& options,
+                   InstallReport& report, std::string& error) {
+    MISE_TRACE_SCOPE("VerifyInstall");
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ListedFile> listed;
+    if (!ListInstall(installDir, listed, error)) return false;
+
+    // Both lists are sorted by path, so one walk pairs them up
+    std::vector<size_t> toHash;  // Into manifest.files
+    std::vector<int64_t> listedTimes(manifest.files.size());
+    size_t next = 0;
+    for (size_t i = 0; i < manifest.files.size(); ++i) {
+        const InstallFile& expected = manifest.files[i];
+        while (next < listed.size() && listed[next].path < expected.path) report.added.push_back(listed[next++].path);
+        if (next == listed.size() || listed[next].path != expected.path) {
+            report.missing.push_back(expected.path);
+            continue;
+        }
+        const ListedFile& found = listed[next++];
+        report.bytes += found.size;
+        if (found.size != expected.size) {
+            report.damaged.push_back(expected.path + ": " + std::to_string(found.size) + " bytes, should be " +
+                                     std::to_string(expected.size));
+        } else if (found.modified == expected.modified && !options.full) {
+            ++report.filesSkipped;
+        } else {
+            listedTimes[i] = found.modified;
+            toHash.push_back(i);
+        }
+    }
+    while (next < listed.size()) report.added.push_back(listed[next++].path);
+
+    std::vector<const std::string*> paths;
+    std::vector<uint64_t> sizes;
+    for (size_t i : toHash) {
+        paths.push_back(&manifest.files[i].path);
+        sizes.push_back(manifest.files[i].size);
+    }
+    std::vector<ChunkDigest> digests;
+    std::vector<std::string> errors;
+    std::atomic<uint64_t> bytesHashed{0};
+    HashFiles(installDir, paths, sizes, manifest.blockSize, options.threads, digests, errors, bytesHashed);
+
+    for (size_t k = 0; k < toHash.size(); ++k) {
+        InstallFile& file = manifest.files[toHash[k]];
+        if (!errors[k].empty()) {
+            report.damaged.push_back(file.path + ": " + errors[k]);
+        } else if (digests[k] != file.digest) {
+            report.damaged.push_back(file.path + ": contents changed");
+        } else if (listedTimes[toHash[k]] != file.modified) {
+            file.modified = listedTimes[toHash[k]];
+            ++report.stampsRefreshed;
+        }
+    }
+    std::sort(report.damaged.begin(), report.damaged.end());
+    report.files = manifest.files.size();
+    report.filesHashed = toHash.size();
+    report.bytesHashed = bytesHashed;
+    report.elapsedMs = ElapsedMs(start);
+    return true;
+}
+
+bool ReadInstallManifest(const std::string& path, InstallManifest& manifest, std::string& error) {
+    MISE_TRACE_SCOPE("ReadInstallManifest");
+    std::string content;
+    if (!ReadFileBytes(path, content)) {
+        error = "There is no install manifest at " + path;
+        return false;
+    }
+    std::istringstream in(content);
+    std::string line, word;
+    manifest = InstallManifest();
+    std::getline(in, line);
+    bool ok = line == manifestMagic && in >> word && word == "build" && in.get() == ' ' && std::getline(in, manifest.buildId) &&
+              in >> word >> manifest.blockSize && word == "block" && in >> word >> manifest.created && word == "created";
+    if (!ok || manifest.blockSize == 0 || manifest.blockSize % MappedFile::mappingGranularity != 0) {
+        error = path + " is not an install manifest this launcher reads";
+        return false;
+    }
+    std::string hex;
+    while (in >> hex) {
+        InstallFile file;
+        if (!ChunkDigest::FromHex(hex, file.digest) || !(in >> file.size >> file.modified) || in.get() != ' ' ||
+            !std::getline(in, file.path) || file.path.empty()) {
+            error = path + " is damaged";
+            return false;
+        }
+        manifest.files.push_back(std::move(file));
+    }
+    std::sort(manifest.files.begin(), manifest.files.end(),
+              [](const InstallFile& a, const InstallFile& b) { return a.path < b.path; });
+    return true;
+}
+
+bool WriteInstallManifest(const std::string& path, const InstallManifest& manifest, std::string& error) {
+    std::string content = std::string(manifestMagic) + "\nbuild " + manifest.buildId + "\nblock " +
+                          std::to_string(manifest.blockSize) + "\ncreated " + std::to_string(manifest.created) + "\n";
+    for (const InstallFile& file : manifest.files) {
+        content += file.digest.Hex() + " " + std::to_string(file.size) + " " + std::to_string(file.modified) + " " +
+                   file.path + "\n";
+    }
+    return WriteFileAtomic(path, content, error);
+}
+
+bool CheckInstall(const std::string& installDir, const std::string& buildId, const std::string& manifestPath,
+                  const InstallCheckOptions& options, InstallReport& report, std::string& error) {
+    MISE_TRACE_SCOPE("CheckInstall");
+    report = InstallReport();
+    InstallManifest manifest;
+    std::error_code ec;
+    if (fs::exists(manifestPath, ec)) {
+        if (!ReadInstallManifest(manifestPath, manifest, error)) {
+            error += " (delete it and check again to record the install afresh)";
+            return false;
+        }
+        if (buildId.empty() || manifest.buildId.empty() || buildId == manifest.buildId) {
+            if (!VerifyInstall(installDir, manifest, options, report, error)) return false;
+            return report.stampsRefreshed == 0 || WriteInstallManifest(manifestPath, manifest, error);
+        }
+        report.previousBuildId = manifest.buildId;  // Steam updated the game; the old manifest describes other files
+    }
+    if (!BuildInstallManifest(installDir, buildId, options, manifest, report, error)) return false;
+    return WriteInstallManifest(manifestPath, manifest, error);
+}
+
+std::string InstallReportText(const InstallReport& report, size_t maxListed) {
+    std::string text;
+    std::string files = std::to_string(report.files) + (report.files == 1 ? " file" : " files");
+    if (report.built) {
+        text = report.previousBuildId.empty() ? "No install manifest yet: recorded "
+                                              : "Steam updated the game since the last check (build " + report.previousBuildId +
+                                                    "): recorded ";
+        text += files + " (" + FormatBytes(report.bytes) + ") as they are now in " + Seconds(report.elapsedMs) +
+                ". Later checks compare against this.\n";
+        return text;
+    }
+    text = files + " checked in " + Seconds(report.elapsedMs) + ": " + std::to_string(report.filesHashed) + " read (" +
+           FormatBytes(report.bytesHashed) + "), " + std::to_string(report.filesSkipped) + " unchanged since the last check.\n";
+    auto list = [&](const char* label, const std::vector<std::string>& paths) {
+        for (size_t i = 0; i < paths.size() && i < maxListed; ++i) text += std::string(label) + paths[i] + "\n";
+        if (paths.size() > maxListed) text += "  ... and " + std::to_string(paths.size() - maxListed) + " more\n";
+    };
+    list("Missing: ", report.missing);
+    list("Damaged: ", report.damaged);
+    if (!report.added.empty()) {
+        text += std::to_string(report.added.size()) + (report.added.size() == 1 ? " file isn't" : " files aren't") +
+                " in the manifest (left alone).\n";
+    }
+    if (report.Ok()) {
+        text += "Every file matches.\n";
+    } else {
+        size_t bad = report.missing.size() + report.damaged.size();
+        text += std::to_string(bad) + (bad == 1 ? " file is" : " files are") +
+                " missing or damaged: use Verify integrity of game files in Steam to repair the install.\n";
+    }
+    return text;
+}
+
+std::string InstallManifestPath(const std::string& iniPath) {
+    fs::path dir = fs::path(iniPath).parent_path();
+    return ((dir.empty() ? fs::path(".") : dir) / "install.manifest").string();
+}
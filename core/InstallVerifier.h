@@ -0,0 +1,90 @@
+/*
+ * InstallVerifier.h
+ * A local check of the game's install folder, for when audio goes missing
+ * or the game crashes on start: which files are gone or damaged, in
+ * seconds and without Steam's network round trip.
+ *
+ * The first check records every file's size, time and hash in a manifest
+ * (install.manifest, next to settings.ini), taking the install as it is
+ * then as the truth; so does the first check after a Steam update, which
+ * changes the build id in the app manifest. Later checks compare against
+ * it. A file whose size and time still match isn't read (a different size
+ * is damage without reading it either); the rest are hashed in 4 MB blocks
+ * through memory mappings, the blocks spread over every core with
+ * RunWorkStealing, so one big archive is hashed by all of them at once.
+ * A full check hashes every file, which is what finds a file changed
+ * without its time changing (a bad sector, say).
+ *
+ * A file's hash is DigestChunk (SnapshotStore.h) of its blocks' hashes.
+ * Files that are in the folder but not in the manifest are counted and
+ * otherwise left alone.
+ */
+
+#pragma once
+
+#include "SnapshotStore.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+constexpr uint64_t installBlockSize = 4 << 20;
+
+struct InstallFile {
+    std::string path;      // Relative, '/'-separated
+    uint64_t size = 0;
+    int64_t modified = 0;  // filesystem clock ticks
+    ChunkDigest digest;
+};
+
+struct InstallManifest {
+    std::string buildId;   // Steam's build the files were recorded from; empty if unknown
+    int64_t created = 0;   // Seconds since 1970
+    uint64_t blockSize = installBlockSize;
+    std::vector<InstallFile> files;  // Sorted by path
+};
+
+struct InstallCheckOptions {
+    unsigned threads = 0;  // 0 = one per hardware thread
+    bool full = false;     // Hash every file, even those whose size and time match the manifest
+};
+
+struct InstallReport {
+    bool built = false;            // A manifest was recorded (there was none, or the build changed) instead of checked
+    std::string previousBuildId;   // The build the old manifest was for, when built because Steam updated the game
+    size_t files = 0;
+    size_t filesHashed = 0;
+    size_t filesSkipped = 0;       // Same size and time as in the manifest
+    size_t stampsRefreshed = 0;    // Hashed because the time changed, but the same bytes; the manifest takes the new time
+    uint64_t bytes = 0;
+    uint64_t bytesHashed = 0;
+    uint64_t elapsedMs = 0;
+    std::vector<std::string> missing;
+    std::vector<std::string> damaged;  // "path: what's wrong"
+    std::vector<std::string> added;    // In the folder but not the manifest
+
+    bool Ok() const { return missing.empty() && damaged.empty(); }
+};
+
+// Record every file under installDir (hashed on options.threads threads, options.full regardless)
+bool BuildInstallManifest(const std::string& installDir, const std::string& buildId, const InstallCheckOptions& options,
+                          InstallManifest& manifest, InstallReport& report, std::string& error);
+
+// Compare installDir with manifest; problems go in report, false only if the folder can't be listed.
+// Files whose bytes match at a new time get that time in manifest, so the next check can skip them
+bool VerifyInstall(const std::string& installDir, InstallManifest& manifest, const InstallCheckOptions& options,
+                   InstallReport& report, std::string& error);
+
+bool ReadInstallManifest(const std::string& path, InstallManifest& manifest, std::string& error);
+bool WriteInstallManifest(const std::string& path, const InstallManifest& manifest, std::string& error);
+
+// The whole check: verify against the manifest at manifestPath, or record one when there is none yet or
+// buildId says Steam updated the game since; the manifest is written back when anything in it changed
+bool CheckInstall(const std::string& installDir, const std::string& buildId, const std::string& manifestPath,
+                  const InstallCheckOptions& options, InstallReport& report, std::string& error);
+
+// What the check found, for a console or a message box; lists at most maxListed files of each kind
+std::string InstallReportText(const InstallReport& report, size_t maxListed = SIZE_MAX);
+
+// install.manifest, next to settings.ini
+std::string InstallManifestPath(const std::string& iniPath);
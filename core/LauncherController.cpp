@@ -0,0 +1,443 @@
+/*
+ * LauncherController.cpp
+ * "Handling controls: one row, one key, no more guessing games!"
+ */
+
+#include "LauncherController.h"
+
+#include "IniMerge.h"
+#include "TextFile.h"
+#include "Trace.h"
+
+LauncherController::LauncherController(LauncherView& view, std::function<std::string()> desktopResolution)
+    : view_(view), desktopResolution_(std::move(desktopResolution)), session_(&view.TextBox()) {
+    // Every change to the text is noted by the validator (and the journal); the check itself waits for a pause in typing
+    session_.SetListener([this](size_t start, size_t removed, std::string_view inserted) {
+        validator_.Edit(start, removed, inserted);
+        view_.ValidationDue();
+        if (journaling_ && journal_.Append(start, removed, inserted)) view_.JournalDue();
+    });
+}
+
+void LauncherController::Record(UiEvent event) {
+    if (recording_) recording_->events.push_back(std::move(event));
+}
+
+void LauncherController::Record(UiEventKind kind) {
+    UiEvent event;
+    event.kind = kind;
+    Record(std::move(event));
+}
+
+ViewAnswer LauncherController::Ask(const std::string& title, const std::string& question, bool canCancel) {
+    ViewAnswer answer = view_.Ask(title, question, canCancel);
+    UiEvent event;
+    event.kind = UiEventKind::Answer;
+    event.answer = answer;
+    Record(std::move(event));
+    return answer;
+}
+
+// Patch one document splice into the text box without it counting as typing
+void LauncherController::ApplySplice(const IniSplice& splice) {
+    updating_ = true;
+    ::ApplySplice(session_, splice);
+    updating_ = false;
+}
+
+// Bring the text box in line with doc_, rewriting only the range that differs
+void LauncherController::RefreshTextBox() {
+    MISE_TRACE_SCOPE("RefreshEditBox");
+    updating_ = true;
+    SyncEditBuffer(session_, session_.Text(), doc_.Text());
+    updating_ = false;
+}
+
+// "Never pay more than 20 pieces of eight for a parse!"
+IniDocument& LauncherController::Document() {
+    if (docStale_) {
+        doc_.Parse(session_.Text());
+        docStale_ = false;
+    }
+    return doc_;
+}
+
+// Set one key in the text and show the save reminder
+void LauncherController::UpdateSetting(const char* section, const char* key, const std::string& value) {
+    ApplySplice(Document().Set(section, key, value));
+    view_.ShowSaveReminder(true);
+}
+
+// Set the resolution and windowed keys together (they always travel as a pair)
+void LauncherController::UpdateResolution(const std::string& resolution, bool windowed) {
+    IniDocument& doc = Document();
+    if (!resolution.empty()) {
+        ApplySplice(doc.Set("display", "resolution", resolution));
+    }
+    ApplySplice(doc.Set("display", "windowed", windowed ? "1" : "0"));
+    view_.ShowSaveReminder(true);
+}
+
+// Update one setting control from doc_ (a missing or malformed key leaves it as it is)
+void LauncherController::SyncBinding(const SettingBinding& binding) {
+    if (binding.codec == SettingCodec::Resolution) {
+        const IniEntry* resolution = doc_.Find("display", "resolution");
+        bool windowed = false;
+        if (resolution && doc_.GetBool("display", "windowed", windowed)) {
+            // "You fight like a dairy farmer!" - "How appropriate, you select like a cow!"
+            view_.SetControlValue(binding, FindResolutionChoice(resolutionChoices_, doc_.Value(*resolution), windowed));
+        }
+        return;
+    }
+    int value = 0;
+    if (ReadBindingValue(binding, doc_, value)) view_.SetControlValue(binding, value);
+}
+
+// Update the control that shows section.key (keys without a control are ignored)
+void LauncherController::SyncControl(std::string_view section, std::string_view key) {
+    if (const SettingBinding* binding = FindSettingBinding(section, key)) {
+        SyncBinding(*binding);
+    }
+}
+
+void LauncherController::SyncAllControls() {
+    for (const SettingBinding& binding : settingBindings) {
+        SyncBinding(binding);
+    }
+}
+
+void LauncherController::ShowLoaded(LoadedSettings loaded) {
+    MISE_TRACE_SCOPE("ShowLoadedSettings");
+    UiEvent event;
+    event.kind = UiEventKind::Load;
+    event.text = loaded.document.Text();
+    Record(std::move(event));
+
+    {
+        EditStep step(session_, "Load");
+        if (loaded.ok) diskBaseline_ = std::move(loaded.baseline);
+        doc_ = std::move(loaded.document);
+        docStale_ = false;
+        RefreshTextBox();
+        SyncAllControls();
+    }
+    MarkClean();
+}
+
+// The text matches settings.ini again: nothing for the journal to keep
+void LauncherController::MarkClean() {
+    if (journaling_) journal_.MarkClean(session_.Text());
+}
+
+// "This is the second biggest settings loader I've ever seen!"
+void LauncherController::Load() {
+    MISE_TRACE_SCOPE("LoadSettingsToEditBox");
+    ShowLoaded(ReadSettingsForEditBox(iniPath_));
+}
+
+// "Ahoy! Someone's been rearranging the furniture!"
+void LauncherController::FileChanged() {
+    MISE_TRACE_SCOPE("ReloadChangedSettings");
+    std::string content;
+    if (!ReadTextFile(iniPath_, content)) return; // Gone; the next save puts it back
+    UiEvent event;
+    event.kind = UiEventKind::FileChanged;
+    event.text = content;
+    Record(std::move(event));
+
+    std::vector<IniKeyChange> changes;
+    if (!diskBaseline_.Update(content, changes)) {
+        return; // Exactly what we already know about (e.g. our own save)
+    }
+
+    // Hand edits to other keys in the text are kept; only the changed keys are spliced in
+    EditStep step(session_, "Reload");
+    IniDocument& doc = Document();
+    for (const IniSplice& splice : ApplyIniChanges(doc, changes)) {
+        ApplySplice(splice);
+    }
+    for (const IniKeyChange& change : changes) {
+        SyncControl(change.section, change.key);
+    }
+}
+
+void LauncherController::SetResolutions(const std::vector<DisplayMode>& resolutions) {
+    MISE_TRACE_SCOPE("FillResolutionCombo");
+    UiEvent event;
+    event.kind = UiEventKind::Resolutions;
+    for (const DisplayMode& mode : resolutions) {
+        if (!event.text.empty()) event.text += ' ';
+        event.text += mode.Resolution();
+    }
+    Record(std::move(event));
+
+    resolutionChoices_ = BuildResolutionChoices(resolutions);
+    view_.SetResolutionItems(resolutionChoices_);
+    SyncBinding(*FindSettingBinding(resolutionControlId));
+}
+
+void LauncherController::ControlChanged(int controlId) {
+    const SettingBinding* binding = FindSettingBinding(controlId);
+    if (!binding) return;
+    TraceSpan span(binding->traceName);
+    int value = view_.ControlValue(*binding);
+
+    UiEvent event;
+    event.kind = binding->widget == WidgetKind::CheckBox ? UiEventKind::Check
+               : binding->widget == WidgetKind::Slider   ? UiEventKind::Slide
+                                                         : UiEventKind::Select;
+    event.controlId = controlId;
+    event.value = value;
+    Record(std::move(event));
+
+    EditStep step(session_, binding->key); // The resolution's two keys undo together
+    if (binding->codec == SettingCodec::Resolution) {
+        if (value == autodetectResolutionIndex) {
+            // Autodetect the desktop resolution, full screen
+            UiEvent desktop;
+            desktop.kind = UiEventKind::Desktop;
+            desktop.text = desktopResolution_ ? desktopResolution_() : "";
+            UpdateResolution(desktop.text, false);
+            Record(std::move(desktop));
+        } else if (value > 0 && value < (int)resolutionChoices_.size()) {
+            UpdateResolution(resolutionChoices_[value].resolution, resolutionChoices_[value].windowed);
+        }
+        return;
+    }
+    if (value < 0) return; // Combo with nothing selected
+    UpdateSetting(binding->section, binding->key, FormatBindingValue(*binding, value));
+}
+
+void LauncherController::TextEdited(std::string_view viewText) {
+    if (updating_) return;
+    MISE_TRACE_SCOPE("EN_CHANGE");
+    if (recording_) {
+        std::string before = session_.Text();
+        TextDiff diff = ComputeTextDiff(before, viewText);
+        UiEvent event;
+        event.kind = UiEventKind::Type;
+        event.start = diff.start;
+        event.removed = diff.removed;
+        event.text = std::string(viewText.substr(diff.start, diff.inserted));
+        Record(std::move(event));
+    }
+    // Record it for undo; the parsed document needs a refresh before next use
+    session_.ViewChanged(viewText);
+    docStale_ = true;
+    view_.ShowSaveReminder(true);
+}
+
+// Before saving: if the text has values the game can't read, say which and ask whether to save anyway
+bool LauncherController::ConfirmSaveWithErrors() {
+    Validate();
+    if (validator_.ErrorCount() == 0) return true;
+    std::string message = "These settings have values the game can't read:\n\n";
+    size_t listed = 0;
+    for (const SettingDiagnostic& diagnostic : validator_.Diagnostics()) {
+        if (diagnostic.severity != SettingSeverity::Error) continue;
+        if (++listed > 5) {
+            message += "...\n";
+            break;
+        }
+        message += "Line " + std::to_string(diagnostic.line + 1) + ": " + diagnostic.message + "\n";
+    }
+    message += "\nSave anyway?";
+    return Ask("Check Settings", message, false) == ViewAnswer::Yes;
+}
+
+// Merge the text with whatever changed on disk since it was loaded, then write it.
+// False if both changed the same keys and the user chose to keep editing instead
+bool LauncherController::SaveMerged(SaveResult& saved) {
+    std::string diskBytes;
+    IniMerge merge = MergeWithDisk(iniPath_, diskBaseline_, Document(), IniConflictChoice::KeepOurs, diskBytes);
+    if (!merge.taken.empty() || !merge.conflicts.empty()) {
+        // Changed on disk behind our back; a replay has to find the same file
+        UiEvent disk;
+        disk.kind = UiEventKind::Disk;
+        disk.text = diskBytes;
+        Record(std::move(disk));
+    }
+    if (!merge.conflicts.empty()) {
+        std::string question = "These settings were also changed in settings.ini since it was loaded:\n\n" +
+                               DescribeIniConflicts(merge.conflicts) + "\nYes saves your values, No keeps the ones on disk.";
+        ViewAnswer answer = Ask("Save Settings", question, true);
+        if (answer == ViewAnswer::Cancel) return false;
+        if (answer == ViewAnswer::No) merge = MergeWithDisk(iniPath_, diskBaseline_, Document(), IniConflictChoice::TakeTheirs, diskBytes);
+    }
+
+    // What the disk changed shows up in the text too, as one undo step
+    if (!merge.taken.empty()) {
+        EditStep step(session_, "Merge");
+        for (const IniSplice& splice : ApplyIniChanges(Document(), merge.taken)) {
+            ApplySplice(splice);
+        }
+        for (const IniKeyChange& change : merge.taken) {
+            SyncControl(change.section, change.key);
+        }
+    }
+
+    saved = SaveMergedSettings(iniPath_, merge.merged, diskBytes);
+    if (saved.status != SaveStatus::Failed) diskBaseline_.Reset(normalizeWindowsNewlines(merge.merged.Text()));
+    return true;
+}
+
+// "This is the second biggest save button I've ever seen!"
+bool LauncherController::Save() {
+    MISE_TRACE_SCOPE("Command.Save");
+    Record(UiEventKind::Save);
+    return SaveText();
+}
+
+// Check, merge and write the text as it is now (Save, and applying a profile)
+bool LauncherController::SaveText() {
+    if (!ConfirmSaveWithErrors()) {
+        return false; // Keep editing; nothing was written
+    }
+    SaveResult saved;
+    if (!SaveMerged(saved)) {
+        return false; // Changed on disk too, and the user would rather look first
+    }
+    if (saved.status == SaveStatus::Failed) {
+        // settings.ini is untouched, so keep the reminder up and say what went wrong
+        view_.ShowError("Error", "Settings were not saved.\n" + saved.error);
+        return false;
+    }
+    view_.ShowSaveReminder(false);
+    MarkClean();
+    return true;
+}
+
+// "Resetting to defaults: It's like finding buried treasure!"
+void LauncherController::Reset() {
+    MISE_TRACE_SCOPE("Command.Reset");
+    Record(UiEventKind::Reset);
+    const char* defaultSettings =
+        "[localization]\r\n"
+        "language=0\r\n"
+        "[display]\r\n"
+        "windowed=0\r\n"
+        "shaders=1\r\n"
+        "resolution=3840x2160\r\n"
+        "[audio]\r\n"
+        "music=70\r\n"
+        "voice=80\r\n"
+        "sfx=70\r\n"
+        "subtitles=1\r\n";
+
+    // One step the user can take back
+    EditStep step(session_, "Reset Defaults");
+    doc_.Parse(defaultSettings);
+    docStale_ = false;
+    RefreshTextBox();
+
+    // The controls follow the defaults (English, 4K Full Screen, everything switched on)
+    SyncAllControls();
+    view_.ShowSaveReminder(true);
+}
+
+// "Wear the 4K hat today, the 1080p hat tomorrow."
+bool LauncherController::ApplyProfile(std::string_view settings) {
+    MISE_TRACE_SCOPE("Command.ApplyProfile");
+    UiEvent event;
+    event.kind = UiEventKind::Profile;
+    event.text = std::string(settings);
+    Record(std::move(event));
+
+    {
+        EditStep step(session_, "Apply Profile");
+        doc_.Parse(toWindowsNewlines(settings));
+        docStale_ = false;
+        RefreshTextBox();
+        SyncAllControls();
+    }
+    view_.ShowSaveReminder(true);
+    return SaveText();
+}
+
+// Undo or redo one step of the text's history, then bring the controls in line with the result
+void LauncherController::StepHistory(bool redo) {
+    TraceSpan span(redo ? "Command.Redo" : "Command.Undo");
+    Record(redo ? UiEventKind::Redo : UiEventKind::Undo);
+    updating_ = true;
+    bool stepped = redo ? session_.Redo() : session_.Undo();
+    updating_ = false;
+    if (!stepped) {
+        view_.Beep(); // Nothing (more) to undo or redo
+        return;
+    }
+    docStale_ = true;
+    Document();
+    SyncAllControls();
+    view_.ShowSaveReminder(true);
+}
+
+// "You fight like a dairy farmer! And you type like one, too."
+void LauncherController::Validate() {
+    MISE_TRACE_SCOPE("ValidateEditBox");
+    validator_.Revalidate(session_.Document());
+
+    size_t problems = validator_.ErrorCount() + validator_.WarningCount();
+    if (problems == 0) {
+        view_.ShowDiagnostic("", false);
+        return;
+    }
+    std::vector<SettingDiagnostic> diagnostics = validator_.Diagnostics();
+    const SettingDiagnostic* shown = &diagnostics.front();
+    for (const SettingDiagnostic& diagnostic : diagnostics) {
+        if (diagnostic.severity == SettingSeverity::Error) {
+            shown = &diagnostic;
+            break;
+        }
+    }
+    std::string text = "Line " + std::to_string(shown->line + 1) + ": " + shown->message;
+    if (problems > 1) text += "  (+" + std::to_string(problems - 1) + " more)";
+    view_.ShowDiagnostic(text, shown->severity == SettingSeverity::Error);
+}
+
+void LauncherController::StartJournal(const std::string& path) {
+    JournalContents contents;
+    std::string error;
+    // Not recorded: a replay has no journal to ask about
+    bool recover = ReadChangeJournal(path, contents, error) && contents.text != contents.base &&
+                   view_.Ask("Unsaved Changes", "The launcher was closed with changes that were never saved.\n\nPut them back?", false) ==
+                       ViewAnswer::Yes;
+    journal_.Start(path, session_.Text());
+    journaling_ = true;
+    if (recover) Recover(contents);
+}
+
+// Put a journal's edits back as one undo step; they go into the new journal like any other edit
+// "Ahoy! I've found the treasure I buried before the ship went down!"
+void LauncherController::Recover(const JournalContents& contents) {
+    MISE_TRACE_SCOPE("RecoverJournal");
+    std::string before = session_.Text();
+    std::string recovered = contents.text;
+    if (contents.base != before) {
+        // settings.ini changed since the edits were made: keep them, and whatever else changed on disk
+        IniMerge merge = MergeIniDocuments(IniDocument(contents.base), IniDocument(contents.text), Document(), IniConflictChoice::KeepOurs);
+        recovered = merge.merged.Text();
+    }
+    if (recording_) {
+        // A replay has no journal; to it, this is typing
+        TextDiff diff = ComputeTextDiff(before, recovered);
+        UiEvent event;
+        event.kind = UiEventKind::Type;
+        event.start = diff.start;
+        event.removed = diff.removed;
+        event.text = recovered.substr(diff.start, diff.inserted);
+        Record(std::move(event));
+    }
+
+    EditStep step(session_, "Recover");
+    doc_.Parse(std::move(recovered));
+    docStale_ = false;
+    RefreshTextBox();
+    SyncAllControls();
+    view_.ShowSaveReminder(true);
+}
+
+void LauncherController::CompactJournal() {
+    if (!journaling_) return;
+    std::string error;
+    journal_.Compact(session_.Text(), error);  // If it fails, the appended edits are still there and recover just as well
+}
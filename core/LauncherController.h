@@ -0,0 +1,168 @@
+/*
+ * LauncherController.h
+ * What the launcher window does when it's used, without the window. The
+ * setting controls, typing in the text box, Save, Reset Defaults, undo
+ * and redo all go through a LauncherController, which owns the text and
+ * its parse, the undo history, the validator and what settings.ini looked
+ * like on disk. It talks back through a LauncherView.
+ *
+ * MISELauncher.cpp implements the view with the real HWNDs; UiReplay.h
+ * implements it with plain fields, so a recorded session runs the same
+ * code headless. With a UiRecording attached, every interaction (and every
+ * answer the view gave) is appended to it.
+ *
+ * With a journal started, every change to the text also goes to a
+ * ChangeJournal next to settings.ini until the text is saved or reloaded,
+ * and edits a crash or a close without saving left there are offered back.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ChangeJournal.h"
+#include "EditHistory.h"
+#include "IniDiff.h"
+#include "IniDocument.h"
+#include "LauncherSettings.h"
+#include "SettingBindings.h"
+#include "SettingsValidator.h"
+#include "Startup.h"
+#include "TextFile.h"
+#include "UiRecording.h"
+
+class LauncherView {
+public:
+    virtual ~LauncherView() = default;
+
+    // The text box; the controller's own changes go in through Replace
+    virtual EditBuffer& TextBox() = 0;
+
+    // A setting control's value: check state, combo index (-1 when nothing is selected) or slider position
+    virtual int ControlValue(const SettingBinding& binding) = 0;
+    virtual void SetControlValue(const SettingBinding& binding, int value) = 0;
+
+    // New entries for the resolution combo
+    virtual void SetResolutionItems(const std::vector<ResolutionChoice>& choices) = 0;
+
+    virtual void ShowSaveReminder(bool show) = 0;
+
+    // The first problem with the text, shown above it; empty text hides the line
+    virtual void ShowDiagnostic(const std::string& text, bool isError) = 0;
+
+    // The text changed: Validate should run once typing pauses
+    virtual void ValidationDue() = 0;
+
+    // The journal grew: CompactJournal should run once typing has paused for longer
+    virtual void JournalDue() = 0;
+
+    // A yes/no question, or yes/no/cancel when canCancel
+    virtual ViewAnswer Ask(const std::string& title, const std::string& question, bool canCancel) = 0;
+
+    virtual void ShowError(const std::string& title, const std::string& message) = 0;
+
+    // Undo or redo with nothing left to step
+    virtual void Beep() = 0;
+};
+
+class LauncherController {
+public:
+    // desktopResolution answers Autodetect in the resolution combo ("WxH")
+    LauncherController(LauncherView& view, std::function<std::string()> desktopResolution);
+    LauncherController(const LauncherController&) = delete;
+    LauncherController& operator=(const LauncherController&) = delete;
+
+    void SetIniPath(std::string path) { iniPath_ = std::move(path); }
+    const std::string& IniPath() const { return iniPath_; }
+
+    // Every interaction from now on is added to recording (null to stop)
+    void SetRecording(UiRecording* recording) { recording_ = recording; }
+
+    // Show settings read by ReadSettingsForEditBox in the text box and the controls
+    void ShowLoaded(LoadedSettings loaded);
+
+    // Read settings.ini again and show it
+    void Load();
+
+    // settings.ini changed on disk: pull in only the keys that changed, keeping edits to the others
+    void FileChanged();
+
+    // The resolution combo lists these (an empty list is the fixed default one)
+    void SetResolutions(const std::vector<DisplayMode>& resolutions);
+
+    // The user changed a setting control: write its value into the text
+    void ControlChanged(int controlId);
+
+    // The user typed: viewText is the text box's whole text now
+    void TextEdited(std::string_view viewText);
+
+    // True while the controller itself is writing to the text box (its change notifications aren't typing)
+    bool UpdatingTextBox() const { return updating_; }
+
+    // Save Settings: check the text, merge with the disk, write. False if nothing was written
+    bool Save();
+
+    // Reset Defaults, as one undo step
+    void Reset();
+
+    // Show a profile's settings as one undo step and save them; false if nothing was written. Edits that
+    // weren't saved are still in the history, an undo away
+    bool ApplyProfile(std::string_view settings);
+
+    void Undo() { StepHistory(false); }
+    void Redo() { StepHistory(true); }
+
+    // Check the lines edited since last time and show the first problem (errors first)
+    void Validate();
+
+    // Keep unsaved edits in the journal at path from now on; edits a crash or a close
+    // without saving left there are offered back first (merged with settings.ini if it changed since)
+    void StartJournal(const std::string& path);
+
+    // Fold the journal's appended edits into one atomic rewrite (on a pause in typing, and on exit)
+    void CompactJournal();
+
+    // The text box's text
+    std::string Text() const { return session_.Text(); }
+
+    // The parsed text, re-parsed only if the user has typed since last time
+    IniDocument& Document();
+
+    EditSession& Session() { return session_; }
+    const SettingsValidator& Validator() const { return validator_; }
+
+private:
+    void ApplySplice(const IniSplice& splice);
+    void RefreshTextBox();
+    void UpdateSetting(const char* section, const char* key, const std::string& value);
+    void UpdateResolution(const std::string& resolution, bool windowed);
+    void SyncBinding(const SettingBinding& binding);
+    void SyncControl(std::string_view section, std::string_view key);
+    void SyncAllControls();
+    bool ConfirmSaveWithErrors();
+    bool SaveMerged(SaveResult& saved);
+    bool SaveText();
+    void StepHistory(bool redo);
+    ViewAnswer Ask(const std::string& title, const std::string& question, bool canCancel);
+    void Record(UiEvent event);
+    void Record(UiEventKind kind);
+    void MarkClean();
+    void Recover(const JournalContents& contents);
+
+    LauncherView& view_;
+    std::function<std::string()> desktopResolution_;
+    std::string iniPath_;
+    EditSession session_;
+    IniDocument doc_;
+    bool docStale_ = true;   // The user typed since the last parse
+    bool updating_ = false;  // We're writing to the text box ourselves
+    SettingsBaseline diskBaseline_;
+    SettingsValidator validator_;
+    std::vector<ResolutionChoice> resolutionChoices_ = DefaultResolutionChoices();
+    UiRecording* recording_ = nullptr;
+    ChangeJournal journal_;
+    bool journaling_ = false;
+};
@@ -0,0 +1,74 @@
+/*
+ * LauncherSettings.cpp
+ * "This is the second biggest resolution table I've ever seen!"
+ */
+
+#include "LauncherSettings.h"
+
+#include "SteamLibrary.h"
+
+namespace {
+
+// Sizes common enough to deserve a name in the combo box
+struct NamedResolution {
+    const char* name;
+    const char* resolution;
+};
+
+const NamedResolution namedResolutions[] = {
+    {"4K UHD ", "3840x2160"},
+    {"QHD/2K ", "2560x1440"},
+    {"Full HD", "1920x1080"},
+};
+
+} // namespace
+
+std::vector<ResolutionChoice> DefaultResolutionChoices() {
+    std::vector<ResolutionChoice> choices;
+    choices.push_back({"Autodetect/Recommend Resolution", "", false});
+    for (const NamedResolution& named : namedResolutions) {
+        choices.push_back({ResolutionChoiceLabel(named.resolution, false), named.resolution, false});
+        choices.push_back({ResolutionChoiceLabel(named.resolution, true), named.resolution, true});
+    }
+    return choices;
+}
+
+std::string ResolutionChoiceLabel(std::string_view resolution, bool windowed) {
+    std::string label;
+    for (const NamedResolution& named : namedResolutions) {
+        if (resolution == named.resolution) {
+            label = std::string(named.name) + " - ";
+            break;
+        }
+    }
+    label += windowed ? "Windowed    (" : "Full Screen (";
+    label.append(resolution);
+    label += ')';
+    return label;
+}
+
+int FindResolutionChoice(const std::vector<ResolutionChoice>& choices, std::string_view resolution, bool windowed) {
+    for (size_t i = autodetectResolutionIndex + 1; i < choices.size(); ++i) {
+        if (choices[i].windowed == windowed && resolution == choices[i].resolution) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+std::string GameSettingsPath(const std::string& roamingAppData) {
+    return JoinPath(JoinPath(JoinPath(roamingAppData, "LucasArts"), "The Secret of Monkey Island Special Edition"), "settings.ini");
+}
+
+std::string SteamLaunchUrl() {
+    return "steam://launch/" + std::to_string(gameAppId);
+}
+
+LaunchCommand BuildSteamLaunchCommand(const std::string& steamExe) {
+    return {steamExe, SteamLaunchUrl(), ""};
+}
+
+LaunchCommand BuildDirectLaunchCommand(const std::string& installPath, const std::string& launchOptions) {
+    // The game looks for its .pak files relative to the working directory
+    return {JoinPath(installPath, gameExecutable), LaunchOptionArguments(launchOptions), installPath};
+}
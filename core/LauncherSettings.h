@@ -0,0 +1,59 @@
+/*
+ * LauncherSettings.h
+ * What the launcher's controls mean in settings.ini terms, and how the game
+ * gets started, kept free of any window code.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Steam app id of The Secret of Monkey Island Special Edition
+constexpr int gameAppId = 32360;
+
+// The game's executable, inside its Steam install folder
+constexpr const char* gameExecutable = "MISE.exe";
+
+// settings.ini, under the Windows user's roaming AppData folder (a real one, or one inside a Proton prefix)
+std::string GameSettingsPath(const std::string& roamingAppData);
+
+// One entry of the resolution combo box
+struct ResolutionChoice {
+    std::string label;
+    std::string resolution;  // "WxH", or empty for autodetect
+    bool windowed = false;
+};
+
+// Entry 0 of every choice list is "Autodetect"; the rest are resolution/windowed pairs
+constexpr int autodetectResolutionIndex = 0;
+
+// The fixed list shown until the display-mode catalog has answered
+std::vector<ResolutionChoice> DefaultResolutionChoices();
+
+// "QHD/2K  - Windowed    (2560x1440)"; well-known sizes get their marketing name
+std::string ResolutionChoiceLabel(std::string_view resolution, bool windowed);
+
+// Languages in the order the game numbers them (language=0 is English)
+inline constexpr const char* languageNames[] = {"English", "French", "Italian", "German", "Spanish"};
+inline constexpr int languageCount = sizeof(languageNames) / sizeof(languageNames[0]);
+
+// Index of a resolution/windowed pair in choices, or -1 if it's not listed
+int FindResolutionChoice(const std::vector<ResolutionChoice>& choices, std::string_view resolution, bool windowed);
+
+// What to run to start the game: a file and its parameters, ShellExecute-style
+struct LaunchCommand {
+    std::string file;
+    std::string parameters;
+    std::string workingDirectory;  // Empty: inherit the launcher's
+};
+
+// Start the game through the Steam client at steamExe
+LaunchCommand BuildSteamLaunchCommand(const std::string& steamExe);
+
+// Start the game's executable directly from its install folder, with the user's Steam launch options
+LaunchCommand BuildDirectLaunchCommand(const std::string& installPath, const std::string& launchOptions);
+
+// steam://launch/<app id>
+std::string SteamLaunchUrl();
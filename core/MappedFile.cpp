@@ -0,0 +1,113 @@
+/*
+ * MappedFile.cpp
+ * "Why read a file when you can just look at it?"
+ */
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::Open(const std::string& path, std::string& error) {
+    return OpenRange(path, 0, SIZE_MAX, error);
+}
+
+#ifdef _WIN32
+
+bool MappedFile::OpenRange(const std::string& path, uint64_t offset, size_t length, std::string& error) {
+    Close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "Could not open " + path + " (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        error = "Could not size " + path + " (error " + std::to_string(GetLastError()) + ")";
+        CloseHandle(file);
+        return false;
+    }
+    uint64_t fileSize = static_cast<uint64_t>(size.QuadPart);
+    file_ = file;
+    size_ = offset < fileSize ? static_cast<size_t>(std::min<uint64_t>(fileSize - offset, length)) : 0;
+    open_ = true;
+    if (size_ == 0) return true; // Nothing to map
+
+    mapping_ = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    data_ = mapping_ ? static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, static_cast<DWORD>(offset >> 32),
+                                                              static_cast<DWORD>(offset), size_))
+                     : nullptr;
+    if (!data_) {
+        error = "Could not map " + path + " (error " + std::to_string(GetLastError()) + ")";
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+    data_ = nullptr;
+    mapping_ = nullptr;
+    file_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+#else
+
+bool MappedFile::OpenRange(const std::string& path, uint64_t offset, size_t length, std::string& error) {
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "Could not open " + path + " (" + std::strerror(errno) + ")";
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        error = "Could not size " + path + " (" + std::strerror(errno) + ")";
+        close(fd);
+        return false;
+    }
+    uint64_t fileSize = static_cast<uint64_t>(info.st_size);
+    size_ = offset < fileSize ? static_cast<size_t>(std::min<uint64_t>(fileSize - offset, length)) : 0;
+    if (size_ > 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(offset));
+        if (data == MAP_FAILED) {
+            error = "Could not map " + path + " (" + std::strerror(errno) + ")";
+            close(fd);
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const char*>(data);
+    }
+    close(fd); // The mapping keeps the file alive on its own
+    open_ = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+#endif
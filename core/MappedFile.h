@@ -0,0 +1,46 @@
+/*
+ * MappedFile.h
+ * A read-only memory mapping of a whole file, or of one window of it (so a
+ * file bigger than a 32-bit address space can still be read a piece at a
+ * time).
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map path read-only; an empty file opens fine with Size() == 0
+    bool Open(const std::string& path, std::string& error);
+
+    // Map at most length bytes from offset, which must be a multiple of mappingGranularity.
+    // Size() is what was mapped: less than length at the end of the file, 0 past it
+    bool OpenRange(const std::string& path, uint64_t offset, size_t length, std::string& error);
+
+    // Mapping offsets are a multiple of this (the Windows allocation granularity, a multiple of any page size)
+    static constexpr uint64_t mappingGranularity = 64 << 10;
+
+    void Close();
+
+    bool IsOpen() const { return open_; }
+    const char* Data() const { return data_; }
+    size_t Size() const { return size_; }
+    std::string_view View() const { return std::string_view(data_, size_); }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
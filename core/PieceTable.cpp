@@ -0,0 +1,153 @@
+/*
+ * PieceTable.cpp
+ * "I've got a piece of this, a piece of that... it all adds up to a settings file!"
+ */
+
+#include "PieceTable.h"
+
+#include <algorithm>
+
+namespace {
+
+// Past this many pieces, every lookup walks a long list; fold them back into one
+constexpr size_t compactPieceLimit = 1024;
+
+// Deleted and retyped text piles up in the append buffer; fold once it's mostly dead weight
+constexpr size_t compactAddedLimit = 1 << 20;
+
+} // namespace
+
+void PieceTable::Reset(std::string text) {
+    original_ = std::move(text);
+    added_.clear();
+    pieces_.clear();
+    size_ = original_.size();
+    if (size_) pieces_.push_back({false, 0, size_});
+}
+
+std::string_view PieceTable::View(const Piece& piece) const {
+    const std::string& buffer = piece.added ? added_ : original_;
+    return std::string_view(buffer).substr(piece.start, piece.length);
+}
+
+std::string PieceTable::Text() const {
+    std::string text;
+    text.reserve(size_);
+    for (const Piece& piece : pieces_) text += View(piece);
+    return text;
+}
+
+std::string PieceTable::Substr(size_t start, size_t length) const {
+    std::string text;
+    if (start >= size_) return text;
+    length = std::min(length, size_ - start);
+    text.reserve(length);
+    size_t pieceStart = 0;
+    for (const Piece& piece : pieces_) {
+        size_t pieceEnd = pieceStart + piece.length;
+        if (pieceEnd > start) {
+            size_t from = start > pieceStart ? start - pieceStart : 0;
+            size_t take = std::min(piece.length - from, length - text.size());
+            text += View(piece).substr(from, take);
+            if (text.size() == length) break;
+        }
+        pieceStart = pieceEnd;
+    }
+    return text;
+}
+
+TextDiff PieceTable::DiffTo(std::string_view after) const {
+    const size_t limit = std::min(size_, after.size());
+
+    // Common prefix: whole pieces at a time until one differs
+    size_t prefix = 0;
+    for (const Piece& piece : pieces_) {
+        std::string_view view = View(piece).substr(0, limit - prefix);
+        size_t same = 0;
+        if (after.compare(prefix, view.size(), view) == 0) {
+            same = view.size();
+        } else {
+            while (same < view.size() && view[same] == after[prefix + same]) ++same;
+        }
+        prefix += same;
+        if (same < piece.length || prefix == limit) break;
+    }
+
+    // Common suffix the same way, walking the pieces backwards and never overlapping the prefix
+    size_t suffix = 0;
+    const size_t suffixLimit = limit - prefix;
+    for (auto piece = pieces_.rbegin(); piece != pieces_.rend() && suffix < suffixLimit; ++piece) {
+        std::string_view view = View(*piece);
+        view = view.substr(view.size() - std::min(view.size(), suffixLimit - suffix));
+        if (after.compare(after.size() - suffix - view.size(), view.size(), view) == 0) {
+            suffix += view.size();
+            if (view.size() < piece->length) break;
+            continue;
+        }
+        for (size_t same = 0; same < view.size() && view[view.size() - 1 - same] == after[after.size() - 1 - suffix]; ++same) {
+            ++suffix;
+        }
+        break;
+    }
+
+    TextDiff diff;
+    diff.start = prefix;
+    diff.removed = size_ - prefix - suffix;
+    diff.inserted = after.size() - prefix - suffix;
+    return diff;
+}
+
+size_t PieceTable::SplitAt(size_t offset) {
+    size_t pieceStart = 0;
+    for (size_t i = 0; i < pieces_.size(); ++i) {
+        if (offset == pieceStart) return i;
+        size_t pieceEnd = pieceStart + pieces_[i].length;
+        if (offset < pieceEnd) {
+            Piece tail = pieces_[i];
+            size_t head = offset - pieceStart;
+            pieces_[i].length = head;
+            tail.start += head;
+            tail.length -= head;
+            pieces_.insert(pieces_.begin() + i + 1, tail);
+            return i + 1;
+        }
+        pieceStart = pieceEnd;
+    }
+    return pieces_.size();
+}
+
+void PieceTable::Replace(size_t start, size_t end, std::string_view text) {
+    start = std::min(start, size_);
+    end = std::min(std::max(end, start), size_);
+    if (start == end && text.empty()) return;
+
+    size_t first = SplitAt(start);
+    size_t last = SplitAt(end);
+    pieces_.erase(pieces_.begin() + first, pieces_.begin() + last);
+    size_ -= end - start;
+
+    if (!text.empty()) {
+        // Typing straight after the previous insertion just makes that piece longer
+        Piece* previous = first > 0 ? &pieces_[first - 1] : nullptr;
+        if (previous && previous->added && previous->start + previous->length == added_.size()) {
+            previous->length += text.size();
+        } else {
+            pieces_.insert(pieces_.begin() + first, Piece{true, added_.size(), text.size()});
+        }
+        added_ += text;
+        size_ += text.size();
+    }
+
+    if (pieces_.size() > compactPieceLimit || (added_.size() > compactAddedLimit && added_.size() > 2 * size_)) {
+        Compact();
+    }
+}
+
+size_t PieceTable::MemoryUsage() const {
+    return original_.capacity() + added_.capacity() + pieces_.capacity() * sizeof(Piece);
+}
+
+void PieceTable::Compact() {
+    Reset(Text());
+    added_.shrink_to_fit();
+}
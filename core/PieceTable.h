@@ -0,0 +1,63 @@
+/*
+ * PieceTable.h
+ * The launcher's own copy of the settings text. The loaded file is kept as
+ * one read-only string and every edit appends to a second one; the document
+ * is the list of pieces of those two strings in order. An edit touches a few
+ * pieces and never moves the rest of the text, however big it is.
+ *
+ * Typing at the end of the last insertion grows that piece instead of adding
+ * a new one, and the table folds itself back into a single piece once it
+ * gets fragmented, so long sessions stay cheap.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "EditBuffer.h"
+
+class PieceTable : public EditBuffer {
+public:
+    PieceTable() = default;
+    explicit PieceTable(std::string text) { Reset(std::move(text)); }
+
+    // Start over from text, dropping every piece and the append buffer
+    void Reset(std::string text);
+
+    std::string Text() const override;
+    void Replace(size_t start, size_t end, std::string_view text) override;
+
+    // Up to length characters from start
+    std::string Substr(size_t start, size_t length) const;
+
+    // ComputeTextDiff(Text(), after), compared piece by piece without building Text()
+    TextDiff DiffTo(std::string_view after) const;
+
+    size_t Size() const { return size_; }
+    size_t PieceCount() const { return pieces_.size(); }
+
+    // Bytes held by both buffers and the piece list
+    size_t MemoryUsage() const;
+
+    // Fold everything into one piece over a fresh original buffer
+    void Compact();
+
+private:
+    struct Piece {
+        bool added;     // In added_ rather than original_
+        size_t start;
+        size_t length;
+    };
+
+    std::string_view View(const Piece& piece) const;
+
+    // Split pieces so one begins exactly at offset; returns its index (PieceCount() at the end)
+    size_t SplitAt(size_t offset);
+
+    std::string original_;
+    std::string added_;
+    std::vector<Piece> pieces_;
+    size_t size_ = 0;
+};
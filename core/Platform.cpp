@@ -0,0 +1,367 @@
+/*
+ * Platform.cpp
+ * "You fight like a dairy farmer! ...On two operating systems."
+ */
+
+#include "Platform.h"
+
+#include "DisplayModes.h"
+#include "LauncherSettings.h"
+#include "Trace.h"
+
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <shellapi.h>
+#include <shlobj.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+
+class Win32Platform : public GamePlatform {
+public:
+    // "That's the second biggest path I've ever seen!"
+    std::string SettingsPath() override {
+        MISE_TRACE_SCOPE("GetINIPath");
+        char appdata[MAX_PATH];
+        if (SUCCEEDED(SHGetFolderPathA(NULL, CSIDL_APPDATA, NULL, 0, appdata))) {
+            return GameSettingsPath(appdata);
+        }
+        return ""; // Like a treasure chest with no gold
+    }
+
+    // From the registry; read once, since Steam doesn't move while we're running
+    bool SteamPaths(std::string& steamRoot, std::string& steamExe, std::string& error) override {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (!cachedExe_.empty()) {
+            steamRoot = cachedRoot_;
+            steamExe = cachedExe_;
+            return true;
+        }
+
+        MISE_TRACE_SCOPE("RegQueryValueExA");
+        char steamPath[MAX_PATH] = {0};
+        char steamFolder[MAX_PATH] = {0};
+        HKEY hKey;
+
+        if (RegOpenKeyExA(HKEY_CURRENT_USER, "Software\\Valve\\Steam", 0, KEY_READ, &hKey) == ERROR_SUCCESS) {
+            DWORD pathSize = sizeof(steamPath);
+            if (RegQueryValueExA(hKey, "SteamExe", nullptr, nullptr, (LPBYTE)steamPath, &pathSize) != ERROR_SUCCESS) {
+                error = "Failed to retrieve Steam path from the registry.";
+                RegCloseKey(hKey);
+                return false;
+            }
+            DWORD folderSize = sizeof(steamFolder);
+            RegQueryValueExA(hKey, "SteamPath", nullptr, nullptr, (LPBYTE)steamFolder, &folderSize);
+            RegCloseKey(hKey);
+        } else {
+            error = "Failed to open Steam registry key.";
+            return false;
+        }
+
+        if (strlen(steamPath) == 0) {
+            error = "Steam path is empty. Ensure Steam is installed.";
+            return false;
+        }
+
+        cachedExe_ = steamPath;
+        cachedRoot_ = steamFolder;
+        if (cachedRoot_.empty()) {
+            // No SteamPath value; the library files sit next to steam.exe
+            size_t slash = cachedExe_.find_last_of("\\/");
+            cachedRoot_ = slash == std::string::npos ? "" : cachedExe_.substr(0, slash);
+        }
+        steamRoot = cachedRoot_;
+        steamExe = cachedExe_;
+        return true;
+    }
+
+    // Straight from the install folder when Steam's files say where that is, through steam:// otherwise
+    // "Launching the game: It's like setting sail for Monkey Island!"
+    bool LaunchGame(std::string& error) override {
+        MISE_TRACE_SCOPE("LaunchGame");
+        std::string steamRoot, steamExe;
+        if (!SteamPaths(steamRoot, steamExe, error)) return false;
+
+        SteamAppInstall install;
+        std::string directError;
+        if (!steamRoot.empty() && locator_.Locate(steamRoot, gameAppId, install, directError)) {
+            LaunchCommand direct = BuildDirectLaunchCommand(install.installPath, ReadSteamLaunchOptions(steamRoot, gameAppId));
+            if (StartGameProcess(direct, directError)) return true;
+        }
+
+        MISE_TRACE_SCOPE("ShellExecuteA");
+        LaunchCommand command = BuildSteamLaunchCommand(steamExe);
+        HINSTANCE result = ShellExecuteA(NULL, "open", command.file.c_str(), command.parameters.c_str(), NULL, SW_SHOWNORMAL);
+
+        // Check for errors without casting to int
+        if (reinterpret_cast<intptr_t>(result) <= 32) {
+            error = "Failed to launch the game via Steam. Ensure Steam is installed and running.";
+            return false;
+        }
+        return true;
+    }
+
+    // "I'm looking for the biggest screen on this island!"
+    std::string DesktopResolution() override {
+        DEVMODEA devMode = {};
+        devMode.dmSize = sizeof(devMode);
+        if (!EnumDisplaySettingsA(NULL, ENUM_CURRENT_SETTINGS, &devMode)) return "";
+        return std::to_string(devMode.dmPelsWidth) + "x" + std::to_string(devMode.dmPelsHeight);
+    }
+
+private:
+    // Start the game executable itself, in its own folder
+    static bool StartGameProcess(const LaunchCommand& command, std::string& error) {
+        MISE_TRACE_SCOPE("CreateProcessA");
+        std::string commandLine = "\"" + command.file + "\"";
+        if (!command.parameters.empty()) commandLine += " " + command.parameters;
+
+        STARTUPINFOA startupInfo = {};
+        startupInfo.cb = sizeof(startupInfo);
+        PROCESS_INFORMATION processInfo = {};
+        if (!CreateProcessA(command.file.c_str(), &commandLine[0], NULL, NULL, FALSE, 0, NULL,
+                            command.workingDirectory.empty() ? NULL : command.workingDirectory.c_str(), &startupInfo, &processInfo)) {
+            error = "Failed to start " + command.file + " (error " + std::to_string(GetLastError()) + ").";
+            return false;
+        }
+        CloseHandle(processInfo.hThread);
+        CloseHandle(processInfo.hProcess);
+        return true;
+    }
+
+    std::mutex cacheMutex_;
+    std::string cachedRoot_, cachedExe_;
+};
+
+#elif defined(__linux__)
+
+// Where Proton's prefix keeps what a Windows user would have in %APPDATA%
+const char* const protonRoamingAppData = "drive_c/users/steamuser/AppData/Roaming";
+
+bool PathExists(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0;
+}
+
+std::string HomeFolder() {
+    const char* home = getenv("HOME");
+    if (home && *home) return home;
+    const passwd* user = getpwuid(getuid());
+    return user && user->pw_dir ? user->pw_dir : "";
+}
+
+} // namespace
+
+std::string FindOnPath(const std::string& name) {
+    const char* path = getenv("PATH");
+    std::string_view rest = path ? path : "/usr/local/bin:/usr/bin:/bin";
+    while (!rest.empty()) {
+        size_t colon = rest.find(':');
+        std::string_view folder = rest.substr(0, colon);
+        rest = colon == std::string_view::npos ? std::string_view() : rest.substr(colon + 1);
+        if (folder.empty()) continue;
+        std::string candidate = JoinPath(std::string(folder), name);
+        struct stat info;
+        if (stat(candidate.c_str(), &info) == 0 && S_ISREG(info.st_mode) && access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+    }
+    return "";
+}
+
+std::vector<std::string> SteamRootCandidates() {
+    std::string home = HomeFolder();
+    const char* dataHome = getenv("XDG_DATA_HOME");
+    std::string data = dataHome && *dataHome ? dataHome : home + "/.local/share";
+    return {home + "/.steam/steam", home + "/.steam/root", data + "/Steam",
+            home + "/.var/app/com.valvesoftware.Steam/.local/share/Steam",
+            home + "/snap/steam/common/.local/share/Steam"};
+}
+
+bool SpawnDetached(const std::vector<std::string>& argv, std::string& error) {
+    MISE_TRACE_SCOPE("SpawnDetached");
+    std::vector<char*> args;
+    for (const std::string& arg : argv) args.push_back(const_cast<char*>(arg.c_str()));
+    args.push_back(nullptr);
+
+    // The exec failure (an errno) comes back through this pipe; a successful exec just closes it
+    int status[2];
+    if (pipe2(status, O_CLOEXEC) != 0) {
+        error = std::string("Failed to start ") + args[0] + ": " + strerror(errno);
+        return false;
+    }
+    int devNull = open("/dev/null", O_RDWR | O_CLOEXEC);
+
+    pid_t child = fork();
+    if (child == 0) {
+        // Only async-signal-safe calls from here on: the launcher's other threads didn't come along
+        setsid();
+        pid_t grandchild = fork();
+        if (grandchild != 0) _exit(grandchild < 0 ? 1 : 0);
+        if (devNull >= 0) {
+            dup2(devNull, STDIN_FILENO);
+            dup2(devNull, STDOUT_FILENO);
+            dup2(devNull, STDERR_FILENO);
+        }
+        execv(args[0], args.data());
+        int execError = errno;
+        ssize_t written = write(status[1], &execError, sizeof(execError));
+        (void)written;
+        _exit(127);
+    }
+    close(status[1]);
+    if (devNull >= 0) close(devNull);
+    if (child < 0) {
+        error = std::string("Failed to start ") + args[0] + ": " + strerror(errno);
+        close(status[0]);
+        return false;
+    }
+
+    int childStatus = 0;
+    while (waitpid(child, &childStatus, 0) < 0 && errno == EINTR) {}
+    int execError = 0;
+    ssize_t got;
+    while ((got = read(status[0], &execError, sizeof(execError))) < 0 && errno == EINTR) {}
+    close(status[0]);
+
+    if (got == static_cast<ssize_t>(sizeof(execError))) {
+        error = std::string("Failed to start ") + args[0] + ": " + strerror(execError);
+        return false;
+    }
+    if (!WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0) {
+        error = std::string("Failed to start ") + args[0] + ": the process could not be created";
+        return false;
+    }
+    return true;
+}
+
+namespace {
+
+class LinuxPlatform : public GamePlatform {
+public:
+    // settings.ini in the game's Proton prefix; one that exists wins over one the game hasn't written yet
+    std::string SettingsPath() override {
+        MISE_TRACE_SCOPE("GetINIPath");
+        std::string steamRoot, steamExe, error;
+        if (!SteamPaths(steamRoot, steamExe, error) || steamRoot.empty()) return "";
+
+        std::vector<std::string> prefixes = FindProtonPrefixes(steamRoot, gameAppId);
+        for (const std::string& prefix : prefixes) {
+            std::string path = GameSettingsPath(JoinPath(prefix, protonRoamingAppData));
+            if (PathExists(path)) return path;
+        }
+        return prefixes.empty() ? "" : GameSettingsPath(JoinPath(prefixes.front(), protonRoamingAppData));
+    }
+
+    // The first Steam folder that has a steamapps/, and steam from $PATH; looked up once
+    bool SteamPaths(std::string& steamRoot, std::string& steamExe, std::string& error) override {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (!looked_) {
+            MISE_TRACE_SCOPE("FindSteam");
+            for (const std::string& candidate : SteamRootCandidates()) {
+                std::error_code ec;
+                if (!std::filesystem::is_directory(candidate + "/steamapps", ec)) continue;
+                // Resolved, so it compares equal to the same folder as libraryfolders.vdf spells it
+                std::filesystem::path resolved = std::filesystem::canonical(candidate, ec);
+                cachedRoot_ = ec ? candidate : resolved.string();
+                break;
+            }
+            cachedExe_ = FindOnPath("steam");
+            looked_ = true;
+        }
+        if (cachedRoot_.empty() && cachedExe_.empty()) {
+            error = "Steam was not found: there is no steam on PATH and no Steam folder in " + HomeFolder() + ".";
+            return false;
+        }
+        steamRoot = cachedRoot_;
+        steamExe = cachedExe_;
+        return true;
+    }
+
+    // MISE.exe is a Windows program and only Steam knows which Proton runs it, so this always goes through
+    // the client: the steam binary, or whatever handles steam:// links (the Flatpak client, for one)
+    bool LaunchGame(std::string& error) override {
+        MISE_TRACE_SCOPE("LaunchGame");
+        std::string steamRoot, steamExe;
+        if (!SteamPaths(steamRoot, steamExe, error)) return false;
+        if (!steamExe.empty()) {
+            LaunchCommand command = BuildSteamLaunchCommand(steamExe);
+            return SpawnDetached({command.file, command.parameters}, error);
+        }
+        std::string opener = FindOnPath("xdg-open");
+        if (opener.empty()) {
+            error = "Failed to launch the game: there is no steam or xdg-open on PATH.";
+            return false;
+        }
+        return SpawnDetached({opener, SteamLaunchUrl()}, error);
+    }
+
+    std::string DesktopResolution() override {
+        DisplayMode mode;
+        return CreateSystemDisplayModeProvider()->CurrentMode(mode) ? mode.Resolution() : "";
+    }
+
+private:
+    std::mutex cacheMutex_;
+    bool looked_ = false;
+    std::string cachedRoot_, cachedExe_;
+};
+
+#else
+
+class NullPlatform : public GamePlatform {
+public:
+    std::string SettingsPath() override { return ""; }
+    bool SteamPaths(std::string&, std::string&, std::string& error) override {
+        error = "Finding Steam is not supported on this platform.";
+        return false;
+    }
+    bool LaunchGame(std::string& error) override {
+        error = "Launching the game is not supported on this platform.";
+        return false;
+    }
+    std::string DesktopResolution() override { return ""; }
+};
+
+#endif
+
+} // namespace
+
+bool GamePlatform::FindGameInstall(SteamAppInstall& install, std::string& error) {
+    std::string steamRoot, steamExe;
+    if (!SteamPaths(steamRoot, steamExe, error)) return false;
+    if (steamRoot.empty()) {
+        error = "Steam's library folders could not be found.";
+        return false;
+    }
+    return locator_.Locate(steamRoot, gameAppId, install, error);
+}
+
+std::unique_ptr<GamePlatform> CreateSystemPlatform() {
+#ifdef _WIN32
+    return std::make_unique<Win32Platform>();
+#elif defined(__linux__)
+    return std::make_unique<LinuxPlatform>();
+#else
+    return std::make_unique<NullPlatform>();
+#endif
+}
@@ -0,0 +1,66 @@
+/*
+ * Platform.h
+ * The few things the launcher needs from the machine it runs on: where
+ * settings.ini is, where Steam is, how to start the game and what the
+ * desktop runs at. Everything else in core/ is the same everywhere.
+ *
+ * The Windows backend asks the shell and the registry. The Linux backend
+ * is for the game running under Proton: settings.ini lives in the game's
+ * Wine prefix (<library>/steamapps/compatdata/32360/pfx) in whichever
+ * Steam library has it, and the game is started by the local Steam client,
+ * since only Steam knows which Proton runs it.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SteamLibrary.h"
+
+class GamePlatform {
+public:
+    virtual ~GamePlatform() = default;
+
+    // settings.ini's full path (it may not exist until the game has run once); empty if there's nowhere to look
+    virtual std::string SettingsPath() = 0;
+
+    // Steam's own folder (the one with steamapps/) and the client to run; either may be empty, but not both
+    virtual bool SteamPaths(std::string& steamRoot, std::string& steamExe, std::string& error) = 0;
+
+    // Start the game; fills error instead of showing it, so every frontend can report it its own way
+    virtual bool LaunchGame(std::string& error) = 0;
+
+    // "WxH" of the primary monitor right now, or empty if it can't be read
+    virtual std::string DesktopResolution() = 0;
+
+    // Install folder lookups, cached until Steam's library files change
+    SteamAppLocator& Locator() { return locator_; }
+
+    // Where Steam installed the game (and which build), from Steam's library files
+    bool FindGameInstall(SteamAppInstall& install, std::string& error);
+
+protected:
+    SteamAppLocator locator_;
+};
+
+// The backend for this platform (Windows, Linux/Proton; one that finds nothing elsewhere)
+std::unique_ptr<GamePlatform> CreateSystemPlatform();
+
+#if defined(__linux__) && !defined(_WIN32)
+
+// The Linux backend's lookups, for the tests
+
+// Where the Steam client keeps steamapps/, most likely first: the native package (~/.steam/steam is its link to
+// the real folder), then the Flatpak and Snap packages
+std::vector<std::string> SteamRootCandidates();
+
+// name's full path from $PATH, or empty
+std::string FindOnPath(const std::string& name);
+
+// Start argv[0] (a full path) in a session of its own, with no terminal, and let go of it: the grandchild is
+// reparented to init, so nothing is ever left for us to wait for. False, with error, if it couldn't be started
+bool SpawnDetached(const std::vector<std::string>& argv, std::string& error);
+
+#endif
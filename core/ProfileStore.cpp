@@ -0,0 +1,237 @@
+/*
+ * ProfileStore.cpp
+ * "I've got a jar of dirt! I've got a jar of dirt! ...and a jar of profiles."
+ */
+
+#include "ProfileStore.h"
+
+#include "AtomicFile.h"
+#include "TextFile.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <sys/stat.h>
+
+namespace {
+
+const char storeMagic[8] = {'M', 'I', 'S', 'E', 'P', 'R', 'F', '1'};
+const uint32_t storeVersion = 1;
+const size_t headerSize = 8 + 4 * 4;  // magic, version, slot count, profile count, reserved
+const size_t slotSize = 8 + 4 * 4;    // name hash, name offset/length, settings offset/length
+
+uint32_t ReadU32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t ReadU64(const char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+void AppendU32(std::string& out, uint32_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendU64(std::string& out, uint64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Never zero, so a zero hash can mark an empty slot
+uint64_t NameHash(std::string_view name) {
+    uint64_t hash = HashContent(name);
+    return hash ? hash : 1;
+}
+
+} // namespace
+
+struct ProfileStore::Slot {
+    uint64_t hash = 0;
+    uint32_t nameOffset = 0, nameLength = 0;
+    uint32_t dataOffset = 0, dataLength = 0;
+};
+
+bool ProfileStore::Open(const std::string& path, std::string& error) {
+    MISE_TRACE_SCOPE("ProfileStore::Open");
+    Close();
+    path_ = path;
+
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return true; // No store yet, no profiles yet
+
+    // A copy rather than a mapping: Windows won't let anyone replace a file while it is mapped
+    if (!ReadFileBytes(path, data_)) {
+        error = "Could not read " + path;
+        return false;
+    }
+    const char* data = data_.data();
+    size_t size = data_.size();
+    if (size < headerSize || std::memcmp(data, storeMagic, sizeof(storeMagic)) != 0 ||
+        ReadU32(data + 8) != storeVersion) {
+        error = path + " is not a launcher profile store";
+        data_.clear();
+        return false;
+    }
+    slotCount_ = ReadU32(data + 12);
+    count_ = ReadU32(data + 16);
+    size_t tablesEnd = headerSize + slotCount_ * slotSize + count_ * 4;
+    if ((slotCount_ & (slotCount_ - 1)) != 0 || count_ > slotCount_ || tablesEnd > size) {
+        error = path + " is damaged";
+        data_.clear();
+        slotCount_ = count_ = 0;
+        return false;
+    }
+    return true;
+}
+
+void ProfileStore::Close() {
+    data_.clear();
+    slotCount_ = 0;
+    count_ = 0;
+}
+
+bool ProfileStore::ReadSlot(size_t index, Slot& slot) const {
+    const char* p = data_.data() + headerSize + index * slotSize;
+    slot.hash = ReadU64(p);
+    slot.nameOffset = ReadU32(p + 8);
+    slot.nameLength = ReadU32(p + 12);
+    slot.dataOffset = ReadU32(p + 16);
+    slot.dataLength = ReadU32(p + 20);
+    if (slot.hash == 0) return false;
+    // Don't trust spans that run off the end of the file
+    return size_t(slot.nameOffset) + slot.nameLength <= data_.size() &&
+           size_t(slot.dataOffset) + slot.dataLength <= data_.size();
+}
+
+std::vector<std::string_view> ProfileStore::Names() const {
+    std::vector<std::string_view> names;
+    names.reserve(count_);
+    const char* order = data_.data() + headerSize + slotCount_ * slotSize;
+    for (size_t i = 0; i < count_; ++i) {
+        Slot slot;
+        uint32_t index = ReadU32(order + i * 4);
+        if (index < slotCount_ && ReadSlot(index, slot)) {
+            names.emplace_back(data_.data() + slot.nameOffset, slot.nameLength);
+        }
+    }
+    return names;
+}
+
+bool ProfileStore::Find(std::string_view name, std::string_view& settings) const {
+    if (slotCount_ == 0) return false;
+    uint64_t hash = NameHash(name);
+    size_t mask = slotCount_ - 1;
+    for (size_t probe = 0; probe < slotCount_; ++probe) {
+        Slot slot;
+        size_t index = (hash + probe) & mask;
+        if (!ReadSlot(index, slot)) return false; // Empty slot ends the probe chain
+        if (slot.hash == hash && std::string_view(data_.data() + slot.nameOffset, slot.nameLength) == name) {
+            settings = std::string_view(data_.data() + slot.dataOffset, slot.dataLength);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ProfileStore::Rewrite(std::vector<std::pair<std::string, std::string>> profiles, std::string& error) {
+    std::sort(profiles.begin(), profiles.end());
+
+    // Keep the table at most half full so probe chains stay short
+    size_t slots = 8;
+    while (slots < profiles.size() * 2) slots *= 2;
+
+    size_t blobStart = headerSize + slots * slotSize + profiles.size() * 4;
+    std::vector<Slot> table(slots);
+    std::vector<uint32_t> order;
+    std::string blob;
+    for (const auto& profile : profiles) {
+        Slot slot;
+        slot.hash = NameHash(profile.first);
+        slot.nameOffset = static_cast<uint32_t>(blobStart + blob.size());
+        slot.nameLength = static_cast<uint32_t>(profile.first.size());
+        blob += profile.first;
+        slot.dataOffset = static_cast<uint32_t>(blobStart + blob.size());
+        slot.dataLength = static_cast<uint32_t>(profile.second.size());
+        blob += profile.second;
+
+        size_t index = slot.hash & (slots - 1);
+        while (table[index].hash != 0) index = (index + 1) & (slots - 1);
+        table[index] = slot;
+        order.push_back(static_cast<uint32_t>(index));
+    }
+
+    std::string out;
+    out.reserve(blobStart + blob.size());
+    out.append(storeMagic, sizeof(storeMagic));
+    AppendU32(out, storeVersion);
+    AppendU32(out, static_cast<uint32_t>(slots));
+    AppendU32(out, static_cast<uint32_t>(profiles.size()));
+    AppendU32(out, 0);
+    for (const Slot& slot : table) {
+        AppendU64(out, slot.hash);
+        AppendU32(out, slot.nameOffset);
+        AppendU32(out, slot.nameLength);
+        AppendU32(out, slot.dataOffset);
+        AppendU32(out, slot.dataLength);
+    }
+    for (uint32_t index : order) AppendU32(out, index);
+    out += blob;
+
+    if (!WriteFileAtomic(path_, out, error)) return false;
+    data_ = std::move(out);
+    slotCount_ = slots;
+    count_ = profiles.size();
+    return true;
+}
+
+bool ProfileStore::Reload(std::string& error) {
+    std::string path = path_;
+    return Open(path, error);
+}
+
+bool ProfileStore::Put(std::string_view name, std::string_view settings, std::string& error) {
+    MISE_TRACE_SCOPE("ProfileStore::Put");
+    if (name.empty()) {
+        error = "A profile needs a name";
+        return false;
+    }
+    // name and settings may be views into data_, which Reload replaces
+    std::pair<std::string, std::string> added(name, settings);
+    if (!Reload(error)) return false;
+    std::vector<std::pair<std::string, std::string>> profiles;
+    for (std::string_view existing : Names()) {
+        if (existing == added.first) continue;
+        std::string_view data;
+        Find(existing, data);
+        profiles.emplace_back(std::string(existing), std::string(data));
+    }
+    profiles.push_back(std::move(added));
+    return Rewrite(std::move(profiles), error);
+}
+
+bool ProfileStore::Remove(std::string_view name, std::string& error) {
+    std::string removed(name);
+    if (!Reload(error)) return false;
+    std::vector<std::pair<std::string, std::string>> profiles;
+    bool found = false;
+    for (std::string_view existing : Names()) {
+        std::string_view data;
+        Find(existing, data);
+        if (existing == removed) {
+            found = true;
+            continue;
+        }
+        profiles.emplace_back(std::string(existing), std::string(data));
+    }
+    if (!found) return false;
+    return Rewrite(std::move(profiles), error);
+}
+
+std::string ProfileStorePath(const std::string& iniPath) {
+    size_t slash = iniPath.find_last_of("\\/");
+    return (slash == std::string::npos ? std::string() : iniPath.substr(0, slash + 1)) + "profiles.dat";
+}
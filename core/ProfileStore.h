@@ -0,0 +1,57 @@
+/*
+ * ProfileStore.h
+ * Named settings profiles ("4K fullscreen German with shaders") in one
+ * compact file that is read in one go and looked up through a hash table,
+ * so listing or applying a profile never parses the other profiles. The
+ * file isn't kept open or mapped, so another launcher (--save-profile) or
+ * a backup restore can replace it while the window is up.
+ *
+ * File layout (little-endian):
+ *   header   "MISEPRF1", version, slot count (power of two), profile count
+ *   slots    open-addressed hash table: name hash, name span, settings span
+ *   order    slot indices sorted by name, for listing
+ *   blob     names and settings text
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ProfileStore {
+public:
+    // Read the store at path; a missing file is simply an empty store
+    bool Open(const std::string& path, std::string& error);
+    void Close();
+
+    const std::string& Path() const { return path_; }
+    size_t Count() const { return count_; }
+
+    // Profile names in alphabetical order (views into the store's copy of the file)
+    std::vector<std::string_view> Names() const;
+
+    // O(1) lookup; settings is a view into the store's copy of the file, valid until the store changes
+    bool Find(std::string_view name, std::string_view& settings) const;
+
+    // Add or replace a profile, rewriting the store atomically. The file is read again first, so
+    // profiles another process saved since Open aren't lost
+    bool Put(std::string_view name, std::string_view settings, std::string& error);
+
+    // Remove a profile; false with an empty error if it didn't exist
+    bool Remove(std::string_view name, std::string& error);
+
+private:
+    struct Slot;
+    bool ReadSlot(size_t index, Slot& slot) const;
+    bool Reload(std::string& error);
+    bool Rewrite(std::vector<std::pair<std::string, std::string>> profiles, std::string& error);
+
+    std::string path_;
+    std::string data_;  // The whole file
+    size_t slotCount_ = 0;
+    size_t count_ = 0;
+};
+
+// profiles.dat in the same folder as settings.ini
+std::string ProfileStorePath(const std::string& iniPath);
@@ -0,0 +1,71 @@
+/*
+ * SettingBindings.cpp
+ * "Every control has its key. Even the one with the monkey on it."
+ */
+
+#include "SettingBindings.h"
+
+#include <algorithm>
+
+namespace {
+
+bool EqualsIgnoreCase(std::string_view a, const char* b) {
+    if (!b || a.size() != std::char_traits<char>::length(b)) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+int ClampVolume(int value) {
+    return std::min(100, std::max(0, value));
+}
+
+} // namespace
+
+const SettingBinding* FindSettingBinding(std::string_view section, std::string_view key) {
+    for (const SettingBinding& binding : settingBindings) {
+        if (EqualsIgnoreCase(section, binding.section) &&
+            (EqualsIgnoreCase(key, binding.key) || EqualsIgnoreCase(key, binding.pairedKey))) {
+            return &binding;
+        }
+    }
+    return nullptr;
+}
+
+bool ReadBindingValue(const SettingBinding& binding, const IniDocument& doc, int& controlValue) {
+    switch (binding.codec) {
+        case SettingCodec::Bool: {
+            bool enabled = false;
+            if (!doc.GetBool(binding.section, binding.key, enabled)) return false;
+            controlValue = enabled ? 1 : 0;
+            return true;
+        }
+        case SettingCodec::EnumIndex:
+            // Out-of-range indexes are reported as-is; the combo simply shows no selection
+            return doc.GetInt(binding.section, binding.key, controlValue);
+        case SettingCodec::Volume:
+            if (!doc.GetInt(binding.section, binding.key, controlValue)) return false;
+            controlValue = ClampVolume(controlValue);
+            return true;
+        case SettingCodec::Resolution:
+            break;
+    }
+    return false;
+}
+
+std::string FormatBindingValue(const SettingBinding& binding, int controlValue) {
+    switch (binding.codec) {
+        case SettingCodec::Bool:
+            return controlValue ? "1" : "0";
+        case SettingCodec::Volume:
+            return std::to_string(ClampVolume(controlValue));
+        case SettingCodec::EnumIndex:
+        case SettingCodec::Resolution:
+            break;
+    }
+    return std::to_string(controlValue);
+}
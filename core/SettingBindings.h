@@ -0,0 +1,97 @@
+/*
+ * SettingBindings.h
+ * One row per settings control: which window control it is, which
+ * settings.ini key it edits, how the value is encoded, and where it sits.
+ * The launcher creates its controls, dispatches their notifications and
+ * refreshes them from this table, so a new setting is one new row.
+ *
+ * Control ids are dense from firstSettingControlId, which makes the id ->
+ * row lookup an array index (checked at compile time below).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "IniDocument.h"
+#include "LauncherSettings.h"
+
+// How a control's value is written to settings.ini
+enum class SettingCodec {
+    Bool,        // Check box <-> "1"/"0"
+    EnumIndex,   // Combo index <-> "0", "1", ...
+    Resolution,  // Resolution combo <-> "WxH" plus the paired "windowed" key
+    Volume,      // Slider 0-100 <-> "0".."100"
+};
+
+enum class WidgetKind {
+    CheckBox,
+    ComboBox,
+    Slider,      // Caption on the left, trackbar on the right
+};
+
+struct SettingBinding {
+    int controlId;
+    const char* section;
+    const char* key;
+    const char* pairedKey;        // Another key the control writes too (null if none)
+    SettingCodec codec;
+    WidgetKind widget;
+    const char* label;            // Check box text or slider caption (null for combos)
+    const char* const* items;     // Fixed combo entries (null when filled at run time)
+    int itemCount;
+    int x, y, width, height;      // Client-area layout
+    const char* traceName;        // Span name when the control changes
+};
+
+constexpr int firstSettingControlId = 2001;
+constexpr int languageControlId = 2001;
+constexpr int resolutionControlId = 2002;
+constexpr int subtitlesControlId = 2003;
+constexpr int shadersControlId = 2004;
+constexpr int musicVolumeControlId = 2005;
+constexpr int voiceVolumeControlId = 2006;
+constexpr int sfxVolumeControlId = 2007;
+
+inline constexpr SettingBinding settingBindings[] = {
+    {languageControlId, "localization", "language", nullptr, SettingCodec::EnumIndex, WidgetKind::ComboBox,
+     nullptr, languageNames, languageCount, 20, 340, 200, 150, "Command.Language"},
+    {resolutionControlId, "display", "resolution", "windowed", SettingCodec::Resolution, WidgetKind::ComboBox,
+     nullptr, nullptr, 0, 240, 340, 300, 230, "Command.Resolution"},
+    {subtitlesControlId, "audio", "subtitles", nullptr, SettingCodec::Bool, WidgetKind::CheckBox,
+     "Enable Subtitles", nullptr, 0, 20, 365, 200, 30, "Command.Subtitles"},
+    {shadersControlId, "display", "shaders", nullptr, SettingCodec::Bool, WidgetKind::CheckBox,
+     "Enable Shaders", nullptr, 0, 240, 365, 200, 30, "Command.Shaders"},
+    {musicVolumeControlId, "audio", "music", nullptr, SettingCodec::Volume, WidgetKind::Slider,
+     "Music", nullptr, 0, 20, 400, 235, 30, "Command.MusicVolume"},
+    {voiceVolumeControlId, "audio", "voice", nullptr, SettingCodec::Volume, WidgetKind::Slider,
+     "Voice", nullptr, 0, 272, 400, 235, 30, "Command.VoiceVolume"},
+    {sfxVolumeControlId, "audio", "sfx", nullptr, SettingCodec::Volume, WidgetKind::Slider,
+     "SFX", nullptr, 0, 525, 400, 235, 30, "Command.SfxVolume"},
+};
+inline constexpr size_t settingBindingCount = sizeof(settingBindings) / sizeof(settingBindings[0]);
+
+constexpr bool SettingBindingIdsAreDense() {
+    for (size_t i = 0; i < settingBindingCount; ++i) {
+        if (settingBindings[i].controlId != firstSettingControlId + static_cast<int>(i)) return false;
+    }
+    return true;
+}
+static_assert(SettingBindingIdsAreDense(), "settingBindings rows must be in control id order with no gaps");
+
+// Row for a control id, or null if the control isn't a setting (one bounds check, one index)
+constexpr const SettingBinding* FindSettingBinding(int controlId) {
+    size_t index = static_cast<size_t>(controlId - firstSettingControlId);
+    return controlId >= firstSettingControlId && index < settingBindingCount ? &settingBindings[index] : nullptr;
+}
+
+// Row whose key or paired key is section.key (case-insensitive), or null
+const SettingBinding* FindSettingBinding(std::string_view section, std::string_view key);
+
+// Control value stored in doc for binding (not for SettingCodec::Resolution); false if missing or malformed
+bool ReadBindingValue(const SettingBinding& binding, const IniDocument& doc, int& controlValue);
+
+// settings.ini text for a control value (not for SettingCodec::Resolution)
+std::string FormatBindingValue(const SettingBinding& binding, int controlValue);
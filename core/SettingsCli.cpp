@@ -0,0 +1,461 @@
+/*
+ * SettingsCli.cpp
+ * "I'm selling these fine leather jackets... and command-line switches."
+ */
+
+#include "SettingsCli.h"
+
+#include "AssetPrefetch.h"
+#include "ControlChannel.h"
+#include "FleetApply.h"
+#include "GameSession.h"
+#include "IniDocument.h"
+#include "InstallVerifier.h"
+#include "LauncherSettings.h"
+#include "ProfileStore.h"
+#include "SettingsSchema.h"
+#include "SettingsValidator.h"
+#include "SnapshotStore.h"
+#include "TextFile.h"
+#include "Trace.h"
+
+#include <future>
+
+namespace {
+
+const char* const usageText =
+    "Usage: MISELauncher [options]\n"
+    "  --set section.key=value   Change a setting (repeatable)\n"
+    "  --get section.key         Print a setting (repeatable)\n"
+    "  --dump                    Print the whole settings.ini\n"
+    "  --check                   Report values the game can't read (exit code 1 if any)\n"
+    "  --force                   Let --set write a value the game can't read\n"
+    "  --profile name            Apply a saved profile before any --set\n"
+    "  --save-profile name       Save the resulting settings as a profile\n"
+    "  --delete-profile name     Remove a saved profile\n"
+    "  --profiles                List saved profiles\n"
+    "  --snapshot                Back up the game's data folder (settings and saves) before any change\n"
+    "  --snapshots               List the backups\n"
+    "  --restore-snapshot id     Put the data folder back the way backup id found it\n"
+    "  --verify-install          Check the game's install folder for missing or damaged files (exit code 1 if any);\n"
+    "                            the first check records the install as it is\n"
+    "  --full                    With --verify-install: read every file, not just those whose size or time changed\n"
+    "  --prefetch                Read the game's big data files into memory first, so --launch loads faster\n"
+    "  --launch                  Start the game after applying changes\n"
+    "  --supervise               Wait for the game to exit, then print how it ran (also added to sessions.log)\n"
+    "  --restore-settings        With --supervise: put settings.ini back if the game changed it\n"
+    "  --interval ms             How often --supervise samples the game (default 2000)\n"
+    "  --fleet template.ini      Apply the template's settings to every --targets and --glob file,\n"
+    "                            printing one JSON line per file (exit code 1 if any failed)\n"
+    "  --targets file            A list of settings.ini paths, one per line (repeatable)\n"
+    "  --glob pattern            settings.ini paths matching pattern: * and ? in a name, ** for any folders (repeatable)\n"
+    "  --jobs n                  Files --fleet works on at once (default: one per CPU, at most 8), or threads\n"
+    "                            --verify-install hashes on (default: one per CPU)\n"
+    "  --control request         Send a request to the resident launcher and print its answer (repeatable),\n"
+    "                            e.g. --control \"set display.windowed=1\" --control launch\n"
+    "  --ini path                Use this settings.ini instead of the default\n"
+    "  --help                    Show this help\n";
+
+struct CliRequest {
+    std::vector<std::pair<std::string, std::string>> sets;
+    std::vector<std::string> gets;
+    std::vector<std::string> controls;
+    std::string iniPath;
+    std::string applyProfile, saveProfile, deleteProfile;
+    std::string restoreSnapshot;
+    std::string fleetTemplate;
+    FleetTargets fleetTargets;
+    unsigned jobs = 0;
+    unsigned intervalMs = SessionOptions().intervalMs;
+    bool listProfiles = false;
+    bool snapshot = false;
+    bool listSnapshots = false;
+    bool verifyInstall = false;
+    bool fullVerify = false;
+    bool prefetch = false;
+    bool dump = false;
+    bool check = false;
+    bool force = false;
+    bool launch = false;
+    bool supervise = false;
+    bool restoreSettings = false;
+    bool help = false;
+};
+
+bool ParseArgs(const std::vector<std::string>& args, CliRequest& request, std::ostream& err) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool hasValue = i + 1 < args.size();
+        if (arg == "--set" && hasValue) {
+            const std::string& assignment = args[++i];
+            size_t eq = assignment.find('=');
+            if (eq == std::string::npos) {
+                err << "--set expects section.key=value, got '" << assignment << "'\n";
+                return false;
+            }
+            if (!IsSingleLine(assignment)) {
+                err << "--set values can't have line breaks in them\n";
+                return false;
+            }
+            request.sets.emplace_back(assignment.substr(0, eq), assignment.substr(eq + 1));
+        } else if (arg == "--get" && hasValue) {
+            request.gets.push_back(args[++i]);
+        } else if (arg == "--control" && hasValue) {
+            request.controls.push_back(args[++i]);
+        } else if (arg == "--ini" && hasValue) {
+            request.iniPath = args[++i];
+        } else if (arg == "--profile" && hasValue) {
+            request.applyProfile = args[++i];
+        } else if (arg == "--save-profile" && hasValue) {
+            request.saveProfile = args[++i];
+        } else if (arg == "--delete-profile" && hasValue) {
+            request.deleteProfile = args[++i];
+        } else if (arg == "--profiles") {
+            request.listProfiles = true;
+        } else if (arg == "--restore-snapshot" && hasValue) {
+            request.restoreSnapshot = args[++i];
+        } else if (arg == "--fleet" && hasValue) {
+            request.fleetTemplate = args[++i];
+        } else if (arg == "--targets" && hasValue) {
+            request.fleetTargets.listFiles.push_back(args[++i]);
+        } else if (arg == "--glob" && hasValue) {
+            request.fleetTargets.globs.push_back(args[++i]);
+        } else if (arg == "--jobs" && hasValue) {
+            int jobs = 0;
+            if (!ParseIniInt(args[++i], jobs) || jobs < 1 || jobs > 256) {
+                err << "--jobs expects a number from 1 to 256, got '" << args[i] << "'\n";
+                return false;
+            }
+            request.jobs = static_cast<unsigned>(jobs);
+        } else if (arg == "--interval" && hasValue) {
+            int interval = 0;
+            if (!ParseIniInt(args[++i], interval) || interval < 10 || interval > 3600000) {
+                err << "--interval expects milliseconds from 10 to 3600000, got '" << args[i] << "'\n";
+                return false;
+            }
+            request.intervalMs = static_cast<unsigned>(interval);
+        } else if (arg == "--snapshot") {
+            request.snapshot = true;
+        } else if (arg == "--snapshots") {
+            request.listSnapshots = true;
+        } else if (arg == "--verify-install") {
+            request.verifyInstall = true;
+        } else if (arg == "--prefetch") {
+            request.prefetch = true;
+        } else if (arg == "--full") {
+            request.fullVerify = true;
+        } else if (arg == "--dump") {
+            request.dump = true;
+        } else if (arg == "--check") {
+            request.check = true;
+        } else if (arg == "--force") {
+            request.force = true;
+        } else if (arg == "--launch") {
+            request.launch = true;
+        } else if (arg == "--supervise") {
+            request.supervise = true;
+        } else if (arg == "--restore-settings") {
+            request.restoreSettings = true;
+        } else if (arg == "--help" || arg == "-h" || arg == "/?") {
+            request.help = true;
+        } else {
+            err << "Unknown or incomplete option '" << arg << "'\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Fleet mode works on other machines' files, so none of the single-file options apply
+int RunFleet(const CliRequest& request, std::ostream& out, std::ostream& err) {
+    if (request.fleetTargets.listFiles.empty() && request.fleetTargets.globs.empty()) {
+        err << "--fleet needs --targets or --glob to say which files\n";
+        return 2;
+    }
+    std::vector<SettingOverride> overrides;
+    std::string error;
+    if (!LoadFleetTemplate(request.fleetTemplate, overrides, error)) {
+        err << error << "\n";
+        return 2;
+    }
+    for (const SettingOverride& setting : overrides) {
+        const SettingSchema* schema = FindSettingSchema(setting.section, setting.key);
+        std::string problem;
+        if (schema && !request.force && !CheckSettingValue(*schema, setting.value, problem)) {
+            err << setting.section << "." << setting.key << "=" << setting.value << ": " << problem
+                << " (--force writes it anyway)\n";
+            return 2;
+        }
+    }
+
+    FleetSummary summary = ApplyFleet(overrides, request.fleetTargets, request.jobs, [&out](const FleetFileResult& result) {
+        out << FleetResultJson(result) << "\n";
+    });
+    out.flush();
+    err << summary.changed << " changed, " << summary.unchanged << " unchanged, " << summary.failed << " failed\n";
+    return summary.failed > 0 ? 1 : 0;
+}
+
+// The resident launcher owns settings.ini while it runs, so --control talks to it instead
+int RunControl(const CliRequest& request, std::ostream& out, std::ostream& err) {
+    ControlClient client;
+    std::string error;
+    if (!client.Connect(DefaultControlEndpoint(), error)) {
+        err << error << " (start it with MISELauncher --resident)\n";
+        return 2;
+    }
+    int result = 0;
+    for (const std::string& line : request.controls) {
+        std::string response;
+        if (!client.Request(line, response, error)) {
+            err << error << "\n";
+            return 2;
+        }
+        out << response << "\n";
+        if (response.compare(0, 2, "ok") != 0) result = 1;
+    }
+    return result;
+}
+
+// The game's install folder through the frontend's Steam lookup; says why on err if there's none
+bool FindInstall(const CliHooks& hooks, SteamAppInstall& install, std::ostream& err) {
+    std::string error;
+    if (hooks.findInstall && hooks.findInstall(install, error)) return true;
+    err << "The game's install folder could not be found: " << (error.empty() ? "finding it is not supported here" : error)
+        << "\n";
+    return false;
+}
+
+} // namespace
+
+bool SplitSettingName(const std::string& name, std::string& section, std::string& key) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos || dot == 0 || dot + 1 == name.size()) return false;
+    section = name.substr(0, dot);
+    key = name.substr(dot + 1);
+    return true;
+}
+
+bool IsCliInvocation(const std::vector<std::string>& args) {
+    for (const std::string& arg : args) {
+        if (arg.size() > 1 && (arg[0] == '-' || arg == "/?")) return true;
+    }
+    return false;
+}
+
+int RunSettingsCli(const std::vector<std::string>& args, const CliHooks& hooks, std::ostream& out, std::ostream& err) {
+    MISE_TRACE_SCOPE("RunSettingsCli");
+    CliRequest request;
+    if (!ParseArgs(args, request, err)) {
+        err << usageText;
+        return 2;
+    }
+    if (request.help) {
+        out << usageText;
+        return 0;
+    }
+    if (!request.fleetTemplate.empty()) {
+        return RunFleet(request, out, err);
+    }
+    if (!request.controls.empty()) {
+        return RunControl(request, out, err);
+    }
+
+    std::string path = request.iniPath.empty() && hooks.iniPath ? hooks.iniPath() : request.iniPath;
+    if (path.empty()) {
+        err << "settings.ini path could not be determined\n";
+        return 1;
+    }
+
+    // Backups come first: a snapshot sees the folder before this run changes it, a restore before it's read
+    std::string error;
+    SnapshotStore snapshots(SnapshotStorePath(path), SnapshotExcludedFiles(path));
+    if (request.snapshot) {
+        std::string id;
+        SnapshotStats stats;
+        if (!snapshots.Take(SnapshotSourceDir(path), id, stats, error) || !snapshots.Prune(defaultSnapshotKeep, error)) {
+            err << "Failed to back up the data folder: " << error << "\n";
+            return 1;
+        }
+        if (stats.unchanged) {
+            out << "Snapshot " << id << " still matches the data folder\n";
+        } else {
+            out << "Snapshot " << id << ": " << stats.files << " files, " << stats.filesRead << " read, "
+                << stats.bytesWritten << " bytes stored\n";
+        }
+    }
+    if (!request.restoreSnapshot.empty()) {
+        RestoreStats stats;
+        if (!snapshots.Restore(request.restoreSnapshot, SnapshotSourceDir(path), stats, error)) {
+            if (stats.failed.empty()) {
+                err << "Failed to restore " << request.restoreSnapshot << ": " << error << "\n";
+            } else {
+                err << "Restored " << stats.filesWritten << " files of " << request.restoreSnapshot << ", but " << error << "\n";
+            }
+            return 1;
+        }
+        out << "Restored " << request.restoreSnapshot << ": " << stats.filesWritten << " files written, "
+            << stats.filesUnchanged << " already matched";
+        if (stats.filesNotInSnapshot) out << ", " << stats.filesNotInSnapshot << " newer files left alone";
+        out << "\n";
+    }
+    if (request.listSnapshots) {
+        std::vector<SnapshotInfo> list;
+        if (!snapshots.List(list, error)) {
+            err << error << "\n";
+            return 1;
+        }
+        for (const SnapshotInfo& info : list) out << info.id << "  " << SnapshotLabel(info) << "\n";
+    }
+
+    // Before any launch, so a damaged install is reported instead of crashing the game
+    int status = 0;
+    if (request.verifyInstall) {
+        SteamAppInstall install;
+        if (!FindInstall(hooks, install, err)) return 1;
+        InstallCheckOptions options;
+        options.threads = request.jobs;
+        options.full = request.fullVerify;
+        InstallReport report;
+        if (!CheckInstall(install.installPath, install.buildId, InstallManifestPath(path), options, report, error)) {
+            err << "Failed to check " << install.installPath << ": " << error << "\n";
+            return 1;
+        }
+        out << InstallReportText(report);
+        if (!report.Ok() && request.launch) {
+            err << "Not launching the game with a damaged install\n";
+            return 1;
+        }
+        if (!report.Ok()) status = 1;
+    }
+
+    // Profiles live next to settings.ini and are only opened when asked for
+    ProfileStore profiles;
+    bool needsProfiles = !request.applyProfile.empty() || !request.saveProfile.empty() ||
+                         !request.deleteProfile.empty() || request.listProfiles;
+    if (needsProfiles && !profiles.Open(ProfileStorePath(path), error)) {
+        err << error << "\n";
+        return 1;
+    }
+
+    bool needsFile = !request.sets.empty() || !request.gets.empty() || request.dump || request.check ||
+                     !request.saveProfile.empty();
+    IniDocument doc;
+    bool changed = false;
+    if (!request.applyProfile.empty()) {
+        // A profile is a whole settings.ini, so it replaces the file instead of being read on top of it
+        std::string_view settings;
+        if (!profiles.Find(request.applyProfile, settings)) {
+            err << "No profile named '" << request.applyProfile << "'\n";
+            return 1;
+        }
+        doc.Parse(std::string(settings));
+        changed = true;
+    } else if (needsFile) {
+        std::string content;
+        if (!ReadTextFile(path, content)) {
+            err << "Failed to open " << path << "\n";
+            return 1;
+        }
+        doc.Parse(std::move(content));
+    }
+
+    // Apply every --set; only a real change makes us write the file back
+    for (const auto& assignment : request.sets) {
+        std::string section, key;
+        if (!SplitSettingName(assignment.first, section, key)) {
+            err << "Setting names look like section.key, got '" << assignment.first << "'\n";
+            return 2;
+        }
+        const SettingSchema* schema = FindSettingSchema(section, key);
+        std::string problem;
+        if (schema && !request.force && !CheckSettingValue(*schema, assignment.second, problem)) {
+            err << assignment.first << "=" << assignment.second << ": " << problem << " (--force writes it anyway)\n";
+            return 2;
+        }
+        changed |= doc.Set(section, key, assignment.second).changed;
+    }
+    if (changed) {
+        SaveResult saved = SaveSettingsFile(path, doc.Text());
+        if (saved.status == SaveStatus::Failed) {
+            err << "Failed to write " << path << ": " << saved.error << "\n";
+            return 1;
+        }
+    }
+
+    if (!request.saveProfile.empty() && !profiles.Put(request.saveProfile, normalizeWindowsNewlines(doc.Text()), error)) {
+        err << "Failed to save profile: " << error << "\n";
+        return 1;
+    }
+    if (!request.deleteProfile.empty() && !profiles.Remove(request.deleteProfile, error)) {
+        err << (error.empty() ? "No profile named '" + request.deleteProfile + "'" : error) << "\n";
+        return 1;
+    }
+    if (request.listProfiles) {
+        for (std::string_view name : profiles.Names()) out << name << "\n";
+    }
+
+    for (const std::string& name : request.gets) {
+        std::string section, key;
+        const IniEntry* entry = SplitSettingName(name, section, key) ? doc.Find(section, key) : nullptr;
+        if (!entry) {
+            err << name << " not found\n";
+            status = 1;
+            continue;
+        }
+        out << doc.Value(*entry) << "\n";
+    }
+    if (request.dump) {
+        out << normalizeWindowsNewlines(doc.Text());
+    }
+    if (request.check) {
+        SettingsValidator validator;
+        validator.Reset(doc.Text());
+        for (const SettingDiagnostic& diagnostic : validator.Diagnostics()) {
+            out << "line " << diagnostic.line + 1 << ": "
+                << (diagnostic.severity == SettingSeverity::Error ? "error: " : "warning: ") << diagnostic.message << "\n";
+        }
+        if (validator.ErrorCount() > 0) status = 1;
+    }
+
+    // Last before the launch, so the game finds its big files still in memory. It only saves time, so nothing
+    // here stops the launch
+    if (request.prefetch) {
+        SteamAppInstall install;
+        if (FindInstall(hooks, install, err)) {
+            std::atomic<bool> stop{false};
+            PrefetchOptions options;
+            options.progressEveryMs = 1000;
+            PrefetchProgress progress = PrefetchAssets(install.installPath, options, stop, [&out](const PrefetchProgress& now) {
+                if (now.state == PrefetchState::Running) out << "Prefetching game files: " << now.Percent() << "%" << std::endl;
+            });
+            (progress.state == PrefetchState::Failed ? err : out) << PrefetchSummary(progress) << "\n";
+        }
+    }
+
+    // Watching starts before the launch, so settings.ini as it is now is what a restore goes back to
+    std::promise<SessionSummary> sessionEnded;  // Outlives the supervisor, whose thread may still set it
+    GameSupervisor supervisor(CreateSystemProcessMonitor());
+    if (request.supervise) {
+        SessionOptions options;
+        options.exeName = gameExecutable;
+        options.iniPath = path;
+        options.intervalMs = request.intervalMs;
+        options.restoreSettings = request.restoreSettings;
+        supervisor.Start(options, [&sessionEnded](const SessionSummary& summary) { sessionEnded.set_value(summary); });
+    }
+    if (request.launch) {
+        if (!hooks.launchGame || !hooks.launchGame(error)) {
+            err << (error.empty() ? "Launching the game is not supported here" : error) << "\n";
+            return 1;
+        }
+    }
+    if (request.supervise) {
+        SessionSummary summary = sessionEnded.get_future().get();
+        out << SessionSummaryText(summary);
+        if (!summary.found) status = 1;
+        if (summary.found && !AppendSessionLog(path, summary, error)) err << error << "\n";
+    }
+    out.flush();
+    return status;
+}
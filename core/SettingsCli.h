@@ -0,0 +1,43 @@
+/*
+ * SettingsCli.h
+ * Headless command-line mode: edit settings.ini and launch without a window.
+ *
+ *   MISELauncher --set display.resolution=2560x1440 --set localization.language=3 --launch
+ *   MISELauncher --get display.windowed
+ *   MISELauncher --dump
+ *   MISELauncher --check
+ *   MISELauncher --snapshot --launch
+ *   MISELauncher --verify-install
+ *   MISELauncher --prefetch --launch
+ *   MISELauncher --launch --supervise --restore-settings
+ *   MISELauncher --fleet standard.ini --glob "C:\Users\*\AppData\Roaming\LucasArts\*\settings.ini"
+ *   MISELauncher --control "set display.windowed=1" --control launch
+ *
+ * Keys are written section.key. The read/modify/write path is the same one
+ * the GUI uses (ReadTextFile -> IniDocument -> WriteFile).
+ */
+
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "SteamLibrary.h"
+
+// Platform pieces the CLI needs but can't provide itself
+struct CliHooks {
+    std::function<std::string()> iniPath;                 // Where settings.ini lives
+    std::function<bool(std::string& error)> launchGame;   // Start the game; fill error on failure
+    std::function<bool(SteamAppInstall& install, std::string& error)> findInstall;  // Where Steam installed the game
+};
+
+// True when the arguments ask for the command-line mode instead of the GUI
+bool IsCliInvocation(const std::vector<std::string>& args);
+
+// Run the command-line mode; args excludes the program name. Returns the process exit code.
+int RunSettingsCli(const std::vector<std::string>& args, const CliHooks& hooks, std::ostream& out, std::ostream& err);
+
+// Split "section.key" at the last dot; false if either half is empty
+bool SplitSettingName(const std::string& name, std::string& section, std::string& key);
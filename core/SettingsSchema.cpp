@@ -0,0 +1,81 @@
+/*
+ * SettingsSchema.cpp
+ * "resolution=potato? I don't think so."
+ */
+
+#include "SettingsSchema.h"
+
+#include "IniDocument.h"
+
+namespace {
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// A side of WIDTHxHEIGHT: digits only, within the schema's range
+bool ParseResolutionSide(std::string_view text, const SettingSchema& schema) {
+    int value = 0;
+    return !text.empty() && text[0] != '-' && text[0] != '+' && ParseIniInt(text, value) &&
+           value >= schema.minimum && value <= schema.maximum;
+}
+
+} // namespace
+
+const SettingSchema* FindSettingSchema(std::string_view section, std::string_view key) {
+    for (const SettingSchema& schema : settingsSchema) {
+        if (EqualsIgnoreCase(section, schema.section) && EqualsIgnoreCase(key, schema.key)) return &schema;
+    }
+    return nullptr;
+}
+
+bool IsKnownSettingsSection(std::string_view section) {
+    for (const SettingSchema& schema : settingsSchema) {
+        if (EqualsIgnoreCase(section, schema.section)) return true;
+    }
+    return false;
+}
+
+bool CheckSettingValue(const SettingSchema& schema, std::string_view value, std::string& problem) {
+    int number = 0;
+    switch (schema.type) {
+        case SettingType::Bool:
+            if (value == "0" || value == "1") return true;
+            problem = std::string(schema.key) + " must be 0 or 1";
+            return false;
+
+        case SettingType::Int:
+            if (ParseIniInt(value, number) && number >= schema.minimum && number <= schema.maximum) return true;
+            problem = std::string(schema.key) + " must be a whole number from " + std::to_string(schema.minimum) +
+                      " to " + std::to_string(schema.maximum);
+            return false;
+
+        case SettingType::Enum: {
+            if (ParseIniInt(value, number) && number >= 0 && number < schema.itemCount) return true;
+            problem = std::string(schema.key) + " must be one of";
+            for (int i = 0; i < schema.itemCount; ++i) {
+                problem += (i ? ", " : " ") + std::to_string(i) + " (" + schema.items[i] + ")";
+            }
+            return false;
+        }
+
+        case SettingType::Resolution: {
+            size_t x = value.find('x');
+            if (x != std::string_view::npos && ParseResolutionSide(value.substr(0, x), schema) &&
+                ParseResolutionSide(value.substr(x + 1), schema)) {
+                return true;
+            }
+            problem = std::string(schema.key) + " must look like 1920x1080 (each side " +
+                      std::to_string(schema.minimum) + " to " + std::to_string(schema.maximum) + ")";
+            return false;
+        }
+    }
+    return true;
+}
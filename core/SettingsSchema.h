@@ -0,0 +1,50 @@
+/*
+ * SettingsSchema.h
+ * Every section and key the game reads from settings.ini, with what its
+ * value may be. SettingsValidator checks the edit box against this table,
+ * and the command line checks --set values with it.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "LauncherSettings.h"
+
+enum class SettingType {
+    Bool,        // 0 or 1
+    Int,         // Whole number in [minimum, maximum]
+    Enum,        // Index into items
+    Resolution,  // WIDTHxHEIGHT, each side in [minimum, maximum]
+};
+
+struct SettingSchema {
+    const char* section;
+    const char* key;
+    SettingType type;
+    int minimum;
+    int maximum;
+    const char* const* items;  // Enum names, in index order
+    int itemCount;
+};
+
+inline constexpr SettingSchema settingsSchema[] = {
+    {"localization", "language", SettingType::Enum, 0, languageCount - 1, languageNames, languageCount},
+    {"display", "windowed", SettingType::Bool, 0, 1, nullptr, 0},
+    {"display", "shaders", SettingType::Bool, 0, 1, nullptr, 0},
+    {"display", "resolution", SettingType::Resolution, 320, 16384, nullptr, 0},
+    {"audio", "music", SettingType::Int, 0, 100, nullptr, 0},
+    {"audio", "voice", SettingType::Int, 0, 100, nullptr, 0},
+    {"audio", "sfx", SettingType::Int, 0, 100, nullptr, 0},
+    {"audio", "subtitles", SettingType::Bool, 0, 1, nullptr, 0},
+};
+
+// The schema row for section.key (case-insensitive), or null for a key the game doesn't know
+const SettingSchema* FindSettingSchema(std::string_view section, std::string_view key);
+
+// True if some schema row lives in this section
+bool IsKnownSettingsSection(std::string_view section);
+
+// True if value is allowed; otherwise problem says why, in a sentence naming the key
+bool CheckSettingValue(const SettingSchema& schema, std::string_view value, std::string& problem);
@@ -0,0 +1,225 @@
+/*
+ * SettingsValidator.cpp
+ * "You call that a resolution? I've seen better numbers on a grog bottle!"
+ */
+
+#include "SettingsValidator.h"
+
+#include "SettingsSchema.h"
+#include "Trace.h"
+
+#include <algorithm>
+
+namespace {
+
+std::string_view TrimBlanks(std::string_view text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string_view::npos) return {};
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+void SettingsValidator::Reset(std::string_view text) {
+    MISE_TRACE_SCOPE("SettingsValidator::Reset");
+    lines_.clear();
+    gap_ = gapSize_ = 0;
+    size_t start = 0;
+    for (size_t newline = text.find('\n'); newline != std::string_view::npos; newline = text.find('\n', start)) {
+        lines_.push_back(Line(newline + 1 - start));
+        start = newline + 1;
+    }
+    lines_.push_back(Line(text.size() - start));  // The last line has no newline (and may be empty)
+    gap_ = lines_.size();
+
+    sectionNames_.assign(1, std::string());
+    sectionIds_.clear();
+    cursorLine_ = cursorStart_ = 0;
+    errorCount_ = warningCount_ = 0;
+    dirtyBegin_ = 0;
+    dirtyEnd_ = LineCount();
+    Revalidate(text);
+}
+
+size_t SettingsValidator::LineStart(size_t line) {
+    while (cursorLine_ < line) cursorStart_ += At(cursorLine_++).length;
+    while (cursorLine_ > line) cursorStart_ -= At(--cursorLine_).length;
+    return cursorStart_;
+}
+
+size_t SettingsValidator::LineAt(size_t offset, size_t& lineStart) {
+    // Walk from wherever the last edit was; typing stays on the same line or the next one
+    while (offset < cursorStart_ && cursorLine_ > 0) cursorStart_ -= At(--cursorLine_).length;
+    while (cursorLine_ + 1 < LineCount() && offset >= cursorStart_ + At(cursorLine_).length) {
+        cursorStart_ += At(cursorLine_++).length;
+    }
+    lineStart = cursorStart_;
+    return cursorLine_;
+}
+
+void SettingsValidator::MoveGap(size_t line) {
+    if (gapSize_ == 0) {
+        // Nothing to move, and moving the lines onto themselves would empty their messages
+    } else if (line < gap_) {
+        std::move_backward(lines_.begin() + line, lines_.begin() + gap_, lines_.begin() + gap_ + gapSize_);
+    } else if (line > gap_) {
+        std::move(lines_.begin() + gap_ + gapSize_, lines_.begin() + line + gapSize_, lines_.begin() + gap_);
+    }
+    gap_ = line;
+}
+
+void SettingsValidator::Edit(size_t start, size_t removed, std::string_view inserted) {
+    size_t firstStart = 0, lastStart = 0;
+    size_t first = LineAt(start, firstStart);
+    size_t last = LineAt(start + removed, lastStart);
+    size_t prefix = start - firstStart;
+    size_t suffix = lastStart + At(last).length - std::min(start + removed, lastStart + At(last).length);
+
+    // The replaced lines become prefix + inserted + suffix, split at the inserted newlines
+    uint32_t section = first > 0 ? At(first - 1).section : 0;
+    std::vector<Line> replacement;
+    size_t run = prefix, from = 0;
+    for (size_t newline = inserted.find('\n'); newline != std::string_view::npos; newline = inserted.find('\n', from)) {
+        replacement.push_back(Line(run + newline + 1 - from, section));
+        run = 0;
+        from = newline + 1;
+    }
+    replacement.push_back(Line(run + inserted.size() - from + suffix, section));
+
+    for (size_t line = first; line <= last; ++line) Count(At(line), -1);
+    size_t oldCount = last - first + 1;
+    size_t newCount = replacement.size();
+    if (oldCount == newCount) {
+        for (size_t i = 0; i < newCount; ++i) At(first + i) = std::move(replacement[i]);
+    } else {
+        // Lines come and go at the gap, so only the lines between this edit and the last one move
+        MoveGap(first);
+        gapSize_ += oldCount;
+        if (gapSize_ < newCount) {
+            size_t grow = newCount - gapSize_ + LineCount() / 8 + 16;
+            lines_.insert(lines_.begin() + gap_, grow, Line());
+            gapSize_ += grow;
+        }
+        for (Line& line : replacement) lines_[gap_++] = std::move(line);
+        gapSize_ -= newCount;
+    }
+    cursorLine_ = first;
+    cursorStart_ = firstStart;
+
+    // Merge the new lines into the dirty range, moving its ends past the edit
+    auto shift = [&](size_t line, size_t inside) {
+        if (line <= first) return line;
+        if (line > last + 1) return line + newCount - oldCount;
+        return inside;
+    };
+    if (Dirty()) {
+        dirtyBegin_ = std::min(shift(dirtyBegin_, first), first);
+        dirtyEnd_ = std::max(shift(dirtyEnd_, first + newCount), first + newCount);
+    } else {
+        dirtyBegin_ = first;
+        dirtyEnd_ = first + newCount;
+    }
+}
+
+size_t SettingsValidator::Revalidate(std::string_view text) {
+    return RevalidateLines(text.size(), [text](size_t start, size_t length) { return text.substr(start, length); });
+}
+
+size_t SettingsValidator::Revalidate(const PieceTable& text) {
+    std::string line;
+    return RevalidateLines(text.Size(), [&text, &line](size_t start, size_t length) {
+        line = text.Substr(start, length);
+        return std::string_view(line);
+    });
+}
+
+template <typename LineText>
+size_t SettingsValidator::RevalidateLines(size_t textSize, const LineText& lineText) {
+    if (!Dirty()) return 0;
+    size_t line = dirtyBegin_;
+    size_t start = LineStart(line);
+    uint32_t section = line > 0 ? At(line - 1).section : 0;
+    size_t checked = 0;
+    for (; line < LineCount() && start <= textSize; ++line) {
+        Line& current = At(line);
+        // Past the edit, a line only needs another look if the section it sits in has changed
+        if (line >= dirtyEnd_ && (current.header || current.section == section)) break;
+        CheckLine(current, lineText(start, current.length), section);
+        section = current.section;
+        start += current.length;
+        ++checked;
+    }
+    dirtyBegin_ = dirtyEnd_ = 0;
+    return checked;
+}
+
+uint32_t SettingsValidator::InternSection(std::string_view name) {
+    std::string folded(name);
+    for (char& c : folded) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    auto found = sectionIds_.find(folded);
+    if (found != sectionIds_.end()) return found->second;
+    uint32_t id = static_cast<uint32_t>(sectionNames_.size());
+    sectionNames_.push_back(folded);
+    sectionIds_.emplace(std::move(folded), id);
+    return id;
+}
+
+void SettingsValidator::CheckLine(Line& line, std::string_view text, uint32_t section) {
+    Count(line, -1);
+    line.header = false;
+    line.section = section;
+    line.severity = SettingSeverity::None;
+    line.message.clear();
+
+    std::string_view content = TrimBlanks(text);
+    auto warn = [&line](std::string message) {
+        line.severity = SettingSeverity::Warning;
+        line.message = std::move(message);
+    };
+
+    if (content.empty() || content[0] == ';' || content[0] == '#') {
+        // Blank or a comment
+    } else if (content[0] == '[') {
+        size_t close = content.find(']');
+        if (close == std::string_view::npos) {
+            warn("This section header is missing its closing ]");
+        } else {
+            std::string_view name = TrimBlanks(content.substr(1, close - 1));
+            line.header = true;
+            line.section = InternSection(name);
+            if (!IsKnownSettingsSection(name)) warn("[" + std::string(name) + "] is not a section the game reads");
+        }
+    } else if (size_t eq = content.find('='); eq == std::string_view::npos) {
+        warn("This is not a key=value line; the game ignores it");
+    } else {
+        std::string_view key = TrimBlanks(content.substr(0, eq));
+        std::string_view value = TrimBlanks(content.substr(eq + 1));
+        const std::string& sectionName = sectionNames_[section];
+        if (section == 0) {
+            warn(std::string(key) + " is outside any [section]; the game ignores it");
+        } else if (const SettingSchema* schema = FindSettingSchema(sectionName, key)) {
+            if (!CheckSettingValue(*schema, value, line.message)) line.severity = SettingSeverity::Error;
+        } else if (IsKnownSettingsSection(sectionName)) {
+            warn(std::string(key) + " is not a setting the game reads in [" + sectionName + "]");
+        }
+    }
+    Count(line, 1);
+}
+
+void SettingsValidator::Count(const Line& line, int direction) {
+    if (line.severity == SettingSeverity::Error) errorCount_ += direction;
+    if (line.severity == SettingSeverity::Warning) warningCount_ += direction;
+}
+
+std::vector<SettingDiagnostic> SettingsValidator::Diagnostics() const {
+    std::vector<SettingDiagnostic> diagnostics;
+    for (size_t line = 0; line < LineCount(); ++line) {
+        if (At(line).severity != SettingSeverity::None) {
+            diagnostics.push_back({line, At(line).severity, At(line).message});
+        }
+    }
+    return diagnostics;
+}
@@ -0,0 +1,98 @@
+/*
+ * SettingsValidator.h
+ * Checks settings.ini text against settingsSchema one line at a time and
+ * remembers the verdict for every line, so after an edit only the lines it
+ * touched are looked at again.
+ *
+ * Edits are reported as they happen (cheap: the line list is adjusted and
+ * the touched lines marked dirty); Revalidate then checks the dirty lines
+ * against the current text, whenever the caller gets round to it. A line is
+ * found from the previous edit's position, and lines are added or removed at
+ * a gap kept where the last edit was, so typing costs the same in a
+ * 20-line file and a 200,000-line one.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "PieceTable.h"
+
+enum class SettingSeverity : uint8_t {
+    None,
+    Warning,  // The game ignores it (unknown key, stray text)
+    Error,    // The game would read a bad value
+};
+
+struct SettingDiagnostic {
+    size_t line = 0;  // Zero-based
+    SettingSeverity severity = SettingSeverity::None;
+    std::string message;
+};
+
+class SettingsValidator {
+public:
+    SettingsValidator() { Reset(""); }
+
+    // Start over with text, checking every line
+    void Reset(std::string_view text);
+
+    // [start, start + removed) of the text was replaced by inserted
+    void Edit(size_t start, size_t removed, std::string_view inserted);
+
+    // Check the lines dirtied since the last call against text (the text after every Edit).
+    // Returns how many lines were checked
+    size_t Revalidate(std::string_view text);
+
+    // Same, copying only the dirty lines out of the launcher's piece table
+    size_t Revalidate(const PieceTable& text);
+
+    bool Dirty() const { return dirtyBegin_ < dirtyEnd_; }
+    size_t LineCount() const { return lines_.size() - gapSize_; }
+    size_t ErrorCount() const { return errorCount_; }
+    size_t WarningCount() const { return warningCount_; }
+
+    // Every line with a problem, in line order
+    std::vector<SettingDiagnostic> Diagnostics() const;
+
+private:
+    struct Line {
+        explicit Line(size_t length = 0, uint32_t section = 0) : length(length), section(section) {}
+
+        size_t length = 0;       // Including the newline, if any
+        uint32_t section = 0;    // Section in force on this line (interned; 0 is before any header)
+        bool header = false;     // A [section] line (section is the one it opens)
+        SettingSeverity severity = SettingSeverity::None;
+        std::string message;
+    };
+
+    template <typename LineText>
+    size_t RevalidateLines(size_t textSize, const LineText& lineText);
+
+    // Logical line -> slot in lines_, which has an unused gap where the last edit was
+    Line& At(size_t line) { return lines_[line < gap_ ? line : line + gapSize_]; }
+    const Line& At(size_t line) const { return lines_[line < gap_ ? line : line + gapSize_]; }
+    void MoveGap(size_t line);
+
+    size_t LineStart(size_t line);
+    size_t LineAt(size_t offset, size_t& lineStart);
+    uint32_t InternSection(std::string_view name);
+    void CheckLine(Line& line, std::string_view text, uint32_t section);
+    void Count(const Line& line, int direction);
+
+    std::vector<Line> lines_;
+    size_t gap_ = 0;          // Slots [gap_, gap_ + gapSize_) of lines_ are unused
+    size_t gapSize_ = 0;
+    std::vector<std::string> sectionNames_;   // Lower-cased, by id
+    std::unordered_map<std::string, uint32_t> sectionIds_;
+    size_t cursorLine_ = 0;   // A line whose start offset is known
+    size_t cursorStart_ = 0;
+    size_t dirtyBegin_ = 0;   // Lines [dirtyBegin_, dirtyEnd_) need checking
+    size_t dirtyEnd_ = 0;
+    size_t errorCount_ = 0;
+    size_t warningCount_ = 0;
+};
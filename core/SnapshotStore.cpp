@@ -0,0 +1,559 @@
+/*
+ * SnapshotStore.cpp
+ * "Dead men tell no tales, and deleted saves tell no tales either. Keep a copy."
+ */
+
+#include "SnapshotStore.h"
+
+#include "AtomicFile.h"
+#include "ChangeJournal.h"
+#include "GameSession.h"
+#include "InstallVerifier.h"
+#include "MappedFile.h"
+#include "ProfileStore.h"
+#include "TextFile.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Chunk hash: four 64-bit lanes over 32-byte stripes (the xxHash64 round), folded two ways into 128 bits
+constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t prime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+uint64_t Rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t Round(uint64_t accumulator, uint64_t input) {
+    return Rotl(accumulator + input * prime2, 31) * prime1;
+}
+
+uint64_t Avalanche(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t ReadU64(const char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Gear table for the chunker: 256 fixed pseudo-random values (splitmix64), built at compile time
+struct GearTable {
+    uint64_t values[256] = {};
+};
+
+constexpr GearTable MakeGearTable() {
+    GearTable table;
+    uint64_t state = 0x4D4953455F534E50ull;  // "MISE_SNP"
+    for (uint64_t& value : table.values) {
+        state += 0x9E3779B97F4A7C15ull;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        value = z ^ (z >> 31);
+    }
+    return table;
+}
+
+constexpr GearTable gearTable = MakeGearTable();
+
+constexpr size_t minChunkSize = 2 << 10;
+constexpr size_t maxChunkSize = 64 << 10;
+// A cut where the top 13 bits of the rolling hash are zero: one byte in 8 KiB, decided by the last 64 bytes
+constexpr uint64_t chunkCutMask = ~0ull << (64 - 13);
+
+const char manifestMagic[] = "MISESNAP 1";
+
+// Ids are UTC times, "-2", "-3"... added for a second snapshot in the same second
+bool IdBefore(const std::string& a, const std::string& b) {
+    const size_t timeLength = 15;  // 20261016-153012
+    int order = a.compare(0, timeLength, b, 0, timeLength);
+    if (order != 0) return order < 0;
+    auto suffix = [](const std::string& id) { return id.size() > timeLength + 1 ? std::atoi(id.c_str() + timeLength + 1) : 1; };
+    return suffix(a) < suffix(b);
+}
+
+bool IsTempFile(const fs::path& path) {
+    return path.extension() == ".tmp";
+}
+
+std::string FormatTime(int64_t seconds, bool local, const char* format) {
+    std::time_t time = static_cast<std::time_t>(seconds);
+    std::tm parts = {};
+#ifdef _WIN32
+    if (local) localtime_s(&parts, &time); else gmtime_s(&parts, &time);
+#else
+    if (local) localtime_r(&time, &parts); else gmtime_r(&time, &parts);
+#endif
+    char text[32];
+    size_t length = std::strftime(text, sizeof(text), format, &parts);
+    return std::string(text, length);
+}
+
+// A chunk file is either whole or missing: written aside, flushed and renamed in, with a temp name no other
+// worker (or process) writing the same chunk can share
+bool WriteChunkFile(const std::string& path, std::string_view data, std::string& error) {
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+    return WriteFileAtomic(path, data, error);
+}
+
+} // namespace
+
+std::string ChunkDigest::Hex() const {
+    char text[33];
+    std::snprintf(text, sizeof(text), "%016llx%016llx", static_cast<unsigned long long>(high),
+                  static_cast<unsigned long long>(low));
+    return std::string(text, 32);
+}
+
+bool ChunkDigest::FromHex(std::string_view hex, ChunkDigest& digest) {
+    if (hex.size() != 32) return false;
+    uint64_t halves[2] = {0, 0};
+    for (size_t i = 0; i < 32; ++i) {
+        char c = hex[i];
+        int nibble = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        if (nibble < 0) return false;
+        halves[i / 16] = (halves[i / 16] << 4) | static_cast<uint64_t>(nibble);
+    }
+    digest.high = halves[0];
+    digest.low = halves[1];
+    return true;
+}
+
+ChunkDigest DigestChunk(std::string_view data) {
+    uint64_t lanes[4] = {prime1 + prime2, prime2, 0, 0 - prime1};
+    const char* p = data.data();
+    const char* end = p + data.size();
+    for (; end - p >= 32; p += 32) {
+        for (int lane = 0; lane < 4; ++lane) lanes[lane] = Round(lanes[lane], ReadU64(p + 8 * lane));
+    }
+    if (p != end) {
+        // The tail, zero-padded to a stripe; the length folded in below tells the padding from real zeros
+        char stripe[32] = {};
+        std::memcpy(stripe, p, static_cast<size_t>(end - p));
+        for (int lane = 0; lane < 4; ++lane) lanes[lane] = Round(lanes[lane], ReadU64(stripe + 8 * lane));
+    }
+    uint64_t length = data.size();
+    ChunkDigest digest;
+    digest.low = Avalanche(Rotl(lanes[0], 1) + Rotl(lanes[1], 7) + Rotl(lanes[2], 12) + Rotl(lanes[3], 18) +
+                           length * prime5);
+    digest.high = Avalanche((lanes[0] ^ Rotl(lanes[2], 29)) * prime4 + (lanes[1] ^ Rotl(lanes[3], 41)) * prime3 +
+                            length);
+    return digest;
+}
+
+std::vector<size_t> FindChunkBoundaries(std::string_view data) {
+    std::vector<size_t> boundaries;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    size_t start = 0;
+    while (start < data.size()) {
+        size_t end = std::min(data.size(), start + maxChunkSize);
+        size_t cut = end;
+        uint64_t hash = 0;
+        for (size_t i = start + minChunkSize; i < end; ++i) {
+            hash = (hash << 1) + gearTable.values[bytes[i]];
+            if ((hash & chunkCutMask) == 0) {
+                cut = i + 1;
+                break;
+            }
+        }
+        boundaries.push_back(cut);
+        start = cut;
+    }
+    return boundaries;
+}
+
+std::string SnapshotStore::ManifestPath(const std::string& id) const {
+    return (fs::path(storeDir_) / "snapshots" / (id + ".snap")).string();
+}
+
+std::string SnapshotStore::ChunkPath(const ChunkDigest& digest) const {
+    std::string hex = digest.Hex();
+    return (fs::path(storeDir_) / "chunks" / hex.substr(0, 2) / hex).string();
+}
+
+bool SnapshotStore::IsExcluded(const std::string& path) const {
+    return std::find(excluded_.begin(), excluded_.end(), path) != excluded_.end();
+}
+
+bool SnapshotStore::StoreFile(const std::string& sourceDir, FileEntry& file, SnapshotStats& stats, std::string& error) const {
+    MappedFile mapped;
+    if (!mapped.Open((fs::path(sourceDir) / fs::path(file.path)).string(), error)) return false;
+    std::string_view data = mapped.View();
+    file.size = data.size();  // It may have changed since it was listed; the time we have is older, so it's read again next time
+    file.chunks.clear();
+    size_t start = 0;
+    for (size_t end : FindChunkBoundaries(data)) {
+        std::string_view chunk = data.substr(start, end - start);
+        ChunkDigest digest = DigestChunk(chunk);
+        std::string path = ChunkPath(digest);
+        // A chunk already in the store is kept; one of the wrong size (left cut short by a crash before chunks
+        // were flushed) is written again rather than trusted
+        std::error_code ec;
+        uintmax_t stored = fs::file_size(path, ec);
+        if (ec || stored != chunk.size()) {
+            if (!WriteChunkFile(path, chunk, error)) return false;
+            ++stats.chunksWritten;
+            stats.bytesWritten += chunk.size();
+        }
+        file.chunks.emplace_back(digest, static_cast<uint32_t>(chunk.size()));
+        start = end;
+    }
+    ++stats.filesRead;
+    stats.bytesRead += data.size();
+    return true;
+}
+
+bool SnapshotStore::Take(const std::string& sourceDir, std::string& id, SnapshotStats& stats, std::string& error,
+                         unsigned threads) {
+    MISE_TRACE_SCOPE("SnapshotStore::Take");
+    stats = SnapshotStats();
+
+    // What's there now; the store is skipped in case someone put it inside the folder it backs up
+    std::vector<FileEntry> files;
+    std::error_code ec;
+    fs::path root(sourceDir);
+    fs::path store = fs::weakly_canonical(storeDir_, ec);
+    {
+        MISE_TRACE_SCOPE("ListFiles");
+        fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+        for (; !ec && it != end; it.increment(ec)) {
+            std::error_code entryError;
+            if (it->is_directory(entryError)) {
+                if (!store.empty() && fs::weakly_canonical(it->path(), entryError) == store) it.disable_recursion_pending();
+                continue;
+            }
+            if (!it->is_regular_file(entryError) || IsTempFile(it->path())) continue;
+            FileEntry file;
+            file.path = it->path().lexically_relative(root).generic_string();
+            file.size = it->file_size(entryError);
+            file.modified = static_cast<int64_t>(it->last_write_time(entryError).time_since_epoch().count());
+            if (entryError || file.path.find('\n') != std::string::npos || IsExcluded(file.path)) continue;
+            files.push_back(std::move(file));
+        }
+    }
+    if (ec) {
+        error = "Could not list " + sourceDir + " (" + ec.message() + ")";
+        return false;
+    }
+    std::sort(files.begin(), files.end(), [](const FileEntry& a, const FileEntry& b) { return a.path < b.path; });
+
+    // Anything the newest snapshot saw at the same size and time is taken from it unread
+    std::string newest;
+    for (fs::directory_iterator it(fs::path(storeDir_) / "snapshots", ec), end; !ec && it != end; it.increment(ec)) {
+        std::string stem = it->path().stem().string();
+        if (it->path().extension() == ".snap" && (newest.empty() || IdBefore(newest, stem))) newest = stem;
+    }
+    ec.clear();
+    std::map<std::string, FileEntry> previous;
+    std::vector<FileEntry> previousFiles;
+    int64_t previousCreated = 0;
+    std::string previousError;
+    if (!newest.empty() && ReadManifest(newest, previousFiles, previousCreated, previousError)) {
+        for (FileEntry& file : previousFiles) previous.emplace(file.path, std::move(file));
+    }
+    std::vector<size_t> toRead;
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto found = previous.find(files[i].path);
+        if (found != previous.end() && found->second.size == files[i].size && found->second.modified == files[i].modified) {
+            files[i].chunks = std::move(found->second.chunks);
+            ++stats.filesSkipped;
+        } else {
+            toRead.push_back(i);
+        }
+    }
+
+    if (!newest.empty() && toRead.empty() && files.size() == previous.size()) {
+        id = newest;
+        stats.files = files.size();
+        for (const FileEntry& file : files) stats.bytes += file.size;
+        stats.unchanged = true;
+        return true;
+    }
+
+    // Chunk and hash the rest in parallel; each worker takes the next file until none are left
+    unsigned workers = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    workers = static_cast<unsigned>(std::min<size_t>(workers, toRead.size()));
+    std::vector<SnapshotStats> workerStats(std::max(1u, workers));
+    std::vector<std::string> workerErrors(workerStats.size());
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    auto work = [&](unsigned worker) {
+        MISE_TRACE_SCOPE("SnapshotWorker");
+        for (size_t index = next++; index < toRead.size() && !failed; index = next++) {
+            if (!StoreFile(sourceDir, files[toRead[index]], workerStats[worker], workerErrors[worker])) {
+                failed = true;
+            }
+        }
+    };
+    if (workers <= 1) {
+        work(0);
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned worker = 0; worker < workers; ++worker) pool.emplace_back(work, worker);
+        for (std::thread& thread : pool) thread.join();
+    }
+    for (size_t worker = 0; worker < workerStats.size(); ++worker) {
+        if (!workerErrors[worker].empty()) {
+            error = workerErrors[worker];
+            return false;
+        }
+        stats.filesRead += workerStats[worker].filesRead;
+        stats.bytesRead += workerStats[worker].bytesRead;
+        stats.chunksWritten += workerStats[worker].chunksWritten;
+        stats.bytesWritten += workerStats[worker].bytesWritten;
+    }
+
+    // The manifest goes in last: a snapshot exists only once all of its chunks do
+    int64_t created = static_cast<int64_t>(std::time(nullptr));
+    std::string baseId = FormatTime(created, false, "%Y%m%d-%H%M%S");
+    id = baseId;
+    for (int suffix = 2; fs::exists(ManifestPath(id), ec); ++suffix) id = baseId + "-" + std::to_string(suffix);
+
+    std::string manifest = std::string(manifestMagic) + "\ncreated " + std::to_string(created) + "\n";
+    for (const FileEntry& file : files) {
+        stats.files++;
+        stats.bytes += file.size;
+        manifest += "file " + std::to_string(file.size) + " " + std::to_string(file.modified) + " " +
+                    std::to_string(file.chunks.size()) + " " + file.path + "\n";
+        for (const auto& chunk : file.chunks) manifest += chunk.first.Hex() + " " + std::to_string(chunk.second) + "\n";
+    }
+    fs::create_directories(fs::path(ManifestPath(id)).parent_path(), ec);
+    if (!WriteFileAtomic(ManifestPath(id), manifest, error)) return false;
+    stats.bytesWritten += manifest.size();
+    return true;
+}
+
+bool SnapshotStore::ReadManifest(const std::string& id, std::vector<FileEntry>& files, int64_t& created,
+                                 std::string& error) const {
+    std::string content;
+    if (!ReadFileBytes(ManifestPath(id), content)) {
+        error = "There is no snapshot named " + id;
+        return false;
+    }
+    std::istringstream in(content);
+    std::string line, word;
+    std::getline(in, line);
+    if (line != manifestMagic || !(in >> word >> created) || word != "created") {
+        error = "Snapshot " + id + " is not in a format this launcher reads";
+        return false;
+    }
+    files.clear();
+    while (in >> word) {
+        FileEntry file;
+        size_t chunkCount = 0;
+        if (word != "file" || !(in >> file.size >> file.modified >> chunkCount) || in.get() != ' ' ||
+            !std::getline(in, file.path)) {
+            error = "Snapshot " + id + " is damaged";
+            return false;
+        }
+        file.chunks.reserve(chunkCount);
+        for (size_t i = 0; i < chunkCount; ++i) {
+            std::string hex;
+            uint32_t length = 0;
+            ChunkDigest digest;
+            if (!(in >> hex >> length) || !ChunkDigest::FromHex(hex, digest)) {
+                error = "Snapshot " + id + " is damaged";
+                return false;
+            }
+            file.chunks.emplace_back(digest, length);
+        }
+        files.push_back(std::move(file));
+    }
+    return true;
+}
+
+bool SnapshotStore::ReadChunk(const ChunkDigest& digest, uint32_t length, std::string& data, std::string& error) const {
+    if (!ReadFileBytes(ChunkPath(digest), data)) {
+        error = "The backup is missing a piece (" + digest.Hex() + ")";
+        return false;
+    }
+    if (data.size() != length || DigestChunk(data) != digest) {
+        error = "A piece of the backup is damaged (" + digest.Hex() + ")";
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotStore::List(std::vector<SnapshotInfo>& snapshots, std::string& error) const {
+    MISE_TRACE_SCOPE("SnapshotStore::List");
+    snapshots.clear();
+    std::error_code ec;
+    fs::path dir = fs::path(storeDir_) / "snapshots";
+    if (!fs::exists(dir, ec)) return true;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != ".snap") continue;
+        SnapshotInfo info;
+        info.id = it->path().stem().string();
+        std::vector<FileEntry> files;
+        std::string manifestError;
+        if (!ReadManifest(info.id, files, info.created, manifestError)) continue;  // Listed by what can be restored
+        info.files = files.size();
+        for (const FileEntry& file : files) info.bytes += file.size;
+        snapshots.push_back(std::move(info));
+    }
+    if (ec) {
+        error = "Could not list " + dir.string() + " (" + ec.message() + ")";
+        return false;
+    }
+    std::sort(snapshots.begin(), snapshots.end(),
+              [](const SnapshotInfo& a, const SnapshotInfo& b) { return IdBefore(b.id, a.id); });
+    return true;
+}
+
+bool SnapshotStore::Restore(const std::string& id, const std::string& targetDir, RestoreStats& stats,
+                            std::string& error) const {
+    MISE_TRACE_SCOPE("SnapshotStore::Restore");
+    stats = RestoreStats();
+    std::vector<FileEntry> files;
+    int64_t created = 0;
+    if (!ReadManifest(id, files, created, error)) return false;
+    // Snapshots taken before a file was excluded still have it
+    files.erase(std::remove_if(files.begin(), files.end(), [this](const FileEntry& file) { return IsExcluded(file.path); }),
+                files.end());
+
+    // Put every file together (and check every chunk) before touching the folder. The data folder
+    // is settings and saves, small enough to hold in memory at once
+    std::vector<std::string> contents(files.size());
+    std::string chunk;
+    for (size_t i = 0; i < files.size(); ++i) {
+        contents[i].reserve(files[i].size);
+        for (const auto& piece : files[i].chunks) {
+            if (!ReadChunk(piece.first, piece.second, chunk, error)) return false;
+            contents[i] += chunk;
+        }
+    }
+
+    // Then write every changed file aside; if one can't be (a full disk), the staged ones go and nothing changed
+    std::vector<std::string> staged(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        fs::path target = fs::path(targetDir) / fs::path(files[i].path);
+        std::string current;
+        std::error_code ec;
+        if (ReadFileBytes(target.string(), current) && current == contents[i]) continue;
+        fs::create_directories(target.parent_path(), ec);
+        if (!StageFileAtomic(target.string(), contents[i], staged[i], error)) {
+            error = files[i].path + ": " + error;
+            for (const std::string& path : staged) {
+                if (!path.empty()) fs::remove(path, ec);
+            }
+            return false;
+        }
+    }
+
+    // Now each file is one rename; one that fails doesn't stop the others
+    std::unordered_set<std::string> known;
+    for (size_t i = 0; i < files.size(); ++i) {
+        fs::path target = fs::path(targetDir) / fs::path(files[i].path);
+        known.insert(files[i].path);
+        std::error_code ec;
+        if (staged[i].empty()) {
+            ++stats.filesUnchanged;
+        } else {
+            std::string fileError;
+            if (!CommitStagedFile(staged[i], target.string(), fileError)) {
+                stats.failed.push_back(files[i].path + ": " + fileError);
+                continue;
+            }
+            ++stats.filesWritten;
+        }
+        // Back to the time it had, so the next snapshot knows the file without reading it
+        fs::last_write_time(target, fs::file_time_type(fs::file_time_type::duration(files[i].modified)), ec);
+    }
+
+    std::error_code ec;
+    fs::path root(targetDir);
+    for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end; !ec && it != end;
+         it.increment(ec)) {
+        std::error_code entryError;
+        std::string path = it->path().lexically_relative(root).generic_string();
+        if (it->is_regular_file(entryError) && !IsTempFile(it->path()) && !known.count(path) && !IsExcluded(path)) {
+            ++stats.filesNotInSnapshot;
+        }
+    }
+    if (!stats.failed.empty()) {
+        error = std::to_string(stats.failed.size()) + " of " + std::to_string(files.size()) +
+                " files could not be put back:";
+        for (const std::string& failure : stats.failed) error += "\n" + failure;
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotStore::Prune(size_t keep, std::string& error) {
+    MISE_TRACE_SCOPE("SnapshotStore::Prune");
+    std::vector<SnapshotInfo> snapshots;
+    if (!List(snapshots, error)) return false;
+    if (snapshots.size() <= keep) return true;
+
+    std::error_code ec;
+    for (size_t i = keep; i < snapshots.size(); ++i) fs::remove(ManifestPath(snapshots[i].id), ec);
+
+    std::unordered_set<std::string> referenced;
+    for (size_t i = 0; i < keep; ++i) {
+        std::vector<FileEntry> files;
+        int64_t created = 0;
+        if (!ReadManifest(snapshots[i].id, files, created, error)) return false;
+        for (const FileEntry& file : files) {
+            for (const auto& chunk : file.chunks) referenced.insert(chunk.first.Hex());
+        }
+    }
+    fs::path chunks = fs::path(storeDir_) / "chunks";
+    std::vector<fs::path> unused;
+    for (fs::recursive_directory_iterator it(chunks, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code entryError;
+        if (it->is_regular_file(entryError) && !referenced.count(it->path().filename().string())) unused.push_back(it->path());
+    }
+    for (const fs::path& path : unused) fs::remove(path, ec);
+    return true;
+}
+
+std::string SnapshotSourceDir(const std::string& iniPath) {
+    fs::path dir = fs::path(iniPath).parent_path();
+    return dir.empty() ? "." : dir.string();
+}
+
+std::vector<std::string> SnapshotExcludedFiles(const std::string& iniPath) {
+    std::vector<std::string> excluded;
+    for (const std::string& path : {ProfileStorePath(iniPath), ChangeJournalPath(iniPath), InstallManifestPath(iniPath),
+                                    SessionLogPath(iniPath)}) {
+        excluded.push_back(fs::path(path).filename().generic_string());
+    }
+    return excluded;
+}
+
+std::string SnapshotStorePath(const std::string& iniPath) {
+    fs::path dataDir = fs::path(SnapshotSourceDir(iniPath));
+    fs::path parent = dataDir.parent_path();
+    if (parent.empty() || parent == dataDir) return (dataDir / "MISELauncher Snapshots").string();
+    return (parent / "MISELauncher Snapshots").string();
+}
+
+std::string SnapshotLabel(const SnapshotInfo& snapshot) {
+    return FormatTime(snapshot.created, true, "%Y-%m-%d %H:%M") + "  " + std::to_string(snapshot.files) +
+           (snapshot.files == 1 ? " file, " : " files, ") + FormatBytes(snapshot.bytes);
+}
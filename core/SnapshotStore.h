@@ -0,0 +1,128 @@
+/*
+ * SnapshotStore.h
+ * Backups of the game's data folder (settings.ini and the save games next to
+ * it), taken before launch and restorable later.
+ *
+ * Files are cut into content-defined chunks (so an edit in the middle of a
+ * save only changes the chunks around it) and every chunk is stored once,
+ * named by a hash of its bytes. A snapshot is then just a small manifest:
+ * which files, their size and modification time, and their chunks. Files
+ * whose size and time match the previous snapshot aren't read at all, the
+ * rest are chunked and hashed on several threads. A folder that hasn't
+ * changed since the last snapshot costs a directory listing and makes no
+ * new snapshot at all.
+ *
+ * Store layout:
+ *   chunks/ab/ab12...ef    one file per chunk, named by its 128-bit hash
+ *   snapshots/<id>.snap    one manifest per snapshot (text)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Content address of a chunk
+struct ChunkDigest {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    bool operator==(const ChunkDigest& other) const { return high == other.high && low == other.low; }
+    bool operator!=(const ChunkDigest& other) const { return !(*this == other); }
+    std::string Hex() const;
+    static bool FromHex(std::string_view hex, ChunkDigest& digest);
+};
+
+ChunkDigest DigestChunk(std::string_view data);
+
+// Content-defined chunk boundaries: the end offset of each chunk of data (2 KiB to 64 KiB, about 8 KiB on average)
+std::vector<size_t> FindChunkBoundaries(std::string_view data);
+
+// What a snapshot did, for the status line and the benchmark
+struct SnapshotStats {
+    size_t files = 0;
+    size_t filesRead = 0;      // Changed since the previous snapshot (or new), so chunked and hashed
+    size_t filesSkipped = 0;   // Same size and time as in the previous snapshot
+    uint64_t bytes = 0;        // Total size of the folder
+    uint64_t bytesRead = 0;
+    size_t chunksWritten = 0;  // Chunks the store didn't have yet
+    uint64_t bytesWritten = 0;
+    bool unchanged = false;    // Nothing changed since the previous snapshot, which stands in for this one
+};
+
+struct SnapshotInfo {
+    std::string id;            // "20261016-153012", UTC; sorts by age
+    int64_t created = 0;       // Seconds since 1970
+    size_t files = 0;
+    uint64_t bytes = 0;
+};
+
+struct RestoreStats {
+    size_t filesWritten = 0;
+    size_t filesUnchanged = 0;
+    size_t filesNotInSnapshot = 0;  // Present in the folder now, left alone
+    std::vector<std::string> failed;  // "path: why", for files that couldn't be put back
+};
+
+// Snapshots kept by the launcher; older ones are pruned after each new one
+constexpr size_t defaultSnapshotKeep = 30;
+
+class SnapshotStore {
+public:
+    // Files at the 'excluded' relative paths ('/'-separated) are never backed up or put back
+    explicit SnapshotStore(std::string storeDir, std::vector<std::string> excluded = {})
+        : storeDir_(std::move(storeDir)), excluded_(std::move(excluded)) {}
+
+    const std::string& Dir() const { return storeDir_; }
+
+    // Snapshot every file under sourceDir on up to 'threads' threads (0 = one per hardware thread).
+    // If nothing changed since the newest snapshot, no new one is made and id is the newest's
+    bool Take(const std::string& sourceDir, std::string& id, SnapshotStats& stats, std::string& error,
+              unsigned threads = 0);
+
+    // Every snapshot, newest first; a store that doesn't exist yet is simply empty
+    bool List(std::vector<SnapshotInfo>& snapshots, std::string& error) const;
+
+    // Put the files of snapshot id back under targetDir. Every chunk is checked and every changed file
+    // written aside before any is replaced, so a bad backup or a full disk changes nothing; a file that then
+    // can't be replaced (another program has it open) is listed in stats.failed and the rest still are.
+    // Files the snapshot doesn't know about are left alone
+    bool Restore(const std::string& id, const std::string& targetDir, RestoreStats& stats, std::string& error) const;
+
+    // Keep the newest 'keep' snapshots and delete the chunks nothing refers to any more
+    bool Prune(size_t keep, std::string& error);
+
+private:
+    struct FileEntry {
+        std::string path;      // Relative, '/'-separated
+        uint64_t size = 0;
+        int64_t modified = 0;  // filesystem clock ticks
+        std::vector<std::pair<ChunkDigest, uint32_t>> chunks;  // Digest and length
+    };
+
+    std::string ManifestPath(const std::string& id) const;
+    std::string ChunkPath(const ChunkDigest& digest) const;
+    bool ReadManifest(const std::string& id, std::vector<FileEntry>& files, int64_t& created, std::string& error) const;
+    bool ReadChunk(const ChunkDigest& digest, uint32_t length, std::string& data, std::string& error) const;
+    bool StoreFile(const std::string& sourceDir, FileEntry& file, SnapshotStats& stats, std::string& error) const;
+    bool IsExcluded(const std::string& path) const;
+
+    std::string storeDir_;
+    std::vector<std::string> excluded_;
+};
+
+// "MISELauncher Snapshots", beside the game's data folder (so snapshots never snapshot themselves)
+std::string SnapshotStorePath(const std::string& iniPath);
+
+// The folder that holds settings.ini and the saves
+std::string SnapshotSourceDir(const std::string& iniPath);
+
+// The launcher's own files in that folder (profiles, the unsaved-changes journal, the install manifest,
+// the session log), relative to it. Snapshots leave them out: an old copy put back would be wrong, and
+// the launcher may have them open
+std::vector<std::string> SnapshotExcludedFiles(const std::string& iniPath);
+
+// "2026-10-16 17:30  12 files, 3.4 MB", in local time
+std::string SnapshotLabel(const SnapshotInfo& snapshot);
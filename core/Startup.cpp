@@ -0,0 +1,48 @@
+/*
+ * Startup.cpp
+ * "Weeeeell, I'll just do it all at once then!"
+ */
+
+#include "Startup.h"
+
+#include "LauncherSettings.h"
+#include "TextFile.h"
+
+LoadedSettings ReadSettingsForEditBox(const std::string& path) {
+    LoadedSettings loaded;
+    std::string content;
+    loaded.ok = !path.empty() && ReadTextFile(path, content);
+    if (loaded.ok) {
+        loaded.baseline.Reset(content);
+    } else {
+        content = "[Failed to open file]"; // Show what went wrong right in the edit box
+    }
+    loaded.document.Parse(toWindowsNewlines(content));
+    return loaded;
+}
+
+StartupTasks AddStartupTasks(TaskGraph& graph, StartupState& state, const StartupHooks& hooks,
+                             ProfileStore& profiles, SteamAppLocator& locator, DisplayModeCatalog& displayModes) {
+    StartupTasks tasks;
+    tasks.iniPath = graph.Add("Startup.IniPath", [&state, hooks] {
+        if (hooks.iniPath) state.iniPath = hooks.iniPath();
+    });
+    tasks.settings = graph.Add("Startup.Settings", [&state] {
+        state.settings = ReadSettingsForEditBox(state.iniPath);
+    }, {tasks.iniPath});
+    tasks.profiles = graph.Add("Startup.Profiles", [&state, &profiles] {
+        if (!state.iniPath.empty()) state.profilesOpened = profiles.Open(ProfileStorePath(state.iniPath), state.profileError);
+    }, {tasks.iniPath});
+    tasks.steam = graph.Add("Startup.Steam", [&state, &locator, hooks] {
+        // Only warms the locator's cache, so the first Launch click doesn't read Steam's files
+        std::string steamRoot;
+        if (hooks.steamRoot && hooks.steamRoot(steamRoot, state.steamError) && !steamRoot.empty()) {
+            state.gameFound = locator.Locate(steamRoot, gameAppId, state.install, state.steamError);
+        }
+    });
+    tasks.displayModes = graph.Add("Startup.DisplayModes", [&displayModes] {
+        displayModes.Refresh(nullptr);
+        displayModes.Wait();
+    });
+    return tasks;
+}
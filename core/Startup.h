@@ -0,0 +1,61 @@
+/*
+ * Startup.h
+ * The launcher's startup work as a task graph, so the slow parts (finding
+ * and reading settings.ini, opening profiles, probing Steam, listing
+ * display modes) overlap with window creation on the UI thread:
+ *
+ *   IniPath --> Settings
+ *          \--> Profiles
+ *   Steam
+ *   DisplayModes
+ *
+ * Nothing here touches a window; the caller joins the graph and shows the
+ * results. Benchmarks run the same graph headless.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "DisplayModes.h"
+#include "IniDiff.h"
+#include "IniDocument.h"
+#include "ProfileStore.h"
+#include "SteamLibrary.h"
+#include "TaskGraph.h"
+
+// Platform lookups startup can't do itself
+struct StartupHooks {
+    std::function<std::string()> iniPath;                                      // Where settings.ini lives
+    std::function<bool(std::string& steamRoot, std::string& error)> steamRoot;  // Steam's install folder
+};
+
+// settings.ini as the edit box will show it
+struct LoadedSettings {
+    bool ok = false;
+    IniDocument document;       // \r\n text; "[Failed to open file]" when the read failed
+    SettingsBaseline baseline;  // What's on disk (only meaningful when ok)
+};
+
+// Read and parse settings.ini; safe on any thread
+LoadedSettings ReadSettingsForEditBox(const std::string& path);
+
+// What the startup tasks produced; read it only after joining the task that fills it
+struct StartupState {
+    std::string iniPath;
+    LoadedSettings settings;
+    bool profilesOpened = false;
+    std::string profileError;
+    bool gameFound = false;
+    SteamAppInstall install;
+    std::string steamError;
+};
+
+struct StartupTasks {
+    TaskGraph::TaskId iniPath, settings, profiles, steam, displayModes;
+};
+
+// Add the startup tasks to graph; profiles, locator and displayModes are filled in place
+StartupTasks AddStartupTasks(TaskGraph& graph, StartupState& state, const StartupHooks& hooks,
+                             ProfileStore& profiles, SteamAppLocator& locator, DisplayModeCatalog& displayModes);
@@ -0,0 +1,253 @@
+/*
+ * SteamLibrary.cpp
+ * "I'm Guybrush Threepwood, and I know which drive you put the game on."
+ */
+
+#include "SteamLibrary.h"
+
+#include "IniDocument.h"
+#include "TextFile.h"
+#include "Trace.h"
+#include "Vdf.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sys/stat.h>
+
+namespace {
+
+#ifdef _WIN32
+const char pathSeparator = '\\';
+#else
+const char pathSeparator = '/';
+#endif
+
+std::string SteamAppsPath(const std::string& library) {
+    return JoinPath(library, "steamapps");
+}
+
+std::string ManifestPath(const std::string& library, int appId) {
+    return JoinPath(SteamAppsPath(library), "appmanifest_" + std::to_string(appId) + ".acf");
+}
+
+bool IsRegularFile(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFMT) == S_IFREG;
+}
+
+// Library paths are compared loosely: Steam mixes slashes and drive-letter case
+std::string ComparablePath(std::string path) {
+    for (char& c : path) {
+        if (c == '\\') c = '/';
+#ifdef _WIN32
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+#endif
+    }
+    while (path.size() > 1 && path.back() == '/') path.pop_back();
+    return path;
+}
+
+bool IsDirectory(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFMT) == S_IFDIR;
+}
+
+// Every library, the ones that list appId first, so the common case opens exactly one manifest
+std::vector<SteamLibraryFolder> LibrariesFor(const std::string& steamRoot, int appId) {
+    std::string libraryError;
+    std::vector<SteamLibraryFolder> libraries = ReadSteamLibraryFolders(steamRoot, libraryError);
+    std::stable_partition(libraries.begin(), libraries.end(), [appId](const SteamLibraryFolder& library) {
+        return std::find(library.apps.begin(), library.apps.end(), appId) != library.apps.end();
+    });
+    return libraries;
+}
+
+} // namespace
+
+std::string JoinPath(const std::string& path, const std::string& name) {
+    if (path.empty()) return name;
+    char last = path.back();
+    if (last == '/' || last == '\\') return path + name;
+    return path + pathSeparator + name;
+}
+
+std::vector<SteamLibraryFolder> ReadSteamLibraryFolders(const std::string& steamRoot, std::string& error) {
+    std::vector<SteamLibraryFolder> libraries;
+    libraries.push_back({steamRoot, {}});
+
+    VdfNode root;
+    if (!ReadVdfFile(JoinPath(SteamAppsPath(steamRoot), "libraryfolders.vdf"), root, error)) {
+        return libraries;  // No extra libraries; the Steam folder itself still counts
+    }
+    const VdfNode* folders = root.Find("libraryfolders");
+    if (!folders) folders = root.Find("LibraryFolders");
+    if (!folders) return libraries;
+
+    for (const VdfNode& entry : folders->children) {
+        // Libraries are numbered "0", "1", ...; other keys (contentstatsid, TimeNextStatsReport) aren't libraries
+        int index = 0;
+        if (!ParseIniInt(entry.key, index)) continue;
+
+        SteamLibraryFolder folder;
+        if (entry.isBlock) {
+            // Current layout: "1" { "path" "D:\\SteamLibrary" "apps" { "32360" "123456" } }
+            folder.path.assign(entry.Get("path"));
+            if (const VdfNode* apps = entry.Find("apps")) {
+                for (const VdfNode& app : apps->children) {
+                    int appId = 0;
+                    if (ParseIniInt(app.key, appId)) folder.apps.push_back(appId);
+                }
+            }
+        } else {
+            // Old layout: "1" "D:\\SteamLibrary"
+            folder.path = entry.value;
+        }
+        if (folder.path.empty()) continue;
+
+        std::string comparable = ComparablePath(folder.path);
+        auto existing = std::find_if(libraries.begin(), libraries.end(), [&](const SteamLibraryFolder& library) {
+            return ComparablePath(library.path) == comparable;
+        });
+        if (existing != libraries.end()) {
+            // The Steam folder is listed as library "0"; keep our spelling, take its app list
+            existing->apps = std::move(folder.apps);
+        } else {
+            libraries.push_back(std::move(folder));
+        }
+    }
+    error.clear();
+    return libraries;
+}
+
+bool ReadAppManifest(const std::string& manifestPath, const std::string& libraryPath, SteamAppInstall& install, std::string& error) {
+    VdfNode root;
+    if (!ReadVdfFile(manifestPath, root, error)) return false;
+    const VdfNode* state = root.Find("AppState");
+    std::string_view installDir = state ? state->Get("installdir") : std::string_view();
+    if (installDir.empty()) {
+        error = manifestPath + " has no AppState/installdir";
+        return false;
+    }
+    install.libraryPath = libraryPath;
+    install.manifestPath = manifestPath;
+    install.installPath = JoinPath(JoinPath(SteamAppsPath(libraryPath), "common"), std::string(installDir));
+    install.name.assign(state->Get("name"));
+    install.buildId.assign(state->Get("buildid"));
+    return true;
+}
+
+bool FindSteamApp(const std::string& steamRoot, int appId, SteamAppInstall& install, std::string& error) {
+    std::vector<SteamLibraryFolder> libraries = LibrariesFor(steamRoot, appId);
+    for (const SteamLibraryFolder& library : libraries) {
+        std::string manifest = ManifestPath(library.path, appId);
+        if (!IsRegularFile(manifest)) continue;
+        if (ReadAppManifest(manifest, library.path, install, error)) return true;
+    }
+    if (error.empty()) {
+        error = "App " + std::to_string(appId) + " is not installed in any of " +
+                std::to_string(libraries.size()) + " Steam library folder(s)";
+    }
+    return false;
+}
+
+std::string ProtonPrefixPath(const std::string& libraryPath, int appId) {
+    return JoinPath(JoinPath(JoinPath(SteamAppsPath(libraryPath), "compatdata"), std::to_string(appId)), "pfx");
+}
+
+std::vector<std::string> FindProtonPrefixes(const std::string& steamRoot, int appId) {
+    MISE_TRACE_SCOPE("FindProtonPrefixes");
+    // Proton keeps the prefix in the library the game is installed in, but one left behind by a move still counts
+    std::vector<std::string> prefixes;
+    for (const SteamLibraryFolder& library : LibrariesFor(steamRoot, appId)) {
+        std::string prefix = ProtonPrefixPath(library.path, appId);
+        if (IsDirectory(prefix)) prefixes.push_back(std::move(prefix));
+    }
+    return prefixes;
+}
+
+std::string ReadSteamLaunchOptions(const std::string& steamRoot, int appId) {
+    MISE_TRACE_SCOPE("ReadSteamLaunchOptions");
+    // Every account that ever logged in has a userdata folder; the newest localconfig.vdf is the current user
+    std::string newestConfig;
+    std::filesystem::file_time_type newestTime;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(JoinPath(steamRoot, "userdata"), ec), end; !ec && it != end; it.increment(ec)) {
+        std::filesystem::path config = it->path() / "config" / "localconfig.vdf";
+        std::error_code timeError;
+        auto modified = std::filesystem::last_write_time(config, timeError);
+        if (timeError) continue;
+        if (newestConfig.empty() || modified > newestTime) {
+            newestConfig = config.string();
+            newestTime = modified;
+        }
+    }
+    if (newestConfig.empty()) return "";
+
+    VdfNode root;
+    std::string error;
+    if (!ReadVdfFile(newestConfig, root, error)) return "";
+    const VdfNode* node = &root;
+    for (const char* key : {"UserLocalConfigStore", "Software", "Valve", "Steam", "apps"}) {
+        node = node->Find(key);
+        if (!node) return "";
+    }
+    const VdfNode* app = node->Find(std::to_string(appId));
+    return app ? std::string(app->Get("LaunchOptions")) : "";
+}
+
+std::string LaunchOptionArguments(const std::string& launchOptions) {
+    // "VAR=1 %command% -args": what's before %command% is for a shell (or Proton), only the rest reaches the game
+    const std::string placeholder = "%command%";
+    size_t at = launchOptions.find(placeholder);
+    std::string_view arguments = launchOptions;
+    if (at != std::string::npos) arguments.remove_prefix(at + placeholder.size());
+    return std::string(Trim(arguments));
+}
+
+SteamAppLocator::Stamp SteamAppLocator::StampOf(const std::string& path) {
+    Stamp stamp;
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) {
+        stamp.exists = true;
+        stamp.modified = static_cast<int64_t>(info.st_mtime);
+        stamp.size = static_cast<int64_t>(info.st_size);
+    }
+    return stamp;
+}
+
+bool SteamAppLocator::Locate(const std::string& steamRoot, int appId, SteamAppInstall& install, std::string& error) {
+    MISE_TRACE_SCOPE("SteamAppLocator::Locate");
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string libraryFile = JoinPath(SteamAppsPath(steamRoot), "libraryfolders.vdf");
+
+    // Two stat calls decide whether the last answer still holds
+    if (valid_ && steamRoot == steamRoot_ && appId == appId_ &&
+        StampOf(libraryFile) == libraryStamp_ && StampOf(install_.manifestPath) == manifestStamp_) {
+        install = install_;
+        return true;
+    }
+
+    ++resolveCount_;
+    valid_ = false;
+    Stamp libraryStamp = StampOf(libraryFile);
+    if (!FindSteamApp(steamRoot, appId, install_, error)) return false;
+
+    // Failures aren't cached: the next launch looks again, in case the game was just installed
+    valid_ = true;
+    steamRoot_ = steamRoot;
+    appId_ = appId;
+    libraryStamp_ = libraryStamp;
+    manifestStamp_ = StampOf(install_.manifestPath);
+    install = install_;
+    return true;
+}
+
+void SteamAppLocator::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    valid_ = false;
+}
+
+size_t SteamAppLocator::ResolveCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resolveCount_;
+}
@@ -0,0 +1,91 @@
+/*
+ * SteamLibrary.h
+ * Where Steam installed the game, worked out from Steam's own files
+ * instead of asking the Steam client:
+ *
+ *   <steam>/steamapps/libraryfolders.vdf     every library folder
+ *   <library>/steamapps/appmanifest_N.acf    which library has app N, and its installdir
+ *   <steam>/userdata/<user>/config/localconfig.vdf   the user's launch options
+ *   <library>/steamapps/compatdata/N/pfx     app N's Proton prefix, on Linux
+ *
+ * Nothing here touches the registry or starts a process, so it runs the
+ * same against a real Steam install or a fixture tree on Linux.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One library folder from libraryfolders.vdf
+struct SteamLibraryFolder {
+    std::string path;       // Library root (the folder that holds steamapps/)
+    std::vector<int> apps;  // App ids Steam says live here (empty in the old file format)
+};
+
+// An installed app, resolved from its appmanifest
+struct SteamAppInstall {
+    std::string libraryPath;
+    std::string manifestPath;  // <library>/steamapps/appmanifest_N.acf
+    std::string installPath;   // <library>/steamapps/common/<installdir>
+    std::string name;
+    std::string buildId;       // Steam's build of the installed files; changes with every update
+};
+
+// path + separator + name, using the platform's separator
+std::string JoinPath(const std::string& path, const std::string& name);
+
+// steamRoot first, then every other library in libraryfolders.vdf (both the old and the current layout)
+std::vector<SteamLibraryFolder> ReadSteamLibraryFolders(const std::string& steamRoot, std::string& error);
+
+// Parse one appmanifest_N.acf that lives in libraryPath
+bool ReadAppManifest(const std::string& manifestPath, const std::string& libraryPath, SteamAppInstall& install, std::string& error);
+
+// Look through every library for appId; libraries that claim the app are tried first
+bool FindSteamApp(const std::string& steamRoot, int appId, SteamAppInstall& install, std::string& error);
+
+// <library>/steamapps/compatdata/<appId>/pfx: the Wine prefix Proton runs appId in
+std::string ProtonPrefixPath(const std::string& libraryPath, int appId);
+
+// Every Proton prefix for appId that exists, in the order FindSteamApp tries libraries
+std::vector<std::string> FindProtonPrefixes(const std::string& steamRoot, int appId);
+
+// Launch options the most recently active Steam user set for appId, or empty
+std::string ReadSteamLaunchOptions(const std::string& steamRoot, int appId);
+
+// The arguments part of a Steam launch option string ("%command% -foo" -> "-foo")
+std::string LaunchOptionArguments(const std::string& launchOptions);
+
+// FindSteamApp with a cache that stays valid until libraryfolders.vdf or the manifest change on disk.
+// Safe to call from any thread.
+class SteamAppLocator {
+public:
+    bool Locate(const std::string& steamRoot, int appId, SteamAppInstall& install, std::string& error);
+
+    // Forget the cached answer
+    void Clear();
+
+    // How many times the cache missed and the library files were read
+    size_t ResolveCount() const;
+
+private:
+    struct Stamp {
+        bool exists = false;
+        int64_t modified = 0;
+        int64_t size = 0;
+        bool operator==(const Stamp& other) const {
+            return exists == other.exists && modified == other.modified && size == other.size;
+        }
+    };
+    static Stamp StampOf(const std::string& path);
+
+    mutable std::mutex mutex_;
+    bool valid_ = false;
+    std::string steamRoot_;
+    int appId_ = 0;
+    Stamp libraryStamp_, manifestStamp_;
+    SteamAppInstall install_;
+    size_t resolveCount_ = 0;
+};
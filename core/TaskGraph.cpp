@@ -0,0 +1,139 @@
+/*
+ * TaskGraph.cpp
+ * "Three-headed monkey? No, three-threaded startup!"
+ */
+
+#include "TaskGraph.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+TaskGraph::TaskId TaskGraph::Add(const char* name, Work work, std::vector<TaskId> dependencies) {
+    TaskId id = tasks_.size();
+    Task task;
+    task.name = name;
+    task.work = std::move(work);
+    task.timing.name = name;
+    for (TaskId dependency : dependencies) {
+        if (dependency < id) {
+            tasks_[dependency].dependents.push_back(id);
+            ++task.pendingDependencies;
+        }
+    }
+    tasks_.push_back(std::move(task));
+    return id;
+}
+
+void TaskGraph::Ready(TaskId task) {
+    tasks_[task].timing.readyNs = TraceNow();
+    readyQueue_.push_back(task);
+}
+
+void TaskGraph::Execute(TaskId id, unsigned worker, std::unique_lock<std::mutex>& lock) {
+    Task& task = tasks_[id];
+    task.timing.worker = worker;
+    task.timing.startNs = TraceNow();
+    lock.unlock();
+    task.work();
+    uint64_t endNs = TraceNow();
+    if (TraceEnabled()) RecordTraceSpan(task.name, task.timing.startNs, endNs);
+    lock.lock();
+
+    task.timing.endNs = endNs;
+    task.done = true;
+    ++finished_;
+    for (TaskId dependent : task.dependents) {
+        if (--tasks_[dependent].pendingDependencies == 0) Ready(dependent);
+    }
+    changed_.notify_all();
+}
+
+void TaskGraph::WorkerLoop(unsigned worker) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        changed_.wait(lock, [this] { return !readyQueue_.empty() || finished_ == tasks_.size(); });
+        if (readyQueue_.empty()) return;  // Everything finished
+        TaskId task = readyQueue_.front();
+        readyQueue_.erase(readyQueue_.begin());
+        Execute(task, worker, lock);
+    }
+}
+
+void TaskGraph::Start(unsigned workers) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (started_) return;
+    started_ = true;
+    startNs_ = TraceNow();
+    for (TaskId id = 0; id < tasks_.size(); ++id) {
+        if (tasks_[id].pendingDependencies == 0) Ready(id);
+    }
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+    workers = static_cast<unsigned>(std::min<size_t>(workers, tasks_.size()));
+    for (unsigned worker = 1; worker <= workers; ++worker) {
+        workers_.emplace_back(&TaskGraph::WorkerLoop, this, worker);
+    }
+}
+
+void TaskGraph::RunSerial() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (started_) return;
+    started_ = true;
+    startNs_ = TraceNow();
+    for (TaskId id = 0; id < tasks_.size(); ++id) {
+        if (tasks_[id].pendingDependencies == 0) Ready(id);
+    }
+    while (!readyQueue_.empty()) {
+        TaskId task = readyQueue_.front();
+        readyQueue_.erase(readyQueue_.begin());
+        Execute(task, 0, lock);
+    }
+}
+
+void TaskGraph::Wait(TaskId task) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!started_ || task >= tasks_.size()) return;
+    changed_.wait(lock, [this, task] { return tasks_[task].done; });
+}
+
+void TaskGraph::WaitAll() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (started_) changed_.wait(lock, [this] { return finished_ == tasks_.size(); });
+    }
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+}
+
+std::vector<TaskGraph::TaskTiming> TaskGraph::Timings() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<TaskTiming> timings;
+    timings.reserve(tasks_.size());
+    for (const Task& task : tasks_) timings.push_back(task.timing);
+    return timings;
+}
+
+std::string TaskGraph::TimingReport() const {
+    std::string report;
+    uint64_t startNs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        startNs = startNs_;
+    }
+    for (const TaskTiming& timing : Timings()) {
+        char line[160];
+        if (timing.endNs == 0) {
+            std::snprintf(line, sizeof(line), "%-20s not finished\n", timing.name);
+        } else {
+            char where[24] = "the caller";
+            if (timing.worker) std::snprintf(where, sizeof(where), "worker %u", timing.worker);
+            std::snprintf(line, sizeof(line), "%-20s ready +%.2f ms  ran %.2f ms  on %s\n", timing.name,
+                          (timing.readyNs - startNs) / 1e6, (timing.endNs - timing.startNs) / 1e6, where);
+        }
+        report += line;
+    }
+    return report;
+}
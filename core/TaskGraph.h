@@ -0,0 +1,88 @@
+/*
+ * TaskGraph.h
+ * A handful of named jobs with dependencies, run on a few worker threads.
+ * Startup uses it to read settings.ini, probe Steam and list display modes
+ * while the UI thread is busy creating windows.
+ *
+ *   TaskGraph graph;
+ *   TaskGraph::TaskId path = graph.Add("FindIni", [&] { ... });
+ *   TaskGraph::TaskId read = graph.Add("ReadIni", [&] { ... }, {path});
+ *   graph.Start(2);
+ *   ...                 // other work on this thread
+ *   graph.Wait(read);   // results of read (and path) are now visible here
+ *
+ * Tasks are added before Start and the graph runs once. Each task is also
+ * recorded as a trace span.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TaskGraph {
+public:
+    using TaskId = size_t;
+    using Work = std::function<void()>;
+
+    // When a task ran, on the graph's clock (TraceNow nanoseconds)
+    struct TaskTiming {
+        const char* name = "";
+        uint64_t readyNs = 0;   // All dependencies done
+        uint64_t startNs = 0;
+        uint64_t endNs = 0;
+        unsigned worker = 0;    // 1-based worker thread; 0 = ran on the caller (RunSerial)
+    };
+
+    TaskGraph() = default;
+    ~TaskGraph() { WaitAll(); }
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    // name must be a string literal; dependencies must already have been added
+    TaskId Add(const char* name, Work work, std::vector<TaskId> dependencies = {});
+
+    // Run every task on up to 'workers' threads (0 = one per hardware thread, capped by the task count)
+    void Start(unsigned workers = 0);
+
+    // Run every task on the calling thread in dependency order (the no-threads baseline)
+    void RunSerial();
+
+    // Block until a task (and so everything it depends on) has finished
+    void Wait(TaskId task);
+    void WaitAll();
+
+    size_t Size() const { return tasks_.size(); }
+    std::vector<TaskTiming> Timings() const;
+
+    // One line per task: "ReadIni  ready +0.10 ms  ran 0.85 ms  on worker 2"
+    std::string TimingReport() const;
+
+private:
+    struct Task {
+        const char* name;
+        Work work;
+        std::vector<TaskId> dependents;
+        size_t pendingDependencies = 0;
+        bool done = false;
+        TaskTiming timing;
+    };
+
+    void Ready(TaskId task);  // Caller holds mutex_
+    void Execute(TaskId task, unsigned worker, std::unique_lock<std::mutex>& lock);
+    void WorkerLoop(unsigned worker);
+
+    std::vector<Task> tasks_;
+    std::vector<TaskId> readyQueue_;
+    std::vector<std::thread> workers_;
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    size_t finished_ = 0;
+    uint64_t startNs_ = 0;
+    bool started_ = false;
+};
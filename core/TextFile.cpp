@@ -0,0 +1,172 @@
+/*
+ * TextFile.cpp
+ * Reading, writing and tidying up settings text.
+ *
+ * Every helper here makes at most one allocation for its output and finds
+ * line endings with memchr (which the C runtime vectorizes), so a load or
+ * save costs one pass over the text instead of one append per character.
+ */
+
+#include "TextFile.h"
+
+#include "AtomicFile.h"
+#include "Trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+// Function to read the raw bytes of a file with a single sized read
+// "Never pay more than 20 pieces of eight for a file reader!"
+bool ReadFileBytes(const std::string& path, std::string& content) {
+    MISE_TRACE_SCOPE("ReadFileBytes");
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    // The size from the open file; a folder opens too (on Linux), but has no bytes to read
+#ifdef _WIN32
+    struct _stat64 info;
+    bool ok = _fstat64(_fileno(file), &info) == 0 && (info.st_mode & _S_IFMT) == _S_IFREG;
+#else
+    struct stat info;
+    bool ok = fstat(fileno(file), &info) == 0 && S_ISREG(info.st_mode);
+#endif
+    long long size = ok ? static_cast<long long>(info.st_size) : -1;
+    if (ok) {
+        content.resize(static_cast<size_t>(size));
+        size_t got = size > 0 ? std::fread(&content[0], 1, content.size(), file) : 0;
+        content.resize(got); // The file may have shrunk under us; keep what we got
+        ok = !std::ferror(file);
+    }
+    std::fclose(file);
+    return ok;
+}
+
+bool ReadTextFile(const std::string& path, std::string& content) {
+    if (!ReadFileBytes(path, content)) return false;
+    normalizeNewlinesInPlace(content);
+    return true;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::string content;
+    if (!ReadTextFile(path, content)) return "[Failed to open file]"; // If the file can't be opened, we raise the Jolly Roger
+    return content;
+}
+
+// Normalize Windows newlines (\r\n) to Unix-style newlines (\n)
+// "You fight like a dairy farmer!" - "How appropriate, you normalize like a cow!"
+std::string normalizeWindowsNewlines(std::string_view text) {
+    std::string result;
+    result.reserve(text.size()); // Output is never longer than the input
+    const char* data = text.data();
+    const char* end = data + text.size();
+    while (data < end) {
+        const char* cr = static_cast<const char*>(std::memchr(data, '\r', end - data));
+        if (!cr) {
+            result.append(data, end);
+            break;
+        }
+        result.append(data, cr);
+        result += '\n';                          // \r\n and lone \r both become \n
+        data = (cr + 1 < end && cr[1] == '\n') ? cr + 2 : cr + 1;
+    }
+    return result;
+}
+
+void normalizeNewlinesInPlace(std::string& text) {
+    char* begin = &text[0];
+    char* end = begin + text.size();
+    char* cr = static_cast<char*>(std::memchr(begin, '\r', text.size()));
+    if (!cr) return; // Already Unix-style, the common case
+
+    char* out = cr;
+    const char* in = cr;
+    while (in < end) {
+        // 'in' sits on a \r here
+        *out++ = '\n';
+        in += (in + 1 < end && in[1] == '\n') ? 2 : 1;
+        const char* next = static_cast<const char*>(std::memchr(in, '\r', end - in));
+        const char* stop = next ? next : end;
+        std::memmove(out, in, stop - in);
+        out += stop - in;
+        in = stop;
+    }
+    text.resize(out - begin);
+}
+
+std::string toWindowsNewlines(std::string_view text) {
+    // Count the bare \n's first so the output is allocated exactly once
+    size_t bare = 0;
+    const char* data = text.data();
+    const char* end = data + text.size();
+    for (const char* p = data; (p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr; ++p) {
+        if (p == data || p[-1] != '\r') ++bare;
+    }
+
+    std::string result;
+    result.reserve(text.size() + bare);
+    while (data < end) {
+        const char* nl = static_cast<const char*>(std::memchr(data, '\n', end - data));
+        if (!nl) {
+            result.append(data, end);
+            break;
+        }
+        result.append(data, nl);
+        if (nl == text.data() || nl[-1] != '\r') result += '\r';
+        result += '\n';
+        data = nl + 1;
+    }
+    return result;
+}
+
+// Save settings text: normalize newlines, skip the write if the disk already has it, else replace atomically
+// "This is the second biggest file writer I've ever seen!"
+SaveResult SaveSettingsFile(const std::string& path, std::string_view contentFromEditBox) {
+    MISE_TRACE_SCOPE("SaveSettingsFile");
+    SaveResult result;
+    // Normalize \r\n to \n before saving (because pirates like consistency)
+    std::string normalized = normalizeWindowsNewlines(contentFromEditBox);
+
+    // Same bytes already on disk? Then there's nothing to write (or to sync over a roaming profile)
+    std::string onDisk;
+    if (ReadFileBytes(path, onDisk) && onDisk.size() == normalized.size() &&
+        HashContent(onDisk) == HashContent(normalized)) {
+        result.status = SaveStatus::Unchanged;
+        return result;
+    }
+
+    if (!WriteFileAtomic(path, normalized, result.error)) {
+        result.status = SaveStatus::Failed; // If the file can't be written, abandon ship!
+        return result;
+    }
+    result.status = SaveStatus::Written;
+    return result;
+}
+
+bool WriteFile(const std::string& path, std::string_view contentFromEditBox) {
+    return SaveSettingsFile(path, contentFromEditBox).status != SaveStatus::Failed;
+}
+
+// Helper function to trim whitespace and line-ending characters
+// "That's the cleanest trim I've ever seen on a pirate!"
+std::string_view Trim(std::string_view str) {
+    size_t start = str.find_first_not_of(" \t\r\n");
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return (start == std::string_view::npos) ? std::string_view() : str.substr(start, end - start + 1);
+}
+
+// "1.5 MB"-style sizes for people to read
+std::string FormatBytes(uint64_t bytes) {
+    char text[32];
+    if (bytes < 1024) {
+        std::snprintf(text, sizeof(text), "%llu bytes", static_cast<unsigned long long>(bytes));
+    } else if (bytes < (1 << 20)) {
+        std::snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+    } else if (bytes < (1 << 30)) {
+        std::snprintf(text, sizeof(text), "%.1f MB", bytes / (1024.0 * 1024.0));
+    } else {
+        std::snprintf(text, sizeof(text), "%.2f GB", bytes / (1024.0 * 1024.0 * 1024.0));
+    }
+    return text;
+}
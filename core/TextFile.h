@@ -0,0 +1,52 @@
+/*
+ * TextFile.h
+ * File and string helpers shared by the GUI and the command-line mode.
+ * Inputs are string_views so callers never copy just to call us.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Read a whole file's bytes with one sized read; false if it can't be opened
+bool ReadFileBytes(const std::string& path, std::string& content);
+
+// Read a whole file with newlines normalized to \n; false if it can't be opened
+bool ReadTextFile(const std::string& path, std::string& content);
+
+// Read a whole file, or "[Failed to open file]" so the edit box shows what went wrong
+std::string ReadFile(const std::string& path);
+
+// Normalize Windows newlines (\r\n) and lone \r to Unix-style newlines (\n)
+std::string normalizeWindowsNewlines(std::string_view text);
+
+// Same as normalizeWindowsNewlines, but shrinks the string in place
+void normalizeNewlinesInPlace(std::string& text);
+
+// Turn bare \n into \r\n for the edit box, leaving existing \r\n alone
+std::string toWindowsNewlines(std::string_view text);
+
+enum class SaveStatus {
+    Written,    // New content is on disk
+    Unchanged,  // Disk already had exactly this content, nothing was written
+    Failed      // Nothing was changed on disk; SaveResult::error says why
+};
+
+struct SaveResult {
+    SaveStatus status = SaveStatus::Failed;
+    std::string error;
+};
+
+// Save with normalized newlines through a temp file and atomic rename, skipping identical content
+SaveResult SaveSettingsFile(const std::string& path, std::string_view contentFromEditBox);
+
+// SaveSettingsFile for callers that only care whether it worked
+bool WriteFile(const std::string& path, std::string_view contentFromEditBox);
+
+// Trim whitespace and line-ending characters from both ends; returns a view into str
+std::string_view Trim(std::string_view str);
+
+// A size for people to read: "512 bytes", "4.0 KB", "1.5 MB", "2.25 GB"
+std::string FormatBytes(uint64_t bytes);
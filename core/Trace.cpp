@@ -0,0 +1,166 @@
+/*
+ * Trace.cpp
+ * "Look behind you, a three-headed stopwatch!"
+ */
+
+#include "Trace.h"
+
+#include "AtomicFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> traceEnabled{false};
+
+namespace {
+
+struct TraceRecord {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+};
+
+// One thread's spans. Only the owning thread writes; readers copy what head says is there
+// and throw away anything the writer could have lapped while they were copying.
+struct TraceRing {
+    uint32_t threadId = 0;
+    std::atomic<uint64_t> head{0};  // Spans ever written (the next slot is head % capacity)
+    TraceRecord records[traceRingCapacity];
+};
+
+// Rings are never freed: a thread that exits still has spans worth dumping
+std::mutex ringsMutex;
+std::vector<std::unique_ptr<TraceRing>> rings;
+
+thread_local TraceRing* threadRing = nullptr;
+
+TraceRing* ThisThreadRing() {
+    if (!threadRing) {
+        auto ring = std::make_unique<TraceRing>();
+        std::lock_guard<std::mutex> lock(ringsMutex);  // Once per thread, not per span
+        ring->threadId = static_cast<uint32_t>(rings.size() + 1);
+        threadRing = ring.get();
+        rings.push_back(std::move(ring));
+    }
+    return threadRing;
+}
+
+// The live spans of a ring, oldest first
+std::vector<TraceRecord> SnapshotRing(const TraceRing& ring) {
+    uint64_t before = ring.head.load(std::memory_order_acquire);
+    uint64_t first = before > traceRingCapacity ? before - traceRingCapacity : 0;
+    std::vector<TraceRecord> copy;
+    copy.reserve(static_cast<size_t>(before - first));
+    for (uint64_t i = first; i < before; ++i) copy.push_back(ring.records[i % traceRingCapacity]);
+
+    // Slots the writer reused while we copied may be torn; drop them. That includes slot after % capacity,
+    // which the writer may be filling right now (it bumps head only once the record is in)
+    uint64_t after = ring.head.load(std::memory_order_acquire);
+    uint64_t overwritten = after + 1 > traceRingCapacity ? after + 1 - traceRingCapacity : 0;
+    if (overwritten > first) {
+        size_t drop = static_cast<size_t>(std::min<uint64_t>(overwritten - first, copy.size()));
+        copy.erase(copy.begin(), copy.begin() + drop);
+    }
+    return copy;
+}
+
+void AppendJsonString(std::string& out, const char* text) {
+    out += '"';
+    for (const char* p = text; *p; ++p) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+// Chrome wants microseconds; keep the nanoseconds as a fraction
+void AppendMicroseconds(std::string& out, uint64_t ns) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%llu.%03u", static_cast<unsigned long long>(ns / 1000), static_cast<unsigned>(ns % 1000));
+    out += number;
+}
+
+} // namespace
+
+void EnableTracing(bool enabled) {
+    if (enabled) TraceNow();  // Start the clock before the first span
+    traceEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t TraceNow() {
+    using Clock = std::chrono::steady_clock;
+    static const Clock::time_point epoch = Clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+}
+
+void RecordTraceSpan(const char* name, uint64_t startNs, uint64_t endNs) {
+    TraceRing* ring = ThisThreadRing();
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->records[head % traceRingCapacity] = {name, startNs, endNs};
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+size_t TraceSpanCount() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    size_t count = 0;
+    for (const auto& ring : rings) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        count += static_cast<size_t>(std::min<uint64_t>(head, traceRingCapacity));
+    }
+    return count;
+}
+
+void ClearTrace() {
+    // Rewinding head is only safe for the calling thread's own ring or idle threads; good enough
+    // for benchmarks and "start a fresh trace" from the UI thread
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (const auto& ring : rings) ring->head.store(0, std::memory_order_release);
+}
+
+std::string ChromeTraceJson() {
+    std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (const auto& ring : rings) {
+        for (const TraceRecord& record : SnapshotRing(*ring)) {
+            json += first ? "\n" : ",\n";
+            first = false;
+            json += "{\"ph\":\"X\",\"pid\":1,\"tid\":";
+            json += std::to_string(ring->threadId);
+            json += ",\"name\":";
+            AppendJsonString(json, record.name);
+            json += ",\"ts\":";
+            AppendMicroseconds(json, record.startNs);
+            json += ",\"dur\":";
+            AppendMicroseconds(json, record.endNs - record.startNs);
+            json += '}';
+        }
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+bool WriteChromeTrace(const std::string& path, std::string& error) {
+    return WriteFileAtomic(path, ChromeTraceJson(), error);
+}
+
+std::string EnableTracingFromEnvironment() {
+    const char* path = std::getenv("MISE_TRACE");
+    if (!path || !*path) return "";
+    EnableTracing(true);
+    return path;
+}
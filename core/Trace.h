@@ -0,0 +1,72 @@
+/*
+ * Trace.h
+ * Built-in span tracing, for finding out where the time goes on a slow machine.
+ *
+ *   void SaveSomething() {
+ *       MISE_TRACE_SCOPE("SaveSomething");
+ *       ...
+ *   }
+ *
+ * Each thread records into its own fixed-size ring (the oldest spans are
+ * overwritten), so recording never takes a lock. While tracing is off a
+ * span is one relaxed atomic load and a branch. WriteChromeTrace dumps
+ * every ring as Chrome trace-event JSON for chrome://tracing or Perfetto.
+ *
+ * Set MISE_TRACE=<file.json> to trace a run; the file is written at exit.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Spans kept per thread before the oldest are overwritten
+constexpr size_t traceRingCapacity = 16384;
+
+extern std::atomic<bool> traceEnabled;
+
+inline bool TraceEnabled() { return traceEnabled.load(std::memory_order_relaxed); }
+void EnableTracing(bool enabled);
+
+// Nanoseconds on a monotonic clock, counted from the first call
+uint64_t TraceNow();
+
+// Record a finished span on the calling thread; name must outlive the process (a string literal)
+void RecordTraceSpan(const char* name, uint64_t startNs, uint64_t endNs);
+
+// Times the enclosing scope; does nothing (not even read the clock) while tracing is off
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name) : name_(TraceEnabled() ? name : nullptr) {
+        if (name_) start_ = TraceNow();
+    }
+    ~TraceSpan() {
+        if (name_) RecordTraceSpan(name_, start_, TraceNow());
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_ = 0;
+};
+
+#define MISE_TRACE_CONCAT_(a, b) a##b
+#define MISE_TRACE_CONCAT(a, b) MISE_TRACE_CONCAT_(a, b)
+#define MISE_TRACE_SCOPE(name) TraceSpan MISE_TRACE_CONCAT(traceSpan_, __LINE__)(name)
+
+// How many spans are currently held across all threads
+size_t TraceSpanCount();
+
+// Drop every recorded span (the rings stay allocated)
+void ClearTrace();
+
+// Every recorded span as {"traceEvents":[...]} JSON
+std::string ChromeTraceJson();
+
+// ChromeTraceJson written atomically to path
+bool WriteChromeTrace(const std::string& path, std::string& error);
+
+// Turn tracing on if MISE_TRACE names an output file; returns that path (empty when not tracing)
+std::string EnableTracingFromEnvironment();
@@ -0,0 +1,272 @@
+/*
+ * UiRecording.cpp
+ * "I remember every move you made, Guybrush. Every. Single. Click."
+ */
+
+#include "UiRecording.h"
+
+#include "AtomicFile.h"
+#include "IniDocument.h"
+#include "TextFile.h"
+
+#include <charconv>
+
+namespace {
+
+const char* const headerLine = "MISE-UI 1";
+
+struct EventName {
+    UiEventKind kind;
+    const char* name;
+};
+
+const EventName eventNames[] = {
+    {UiEventKind::Load, "load"},
+    {UiEventKind::Resolutions, "resolutions"},
+    {UiEventKind::Select, "select"},
+    {UiEventKind::Check, "check"},
+    {UiEventKind::Slide, "slide"},
+    {UiEventKind::Type, "type"},
+    {UiEventKind::Save, "save"},
+    {UiEventKind::Reset, "reset"},
+    {UiEventKind::Profile, "profile"},
+    {UiEventKind::Undo, "undo"},
+    {UiEventKind::Redo, "redo"},
+    {UiEventKind::FileChanged, "filechanged"},
+    {UiEventKind::Answer, "answer"},
+    {UiEventKind::Desktop, "desktop"},
+    {UiEventKind::Disk, "disk"},
+    {UiEventKind::Expect, "expect"},
+    {UiEventKind::ExpectDisk, "expect-disk"},
+};
+
+const char* const answerNames[] = {"yes", "no", "cancel"};  // In ViewAnswer order
+
+// "text" with \\, \", \r, \n and \t escaped, so any settings text stays on one line
+void AppendQuoted(std::string& out, std::string_view text) {
+    out += '"';
+    for (char c : text) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\r': out += "\\r"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:   out += c; break;
+        }
+    }
+    out += '"';
+}
+
+// Reads the arguments of one line, left to right
+class LineReader {
+public:
+    explicit LineReader(std::string_view line) : rest_(line) {}
+
+    bool Word(std::string_view& word) {
+        Skip();
+        size_t end = rest_.find(' ');
+        word = rest_.substr(0, end);
+        rest_.remove_prefix(word.size());
+        return !word.empty();
+    }
+
+    bool Number(size_t& number) {
+        std::string_view word;
+        if (!Word(word)) return false;
+        auto [end, ec] = std::from_chars(word.data(), word.data() + word.size(), number);
+        return ec == std::errc() && end == word.data() + word.size();
+    }
+
+    bool Number(int& number) {
+        std::string_view word;
+        return Word(word) && ParseIniInt(word, number);
+    }
+
+    bool Quoted(std::string& text) {
+        Skip();
+        if (rest_.empty() || rest_[0] != '"') return false;
+        text.clear();
+        for (size_t i = 1; i < rest_.size(); ++i) {
+            char c = rest_[i];
+            if (c == '"') {
+                rest_.remove_prefix(i + 1);
+                return true;
+            }
+            if (c == '\\' && i + 1 < rest_.size()) {
+                switch (rest_[++i]) {
+                    case 'r': c = '\r'; break;
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    default:  c = rest_[i]; break;
+                }
+            }
+            text += c;
+        }
+        return false;  // No closing quote
+    }
+
+    std::string_view Rest() { return Trim(rest_); }
+    bool AtEnd() { Skip(); return rest_.empty(); }
+
+private:
+    void Skip() {
+        while (!rest_.empty() && rest_[0] == ' ') rest_.remove_prefix(1);
+    }
+
+    std::string_view rest_;
+};
+
+bool ParseEvent(UiEventKind kind, LineReader& reader, UiEvent& event) {
+    switch (kind) {
+        case UiEventKind::Load:
+        case UiEventKind::Profile:
+        case UiEventKind::FileChanged:
+        case UiEventKind::Desktop:
+        case UiEventKind::Disk:
+            return reader.Quoted(event.text) && reader.AtEnd();
+        case UiEventKind::Resolutions:
+        case UiEventKind::Expect:
+        case UiEventKind::ExpectDisk:
+            event.text = std::string(reader.Rest());
+            return kind == UiEventKind::Resolutions || event.text.find('=') != std::string::npos;
+        case UiEventKind::Select:
+        case UiEventKind::Check:
+        case UiEventKind::Slide:
+            return reader.Number(event.controlId) && reader.Number(event.value) && reader.AtEnd();
+        case UiEventKind::Type:
+            return reader.Number(event.start) && reader.Number(event.removed) && reader.Quoted(event.text) && reader.AtEnd();
+        case UiEventKind::Answer: {
+            std::string_view word;
+            if (!reader.Word(word) || !reader.AtEnd()) return false;
+            for (int i = 0; i < 3; ++i) {
+                if (word == answerNames[i]) {
+                    event.answer = static_cast<ViewAnswer>(i);
+                    return true;
+                }
+            }
+            return false;
+        }
+        case UiEventKind::Save:
+        case UiEventKind::Reset:
+        case UiEventKind::Undo:
+        case UiEventKind::Redo:
+            return reader.AtEnd();
+    }
+    return false;
+}
+
+} // namespace
+
+const char* UiEventName(UiEventKind kind) {
+    for (const EventName& entry : eventNames) {
+        if (entry.kind == kind) return entry.name;
+    }
+    return "?";
+}
+
+bool IsUiEventInput(UiEventKind kind) {
+    return kind == UiEventKind::Answer || kind == UiEventKind::Desktop || kind == UiEventKind::Disk;
+}
+
+bool IsUiEventCheck(UiEventKind kind) {
+    return kind == UiEventKind::Expect || kind == UiEventKind::ExpectDisk;
+}
+
+std::string FormatUiRecording(const UiRecording& recording) {
+    std::string out = std::string(headerLine) + "\n";
+    for (const UiEvent& event : recording.events) {
+        out += UiEventName(event.kind);
+        switch (event.kind) {
+            case UiEventKind::Load:
+            case UiEventKind::Profile:
+            case UiEventKind::FileChanged:
+            case UiEventKind::Desktop:
+            case UiEventKind::Disk:
+                out += ' ';
+                AppendQuoted(out, event.text);
+                break;
+            case UiEventKind::Resolutions:
+            case UiEventKind::Expect:
+            case UiEventKind::ExpectDisk:
+                if (!event.text.empty()) out += ' ' + event.text;
+                break;
+            case UiEventKind::Select:
+            case UiEventKind::Check:
+            case UiEventKind::Slide:
+                out += ' ' + std::to_string(event.controlId) + ' ' + std::to_string(event.value);
+                break;
+            case UiEventKind::Type:
+                out += ' ' + std::to_string(event.start) + ' ' + std::to_string(event.removed) + ' ';
+                AppendQuoted(out, event.text);
+                break;
+            case UiEventKind::Answer:
+                out += ' ';
+                out += answerNames[static_cast<int>(event.answer)];
+                break;
+            case UiEventKind::Save:
+            case UiEventKind::Reset:
+            case UiEventKind::Undo:
+            case UiEventKind::Redo:
+                break;
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+bool ParseUiRecording(std::string_view text, UiRecording& recording, std::string& error) {
+    recording.events.clear();
+    size_t lineNumber = 0;
+    bool sawHeader = false;
+    while (!text.empty()) {
+        size_t end = text.find('\n');
+        std::string_view line = Trim(text.substr(0, end));
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') continue;
+
+        if (!sawHeader) {
+            if (line != headerLine) {
+                error = "Not a launcher recording (the first line should be \"" + std::string(headerLine) + "\")";
+                return false;
+            }
+            sawHeader = true;
+            continue;
+        }
+
+        LineReader reader(line);
+        std::string_view verb;
+        reader.Word(verb);
+        const EventName* entry = nullptr;
+        for (const EventName& candidate : eventNames) {
+            if (verb == candidate.name) entry = &candidate;
+        }
+        UiEvent event;
+        event.line = lineNumber;
+        if (!entry || !ParseEvent(entry->kind, reader, event)) {
+            error = "Line " + std::to_string(lineNumber) + ": can't read \"" + std::string(line.substr(0, 60)) + "\"";
+            return false;
+        }
+        event.kind = entry->kind;
+        recording.events.push_back(std::move(event));
+    }
+    if (!sawHeader) {
+        error = "The recording is empty";
+        return false;
+    }
+    return true;
+}
+
+bool ReadUiRecording(const std::string& path, UiRecording& recording, std::string& error) {
+    std::string text;
+    if (!ReadFileBytes(path, text)) {
+        error = "Failed to read " + path;
+        return false;
+    }
+    return ParseUiRecording(text, recording, error);
+}
+
+bool WriteUiRecording(const std::string& path, const UiRecording& recording, std::string& error) {
+    return WriteFileAtomic(path, FormatUiRecording(recording), error);
+}
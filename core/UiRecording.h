@@ -0,0 +1,83 @@
+/*
+ * UiRecording.h
+ * A session at the launcher window written down as the interactions that
+ * made it: which combo entry was picked, which box ticked, what was typed
+ * where, Save, Reset, a profile applied, undo, redo. Whatever the session needed from outside
+ * is recorded too (settings.ini as loaded, the display modes, the answers
+ * to questions, the desktop resolution Autodetect found, a settings.ini
+ * that changed under a save), so replaying it
+ * doesn't depend on the machine it was recorded on.
+ *
+ * The file is one event per line:
+ *
+ *   MISE-UI 1
+ *   load "[display]\r\nresolution=1920x1080\r\n..."
+ *   resolutions 3840x2160 2560x1440 1920x1080
+ *   select 2002 3
+ *   check 2003 0
+ *   type 57 1 "5"
+ *   save
+ *   answer yes
+ *   expect display.windowed=1
+ *
+ * expect and expect-disk lines are added by hand: the replay checks that
+ * the text box (or settings.ini) holds that value at that point.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class ViewAnswer { Yes, No, Cancel };
+
+enum class UiEventKind {
+    Load,         // text: settings.ini as read
+    Resolutions,  // text: the resolution combo's sizes, space separated (empty for the default list)
+    Select,       // controlId's combo box, value = index
+    Check,        // controlId's check box, value = 0 or 1
+    Slide,        // controlId's slider, value = position
+    Type,         // Typing: at start, removed characters went and text came in
+    Save,
+    Reset,
+    Profile,      // text: the settings of the profile applied (and saved)
+    Undo,
+    Redo,
+    FileChanged,  // text: settings.ini as something else left it
+    Answer,       // answer: what the last question was told
+    Desktop,      // text: what Autodetect found
+    Disk,         // text: settings.ini as Save found it, changed by something the launcher hadn't noticed yet
+    Expect,       // text: section.key=value that the text box holds
+    ExpectDisk,   // text: section.key=value that settings.ini holds
+};
+
+struct UiEvent {
+    UiEventKind kind = UiEventKind::Save;
+    int controlId = 0;
+    int value = 0;
+    size_t start = 0;
+    size_t removed = 0;
+    std::string text;
+    ViewAnswer answer = ViewAnswer::Yes;
+    size_t line = 0;  // In the file it was read from (0 if it wasn't)
+};
+
+struct UiRecording {
+    std::vector<UiEvent> events;
+};
+
+// "select", "type", ... as written in the file
+const char* UiEventName(UiEventKind kind);
+
+// Answers, desktop resolutions and disk contents are what the interaction before them found, not interactions of their own
+bool IsUiEventInput(UiEventKind kind);
+
+// Expectations are checks, not interactions
+bool IsUiEventCheck(UiEventKind kind);
+
+std::string FormatUiRecording(const UiRecording& recording);
+bool ParseUiRecording(std::string_view text, UiRecording& recording, std::string& error);
+
+bool ReadUiRecording(const std::string& path, UiRecording& recording, std::string& error);
+bool WriteUiRecording(const std::string& path, const UiRecording& recording, std::string& error);
@@ -0,0 +1,234 @@
+/*
+ * UiReplay.cpp
+ * "Déjà vu! Haven't I clicked this before?"
+ */
+
+#include "UiReplay.h"
+
+#include "AtomicFile.h"
+#include "LauncherController.h"
+#include "SettingsCli.h"
+#include "TextFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+
+namespace {
+
+// Controls that are just numbers, and a text box that's just a string
+class FakeLauncherView : public LauncherView {
+public:
+    EditBuffer& TextBox() override { return textBox_; }
+    int ControlValue(const SettingBinding& binding) override { return values_[&binding - settingBindings]; }
+    void SetControlValue(const SettingBinding& binding, int value) override { values_[&binding - settingBindings] = value; }
+    void SetResolutionItems(const std::vector<ResolutionChoice>&) override {}
+    void ShowSaveReminder(bool) override {}
+    void ShowDiagnostic(const std::string&, bool) override {}
+    void ValidationDue() override { validationDue_ = true; }
+    void JournalDue() override {}
+    void ShowError(const std::string&, const std::string&) override {}
+    void Beep() override {}
+
+    ViewAnswer Ask(const std::string&, const std::string&, bool) override {
+        if (answers_.empty()) {
+            ++unanswered_;
+            return ViewAnswer::Yes;
+        }
+        ViewAnswer answer = answers_.front();
+        answers_.pop_front();
+        return answer;
+    }
+
+    MemoryEditBuffer textBox_;
+    int values_[settingBindingCount] = {};
+    bool validationDue_ = false;
+    std::deque<ViewAnswer> answers_;  // What the next questions are told, from the recording
+    size_t unanswered_ = 0;           // Questions the recording had no answer for
+};
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<DisplayMode> ParseResolutions(std::string_view text) {
+    std::vector<DisplayMode> modes;
+    while (!text.empty()) {
+        size_t end = text.find(' ');
+        std::string word(text.substr(0, end));
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        DisplayMode mode;
+        if (std::sscanf(word.c_str(), "%dx%d", &mode.width, &mode.height) == 2) modes.push_back(mode);
+    }
+    return modes;
+}
+
+// "" when doc holds section.key=value, otherwise what it holds instead
+bool CheckExpectation(const IniDocument& doc, const std::string& expectation, std::string& found) {
+    size_t equals = expectation.find('=');
+    std::string section, key;
+    std::string_view want = std::string_view(expectation).substr(equals + 1);
+    if (!SplitSettingName(expectation.substr(0, equals), section, key)) {
+        found = "a name that isn't section.key";
+        return false;
+    }
+    const IniEntry* entry = doc.Find(section, key);
+    if (!entry) {
+        found = "no such key";
+        return false;
+    }
+    found = std::string(doc.Value(*entry));
+    return found == want;
+}
+
+std::string LinePrefix(const UiEvent& event) {
+    return event.line ? "line " + std::to_string(event.line) + ": " : std::string();
+}
+
+} // namespace
+
+UiReplayResult ReplayUiRecording(const UiRecording& recording, const UiReplayOptions& options) {
+    UiReplayResult result;
+    FakeLauncherView view;
+    std::string desktop;
+    LauncherController controller(view, [&desktop] { return desktop; });
+    controller.SetIniPath(options.iniPath);
+    bool loaded = false;
+
+    const std::vector<UiEvent>& events = recording.events;
+    for (size_t i = 0; i < events.size(); ++i) {
+        const UiEvent& event = events[i];
+        if (IsUiEventInput(event.kind)) continue; // Taken by the interaction before it
+
+        if (IsUiEventCheck(event.kind)) {
+            IniDocument disk;
+            if (event.kind == UiEventKind::ExpectDisk) disk.Parse(toWindowsNewlines(ReadFile(options.iniPath)));
+            const IniDocument& doc = event.kind == UiEventKind::Expect ? controller.Document() : disk;
+            std::string found;
+            if (!CheckExpectation(doc, event.text, found)) {
+                result.failures.push_back(LinePrefix(event) + "expected " + event.text + ", " +
+                                          (event.kind == UiEventKind::Expect ? "the text" : "settings.ini") + " has " + found);
+            }
+            continue;
+        }
+
+        // What this interaction will find, as the recording remembers it; the disk is written untimed
+        std::string typed, error;
+        view.answers_.clear();
+        view.unanswered_ = 0;
+        for (size_t j = i + 1; j < events.size() && IsUiEventInput(events[j].kind); ++j) {
+            const UiEvent& input = events[j];
+            if (input.kind == UiEventKind::Answer) view.answers_.push_back(input.answer);
+            if (input.kind == UiEventKind::Desktop) desktop = input.text;
+            if (input.kind == UiEventKind::Disk && !WriteFileAtomic(options.iniPath, input.text, error)) {
+                result.failures.push_back(LinePrefix(input) + error);
+            }
+        }
+
+        // Also untimed: what happened outside the launcher before the interaction
+        if (event.kind == UiEventKind::Load || event.kind == UiEventKind::FileChanged) {
+            if (!WriteFileAtomic(options.iniPath, event.text, error)) {
+                result.failures.push_back(LinePrefix(event) + error);
+                break;
+            }
+        }
+        if (event.kind == UiEventKind::Type) {
+            const std::string& text = view.textBox_.View();
+            if (event.start > text.size() || event.removed > text.size() - event.start) {
+                result.failures.push_back(LinePrefix(event) + "typing past the end of the text");
+                break;
+            }
+            typed = text;
+            typed.replace(event.start, event.removed, event.text);
+        }
+        const SettingBinding* binding = FindSettingBinding(event.controlId);
+        if ((event.kind == UiEventKind::Select || event.kind == UiEventKind::Check || event.kind == UiEventKind::Slide) && !binding) {
+            result.failures.push_back(LinePrefix(event) + "no setting control " + std::to_string(event.controlId));
+            break;
+        }
+
+        uint64_t allocationsBefore = options.allocationCount ? options.allocationCount() : 0;
+        Clock::time_point start = Clock::now();
+        switch (event.kind) {
+            case UiEventKind::Load:
+                controller.ShowLoaded(ReadSettingsForEditBox(options.iniPath));
+                if (!loaded) controller.Session().History().Clear(); // As at startup: undo goes back to the file as loaded
+                loaded = true;
+                break;
+            case UiEventKind::Resolutions: controller.SetResolutions(ParseResolutions(event.text)); break;
+            case UiEventKind::Select:
+            case UiEventKind::Check:
+            case UiEventKind::Slide:
+                view.values_[binding - settingBindings] = event.value;
+                controller.ControlChanged(event.controlId);
+                break;
+            case UiEventKind::Type:
+                // The edit control has the keystroke already when it says so
+                view.textBox_.Replace(event.start, event.start + event.removed, event.text);
+                controller.TextEdited(typed);
+                break;
+            case UiEventKind::Save:        controller.Save(); break;
+            case UiEventKind::Reset:       controller.Reset(); break;
+            case UiEventKind::Profile:     controller.ApplyProfile(event.text); break;
+            case UiEventKind::Undo:        controller.Undo(); break;
+            case UiEventKind::Redo:        controller.Redo(); break;
+            case UiEventKind::FileChanged: controller.FileChanged(); break;
+            default: break;
+        }
+        if (view.validationDue_) {
+            view.validationDue_ = false;
+            controller.Validate();
+        }
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        uint64_t allocations = options.allocationCount ? options.allocationCount() - allocationsBefore : 0;
+        result.timings.push_back({event.kind, event.line, ns, allocations});
+
+        if (view.unanswered_ > 0) {
+            result.failures.push_back(LinePrefix(event) + UiEventName(event.kind) + " asked a question the recording has no answer for");
+        }
+        if (!view.answers_.empty()) {
+            result.failures.push_back(LinePrefix(event) + UiEventName(event.kind) + " asked fewer questions than the recording answered");
+        }
+    }
+
+    result.text = controller.Text();
+    result.ok = result.failures.empty();
+    return result;
+}
+
+std::vector<UiLatencyStats> SummarizeUiTimings(const std::vector<UiEventTiming>& timings) {
+    std::vector<UiLatencyStats> stats;
+    for (int kind = 0; kind <= static_cast<int>(UiEventKind::ExpectDisk); ++kind) {
+        std::vector<uint64_t> ns;
+        uint64_t allocations = 0;
+        for (const UiEventTiming& timing : timings) {
+            if (static_cast<int>(timing.kind) != kind) continue;
+            ns.push_back(timing.ns);
+            allocations += timing.allocations;
+        }
+        if (ns.empty()) continue;
+        std::sort(ns.begin(), ns.end());
+        // Nearest rank: the smallest value at least p percent of the samples are at or under
+        auto percentile = [&ns](double p) { return ns[std::min(ns.size() - 1, static_cast<size_t>(p / 100 * ns.size()))]; };
+        UiLatencyStats row;
+        row.kind = static_cast<UiEventKind>(kind);
+        row.count = ns.size();
+        row.p50Ns = percentile(50);
+        row.p90Ns = percentile(90);
+        row.p99Ns = percentile(99);
+        row.maxNs = ns.back();
+        row.allocationsPerEvent = static_cast<double>(allocations) / ns.size();
+        stats.push_back(row);
+    }
+    return stats;
+}
+
+std::string FormatUiLatencyTable(const std::vector<UiLatencyStats>& stats) {
+    std::string table = "event          count     p50 us     p90 us     p99 us     max us   allocs/event\n";
+    char row[160];
+    for (const UiLatencyStats& stat : stats) {
+        std::snprintf(row, sizeof(row), "%-12s %7zu %10.1f %10.1f %10.1f %10.1f %14.1f\n", UiEventName(stat.kind), stat.count,
+                      stat.p50Ns / 1e3, stat.p90Ns / 1e3, stat.p99Ns / 1e3, stat.maxNs / 1e3, stat.allocationsPerEvent);
+        table += row;
+    }
+    return table;
+}
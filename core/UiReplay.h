@@ -0,0 +1,56 @@
+/*
+ * UiReplay.h
+ * Plays a UiRecording back through a LauncherController with stand-in
+ * controls instead of windows, and a scratch settings.ini instead of the
+ * game's. Each interaction is timed end to end, including the validation
+ * the window would run once typing paused, and its heap allocations are
+ * counted when the caller can count them.
+ *
+ * The expect lines make a recording a regression check as well: a replay
+ * that ends up with different settings, asks a question the recording has
+ * no answer for, or never asks one it does, says where.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "UiRecording.h"
+
+struct UiReplayOptions {
+    std::string iniPath;                        // Scratch settings.ini; overwritten by load and filechanged events
+    std::function<uint64_t()> allocationCount;  // Allocations so far (the benchmark counts them); none if empty
+};
+
+struct UiEventTiming {
+    UiEventKind kind = UiEventKind::Save;
+    size_t line = 0;
+    uint64_t ns = 0;
+    uint64_t allocations = 0;
+};
+
+struct UiReplayResult {
+    bool ok = false;                     // Every expectation held
+    std::vector<UiEventTiming> timings;  // One per interaction, in order
+    std::vector<std::string> failures;   // "line 12: expected display.windowed=1, the text has 0"
+    std::string text;                    // The text box at the end
+};
+
+UiReplayResult ReplayUiRecording(const UiRecording& recording, const UiReplayOptions& options);
+
+// Latency percentiles for one kind of interaction
+struct UiLatencyStats {
+    UiEventKind kind = UiEventKind::Save;
+    size_t count = 0;
+    uint64_t p50Ns = 0, p90Ns = 0, p99Ns = 0, maxNs = 0;
+    double allocationsPerEvent = 0;
+};
+
+// One row per kind that occurs in timings, in UiEventKind order
+std::vector<UiLatencyStats> SummarizeUiTimings(const std::vector<UiEventTiming>& timings);
+
+// The rows as an aligned table, microseconds
+std::string FormatUiLatencyTable(const std::vector<UiLatencyStats>& stats);
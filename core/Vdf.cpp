@@ -0,0 +1,172 @@
+/*
+ * Vdf.cpp
+ * "I've deciphered the map! Curly braces all the way down."
+ */
+
+#include "Vdf.h"
+
+#include "TextFile.h"
+#include "Trace.h"
+
+namespace {
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+class VdfParser {
+public:
+    explicit VdfParser(std::string_view text) : text_(text) {}
+
+    bool ParseBlock(VdfNode& block, bool topLevel, std::string& error) {
+        for (;;) {
+            Token token = Next();
+            if (token.kind == Token::End) {
+                if (topLevel) return true;
+                return Fail("missing '}'", error);
+            }
+            if (token.kind == Token::Close) {
+                if (!topLevel) return true;
+                return Fail("unexpected '}'", error);
+            }
+            if (token.kind != Token::String) return Fail("expected a key", error);
+
+            VdfNode node;
+            node.key = std::move(token.text);
+            Token value = Next();
+            if (value.kind == Token::Open) {
+                node.isBlock = true;
+                if (!ParseBlock(node, false, error)) return false;
+            } else if (value.kind == Token::String) {
+                node.value = std::move(value.text);
+            } else {
+                return Fail("expected a value or '{' after \"" + node.key + "\"", error);
+            }
+            block.children.push_back(std::move(node));
+        }
+    }
+
+private:
+    struct Token {
+        enum Kind { String, Open, Close, End } kind = End;
+        std::string text;
+    };
+
+    bool Fail(const std::string& message, std::string& error) const {
+        error = "line " + std::to_string(line_) + ": " + message;
+        return false;
+    }
+
+    void SkipSpaceAndComments() {
+        while (pos_ < text_.size()) {
+            char c = text_[pos_];
+            if (c == '\n') {
+                ++line_;
+                ++pos_;
+            } else if (c == ' ' || c == '\t' || c == '\r') {
+                ++pos_;
+            } else if (c == '/' && pos_ + 1 < text_.size() && text_[pos_ + 1] == '/') {
+                SkipLine();
+            } else if (c == '#') {
+                SkipLine();  // #include / #base
+            } else {
+                break;
+            }
+        }
+    }
+
+    void SkipLine() {
+        while (pos_ < text_.size() && text_[pos_] != '\n') ++pos_;
+    }
+
+    Token Next() {
+        SkipSpaceAndComments();
+        Token token;
+        if (pos_ >= text_.size()) return token;
+
+        char c = text_[pos_];
+        if (c == '{' || c == '}') {
+            ++pos_;
+            token.kind = c == '{' ? Token::Open : Token::Close;
+            return token;
+        }
+
+        token.kind = Token::String;
+        if (c == '"') {
+            ++pos_;
+            while (pos_ < text_.size() && text_[pos_] != '"') {
+                char ch = text_[pos_++];
+                if (ch == '\\' && pos_ < text_.size()) {
+                    char escaped = text_[pos_++];
+                    switch (escaped) {
+                        case 'n': ch = '\n'; break;
+                        case 't': ch = '\t'; break;
+                        default: ch = escaped; break;  // \\ and \" (and anything else, literally)
+                    }
+                } else if (ch == '\n') {
+                    ++line_;
+                }
+                token.text += ch;
+            }
+            ++pos_;  // Closing quote (or past the end of an unterminated string)
+        } else {
+            // Unquoted token: runs to whitespace, a brace or a quote
+            size_t start = pos_;
+            while (pos_ < text_.size()) {
+                char ch = text_[pos_];
+                if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '{' || ch == '}' || ch == '"') break;
+                ++pos_;
+            }
+            token.text.assign(text_.substr(start, pos_ - start));
+        }
+        return token;
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    int line_ = 1;
+};
+
+} // namespace
+
+const VdfNode* VdfNode::Find(std::string_view name) const {
+    for (const VdfNode& child : children) {
+        if (EqualsIgnoreCase(child.key, name)) return &child;
+    }
+    return nullptr;
+}
+
+std::string_view VdfNode::Get(std::string_view name) const {
+    const VdfNode* child = Find(name);
+    return child && !child->isBlock ? std::string_view(child->value) : std::string_view();
+}
+
+bool ParseVdf(std::string_view text, VdfNode& root, std::string& error) {
+    root = VdfNode();
+    root.isBlock = true;
+    // Steam writes these files as UTF-8, sometimes with a byte order mark
+    if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.remove_prefix(3);
+    VdfParser parser(text);
+    return parser.ParseBlock(root, true, error);
+}
+
+bool ReadVdfFile(const std::string& path, VdfNode& root, std::string& error) {
+    MISE_TRACE_SCOPE("ReadVdfFile");
+    std::string text;
+    if (!ReadFileBytes(path, text)) {
+        error = "Failed to open " + path;
+        return false;
+    }
+    if (!ParseVdf(text, root, error)) {
+        error = path + ", " + error;
+        return false;
+    }
+    return true;
+}
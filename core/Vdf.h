@@ -0,0 +1,40 @@
+/*
+ * Vdf.h
+ * Reader for Valve's KeyValues text format (.vdf/.acf), the files Steam
+ * keeps its library list and app manifests in:
+ *
+ *   "AppState"
+ *   {
+ *       "appid"       "32360"
+ *       "installdir"  "The Secret of Monkey Island Special Edition"
+ *   }
+ *
+ * Keys are matched case-insensitively, as Steam does. Comments (//),
+ * unquoted tokens and \" \\ \n \t escapes are understood; #include and
+ * #base directives are skipped since Steam never uses them in these files.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct VdfNode {
+    std::string key;
+    std::string value;              // Empty for blocks
+    std::vector<VdfNode> children;  // Empty for plain values
+    bool isBlock = false;
+
+    // First child called key (case-insensitive), or null
+    const VdfNode* Find(std::string_view key) const;
+
+    // Value of the child called key, or an empty view if it's missing or a block
+    std::string_view Get(std::string_view key) const;
+};
+
+// Parse a whole file into root's children; false with a line number in error when it's malformed
+bool ParseVdf(std::string_view text, VdfNode& root, std::string& error);
+
+// Read and parse path; false if it can't be read or parsed
+bool ReadVdfFile(const std::string& path, VdfNode& root, std::string& error);
@@ -0,0 +1,95 @@
+/*
+ * WorkStealing.cpp
+ * "Take what you can, give nothing back." -- every idle thread
+ */
+
+#include "WorkStealing.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// The items [next, end) a worker hasn't started yet
+struct Share {
+    std::mutex mutex;
+    size_t next = 0;
+    size_t end = 0;
+};
+
+// The next item of a worker's own share, or SIZE_MAX if it's empty
+size_t TakeOwn(Share& share) {
+    std::lock_guard<std::mutex> lock(share.mutex);
+    return share.next < share.end ? share.next++ : SIZE_MAX;
+}
+
+// Move the back half of the fullest other share to thief's (empty) one and take its first item;
+// SIZE_MAX once no share has anything left
+size_t Steal(std::vector<std::unique_ptr<Share>>& shares, unsigned thief) {
+    for (;;) {
+        size_t victim = SIZE_MAX, most = 0;
+        for (size_t i = 0; i < shares.size(); ++i) {
+            if (i == thief) continue;
+            std::lock_guard<std::mutex> lock(shares[i]->mutex);
+            size_t left = shares[i]->end - shares[i]->next;
+            if (left > most) {
+                most = left;
+                victim = i;
+            }
+        }
+        if (victim == SIZE_MAX) return SIZE_MAX;  // Everything is taken
+
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> lock(shares[victim]->mutex);
+            size_t left = shares[victim]->end - shares[victim]->next;
+            if (left == 0) continue;  // Emptied meanwhile; look again
+            // A single item left is taken whole: the victim would otherwise have nothing to do either
+            begin = shares[victim]->end - (left + 1) / 2;
+            end = shares[victim]->end;
+            shares[victim]->end = begin;
+        }
+        std::lock_guard<std::mutex> lock(shares[thief]->mutex);
+        shares[thief]->next = begin + 1;
+        shares[thief]->end = end;
+        return begin;
+    }
+}
+
+} // namespace
+
+void RunWorkStealing(size_t count, unsigned workers, const std::function<void(size_t item, unsigned worker)>& work) {
+    if (count == 0) return;
+    if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+    workers = static_cast<unsigned>(std::min<size_t>(workers, count));
+    if (workers == 1) {
+        for (size_t item = 0; item < count; ++item) work(item, 0);
+        return;
+    }
+
+    std::vector<std::unique_ptr<Share>> shares;
+    for (unsigned worker = 0; worker < workers; ++worker) {
+        shares.push_back(std::make_unique<Share>());
+        shares.back()->next = count * worker / workers;
+        shares.back()->end = count * (worker + 1) / workers;
+    }
+    auto run = [&](unsigned worker) {
+        MISE_TRACE_SCOPE("WorkStealingWorker");
+        for (;;) {
+            size_t item = TakeOwn(*shares[worker]);
+            if (item == SIZE_MAX) item = Steal(shares, worker);
+            if (item == SIZE_MAX) return;
+            work(item, worker);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned worker = 1; worker < workers; ++worker) pool.emplace_back(run, worker);
+    run(0);
+    for (std::thread& thread : pool) thread.join();
+}
@@ -0,0 +1,24 @@
+/*
+ * WorkStealing.h
+ * Run one function over a range of items on a few threads, for work whose
+ * items cost very different amounts (hashing a 2 GB archive next to a
+ * 300-byte script).
+ *
+ * Each worker starts on its own contiguous share of the items and works
+ * through it front to back, so neighbouring items (the blocks of one file)
+ * mostly stay on one thread. A worker that runs out takes the back half of
+ * whichever share has the most left, so one big file never leaves the
+ * other threads idle while it's hashed.
+ *
+ *   RunWorkStealing(blocks.size(), 0, [&](size_t block, unsigned worker) { ... });
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Call work(item, worker) once for every item in [0, count) on up to 'workers' threads
+// (0 = one per hardware thread, capped by count); worker is 0-based. Returns when all are done.
+// With one worker everything runs on the calling thread, in order
+void RunWorkStealing(size_t count, unsigned workers, const std::function<void(size_t item, unsigned worker)>& work);
@@ -0,0 +1,205 @@
+/*
+ * AssetPrefetchTest.cpp
+ * Prefetching a fixture install folder with free memory and memory
+ * pressure handed in instead of read from the system: the plan only
+ * takes what fits above the reserve, reading stops when memory runs short
+ * part way, the throttle keeps to its rate, and /proc/meminfo and
+ * /proc/pressure/memory text is read the way the kernel writes it.
+ */
+
+#include "Test.h"
+
+#include "../core/AssetPrefetch.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace {
+
+constexpr uint64_t MB = 1 << 20;
+
+// An install folder of archives of the given sizes (in MB) and one file too small to prefetch
+struct PrefetchFixture {
+    TestScratchDir scratch{"mise_test_prefetch"};
+    uint64_t bytes = 0;
+
+    explicit PrefetchFixture(std::initializer_list<uint64_t> archiveSizes) {
+        size_t i = 0;
+        for (uint64_t size : archiveSizes) {
+            WriteTestFile(scratch / ("Data/Archive" + std::to_string(i++) + ".pak"), std::string(size * MB, 'x'));
+            bytes += size * MB;
+        }
+        WriteTestFile(scratch / "Audio/cue0.xwb", std::string(1000, 'x'));
+    }
+};
+
+// Options for the fixture: 1 MB files count, 100 MB kept back, and the memory readings 'available' and
+// 'underPressure' hold at the time
+PrefetchOptions Options(const std::atomic<uint64_t>& available, const std::atomic<bool>& underPressure) {
+    PrefetchOptions options;
+    options.minFileSize = MB;
+    options.memoryReserve = 100 * MB;
+    options.readMemory = [&available, &underPressure](uint64_t& availableNow, bool& underPressureNow) {
+        availableNow = available;
+        underPressureNow = underPressure;
+        return true;
+    };
+    return options;
+}
+
+} // namespace
+
+MISE_TEST(AssetPrefetch, EverythingFits) {
+    PrefetchFixture fixture{8, 4, 2};
+    std::atomic<uint64_t> available{1024 * MB};
+    std::atomic<bool> underPressure{false};
+    std::atomic<bool> stop{false};
+    PrefetchProgress progress = PrefetchAssets(fixture.scratch.Path(), Options(available, underPressure), stop, nullptr);
+    MISE_CHECK(progress.state == PrefetchState::Done);
+    MISE_CHECK_EQUAL(progress.files, 3u);
+    MISE_CHECK_EQUAL(progress.filesDone, 3u);
+    MISE_CHECK_EQUAL(progress.bytesDone, fixture.bytes);
+    MISE_CHECK_EQUAL(progress.Percent(), 100u);
+}
+
+MISE_TEST(AssetPrefetch, PlanTrimmedToFreeMemory) {
+    // 11 MB above the reserve: the 8 MB archive fits, the 4 MB one doesn't, the 2 MB one still does
+    PrefetchFixture fixture{8, 4, 2};
+    std::atomic<uint64_t> available{111 * MB};
+    std::atomic<bool> underPressure{false};
+    std::atomic<bool> stop{false};
+    PrefetchProgress progress = PrefetchAssets(fixture.scratch.Path(), Options(available, underPressure), stop, nullptr);
+    MISE_CHECK(progress.state == PrefetchState::LowMemory);
+    MISE_CHECK_EQUAL(progress.files, 2u);
+    MISE_CHECK_EQUAL(progress.filesDone, 2u);
+    MISE_CHECK_EQUAL(progress.bytesDone, 10 * MB);
+    MISE_CHECK(PrefetchSummary(progress).find("not enough free memory") != std::string::npos);
+}
+
+MISE_TEST(AssetPrefetch, NothingAboveTheReserve) {
+    PrefetchFixture fixture{8, 4};
+    std::atomic<uint64_t> available{100 * MB};
+    std::atomic<bool> underPressure{false};
+    std::atomic<bool> stop{false};
+    PrefetchProgress progress = PrefetchAssets(fixture.scratch.Path(), Options(available, underPressure), stop, nullptr);
+    MISE_CHECK(progress.state == PrefetchState::LowMemory);
+    MISE_CHECK_EQUAL(progress.files, 0u);
+    MISE_CHECK_EQUAL(progress.bytesDone, 0u);
+}
+
+MISE_TEST(AssetPrefetch, PressureBeforeStarting) {
+    // Plenty free, but the system says it's short of memory already
+    PrefetchFixture fixture{8, 4};
+    std::atomic<uint64_t> available{64ull << 30};
+    std::atomic<bool> underPressure{true};
+    std::atomic<bool> stop{false};
+    PrefetchProgress progress = PrefetchAssets(fixture.scratch.Path(), Options(available, underPressure), stop, nullptr);
+    MISE_CHECK(progress.state == PrefetchState::LowMemory);
+    MISE_CHECK_EQUAL(progress.bytesDone, 0u);
+}
+
+MISE_TEST(AssetPrefetch, StopsWhenMemoryRunsShort) {
+    // Memory is asked about every 64 MB; it's gone by the first time, so reading stops there, not at the end
+    PrefetchFixture fixture{48, 48};
+    std::atomic<uint64_t> available{1024 * MB};
+    std::atomic<bool> underPressure{false};
+    std::atomic<bool> stop{false};
+    PrefetchOptions options = Options(available, underPressure);
+    options.threads = 1;
+    options.progressEveryMs = 1;
+    PrefetchProgress progress = PrefetchAssets(fixture.scratch.Path(), options, stop, [&](const PrefetchProgress&) {
+        available = 50 * MB;
+    });
+    MISE_CHECK(progress.state == PrefetchState::LowMemory);
+    MISE_CHECK_EQUAL(progress.files, 2u);
+    MISE_CHECK(progress.bytesDone >= 64 * MB);
+    MISE_CHECK(progress.bytesDone < fixture.bytes);
+
+    // Pressure stops it the same way with memory to spare
+    available = 1024 * MB;
+    progress = PrefetchAssets(fixture.scratch.Path(), options, stop, [&](const PrefetchProgress&) { underPressure = true; });
+    MISE_CHECK(progress.state == PrefetchState::LowMemory);
+    MISE_CHECK(progress.bytesDone < fixture.bytes);
+}
+
+MISE_TEST(AssetPrefetch, NoReadingMeansNoCutoff) {
+    PrefetchFixture fixture{8, 4};
+    std::atomic<bool> stop{false};
+    PrefetchOptions options;
+    options.minFileSize = MB;
+    options.memoryReserve = UINT64_MAX / 2;
+    options.readMemory = [](uint64_t&, bool&) { return false; };
+    PrefetchProgress progress = PrefetchAssets(fixture.scratch.Path(), options, stop, nullptr);
+    MISE_CHECK(progress.state == PrefetchState::Done);
+    MISE_CHECK_EQUAL(progress.bytesDone, fixture.bytes);
+}
+
+MISE_TEST(AssetPrefetch, ThrottleKeepsToItsRate) {
+    // 12 MB at 24 MB/s takes half a second at least, where unthrottled it's a cached read
+    PrefetchFixture fixture{8, 4};
+    std::atomic<uint64_t> available{1024 * MB};
+    std::atomic<bool> underPressure{false};
+    std::atomic<bool> stop{false};
+    PrefetchOptions options = Options(available, underPressure);
+    options.maxBytesPerSecond = 24 * MB;
+    auto start = std::chrono::steady_clock::now();
+    PrefetchProgress progress = PrefetchAssets(fixture.scratch.Path(), options, stop, nullptr);
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    MISE_CHECK(progress.state == PrefetchState::Done);
+    MISE_CHECK_EQUAL(progress.bytesDone, fixture.bytes);
+    MISE_CHECK(elapsedMs >= 490);
+    MISE_CHECK(progress.elapsedMs >= 490u);
+}
+
+MISE_TEST(AssetPrefetch, StopFlag) {
+    PrefetchFixture fixture{8, 4};
+    std::atomic<uint64_t> available{1024 * MB};
+    std::atomic<bool> underPressure{false};
+    std::atomic<bool> stop{false};
+    PrefetchOptions options = Options(available, underPressure);
+    options.threads = 1;
+    options.maxBytesPerSecond = 24 * MB;
+    options.progressEveryMs = 1;
+    PrefetchProgress progress = PrefetchAssets(fixture.scratch.Path(), options, stop, [&](const PrefetchProgress& now) {
+        if (now.state == PrefetchState::Running) stop = true;
+    });
+    MISE_CHECK(progress.state == PrefetchState::Stopped);
+    MISE_CHECK(progress.bytesDone < fixture.bytes);
+    MISE_CHECK(PrefetchSummary(progress).find("(stopped)") != std::string::npos);
+}
+
+MISE_TEST(AssetPrefetch, NoInstallFolder) {
+    TestScratchDir scratch("mise_test_prefetch_missing");
+    std::atomic<bool> stop{false};
+    PrefetchProgress progress = PrefetchAssets(scratch / "Game", PrefetchOptions(), stop, nullptr);
+    MISE_CHECK(progress.state == PrefetchState::Failed);
+    MISE_CHECK(progress.error.find("Game is not a folder") != std::string::npos);
+}
+
+MISE_TEST(AssetPrefetch, ParseMemInfoAndPressure) {
+    const char* meminfo =
+        "MemTotal:       16314876 kB\n"
+        "MemFree:         1203456 kB\n"
+        "MemAvailable:    9876543 kB\n"
+        "Buffers:          345678 kB\n";
+    uint64_t available = 0;
+    bool underPressure = true;
+    MISE_CHECK(ParseLinuxMemoryState(meminfo,
+                                     "some avg10=0.52 avg60=1.10 avg300=0.40 total=123456\n"
+                                     "full avg10=0.00 avg60=0.00 avg300=0.00 total=2345\n",
+                                     available, underPressure));
+    MISE_CHECK_EQUAL(available, 9876543ull << 10);
+    MISE_CHECK(!underPressure);
+
+    MISE_CHECK(ParseLinuxMemoryState(meminfo, "some avg10=37.25 avg60=12.00 avg300=3.10 total=99999999\n", available,
+                                     underPressure));
+    MISE_CHECK(underPressure);
+
+    // No PSI (older kernels, or turned off): memory alone decides
+    MISE_CHECK(ParseLinuxMemoryState(meminfo, "", available, underPressure));
+    MISE_CHECK(!underPressure);
+
+    // Kernels before 3.14 have no MemAvailable
+    MISE_CHECK(!ParseLinuxMemoryState("MemTotal:       16314876 kB\nMemFree:         1203456 kB\n", "", available,
+                                      underPressure));
+}
@@ -0,0 +1,83 @@
+/*
+ * AtomicFileTest.cpp
+ * Atomic replacement under two writers at once, and errors that say which
+ * file they were about.
+ */
+
+#include "Test.h"
+
+#include "../core/AtomicFile.h"
+
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+MISE_TEST(AtomicFile, ReplacesTheFile) {
+    TestScratchDir dir("mise_test_atomic");
+    const std::string path = dir / "settings.ini";
+    std::string error;
+    MISE_CHECK(WriteFileAtomic(path, "first", error));
+    MISE_CHECK(WriteFileAtomic(path, std::string("sec\0nd\r\n", 8), error));
+    MISE_CHECK_EQUAL(ReadTestFile(path), std::string("sec\0nd\r\n", 8));
+}
+
+MISE_TEST(AtomicFile, ConcurrentWritersOfOneFile) {
+    // The window's Save and the control channel's save can land on settings.ini at the same moment:
+    // every write must succeed and the file must always be one of them whole
+    TestScratchDir dir("mise_test_atomic");
+    const std::string path = dir / "settings.ini";
+    const size_t writers = 4, writes = 100, size = 64 << 10;
+    std::atomic<size_t> failures{0};
+    std::atomic<bool> mixed{false};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < writers; ++t) {
+        threads.emplace_back([&, t] {
+            const std::string content(size, char('a' + t));
+            for (size_t i = 0; i < writes; ++i) {
+                std::string error;
+                if (!WriteFileAtomic(path, content, error)) ++failures;
+                std::string seen = ReadTestFile(path);
+                if (seen.size() != size || seen.find_first_not_of(seen[0]) != std::string::npos) mixed = true;
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    MISE_CHECK_EQUAL(failures.load(), size_t(0));
+    MISE_CHECK(!mixed);
+
+    size_t files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir.Path())) {
+        (void)entry;
+        ++files;
+    }
+    MISE_CHECK_EQUAL(files, size_t(1));  // No temp files left
+}
+
+MISE_TEST(AtomicFile, StagedFilesDontCollide) {
+    TestScratchDir dir("mise_test_atomic");
+    const std::string path = dir / "profiles.dat";
+    std::string first, second, error;
+    MISE_CHECK(StageFileAtomic(path, "one", first, error));
+    MISE_CHECK(StageFileAtomic(path, "two", second, error));
+    MISE_CHECK(first != second);
+    MISE_CHECK_EQUAL(ReadTestFile(first), "one");
+    MISE_CHECK(CommitStagedFile(second, path, error));
+    MISE_CHECK(CommitStagedFile(first, path, error));
+    MISE_CHECK_EQUAL(ReadTestFile(path), "one");
+}
+
+MISE_TEST(AtomicFile, ErrorsNameTheFile) {
+    TestScratchDir dir("mise_test_atomic");
+    const std::string path = dir / "missing/install.manifest";
+    std::string error;
+    MISE_CHECK(!WriteFileAtomic(path, "x", error));
+    MISE_CHECK(error.find(path) != std::string::npos);
+    MISE_CHECK(error.find("settings.ini") == std::string::npos);
+
+    // A folder can't be replaced by a file
+    const std::string folder = dir / "journal";
+    std::filesystem::create_directories(folder + "/inside");
+    MISE_CHECK(!WriteFileAtomic(folder, "x", error));
+    MISE_CHECK(error.find("Could not replace " + folder) != std::string::npos);
+}
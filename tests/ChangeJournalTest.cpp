@@ -0,0 +1,207 @@
+/*
+ * ChangeJournalTest.cpp
+ * Unsaved-edit journals cut short at every byte and damaged at every byte,
+ * as a crash mid-write or a bad sector would leave them: exactly the edits
+ * written before the damage must come back, and nothing after it.
+ */
+
+#include "Test.h"
+
+#include "../core/ChangeJournal.h"
+#include "../core/TextFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace {
+
+std::string StartingText() {
+    std::string text = "[localization]\r\nlanguage=0\r\n[display]\r\nwindowed=1\r\nresolution=1920x1080\r\n";
+    for (int section = 0; section < 4; ++section) {
+        text += "[filler" + std::to_string(section) + "]\r\n";
+        for (int key = 0; key < 10; ++key) text += "key" + std::to_string(key) + "=" + std::to_string(section * key) + "\r\n";
+    }
+    return text;
+}
+
+// Writes a journal of random edits and remembers the text after each one
+struct JournalFixture {
+    std::string path;
+    std::vector<std::string> states;  // states[k]: the text after k edits
+    std::vector<uint64_t> ends;       // ends[k]: the journal's size once edit k+1 was appended (the snapshot's end for the compacted edit)
+    uint64_t baseEnd = 0;             // Where the base record ends; nothing can be read from less
+    std::string bytes;                // The journal file as written
+
+    JournalFixture(const std::string& journalPath, size_t edits, size_t compactAfter = 0) : path(journalPath) {
+        std::mt19937 random(32360);
+        std::string text = StartingText();
+        ChangeJournal journal;
+        journal.Start(path, text);
+        states.push_back(text);
+        for (size_t i = 0; i < edits; ++i) {
+            size_t start = random() % (text.size() + 1);
+            size_t removed = std::min<size_t>(random() % 3, text.size() - start);
+            std::string inserted = random() % 4 == 0 ? "" : std::string(1 + random() % (i % 10 == 0 ? 40 : 2), char('a' + random() % 26));
+            text.replace(start, removed, inserted);
+            journal.Append(start, removed, inserted);
+            if (i == 0) baseEnd = journal.FileSize() - (4 + 1 + 4 + 8 + inserted.size());
+            states.push_back(text);
+            if (i + 1 == compactAfter) {
+                std::string error;
+                journal.Compact(text, error);
+                ends.clear();  // The records before it are gone
+            }
+            ends.push_back(journal.FileSize());
+        }
+        journal.Close();
+        bytes = ReadTestFile(path);
+    }
+
+    // Records wholly written before byte 'size'
+    size_t RecordsBefore(uint64_t size) const {
+        size_t records = 0;
+        while (records < ends.size() && ends[records] <= size) ++records;
+        return records;
+    }
+};
+
+// Replay damaged journal bytes; true if they recovered exactly states[expected], or nothing at all when expected is npos
+bool Recovers(const JournalFixture& fixture, const std::string& damaged, size_t expected) {
+    std::string path = fixture.path + ".damaged";
+    WriteTestFile(path, damaged);
+    JournalContents contents;
+    std::string error;
+    bool read = ReadChangeJournal(path, contents, error);
+    return expected == std::string::npos ? !read : read && contents.text == fixture.states[expected];
+}
+
+} // namespace
+
+MISE_TEST(ChangeJournal, ReplaysEveryEdit) {
+    TestScratchDir dir("mise_test_journal");
+    JournalFixture fixture(dir / "settings.ini.journal", 200);
+    JournalContents contents;
+    std::string error;
+    MISE_CHECK(ReadChangeJournal(fixture.path, contents, error));
+    MISE_CHECK_EQUAL(contents.base, fixture.states.front());
+    MISE_CHECK_EQUAL(contents.text, fixture.states.back());
+    MISE_CHECK_EQUAL(contents.edits, size_t(200));
+    MISE_CHECK_EQUAL(contents.unreadableBytes, size_t(0));
+}
+
+MISE_TEST(ChangeJournal, StopsAtATornRecord) {
+    // A crash halfway through appending edit 51: the first 50 come back and the rest is counted as unreadable
+    TestScratchDir dir("mise_test_journal");
+    JournalFixture fixture(dir / "settings.ini.journal", 60);
+    size_t cut = static_cast<size_t>(fixture.ends[49] + (fixture.ends[50] - fixture.ends[49]) / 2);
+    WriteTestFile(fixture.path, fixture.bytes.substr(0, cut));
+    JournalContents contents;
+    std::string error;
+    MISE_CHECK(ReadChangeJournal(fixture.path, contents, error));
+    MISE_CHECK_EQUAL(contents.text, fixture.states[50]);
+    MISE_CHECK_EQUAL(contents.edits, size_t(50));
+    MISE_CHECK_EQUAL(contents.unreadableBytes, cut - static_cast<size_t>(fixture.ends[49]));
+}
+
+MISE_TEST(ChangeJournal, CutShortAtEveryByte) {
+    TestScratchDir dir("mise_test_journal");
+    JournalFixture fixture(dir / "settings.ini.journal", 200);
+    size_t wrong = 0;
+    for (size_t size = 0; size <= fixture.bytes.size(); ++size) {
+        size_t expected = size < fixture.baseEnd ? std::string::npos : fixture.RecordsBefore(size);
+        if (!Recovers(fixture, fixture.bytes.substr(0, size), expected)) ++wrong;
+    }
+    MISE_CHECK_EQUAL(wrong, size_t(0));
+}
+
+MISE_TEST(ChangeJournal, CutShortAfterCompacting) {
+    // The snapshot and the edits appended after it
+    TestScratchDir dir("mise_test_journal");
+    const size_t compactAfter = 120;
+    JournalFixture fixture(dir / "settings.ini.journal", 200, compactAfter);
+    size_t wrong = 0;
+    for (size_t size = fixture.ends.front(); size <= fixture.bytes.size(); ++size) {
+        size_t expected = compactAfter + fixture.RecordsBefore(size) - 1;  // The first "record" is the snapshot
+        if (!Recovers(fixture, fixture.bytes.substr(0, size), expected)) ++wrong;
+    }
+    MISE_CHECK_EQUAL(wrong, size_t(0));
+}
+
+MISE_TEST(ChangeJournal, DamagedAtEveryByte) {
+    // Everything written before the damaged record comes back, nothing after it
+    TestScratchDir dir("mise_test_journal");
+    JournalFixture fixture(dir / "settings.ini.journal", 200);
+    size_t wrong = 0;
+    for (size_t at = 0; at < fixture.bytes.size(); ++at) {
+        std::string damaged = fixture.bytes;
+        damaged[at] ^= 0x5A;
+        size_t expected = at < fixture.baseEnd ? std::string::npos : fixture.RecordsBefore(at);
+        if (!Recovers(fixture, damaged, expected)) ++wrong;
+    }
+    MISE_CHECK_EQUAL(wrong, size_t(0));
+}
+
+MISE_TEST(ChangeJournal, CompactReplacesTheFileWhole) {
+    TestScratchDir dir("mise_test_journal");
+    const std::string path = dir / "settings.ini.journal";
+    const std::string base = StartingText();
+    ChangeJournal journal;
+    journal.Start(path, base);
+    std::string text = base;
+    for (int i = 0; i < 20; ++i) {
+        text.insert(0, "x");
+        journal.Append(0, 0, "x");
+    }
+    const std::string before = ReadTestFile(path);
+
+    // A reader that opened the journal before compaction still sees the old file in full: it was
+    // replaced by a rename, not rewritten in place
+    std::ifstream reader(path, std::ios::binary);
+    std::string error;
+    MISE_CHECK(journal.Compact(text, error));
+    std::string seen((std::istreambuf_iterator<char>(reader)), std::istreambuf_iterator<char>());
+    reader.close();
+#ifndef _WIN32
+    MISE_CHECK_EQUAL(seen, before);
+#endif
+
+    JournalContents contents;
+    MISE_CHECK(ReadChangeJournal(path, contents, error));
+    MISE_CHECK_EQUAL(contents.base, base);
+    MISE_CHECK_EQUAL(contents.text, text);
+    MISE_CHECK_EQUAL(contents.edits, size_t(0));
+    MISE_CHECK(ReadTestFile(path).size() < before.size() + text.size());
+    size_t files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir.Path())) {
+        (void)entry;
+        ++files;
+    }
+    MISE_CHECK_EQUAL(files, size_t(1));  // No temp file left behind
+
+    // Appending carries on in the new file
+    text.insert(0, "y");
+    MISE_CHECK(journal.Append(0, 0, "y"));
+    journal.Close();
+    MISE_CHECK(ReadChangeJournal(path, contents, error));
+    MISE_CHECK_EQUAL(contents.text, text);
+    MISE_CHECK_EQUAL(contents.edits, size_t(1));
+
+    // Undone back to the base: nothing left to keep
+    journal.Start(path, base);
+    journal.Append(0, 0, "z");
+    MISE_CHECK(journal.Compact(base, error));
+    MISE_CHECK(!std::filesystem::exists(path));
+}
+
+MISE_TEST(ChangeJournal, NowhereToWrite) {
+    // Appends and compaction fail without taking anything else down
+    TestScratchDir dir("mise_test_journal");
+    ChangeJournal journal;
+    journal.Start(dir / "missing/settings.ini.journal", "[audio]\r\nmusic=70\r\n");
+    std::string error;
+    MISE_CHECK(!journal.Append(0, 0, "x"));
+    MISE_CHECK(!journal.Append(1, 0, "y"));
+    MISE_CHECK(!journal.Compact("x[audio]\r\nmusic=70\r\n", error));
+    MISE_CHECK(!error.empty());
+}
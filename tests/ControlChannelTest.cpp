@@ -0,0 +1,44 @@
+/*
+ * ControlChannelTest.cpp
+ * A client talking to a server on a scratch endpoint.
+ */
+
+#include "Test.h"
+
+#include "../core/ControlChannel.h"
+
+namespace {
+
+std::string ScratchEndpoint(const TestScratchDir& dir) {
+#ifdef _WIN32
+    return "\\\\.\\pipe\\MISETests-" + std::to_string(std::hash<std::string>()(dir.Path()));
+#else
+    return dir / "control.sock";
+#endif
+}
+
+} // namespace
+
+MISE_TEST(ControlChannel, RequestsAndResponses) {
+    TestScratchDir dir("mise_test_control");
+    const std::string endpoint = ScratchEndpoint(dir);
+    ControlServer server;
+    std::string error;
+    MISE_CHECK(server.Start(endpoint, [](std::string_view request) { return "ok " + std::string(request); }, error));
+
+    ControlServer second;
+    MISE_CHECK(!second.Start(endpoint, [](std::string_view) { return std::string(); }, error));
+
+    ControlClient client;
+    MISE_CHECK(client.Connect(endpoint, error));
+    std::string response;
+    for (const char* request : {"get audio.music", "set display.windowed=0"}) {
+        MISE_CHECK(client.Request(request, response, error));
+        MISE_CHECK_EQUAL(response, "ok " + std::string(request));
+    }
+    client.Close();
+    server.Stop();
+
+    ControlClient late;
+    MISE_CHECK(!late.Connect(endpoint, error));
+}
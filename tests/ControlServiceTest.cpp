@@ -0,0 +1,180 @@
+/*
+ * ControlServiceTest.cpp
+ * Requests answered against a scratch settings.ini: get and set (checked
+ * against the schema), save merging with what changed on disk, profiles,
+ * reload and launch, and the one-line error replies.
+ */
+
+#include "Test.h"
+
+#include "../core/ControlService.h"
+#include "../core/ProfileStore.h"
+
+namespace {
+
+const char* const settingsText = "[display]\r\nwindowed=1\r\n[audio]\r\nmusic=70\r\nsfx=70\r\n";
+
+// A scratch settings.ini and a service loaded from it
+struct ServiceFixture {
+    TestScratchDir scratch{"mise_test_control_service"};
+    std::string ini = scratch / "settings.ini";
+    int launches = 0;
+    ControlService service;
+
+    explicit ServiceFixture(bool canLaunch = true) : service(ini, Hooks(canLaunch)) {
+        WriteTestFile(ini, settingsText);
+        std::string error;
+        MISE_CHECK(service.Load(error));
+    }
+
+    ControlHooks Hooks(bool canLaunch) {
+        ControlHooks hooks;
+        if (canLaunch) {
+            hooks.launchGame = [this](std::string&) {
+                ++launches;
+                return true;
+            };
+        }
+        return hooks;
+    }
+
+    std::string Disk(const char* section, const char* key) const {
+        return std::string(IniDocument(ReadTestFile(ini)).Value(section, key));
+    }
+};
+
+bool IsError(const std::string& reply) {
+    return reply.compare(0, 6, "error ") == 0 && reply.find_first_of("\r\n") == std::string::npos;
+}
+
+} // namespace
+
+MISE_TEST(ControlService, GetAndSet) {
+    ServiceFixture fixture;
+    ControlService& service = fixture.service;
+    MISE_CHECK_EQUAL(service.Handle("ping"), "ok");
+    MISE_CHECK_EQUAL(service.Handle("get audio.music"), "ok 70");
+    MISE_CHECK_EQUAL(service.Handle("get  display.windowed \r"), "ok 1");
+
+    MISE_CHECK_EQUAL(service.Handle("set audio.music=40"), "ok changed");
+    MISE_CHECK_EQUAL(service.Handle("set audio.music = 40"), "ok unchanged");
+    MISE_CHECK_EQUAL(service.Handle("get audio.music"), "ok 40");
+    MISE_CHECK(service.HasUnsavedChanges());
+
+    // Keys that aren't there yet are added
+    MISE_CHECK_EQUAL(service.Handle("set audio.voice=55"), "ok changed");
+    MISE_CHECK_EQUAL(service.Handle("get audio.voice"), "ok 55");
+
+    // Nothing reaches the disk before save
+    MISE_CHECK_EQUAL(ReadTestFile(fixture.ini), settingsText);
+}
+
+MISE_TEST(ControlService, ErrorReplies) {
+    ServiceFixture fixture(false);
+    ControlService& service = fixture.service;
+    MISE_CHECK_EQUAL(service.Handle("get audio.ambience"), "error audio.ambience not found");
+    MISE_CHECK_EQUAL(service.Handle("get music"), "error get expects section.key");
+    MISE_CHECK_EQUAL(service.Handle("set audio.music"), "error set expects section.key=value");
+    MISE_CHECK_EQUAL(service.Handle("set music=40"), "error set expects section.key=value");
+    MISE_CHECK_EQUAL(service.Handle("set audio.music=4\r0"), "error set values can't have line breaks in them");
+    MISE_CHECK_EQUAL(service.Handle("profile"), "error profile expects a profile name");
+    MISE_CHECK_EQUAL(service.Handle("profile Nobody"), "error No profile named 'Nobody'");
+    MISE_CHECK_EQUAL(service.Handle("fly"), "error Unknown request 'fly'");
+    MISE_CHECK_EQUAL(service.Handle("launch"), "error Launching the game is not supported here");
+
+    // Values the schema doesn't allow are refused before they reach the document
+    std::string reply = service.Handle("set audio.music=150");
+    MISE_CHECK(IsError(reply));
+    MISE_CHECK(reply.find("music") != std::string::npos);
+    MISE_CHECK(IsError(service.Handle("set display.windowed=yes")));
+    MISE_CHECK_EQUAL(service.Handle("get audio.music"), "ok 70");
+    MISE_CHECK(!service.HasUnsavedChanges());
+    MISE_CHECK_EQUAL(ReadTestFile(fixture.ini), settingsText);
+}
+
+MISE_TEST(ControlService, SaveWritesOnlyWhenChanged) {
+    ServiceFixture fixture;
+    ControlService& service = fixture.service;
+    MISE_CHECK_EQUAL(service.Handle("save"), "ok unchanged");
+    MISE_CHECK_EQUAL(ReadTestFile(fixture.ini), settingsText);
+
+    MISE_CHECK_EQUAL(service.Handle("set audio.music=40"), "ok changed");
+    MISE_CHECK_EQUAL(service.Handle("save"), "ok written");
+    MISE_CHECK(!service.HasUnsavedChanges());
+    MISE_CHECK_EQUAL(fixture.Disk("audio", "music"), "40");
+    MISE_CHECK_EQUAL(fixture.Disk("display", "windowed"), "1");
+    MISE_CHECK_EQUAL(service.Handle("save"), "ok unchanged");
+}
+
+MISE_TEST(ControlService, SaveMergesWithTheDisk) {
+    ServiceFixture fixture;
+    ControlService& service = fixture.service;
+    MISE_CHECK_EQUAL(service.Handle("set audio.music=40"), "ok changed");
+    MISE_CHECK_EQUAL(service.Handle("set display.windowed=0"), "ok changed");
+
+    // The game rewrote settings.ini meanwhile: one key only it changed, one both changed
+    WriteTestFile(fixture.ini, "[display]\r\nwindowed=1\r\n[audio]\r\nmusic=90\r\nsfx=10\r\n");
+    service.FileChanged();  // Unsaved sets: the request's document stays
+    MISE_CHECK_EQUAL(service.Handle("get audio.music"), "ok 40");
+
+    MISE_CHECK_EQUAL(service.Handle("save"), "ok written");
+    MISE_CHECK_EQUAL(fixture.Disk("audio", "music"), "40");     // The request's set is the newest word
+    MISE_CHECK_EQUAL(fixture.Disk("audio", "sfx"), "10");       // The game's change is kept
+    MISE_CHECK_EQUAL(fixture.Disk("display", "windowed"), "0");
+    MISE_CHECK_EQUAL(service.Handle("get audio.sfx"), "ok 10");
+}
+
+MISE_TEST(ControlService, FileChangedAndReload) {
+    ServiceFixture fixture;
+    ControlService& service = fixture.service;
+
+    // Nothing unsaved: a change on disk is picked up
+    WriteTestFile(fixture.ini, "[display]\r\nwindowed=0\r\n[audio]\r\nmusic=70\r\nsfx=70\r\n");
+    service.FileChanged();
+    MISE_CHECK_EQUAL(service.Handle("get display.windowed"), "ok 0");
+
+    // reload drops unsaved sets
+    MISE_CHECK_EQUAL(service.Handle("set audio.music=10"), "ok changed");
+    MISE_CHECK_EQUAL(service.Handle("reload"), "ok");
+    MISE_CHECK(!service.HasUnsavedChanges());
+    MISE_CHECK_EQUAL(service.Handle("get audio.music"), "ok 70");
+
+    // A settings.ini that can't be read empties the document and is never overwritten by save
+    TestScratchDir missing("mise_test_control_service_missing");
+    ControlService orphan(missing / "settings.ini", ControlHooks());
+    std::string error;
+    MISE_CHECK(!orphan.Load(error));
+    MISE_CHECK(error.find("settings.ini") != std::string::npos);
+    MISE_CHECK_EQUAL(orphan.Handle("get audio.music"), "error audio.music not found");
+    MISE_CHECK(IsError(orphan.Handle("reload")));
+    MISE_CHECK_EQUAL(orphan.Handle("save"), "ok unchanged");
+    MISE_CHECK_EQUAL(ReadTestFile(missing / "settings.ini"), "<missing>");
+}
+
+MISE_TEST(ControlService, ProfileReplacesTheSettings) {
+    ServiceFixture fixture;
+    ControlService& service = fixture.service;
+    ProfileStore profiles;
+    std::string error;
+    MISE_CHECK(profiles.Open(ProfileStorePath(fixture.ini), error));
+    MISE_CHECK(profiles.Put("Quiet", "[display]\r\nwindowed=0\r\n[audio]\r\nmusic=5\r\nsfx=5\r\n", error));
+
+    // An unsaved set is replaced along with everything else
+    MISE_CHECK_EQUAL(service.Handle("set audio.music=40"), "ok changed");
+    MISE_CHECK_EQUAL(service.Handle("profile Quiet"), "ok");
+    MISE_CHECK(!service.HasUnsavedChanges());
+    MISE_CHECK_EQUAL(service.Handle("get audio.music"), "ok 5");
+    MISE_CHECK_EQUAL(fixture.Disk("audio", "music"), "5");
+    MISE_CHECK_EQUAL(fixture.Disk("display", "windowed"), "0");
+    MISE_CHECK_EQUAL(service.Handle("save"), "ok unchanged");
+}
+
+MISE_TEST(ControlService, LaunchSavesFirst) {
+    ServiceFixture fixture;
+    ControlService& service = fixture.service;
+    MISE_CHECK_EQUAL(service.Handle("set audio.music=40"), "ok changed");
+    MISE_CHECK_EQUAL(service.Handle("launch"), "ok");
+    MISE_CHECK_EQUAL(fixture.launches, 1);
+    MISE_CHECK_EQUAL(fixture.Disk("audio", "music"), "40");
+    MISE_CHECK(!service.HasUnsavedChanges());
+}
@@ -0,0 +1,184 @@
+/*
+ * DisplayModesTest.cpp
+ * Sorting and dedup of what the monitors report, the combo entries built
+ * from it, and a catalog that never publishes modes from before an
+ * Invalidate.
+ */
+
+#include "Test.h"
+
+#include "../core/DisplayModes.h"
+
+#include <condition_variable>
+
+namespace {
+
+// "1920x1080@144 1920x1080@60", so a wrong order shows up whole
+std::string ModeList(const std::vector<DisplayMode>& modes) {
+    std::string text;
+    for (const DisplayMode& mode : modes) {
+        if (!text.empty()) text += ' ';
+        text += mode.Resolution() + "@" + std::to_string(mode.refreshRate);
+    }
+    return text;
+}
+
+std::vector<DisplayMode> SortedModes(std::vector<DisplayMode> modes) {
+    SortDisplayModes(modes);
+    return modes;
+}
+
+// The first enumeration blocks until Release(), then reports the modes from before the change;
+// every later one reports the modes from after it
+class GatedModeProvider : public DisplayModeProvider {
+public:
+    GatedModeProvider(std::vector<DisplayMode> before, std::vector<DisplayMode> after)
+        : before_(std::move(before), {}), after_(std::move(after), {}) {}
+
+    std::vector<DisplayMode> EnumerateModes() override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (started_) return after_.EnumerateModes();
+        started_ = true;
+        changed_.notify_all();
+        changed_.wait(lock, [this] { return released_; });
+        return before_.EnumerateModes();
+    }
+    bool CurrentMode(DisplayMode& mode) override { return after_.CurrentMode(mode); }
+
+    void WaitUntilStarted() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return started_; });
+    }
+    void Release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released_ = true;
+        changed_.notify_all();
+    }
+    int EnumerateCount() const { return before_.EnumerateCount() + after_.EnumerateCount(); }
+
+private:
+    FakeDisplayModeProvider before_, after_;
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool started_ = false;
+    bool released_ = false;
+};
+
+} // namespace
+
+MISE_TEST(DisplayModes, SortedByAreaThenWidthThenRefresh) {
+    // 1600x900 and 1200x1200 have the same area, so the wider one goes first
+    std::vector<DisplayMode> modes = SortedModes({
+        {1280, 720, 60}, {1920, 1080, 60}, {1200, 1200, 60}, {1920, 1080, 144}, {1600, 900, 75},
+        {2560, 1440, 60}, {1600, 900, 120},
+    });
+    MISE_CHECK_EQUAL(ModeList(modes), "2560x1440@60 1920x1080@144 1920x1080@60 1600x900@120 1600x900@75 "
+                                      "1200x1200@60 1280x720@60");
+}
+
+MISE_TEST(DisplayModes, SmallModesRemoved) {
+    // Either side under 800x600 is too small; exactly 800x600 stays
+    std::vector<DisplayMode> modes = SortedModes({
+        {640, 480, 60}, {800, 600, 60}, {1024, 576, 60}, {799, 1000, 60}, {1024, 768, 60}, {320, 200, 70},
+    });
+    MISE_CHECK_EQUAL(ModeList(modes), "1024x768@60 800x600@60");
+    MISE_CHECK_EQUAL(ModeList(SortedModes({{640, 480, 60}, {720, 400, 70}})), "");
+}
+
+MISE_TEST(DisplayModes, SameResolutionOnEveryMonitor) {
+    // Two monitors (and two bit depths each) report the same modes: each is listed once
+    std::vector<DisplayMode> raw;
+    for (int monitor = 0; monitor < 2; ++monitor) {
+        for (int depth = 0; depth < 2; ++depth) {
+            raw.push_back({1920, 1080, 60});
+            raw.push_back({1920, 1080, 144});
+            raw.push_back({2560, 1440, 60});
+        }
+    }
+    raw.push_back({1280, 1024, 75});
+    std::vector<DisplayMode> modes = SortedModes(raw);
+    MISE_CHECK_EQUAL(ModeList(modes), "2560x1440@60 1920x1080@144 1920x1080@60 1280x1024@75");
+
+    // One entry per WxH, with its fastest refresh rate
+    MISE_CHECK_EQUAL(ModeList(DistinctResolutions(modes)), "2560x1440@60 1920x1080@144 1280x1024@75");
+}
+
+MISE_TEST(DisplayModes, ChoicesForTheResolutions) {
+    std::vector<ResolutionChoice> choices = BuildResolutionChoices({{2560, 1440, 144}, {1024, 768, 60}});
+    MISE_CHECK_EQUAL(choices.size(), size_t(5));
+    if (choices.size() != 5) return;
+    MISE_CHECK_EQUAL(choices[autodetectResolutionIndex].resolution, "");
+    MISE_CHECK_EQUAL(choices[1].resolution, "2560x1440");
+    MISE_CHECK_EQUAL(choices[1].windowed, false);
+    MISE_CHECK_EQUAL(choices[2].resolution, "2560x1440");
+    MISE_CHECK_EQUAL(choices[2].windowed, true);
+    MISE_CHECK_EQUAL(choices[2].label, ResolutionChoiceLabel("2560x1440", true));
+    MISE_CHECK_EQUAL(choices[3].resolution, "1024x768");
+    MISE_CHECK_EQUAL(choices[4].windowed, true);
+}
+
+MISE_TEST(DisplayModes, NoResolutionsGivesTheDefaults) {
+    // Nothing enumerated (no display, or the provider failed): the built-in list instead of just Autodetect
+    std::vector<ResolutionChoice> choices = BuildResolutionChoices({});
+    std::vector<ResolutionChoice> defaults = DefaultResolutionChoices();
+    MISE_CHECK_EQUAL(choices.size(), defaults.size());
+    MISE_CHECK(choices.size() > 1);
+    for (size_t i = 0; i < choices.size() && i < defaults.size(); ++i) {
+        MISE_CHECK_EQUAL(choices[i].label, defaults[i].label);
+        MISE_CHECK_EQUAL(choices[i].resolution, defaults[i].resolution);
+        MISE_CHECK_EQUAL(choices[i].windowed, defaults[i].windowed);
+    }
+}
+
+MISE_TEST(DisplayModes, CatalogKeepsItsSnapshot) {
+    auto provider = std::make_unique<FakeDisplayModeProvider>(
+        std::vector<DisplayMode>{{1920, 1080, 60}, {640, 480, 60}, {1920, 1080, 60}, {2560, 1440, 144}}, DisplayMode{2560, 1440, 144});
+    FakeDisplayModeProvider& fake = *provider;
+    DisplayModeCatalog catalog(std::move(provider));
+
+    int ready = 0;
+    catalog.Refresh([&ready] { ++ready; });
+    catalog.Wait();
+    std::shared_ptr<const DisplayModeSnapshot> snapshot = catalog.Snapshot();
+    MISE_CHECK(snapshot != nullptr);
+    if (!snapshot) return;
+    MISE_CHECK_EQUAL(ready, 1);
+    MISE_CHECK_EQUAL(ModeList(snapshot->modes), "2560x1440@144 1920x1080@60");
+    MISE_CHECK_EQUAL(ModeList(snapshot->resolutions), "2560x1440@144 1920x1080@60");
+    MISE_CHECK_EQUAL(snapshot->current.Resolution(), "2560x1440");
+
+    // A second Refresh reuses the snapshot; Invalidate enumerates again
+    catalog.Refresh([&ready] { ++ready; });
+    catalog.Wait();
+    MISE_CHECK_EQUAL(fake.EnumerateCount(), 1);
+    MISE_CHECK(catalog.Snapshot() == snapshot);
+    catalog.Invalidate([&ready] { ++ready; });
+    catalog.Wait();
+    MISE_CHECK_EQUAL(fake.EnumerateCount(), 2);
+    MISE_CHECK_EQUAL(ready, 2);
+    MISE_CHECK(catalog.Snapshot() != nullptr && catalog.Snapshot() != snapshot);
+}
+
+MISE_TEST(DisplayModes, InvalidateWhileBuilding) {
+    // The displays change while the worker is still enumerating: what it found is stale and must never be published
+    auto provider = std::make_unique<GatedModeProvider>(std::vector<DisplayMode>{{3840, 2160, 60}, {1920, 1080, 60}},
+                                                        std::vector<DisplayMode>{{1920, 1080, 144}, {1280, 720, 60}});
+    GatedModeProvider& gated = *provider;
+    DisplayModeCatalog catalog(std::move(provider));
+
+    int staleReady = 0, freshReady = 0;
+    catalog.Refresh([&staleReady] { ++staleReady; });
+    gated.WaitUntilStarted();
+    catalog.Invalidate([&freshReady] { ++freshReady; });
+    MISE_CHECK(catalog.Snapshot() == nullptr);
+    gated.Release();
+    catalog.Wait();
+
+    std::shared_ptr<const DisplayModeSnapshot> snapshot = catalog.Snapshot();
+    MISE_CHECK(snapshot != nullptr);
+    if (!snapshot) return;
+    MISE_CHECK_EQUAL(ModeList(snapshot->modes), "1920x1080@144 1280x720@60");
+    MISE_CHECK_EQUAL(gated.EnumerateCount(), 2);
+    MISE_CHECK_EQUAL(staleReady, 0);
+    MISE_CHECK_EQUAL(freshReady, 1);
+}
@@ -0,0 +1,80 @@
+/*
+ * EditBufferTest.cpp
+ * One replacement always brings the buffer to exactly the new text, and
+ * it's no bigger than the part that changed.
+ */
+
+#include "Test.h"
+
+#include "../core/EditBuffer.h"
+
+#include <random>
+
+namespace {
+
+// Sync before -> after and check the buffer ends equal to after with one write of at most the changed middle
+void CheckSync(const std::string& before, const std::string& after, size_t expectedWritten) {
+    MemoryEditBuffer buffer(before);
+    bool changed = SyncEditBuffer(buffer, before, after);
+    MISE_CHECK_EQUAL(buffer.View(), after);
+    MISE_CHECK_EQUAL(changed, before != after);
+    MISE_CHECK_EQUAL(buffer.ReplaceCount(), size_t(changed ? 1 : 0));
+    MISE_CHECK_EQUAL(buffer.CharsWritten(), expectedWritten);
+}
+
+} // namespace
+
+MISE_TEST(EditBuffer, PrefixChange) {
+    CheckSync("language=0\r\nmusic=70", "language=3\r\nmusic=70", 1);
+    CheckSync("abc", "xyzabc", 3);
+    CheckSync("xyzabc", "abc", 0);
+}
+
+MISE_TEST(EditBuffer, SuffixChange) {
+    CheckSync("music=70", "music=100", 2);
+    CheckSync("abc", "abcdef", 3);
+    CheckSync("abcdef", "abc", 0);
+}
+
+MISE_TEST(EditBuffer, OverlappingPrefixAndSuffix) {
+    // "aaa" -> "aaaa": prefix and suffix overlap; the diff must not count a character twice
+    CheckSync("aaa", "aaaa", 1);
+    CheckSync("aaaa", "aaa", 0);
+    CheckSync("abab", "ab", 0);
+    CheckSync("ab", "abab", 2);
+
+    TextDiff diff = ComputeTextDiff("aaa", "aaaa");
+    MISE_CHECK_EQUAL(diff.removed, size_t(0));
+    MISE_CHECK_EQUAL(diff.inserted, size_t(1));
+}
+
+MISE_TEST(EditBuffer, EmptyDiffs) {
+    CheckSync("", "", 0);
+    CheckSync("same", "same", 0);
+    CheckSync("", "new text", 8);
+    CheckSync("old text", "", 0);
+    MISE_CHECK(ComputeTextDiff("same", "same").Empty());
+}
+
+MISE_TEST(EditBuffer, RandomEdits) {
+    std::mt19937 random(32360);
+    const std::string alphabet = "ab=\r\n";
+    for (int round = 0; round < 2000; ++round) {
+        std::string before, after;
+        for (size_t i = random() % 12; i > 0; --i) before += alphabet[random() % alphabet.size()];
+        for (size_t i = random() % 12; i > 0; --i) after += alphabet[random() % alphabet.size()];
+        MemoryEditBuffer buffer(before);
+        SyncEditBuffer(buffer, before, after);
+        MISE_CHECK_EQUAL(buffer.View(), after);
+    }
+}
+
+MISE_TEST(EditBuffer, ApplySplice) {
+    IniDocument doc("[audio]\r\nmusic=70\r\n");
+    MemoryEditBuffer buffer(doc.Text());
+    MISE_CHECK(ApplySplice(buffer, doc.Set("audio", "music", "100")));
+    MISE_CHECK_EQUAL(buffer.View(), doc.Text());
+    MISE_CHECK(ApplySplice(buffer, doc.Set("audio", "voice", "80")));
+    MISE_CHECK_EQUAL(buffer.View(), doc.Text());
+    MISE_CHECK(!ApplySplice(buffer, doc.Set("audio", "voice", "80")));
+}
@@ -0,0 +1,212 @@
+/*
+ * EditHistoryTest.cpp
+ * The piece table agreeing with a plain string through random edits, and
+ * the history on top of it: undo and redo back and forth, typing and
+ * grouped edits undoing as one step, and the oldest steps forgotten once
+ * the memory limit is reached.
+ */
+
+#include "Test.h"
+
+#include "../core/EditHistory.h"
+
+#include <random>
+
+namespace {
+
+// A session mirrored into a plain string, the way the launcher mirrors it into the edit box
+struct SessionFixture {
+    MemoryEditBuffer view;
+    EditSession session;
+
+    explicit SessionFixture(const std::string& text, size_t historyLimit = defaultEditHistoryLimit)
+        : view(text), session(&view, historyLimit) {
+        session.Reset(text);
+    }
+
+    // The user typed: the view changes first, then the session hears about it
+    void Type(size_t start, size_t removed, const std::string& text) {
+        view.Replace(start, start + removed, text);
+        MISE_CHECK(session.ViewChanged(view.View()));
+    }
+
+    void CheckText(const std::string& expected) {
+        MISE_CHECK_EQUAL(session.Text(), expected);
+        MISE_CHECK_EQUAL(view.View(), expected);
+    }
+};
+
+} // namespace
+
+MISE_TEST(EditHistory, PieceTableRandomEdits) {
+    std::mt19937 random(1990);
+    std::string expected = "[display]\r\nwindowed=0\r\nresolution=3840x2160\r\n[audio]\r\nmusic=70\r\n";
+    PieceTable table(expected);
+    for (int i = 0; i < 5000; ++i) {
+        size_t start = random() % (expected.size() + 1);
+        size_t end = start + random() % (std::min<size_t>(expected.size() - start, 12) + 1);
+        std::string text(random() % 6, static_cast<char>('a' + random() % 26));
+        expected.replace(start, end - start, text);
+        table.Replace(start, end, text);
+
+        if (i % 97 == 0) {
+            MISE_CHECK_EQUAL(table.Text(), expected);
+            size_t from = random() % (expected.size() + 1);
+            MISE_CHECK_EQUAL(table.Substr(from, 20), expected.substr(from, 20));
+        }
+    }
+    MISE_CHECK_EQUAL(table.Size(), expected.size());
+    MISE_CHECK_EQUAL(table.Text(), expected);
+
+    // Diffs piece by piece match the plain-string diff
+    std::string after = expected;
+    after.replace(after.size() / 2, 3, "XYZW");
+    TextDiff diff = table.DiffTo(after), plain = ComputeTextDiff(expected, after);
+    MISE_CHECK_EQUAL(diff.start, plain.start);
+    MISE_CHECK_EQUAL(diff.removed, plain.removed);
+    MISE_CHECK_EQUAL(diff.inserted, plain.inserted);
+    MISE_CHECK(table.DiffTo(expected).Empty());
+
+    table.Compact();
+    MISE_CHECK_EQUAL(table.PieceCount(), size_t(1));
+    MISE_CHECK_EQUAL(table.Text(), expected);
+}
+
+MISE_TEST(EditHistory, UndoAndRedo) {
+    SessionFixture fixture("music=70\r\nvoice=80\r\n");
+    EditSession& session = fixture.session;
+    std::vector<std::string> states = {session.Text()};
+    session.Replace(6, 8, "40");
+    states.push_back(session.Text());
+    session.Replace(0, 0, "[audio]\r\n");
+    states.push_back(session.Text());
+    session.Replace(17, 27, "");
+    states.push_back(session.Text());
+    fixture.CheckText("[audio]\r\nmusic=40\r\n");
+    MISE_CHECK_EQUAL(session.History().UndoCount(), size_t(3));
+
+    // All the way back, then all the way forward again; the view follows every step
+    for (size_t i = states.size() - 1; i > 0; --i) {
+        MISE_CHECK(session.Undo());
+        fixture.CheckText(states[i - 1]);
+    }
+    MISE_CHECK(!session.Undo());
+    for (size_t i = 1; i < states.size(); ++i) {
+        MISE_CHECK(session.Redo());
+        fixture.CheckText(states[i]);
+    }
+    MISE_CHECK(!session.Redo());
+
+    // A new edit after an undo drops what could have been redone
+    MISE_CHECK(session.Undo());
+    session.Replace(0, 0, "; volume\r\n");
+    MISE_CHECK(!session.History().CanRedo());
+    MISE_CHECK(session.Undo());
+    fixture.CheckText(states[states.size() - 2]);
+}
+
+MISE_TEST(EditHistory, TypingUndoesByLine) {
+    SessionFixture fixture("music=70\r\n");
+    EditSession& session = fixture.session;
+
+    // Characters typed one at a time: one step
+    for (const char* key : {"v", "o", "i", "c", "e", "=", "5"}) fixture.Type(fixture.view.View().size(), 0, key);
+    MISE_CHECK_EQUAL(session.History().UndoCount(), size_t(1));
+    if (const char* name = session.History().UndoName()) MISE_CHECK_EQUAL(std::string(name), "Typing");
+
+    // A run of backspaces is one step of its own
+    fixture.Type(16, 1, "");
+    fixture.Type(15, 1, "");
+    MISE_CHECK_EQUAL(session.History().UndoCount(), size_t(2));
+    fixture.CheckText("music=70\r\nvoice");
+
+    // The line break joins the typing before it and ends the step; what's typed after it is the next one
+    fixture.Type(15, 0, "=5");
+    fixture.Type(17, 0, "\r\n");
+    fixture.Type(19, 0, "sfx=1");
+    MISE_CHECK_EQUAL(session.History().UndoCount(), size_t(4));
+    fixture.CheckText("music=70\r\nvoice=5\r\nsfx=1");
+
+    // Any other edit in between ends a run of typing too
+    session.Replace(6, 8, "40");
+    fixture.Type(24, 0, "0");
+    MISE_CHECK_EQUAL(session.History().UndoCount(), size_t(6));
+    fixture.CheckText("music=40\r\nvoice=5\r\nsfx=10");
+
+    MISE_CHECK(session.Undo());
+    MISE_CHECK(session.Undo());
+    MISE_CHECK(session.Undo());
+    fixture.CheckText("music=70\r\nvoice=5\r\n");
+    MISE_CHECK(session.Undo());
+    fixture.CheckText("music=70\r\nvoice");
+    MISE_CHECK(session.Undo());
+    fixture.CheckText("music=70\r\nvoice=5");
+    MISE_CHECK(session.Undo());
+    fixture.CheckText("music=70\r\n");
+    MISE_CHECK(!session.Undo());
+
+    // Typing the same thing again isn't a change
+    MISE_CHECK(!session.ViewChanged(fixture.view.View()));
+}
+
+MISE_TEST(EditHistory, StepsGroupEdits) {
+    SessionFixture fixture("[display]\r\nresolution=1920x1080\r\nwindowed=0\r\n");
+    EditSession& session = fixture.session;
+    const std::string before = session.Text();
+    {
+        // The resolution and windowed keys change together, with a nested step joining the outer one
+        EditStep step(session, "Resolution");
+        session.Replace(22, 31, "2560x1440");
+        {
+            EditStep inner(session, "Windowed");
+            session.Replace(42, 43, "1");
+        }
+        MISE_CHECK(!session.History().CanUndo());  // Not while the step is open
+    }
+    fixture.CheckText("[display]\r\nresolution=2560x1440\r\nwindowed=1\r\n");
+    MISE_CHECK_EQUAL(session.History().UndoCount(), size_t(1));
+    if (const char* name = session.History().UndoName()) MISE_CHECK_EQUAL(std::string(name), "Resolution");
+
+    MISE_CHECK(session.Undo());
+    fixture.CheckText(before);
+    MISE_CHECK(session.Redo());
+    fixture.CheckText("[display]\r\nresolution=2560x1440\r\nwindowed=1\r\n");
+
+    // A step that changed nothing leaves no trace
+    { EditStep step(session, "Nothing"); }
+    MISE_CHECK_EQUAL(session.History().UndoCount(), size_t(1));
+}
+
+MISE_TEST(EditHistory, OldestStepsDropAtTheLimit) {
+    const size_t limit = 8 * (sizeof(TextChange) + 64);
+    SessionFixture fixture("", limit);
+    EditSession& session = fixture.session;
+    std::vector<std::string> states = {""};
+    for (int i = 0; i < 100; ++i) {
+        session.Replace(session.Document().Size(), session.Document().Size(), std::string(32, static_cast<char>('a' + i % 26)));
+        states.push_back(session.Text());
+        MISE_CHECK(session.History().MemoryUsage() <= limit);
+    }
+    size_t kept = session.History().UndoCount();
+    MISE_CHECK(kept > 0 && kept < 100);
+
+    // Undo goes back as far as the history reaches, not to the start
+    for (size_t i = 0; i < kept; ++i) MISE_CHECK(session.Undo());
+    MISE_CHECK(!session.Undo());
+    fixture.CheckText(states[100 - kept]);
+
+    // Shrinking the limit drops redo steps first
+    size_t usage = session.History().MemoryUsage();
+    session.History().SetMemoryLimit(usage / 2);
+    MISE_CHECK(session.History().MemoryUsage() <= usage / 2);
+    MISE_CHECK(session.History().RedoCount() < kept);
+
+    // One step bigger than the whole limit isn't kept at all; what comes after it is
+    session.History().Clear();
+    session.Replace(0, 0, std::string(limit, 'x'));
+    MISE_CHECK_EQUAL(session.History().UndoCount(), size_t(0));
+    session.Replace(0, 0, "small");
+    MISE_CHECK_EQUAL(session.History().UndoCount(), size_t(1));
+    MISE_CHECK(session.Undo());
+    MISE_CHECK_EQUAL(session.Text().substr(0, 5), "xxxxx");
+}
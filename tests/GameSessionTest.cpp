@@ -0,0 +1,171 @@
+/*
+ * GameSessionTest.cpp
+ * Watching a session from launch to exit. A scripted monitor drives
+ * discovery, exit and Stop without any real process; on Linux a stand-in
+ * game (a copy of /bin/sh named MISE.exe) is found through /proc, changes
+ * settings.ini and exits, and the supervisor has to notice all three and
+ * put the settings back.
+ */
+
+#include "Test.h"
+
+#include "../core/GameSession.h"
+#include "../core/LauncherSettings.h"
+#include "../core/TextFile.h"
+
+#include <atomic>
+#include <filesystem>
+#include <future>
+
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Appears after 'findAfter' lookups and exits after 'samples' samples, using 1 ms of CPU per sample
+class ScriptedMonitor : public ProcessMonitor {
+public:
+    ScriptedMonitor(int findAfter, int samples) : findAfter_(findAfter), samples_(samples) {}
+
+    uint32_t FindProcess(const std::string& exeName) override {
+        return exeName == gameExecutable && ++lookups_ > findAfter_ ? 4242 : 0;
+    }
+    bool Sample(uint32_t pid, ProcessSample& sample) override {
+        if (pid != 4242 || sampled_ >= samples_) return false;
+        ++sampled_;
+        sample.cpuTimeUs = 1000ull * sampled_;
+        sample.workingSetBytes = 1000ull * sampled_;
+        sample.readBytes = 10ull * sampled_;
+        return true;
+    }
+
+private:
+    int findAfter_, samples_;
+    int lookups_ = 0, sampled_ = 0;
+};
+
+SessionSummary RunSession(std::unique_ptr<ProcessMonitor> monitor, const SessionOptions& options) {
+    GameSupervisor supervisor(std::move(monitor));
+    std::promise<SessionSummary> ended;
+    supervisor.Start(options, [&ended](const SessionSummary& summary) { ended.set_value(summary); });
+    return ended.get_future().get();
+}
+
+} // namespace
+
+MISE_TEST(GameSession, SampleRingKeepsNewest) {
+    SampleRing ring(3);
+    for (int i = 1; i <= 5; ++i) {
+        ProcessSample sample;
+        sample.elapsedMs = i;
+        ring.Push(sample);
+    }
+    MISE_CHECK_EQUAL(ring.Size(), size_t(3));
+    MISE_CHECK_EQUAL(ring[0].elapsedMs, int64_t(3));
+    MISE_CHECK_EQUAL(ring.Newest().elapsedMs, int64_t(5));
+}
+
+MISE_TEST(GameSession, ScriptedSession) {
+    SessionOptions options;
+    options.exeName = gameExecutable;
+    options.intervalMs = 1;
+    options.findTimeoutMs = 5000;
+    SessionSummary summary = RunSession(std::make_unique<ScriptedMonitor>(3, 10), options);
+    MISE_CHECK(summary.found);
+    MISE_CHECK(summary.complete);
+    MISE_CHECK_EQUAL(summary.pid, uint32_t(4242));
+    MISE_CHECK_EQUAL(summary.samples, size_t(10));
+    MISE_CHECK_EQUAL(summary.cpuTimeUs, uint64_t(10000));
+    MISE_CHECK_EQUAL(summary.peakWorkingSetBytes, uint64_t(10000));
+    MISE_CHECK_EQUAL(summary.readBytes, uint64_t(100));
+}
+
+MISE_TEST(GameSession, NeverStarted) {
+    SessionOptions options;
+    options.exeName = gameExecutable;
+    options.intervalMs = 10;
+    options.findTimeoutMs = 100;
+    SessionSummary summary = RunSession(std::make_unique<ScriptedMonitor>(1000000, 0), options);
+    MISE_CHECK(!summary.found);
+    MISE_CHECK(!summary.complete);
+    MISE_CHECK_EQUAL(summary.samples, size_t(0));
+}
+
+MISE_TEST(GameSession, StopEndsTheSession) {
+    GameSupervisor supervisor(std::make_unique<ScriptedMonitor>(0, 1000000));
+    SessionOptions options;
+    options.exeName = gameExecutable;
+    options.intervalMs = 5;
+    std::atomic<bool> ended{false};
+    SessionSummary last;
+    supervisor.Start(options, [&](const SessionSummary& summary) {
+        last = summary;
+        ended = true;
+    });
+    MISE_CHECK(supervisor.IsRunning());
+    MISE_CHECK(!supervisor.Start(options, nullptr));  // One session at a time
+    supervisor.Stop();
+    MISE_CHECK(ended.load());
+    MISE_CHECK(last.found);
+    MISE_CHECK(!last.complete);
+    MISE_CHECK(!supervisor.IsRunning());
+}
+
+#ifdef __linux__
+
+MISE_TEST(GameSession, StandInGameChangesSettings) {
+    TestScratchDir dir("mise_test_session");
+    const std::string program = dir / gameExecutable;
+    const std::string ini = dir / "settings.ini";
+    std::filesystem::copy_file("/bin/sh", program);
+    WriteTestFile(ini, "[localization]\r\nlanguage=0\r\n[audio]\r\nmusic=70\r\n");
+    std::string launched;
+    ReadTextFile(ini, launched);
+
+    GameSupervisor supervisor(CreateSystemProcessMonitor());
+    SessionOptions options;
+    options.exeName = gameExecutable;
+    options.iniPath = ini;
+    options.intervalMs = 20;
+    options.findTimeoutMs = 5000;
+    options.restoreSettings = true;
+    std::promise<SessionSummary> ended;
+    supervisor.Start(options, [&ended](const SessionSummary& summary) { ended.set_value(summary); });
+
+    // The game plays a while, then writes its settings on the way out
+    const std::string script = "sleep 0.3; printf '[localization]\\r\\nlanguage=3\\r\\n[audio]\\r\\nmusic=70\\r\\n' > '" + ini + "'";
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(program.c_str(), program.c_str(), "-c", script.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    SessionSummary summary = ended.get_future().get();
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    MISE_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    MISE_CHECK(summary.found);
+    MISE_CHECK(summary.complete);
+    MISE_CHECK_EQUAL(summary.pid, static_cast<uint32_t>(pid));
+    MISE_CHECK(summary.samples >= 2);
+    MISE_CHECK(summary.durationMs >= 200);
+    MISE_CHECK(summary.peakWorkingSetBytes > 0);
+    MISE_CHECK_EQUAL(summary.settingsChanges.size(), size_t(1));
+    if (!summary.settingsChanges.empty()) {
+        MISE_CHECK_EQUAL(summary.settingsChanges[0].key, "language");
+        MISE_CHECK_EQUAL(summary.settingsChanges[0].newValue, "3");
+    }
+    MISE_CHECK(summary.settingsRestored);
+    std::string now;
+    ReadTextFile(ini, now);
+    MISE_CHECK_EQUAL(now, launched);
+
+    // The summary goes into the log, changes and all
+    std::string error;
+    MISE_CHECK(AppendSessionLog(ini, summary, error));
+    MISE_CHECK(ReadTestFile(SessionLogPath(ini)).find("language") != std::string::npos);
+}
+
+#endif
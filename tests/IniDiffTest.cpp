@@ -0,0 +1,115 @@
+/*
+ * IniDiffTest.cpp
+ * Key-level diffs between two versions of settings.ini, applying them to
+ * a document with edits of its own, and the watcher turning a burst of
+ * writes into one notification.
+ */
+
+#include "Test.h"
+
+#include "../core/AtomicFile.h"
+#include "../core/FileWatcher.h"
+#include "../core/IniDiff.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+const char* const before =
+    "[localization]\r\nlanguage=0\r\n[display]\r\nwindowed=1\r\nresolution=1920x1080\r\n[audio]\r\nmusic=70\r\n";
+
+} // namespace
+
+MISE_TEST(IniDiff, DiffFindsAddedChangedRemoved) {
+    IniDocument old(before);
+    IniDocument now("[localization]\r\nlanguage=2\r\n[display]\r\nwindowed=1\r\n[audio]\r\nmusic=70\r\nvoice=80\r\n");
+    std::vector<IniKeyChange> changes = DiffIniDocuments(old, now);
+    MISE_CHECK_EQUAL(changes.size(), size_t(3));
+    if (changes.size() != 3) return;
+
+    MISE_CHECK(changes[0].kind == IniKeyChange::Changed);
+    MISE_CHECK_EQUAL(changes[0].key, "language");
+    MISE_CHECK_EQUAL(changes[0].oldValue, "0");
+    MISE_CHECK_EQUAL(changes[0].newValue, "2");
+    MISE_CHECK(changes[1].kind == IniKeyChange::Added);
+    MISE_CHECK_EQUAL(changes[1].section, "audio");
+    MISE_CHECK_EQUAL(changes[1].key, "voice");
+    // Removals come last
+    MISE_CHECK(changes[2].kind == IniKeyChange::Removed);
+    MISE_CHECK_EQUAL(changes[2].key, "resolution");
+
+    MISE_CHECK(DiffIniDocuments(old, old).empty());
+}
+
+MISE_TEST(IniDiff, ApplyKeepsUnrelatedEdits) {
+    IniDocument old(before);
+    IniDocument now("[localization]\r\nlanguage=2\r\n[display]\r\nwindowed=1\r\n[audio]\r\nmusic=70\r\nvoice=80\r\n");
+    std::vector<IniKeyChange> changes = DiffIniDocuments(old, now);
+
+    // The launcher's copy has an edit of its own the outside change didn't touch
+    IniDocument mine(before);
+    mine.Set("audio", "music", "40");
+    std::vector<IniSplice> splices = ApplyIniChanges(mine, changes);
+    MISE_CHECK_EQUAL(splices.size(), changes.size());
+    MISE_CHECK_EQUAL(mine.Value("localization", "language"), "2");
+    MISE_CHECK_EQUAL(mine.Value("audio", "voice"), "80");
+    MISE_CHECK_EQUAL(mine.Value("audio", "music"), "40");
+    MISE_CHECK(!mine.Has("display", "resolution"));
+    MISE_CHECK_EQUAL(mine.Value("display", "windowed"), "1");
+}
+
+MISE_TEST(IniDiff, BaselineSkipsOwnSave) {
+    SettingsBaseline baseline;
+    baseline.Reset(before);
+    std::vector<IniKeyChange> changes;
+    MISE_CHECK(!baseline.Update(before, changes));
+    MISE_CHECK(changes.empty());
+
+    std::string changed = before;
+    changed.replace(changed.find("music=70"), 8, "music=10");
+    MISE_CHECK(baseline.Update(changed, changes));
+    MISE_CHECK_EQUAL(changes.size(), size_t(1));
+    MISE_CHECK_EQUAL(baseline.Document().Value("audio", "music"), "10");
+}
+
+MISE_TEST(IniDiff, WatcherDebouncesABurst) {
+    TestScratchDir dir("mise_test_watch");
+    const std::string path = dir / "settings.ini";
+    std::string error;
+    MISE_CHECK(WriteFileAtomic(path, before, error));
+
+    std::atomic<int> calls{0};
+    FileWatcher watcher;
+    MISE_CHECK(watcher.Start(path, 150, [&calls] { ++calls; }, error));
+
+    // The game writing the file several times on exit, in place and by rename
+    for (int i = 0; i < 10; ++i) {
+        std::string text = before;
+        text += "; save " + std::to_string(i) + "\r\n";
+        if (i % 2) {
+            WriteFileAtomic(path, text, error);
+        } else {
+            WriteTestFile(path, text);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    // Changes to other files in the folder don't count
+    WriteTestFile(dir / "other.txt", "x");
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (calls.load() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    MISE_CHECK_EQUAL(calls.load(), 1);
+
+    WriteTestFile(path, before);
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (calls.load() == 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    MISE_CHECK_EQUAL(calls.load(), 2);
+    watcher.Stop();
+}
@@ -0,0 +1,113 @@
+/*
+ * IniDocumentTest.cpp
+ * Lookups stay inside their section, edits touch only the value's bytes,
+ * and keys that aren't there yet land where the game expects them.
+ */
+
+#include "Test.h"
+
+#include "../core/IniDocument.h"
+
+namespace {
+
+const char* const settingsText =
+    "; The Secret of Monkey Island SE\r\n"
+    "[localization]\r\n"
+    "language=0\r\n"
+    "[display]\r\n"
+    "windowed = 1\r\n"
+    "resolution=1920x1080\r\n"
+    "[audio]\r\n"
+    "music=70\r\n";
+
+} // namespace
+
+MISE_TEST(IniDocument, FindIsScopedToSection) {
+    IniDocument doc(settingsText);
+    MISE_CHECK(doc.Has("display", "windowed"));
+    MISE_CHECK(!doc.Has("audio", "windowed"));
+    MISE_CHECK(!doc.Has("", "windowed"));
+    MISE_CHECK_EQUAL(doc.Value("DISPLAY", "Resolution"), "1920x1080");
+    MISE_CHECK_EQUAL(doc.Value("display", "windowed"), "1");
+    MISE_CHECK_EQUAL(doc.Newline(), "\r\n");
+
+    // Same key in two sections: each lookup gets its own
+    IniDocument twice("[a]\nkey=1\n[b]\nkey=2\n");
+    MISE_CHECK_EQUAL(twice.Value("a", "key"), "1");
+    MISE_CHECK_EQUAL(twice.Value("b", "key"), "2");
+}
+
+MISE_TEST(IniDocument, SetSplicesOnlyTheValue) {
+    IniDocument doc(settingsText);
+    IniSplice splice = doc.Set("display", "windowed", "0");
+    MISE_CHECK(splice.changed);
+    MISE_CHECK_EQUAL(splice.removed, size_t(1));
+    MISE_CHECK_EQUAL(splice.inserted, "0");
+    std::string expected = settingsText;
+    expected.replace(splice.offset, 1, "0");
+    MISE_CHECK_EQUAL(doc.Text(), expected);
+
+    // The same value again is no edit at all
+    MISE_CHECK(!doc.Set("display", "windowed", "0").changed);
+}
+
+MISE_TEST(IniDocument, MultiDigitLanguage) {
+    IniDocument doc("[localization]\r\nlanguage=12\r\n[display]\r\nwindowed=0\r\n");
+    int language = -1;
+    MISE_CHECK(doc.GetInt("localization", "language", language));
+    MISE_CHECK_EQUAL(language, 12);
+
+    doc.Set("localization", "language", "3");
+    MISE_CHECK_EQUAL(doc.Text(), "[localization]\r\nlanguage=3\r\n[display]\r\nwindowed=0\r\n");
+    doc.Set("localization", "language", "104");
+    MISE_CHECK(doc.GetInt("localization", "language", language));
+    MISE_CHECK_EQUAL(language, 104);
+    // Offsets after the edit moved with it
+    MISE_CHECK_EQUAL(doc.Value("display", "windowed"), "0");
+
+    int bad = 0;
+    MISE_CHECK(!ParseIniInt("1x", bad));
+    MISE_CHECK(!ParseIniInt("", bad));
+}
+
+MISE_TEST(IniDocument, MissingKeyAppendedToItsSection) {
+    IniDocument doc(settingsText);
+    std::string expected = settingsText;
+    expected.insert(expected.find("[audio]"), "shaders=1\r\n");
+    doc.Set("display", "shaders", "1");
+    MISE_CHECK_EQUAL(doc.Text(), expected);
+    MISE_CHECK_EQUAL(doc.Value("display", "shaders"), "1");
+    MISE_CHECK_EQUAL(doc.Value("audio", "music"), "70");
+
+    // A section that isn't there yet is added at the end
+    const std::string added = "[controls]\r\ninvert=0\r\n";
+    doc.Set("controls", "invert", "0");
+    MISE_CHECK_EQUAL(doc.Text().substr(doc.Text().size() - added.size()), added);
+
+    // A file whose last line has no newline still gets a line of its own
+    IniDocument open("[audio]\nmusic=70");
+    open.Set("audio", "voice", "80");
+    MISE_CHECK_EQUAL(open.Text(), "[audio]\nmusic=70\nvoice=80\n");
+}
+
+MISE_TEST(IniDocument, RemoveDeletesTheWholeLine) {
+    IniDocument doc(settingsText);
+    IniSplice splice = doc.Remove("display", "windowed");
+    MISE_CHECK(splice.changed);
+    MISE_CHECK(!doc.Has("display", "windowed"));
+    MISE_CHECK_EQUAL(doc.Value("display", "resolution"), "1920x1080");
+    MISE_CHECK(doc.Text().find("windowed") == std::string::npos);
+    MISE_CHECK(!doc.Remove("display", "windowed").changed);
+}
+
+MISE_TEST(IniDocument, SetRefusesLineBreaks) {
+    IniDocument doc(settingsText);
+    const std::string before = doc.Text();
+    MISE_CHECK(!doc.Set("display", "windowed", "1\r\n[cheats]\r\ngodmode=1").changed);
+    MISE_CHECK(!doc.Set("display", "unknown", "0\ngodmode=1").changed);
+    MISE_CHECK(!doc.Set("display", "new\rkey", "0").changed);
+    MISE_CHECK(!doc.Set("cheats]\n[x", "godmode", "1").changed);
+    MISE_CHECK_EQUAL(doc.Text(), before);
+    MISE_CHECK(IsSingleLine("1920x1080"));
+    MISE_CHECK(!IsSingleLine("a\rb"));
+}
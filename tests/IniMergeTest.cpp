@@ -0,0 +1,123 @@
+/*
+ * IniMergeTest.cpp
+ * Three-way merges of the launcher's edits with what's on disk: changes
+ * only one side made survive, and keys both sides changed are settled the
+ * way the caller asked, and reported either way.
+ */
+
+#include "Test.h"
+
+#include "../core/IniMerge.h"
+
+namespace {
+
+const char* const baseText =
+    "; settings\r\n[localization]\r\nlanguage=0\r\n[display]\r\nwindowed=1\r\nresolution=1920x1080\r\n[audio]\r\nmusic=70\r\nvoice=80\r\n";
+
+std::string Edited(const char* key, const char* from, const char* to) {
+    std::string text = baseText;
+    std::string old = std::string(key) + "=" + from;
+    text.replace(text.find(old), old.size(), std::string(key) + "=" + to);
+    return text;
+}
+
+} // namespace
+
+MISE_TEST(IniMerge, TheirsOnly) {
+    IniDocument base(baseText), ours(baseText), theirs(Edited("music", "70", "20"));
+    theirs.Set("audio", "subtitles", "1");
+    IniMerge merge = MergeIniDocuments(base, ours, theirs, IniConflictChoice::KeepOurs);
+    MISE_CHECK(merge.conflicts.empty());
+    MISE_CHECK_EQUAL(merge.taken.size(), size_t(2));
+    MISE_CHECK_EQUAL(merge.merged.Value("audio", "music"), "20");
+    MISE_CHECK_EQUAL(merge.merged.Value("audio", "subtitles"), "1");
+    // Our comment and layout stay
+    MISE_CHECK_EQUAL(merge.merged.Text().substr(0, 12), "; settings\r\n");
+}
+
+MISE_TEST(IniMerge, OursOnly) {
+    IniDocument base(baseText), ours(Edited("windowed", "1", "0")), theirs(baseText);
+    IniMerge merge = MergeIniDocuments(base, ours, theirs, IniConflictChoice::TakeTheirs);
+    MISE_CHECK(merge.conflicts.empty());
+    MISE_CHECK(merge.taken.empty());
+    MISE_CHECK_EQUAL(merge.merged.Text(), ours.Text());
+}
+
+MISE_TEST(IniMerge, BothChangedDifferentKeys) {
+    IniDocument base(baseText), ours(Edited("windowed", "1", "0")), theirs(Edited("language", "0", "2"));
+    theirs.Remove("audio", "voice");
+    IniMerge merge = MergeIniDocuments(base, ours, theirs, IniConflictChoice::KeepOurs);
+    MISE_CHECK(merge.conflicts.empty());
+    MISE_CHECK_EQUAL(merge.merged.Value("display", "windowed"), "0");
+    MISE_CHECK_EQUAL(merge.merged.Value("localization", "language"), "2");
+    MISE_CHECK(!merge.merged.Has("audio", "voice"));
+}
+
+MISE_TEST(IniMerge, SameChangeIsNoConflict) {
+    IniDocument base(baseText), ours(Edited("music", "70", "50")), theirs(Edited("music", "70", "50"));
+    IniMerge merge = MergeIniDocuments(base, ours, theirs, IniConflictChoice::KeepOurs);
+    MISE_CHECK(merge.conflicts.empty());
+    MISE_CHECK_EQUAL(merge.merged.Value("audio", "music"), "50");
+}
+
+MISE_TEST(IniMerge, ConflictKeepOurs) {
+    IniDocument base(baseText), ours(Edited("music", "70", "50")), theirs(Edited("music", "70", "20"));
+    IniMerge merge = MergeIniDocuments(base, ours, theirs, IniConflictChoice::KeepOurs);
+    MISE_CHECK_EQUAL(merge.conflicts.size(), size_t(1));
+    MISE_CHECK_EQUAL(merge.merged.Value("audio", "music"), "50");
+    if (!merge.conflicts.empty()) {
+        const IniMergeConflict& conflict = merge.conflicts[0];
+        MISE_CHECK_EQUAL(conflict.section, "audio");
+        MISE_CHECK_EQUAL(conflict.key, "music");
+        MISE_CHECK_EQUAL(conflict.baseValue, "70");
+        MISE_CHECK_EQUAL(conflict.oursValue, "50");
+        MISE_CHECK_EQUAL(conflict.theirsValue, "20");
+    }
+    MISE_CHECK(DescribeIniConflicts(merge.conflicts).find("music") != std::string::npos);
+}
+
+MISE_TEST(IniMerge, ConflictTakeTheirs) {
+    IniDocument base(baseText), ours(Edited("music", "70", "50")), theirs(Edited("music", "70", "20"));
+    IniMerge merge = MergeIniDocuments(base, ours, theirs, IniConflictChoice::TakeTheirs);
+    MISE_CHECK_EQUAL(merge.conflicts.size(), size_t(1));
+    MISE_CHECK_EQUAL(merge.merged.Value("audio", "music"), "20");
+}
+
+MISE_TEST(IniMerge, ConflictWithRemoval) {
+    // We changed a key the disk removed
+    IniDocument base(baseText), ours(Edited("voice", "80", "90")), theirs(baseText);
+    theirs.Remove("audio", "voice");
+    IniMerge kept = MergeIniDocuments(base, ours, theirs, IniConflictChoice::KeepOurs);
+    MISE_CHECK_EQUAL(kept.conflicts.size(), size_t(1));
+    if (!kept.conflicts.empty()) {
+        MISE_CHECK(kept.conflicts[0].inOurs);
+        MISE_CHECK(!kept.conflicts[0].inTheirs);
+    }
+    MISE_CHECK_EQUAL(kept.merged.Value("audio", "voice"), "90");
+    IniMerge taken = MergeIniDocuments(base, ours, theirs, IniConflictChoice::TakeTheirs);
+    MISE_CHECK(!taken.merged.Has("audio", "voice"));
+}
+
+MISE_TEST(IniMerge, SaveWithDisk) {
+    TestScratchDir dir("mise_test_merge");
+    const std::string path = dir / "settings.ini";
+    WriteTestFile(path, baseText);
+    SettingsBaseline loaded;
+    loaded.Reset(baseText);
+
+    // The game changes music while the launcher changes windowed
+    WriteTestFile(path, Edited("music", "70", "20"));
+    IniDocument ours(Edited("windowed", "1", "0"));
+    std::string diskBytes;
+    IniMerge merge = MergeWithDisk(path, loaded, ours, IniConflictChoice::KeepOurs, diskBytes);
+    MISE_CHECK_EQUAL(diskBytes, Edited("music", "70", "20"));
+    MISE_CHECK(SaveMergedSettings(path, merge.merged, diskBytes).status == SaveStatus::Written);
+    IniDocument saved(ReadTestFile(path));
+    MISE_CHECK_EQUAL(saved.Value("audio", "music"), "20");
+    MISE_CHECK_EQUAL(saved.Value("display", "windowed"), "0");
+
+    // Saving the same again writes nothing
+    loaded.Reset(ReadTestFile(path));
+    merge = MergeWithDisk(path, loaded, saved, IniConflictChoice::KeepOurs, diskBytes);
+    MISE_CHECK(SaveMergedSettings(path, merge.merged, diskBytes).status == SaveStatus::Unchanged);
+}
@@ -0,0 +1,168 @@
+/*
+ * InstallVerifierTest.cpp
+ * A fixture install folder checked against its manifest: the first check
+ * records it, later ones skip what kept its size and time, find missing,
+ * cut-short and changed files (the last only when told to read
+ * everything), and a new Steam build records the install afresh.
+ */
+
+#include "Test.h"
+
+#include "../core/InstallVerifier.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <random>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Bytes that don't repeat, so every block hashes differently
+std::string Noise(size_t size, unsigned seed) {
+    std::mt19937 random(seed);
+    std::string bytes(size, '\0');
+    for (char& c : bytes) c = static_cast<char>(random());
+    return bytes;
+}
+
+// An install folder: one archive of several hash blocks and a handful of small files
+struct InstallFixture {
+    TestScratchDir scratch{"mise_test_install"};
+    std::string dir = scratch / "Game";
+    std::string manifestPath = scratch / "install.manifest";
+    std::vector<std::string> files = {"Data/Archive0.pak", "Audio/0/cue0.xwb", "Audio/0/cue1.xwb", "Audio/1/cue2.xwb",
+                                      "MISE.exe"};
+
+    InstallFixture() {
+        WriteTestFile(Path(files[0]), Noise(2 * installBlockSize + 12345, 0));
+        for (size_t i = 1; i < files.size(); ++i) WriteTestFile(Path(files[i]), Noise(1000 + 700 * i, static_cast<unsigned>(i)));
+    }
+
+    std::string Path(const std::string& file) const { return dir + "/" + file; }
+
+    bool Check(const std::string& buildId, InstallReport& report, bool full = false) {
+        InstallCheckOptions options;
+        options.full = full;
+        options.threads = 2;
+        std::string error;
+        bool ok = CheckInstall(dir, buildId, manifestPath, options, report, error);
+        MISE_CHECK_EQUAL(error, "");
+        return ok;
+    }
+
+    // Change one byte in the middle of a file and put its time back, as a bad sector would
+    void FlipByte(const std::string& file, uint64_t offset) {
+        fs::file_time_type time = fs::last_write_time(Path(file));
+        std::string bytes = ReadTestFile(Path(file));
+        bytes[offset] = static_cast<char>(bytes[offset] ^ 0x5A);
+        WriteTestFile(Path(file), bytes);
+        fs::last_write_time(Path(file), time);
+    }
+};
+
+} // namespace
+
+MISE_TEST(InstallVerifier, NoManifestYet) {
+    InstallFixture fixture;
+    InstallReport report;
+    MISE_CHECK(fixture.Check("7", report));
+    MISE_CHECK(report.built);
+    MISE_CHECK_EQUAL(report.previousBuildId, "");
+    MISE_CHECK_EQUAL(report.files, fixture.files.size());
+    MISE_CHECK_EQUAL(report.filesHashed, fixture.files.size());
+    MISE_CHECK(report.Ok());
+
+    InstallManifest manifest;
+    std::string error;
+    MISE_CHECK(ReadInstallManifest(fixture.manifestPath, manifest, error));
+    MISE_CHECK_EQUAL(manifest.buildId, "7");
+    MISE_CHECK_EQUAL(manifest.files.size(), fixture.files.size());
+    MISE_CHECK(std::is_sorted(manifest.files.begin(), manifest.files.end(),
+                              [](const InstallFile& a, const InstallFile& b) { return a.path < b.path; }));
+}
+
+MISE_TEST(InstallVerifier, FastPathSkipsUnchangedFiles) {
+    InstallFixture fixture;
+    InstallReport report;
+    MISE_CHECK(fixture.Check("7", report));
+
+    // Nothing changed: nothing is read
+    MISE_CHECK(fixture.Check("7", report));
+    MISE_CHECK(!report.built);
+    MISE_CHECK(report.Ok());
+    MISE_CHECK_EQUAL(report.filesSkipped, fixture.files.size());
+    MISE_CHECK_EQUAL(report.filesHashed, size_t(0));
+    MISE_CHECK_EQUAL(report.bytesHashed, uint64_t(0));
+
+    // A new time on the same bytes: read once, found fine, and the manifest takes the new time
+    const std::string touched = fixture.Path(fixture.files[2]);
+    fs::last_write_time(touched, fs::last_write_time(touched) + std::chrono::hours(1));
+    MISE_CHECK(fixture.Check("7", report));
+    MISE_CHECK(report.Ok());
+    MISE_CHECK_EQUAL(report.filesHashed, size_t(1));
+    MISE_CHECK_EQUAL(report.stampsRefreshed, size_t(1));
+    MISE_CHECK(fixture.Check("7", report));
+    MISE_CHECK_EQUAL(report.filesHashed, size_t(0));
+    MISE_CHECK_EQUAL(report.filesSkipped, fixture.files.size());
+}
+
+MISE_TEST(InstallVerifier, FindsMissingAndDamagedFiles) {
+    InstallFixture fixture;
+    InstallReport report;
+    MISE_CHECK(fixture.Check("7", report));
+
+    // A deleted cue, a cut-short one, a bad byte deep in the archive with its time put back, and a file Steam didn't install
+    fs::remove(fixture.Path(fixture.files[1]));
+    fs::resize_file(fixture.Path(fixture.files[3]), fs::file_size(fixture.Path(fixture.files[3])) / 2);
+    fixture.FlipByte(fixture.files[0], installBlockSize + 777);
+    WriteTestFile(fixture.Path("Data/mod.pak"), "mod");
+
+    // The fast path sees the missing and the short file without reading either; the changed byte has its old size and time
+    MISE_CHECK(fixture.Check("7", report));
+    MISE_CHECK(!report.Ok());
+    MISE_CHECK(report.missing == std::vector<std::string>{fixture.files[1]});
+    MISE_CHECK_EQUAL(report.damaged.size(), size_t(1));
+    if (!report.damaged.empty()) MISE_CHECK_EQUAL(report.damaged[0].compare(0, fixture.files[3].size(), fixture.files[3]), 0);
+    MISE_CHECK(report.added == std::vector<std::string>{"Data/mod.pak"});
+    MISE_CHECK_EQUAL(report.filesHashed, size_t(0));
+
+    // A full check reads everything and finds the changed byte as well
+    MISE_CHECK(fixture.Check("7", report, true));
+    MISE_CHECK(report.missing == std::vector<std::string>{fixture.files[1]});
+    MISE_CHECK_EQUAL(report.damaged.size(), size_t(2));
+    if (report.damaged.size() == 2) MISE_CHECK_EQUAL(report.damaged[1], fixture.files[0] + ": contents changed");  // Sorted by path
+    MISE_CHECK_EQUAL(report.filesHashed, fixture.files.size() - 2);
+
+    // Checking doesn't make the damage the new truth
+    MISE_CHECK(fixture.Check("7", report, true));
+    MISE_CHECK_EQUAL(report.damaged.size(), size_t(2));
+}
+
+MISE_TEST(InstallVerifier, NewBuildRecordsAfresh) {
+    InstallFixture fixture;
+    InstallReport report;
+    MISE_CHECK(fixture.Check("7", report));
+
+    // Steam updated the game: files changed, one went away, one is new
+    fixture.FlipByte(fixture.files[0], 10);
+    fs::remove(fixture.Path(fixture.files[4]));
+    WriteTestFile(fixture.Path("Data/Patch.pak"), Noise(5000, 99));
+    MISE_CHECK(fixture.Check("8", report));
+    MISE_CHECK(report.built);
+    MISE_CHECK_EQUAL(report.previousBuildId, "7");
+    MISE_CHECK(report.Ok());
+    MISE_CHECK_EQUAL(report.files, fixture.files.size());
+
+    // The new build's files are the truth from now on
+    MISE_CHECK(fixture.Check("8", report, true));
+    MISE_CHECK(!report.built);
+    MISE_CHECK(report.Ok());
+    MISE_CHECK(report.added.empty());
+
+    // An unknown build id (Steam's files unreadable) checks against whatever was recorded
+    MISE_CHECK(fixture.Check("", report));
+    MISE_CHECK(!report.built);
+    MISE_CHECK(report.Ok());
+}
@@ -0,0 +1,36 @@
+/*
+ * LauncherSettingsTest.cpp
+ * Finding a resolution in the combo list, and what of the Steam launch
+ * options reaches the game.
+ */
+
+#include "Test.h"
+
+#include "../core/LauncherSettings.h"
+#include "../core/SteamLibrary.h"
+
+MISE_TEST(LauncherSettings, FindResolutionChoice) {
+    std::vector<ResolutionChoice> choices = DefaultResolutionChoices();
+    int fullScreen = FindResolutionChoice(choices, "2560x1440", false);
+    int windowed = FindResolutionChoice(choices, "2560x1440", true);
+    MISE_CHECK(fullScreen > autodetectResolutionIndex);
+    MISE_CHECK(windowed > autodetectResolutionIndex);
+    MISE_CHECK(fullScreen != windowed);
+    MISE_CHECK_EQUAL(choices[windowed].resolution, "2560x1440");
+    MISE_CHECK(choices[windowed].windowed);
+
+    MISE_CHECK_EQUAL(FindResolutionChoice(choices, "1234x567", false), -1);
+    // Autodetect's empty resolution is never a match
+    MISE_CHECK_EQUAL(FindResolutionChoice(choices, "", false), -1);
+}
+
+MISE_TEST(LauncherSettings, LaunchOptionArguments) {
+    MISE_CHECK_EQUAL(LaunchOptionArguments("-windowed -nosound"), "-windowed -nosound");
+    MISE_CHECK_EQUAL(LaunchOptionArguments("PROTON_LOG=1 %command% -windowed "), "-windowed");
+    MISE_CHECK_EQUAL(LaunchOptionArguments("DXVK_HUD=fps %command%"), "");
+    MISE_CHECK_EQUAL(LaunchOptionArguments(""), "");
+
+    LaunchCommand command = BuildDirectLaunchCommand("/games/MISE", "gamemoderun %command% -skipintro");
+    MISE_CHECK_EQUAL(command.parameters, "-skipintro");
+    MISE_CHECK_EQUAL(command.workingDirectory, "/games/MISE");
+}
@@ -0,0 +1,187 @@
+/*
+ * LinuxPlatformTest.cpp
+ * The Linux/Proton backend against a fake home folder: which Steam folder
+ * and which prefix's settings.ini it picks, what it finds on $PATH, and an
+ * exec failure making it back from the detached child.
+ */
+
+#include "Test.h"
+
+#if defined(__linux__) && !defined(_WIN32)
+
+#include "../core/LauncherSettings.h"
+#include "../core/Platform.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Sets an environment variable (or unsets it, for a null value) and puts the old value back when it goes out of scope
+class ScopedEnv {
+public:
+    ScopedEnv(const char* name, const char* value) : name_(name) {
+        const char* old = getenv(name);
+        hadOld_ = old != nullptr;
+        if (hadOld_) old_ = old;
+        if (value) setenv(name, value, 1);
+        else unsetenv(name);
+    }
+    ~ScopedEnv() {
+        if (hadOld_) setenv(name_, old_.c_str(), 1);
+        else unsetenv(name_);
+    }
+    ScopedEnv(const ScopedEnv&) = delete;
+    ScopedEnv& operator=(const ScopedEnv&) = delete;
+
+private:
+    const char* name_;
+    bool hadOld_ = false;
+    std::string old_;
+};
+
+// The scratch folder with symlinks resolved, the way SteamPaths reports the Steam folder
+std::string RealPath(const TestScratchDir& dir) {
+    return fs::canonical(dir.Path()).string();
+}
+
+std::string PrefixSettingsPath(const std::string& library) {
+    return GameSettingsPath(JoinPath(ProtonPrefixPath(library, gameAppId), "drive_c/users/steamuser/AppData/Roaming"));
+}
+
+bool WriteExecutable(const std::string& path, const std::string& bytes) {
+    if (!WriteTestFile(path, bytes)) return false;
+    std::error_code ec;
+    fs::permissions(path, fs::perms::owner_all, ec);
+    return !ec;
+}
+
+} // namespace
+
+MISE_TEST(LinuxPlatform, SteamRootCandidatesInOrder) {
+    ScopedEnv home("HOME", "/home/guybrush");
+    {
+        ScopedEnv data("XDG_DATA_HOME", "/data/guybrush");
+        std::vector<std::string> expected = {
+            "/home/guybrush/.steam/steam", "/home/guybrush/.steam/root", "/data/guybrush/Steam",
+            "/home/guybrush/.var/app/com.valvesoftware.Steam/.local/share/Steam",
+            "/home/guybrush/snap/steam/common/.local/share/Steam"};
+        MISE_CHECK(SteamRootCandidates() == expected);
+    }
+
+    // No (or an empty) XDG_DATA_HOME means ~/.local/share
+    ScopedEnv data("XDG_DATA_HOME", "");
+    std::vector<std::string> candidates = SteamRootCandidates();
+    MISE_CHECK_EQUAL(candidates.size(), size_t(5));
+    if (candidates.size() == 5) MISE_CHECK_EQUAL(candidates[2], "/home/guybrush/.local/share/Steam");
+}
+
+MISE_TEST(LinuxPlatform, FindOnPath) {
+    TestScratchDir dir("mise_test_platform_path");
+    const std::string first = dir / "first", second = dir / "second", third = dir / "third";
+    WriteTestFile(first + "/steam", "#!/bin/sh\n");  // Not executable
+    fs::create_directories(second + "/steam");        // A folder, not a program
+    MISE_CHECK(WriteExecutable(third + "/steam", "#!/bin/sh\n"));
+    MISE_CHECK(WriteExecutable(first + "/xdg-open", "#!/bin/sh\n"));
+    MISE_CHECK(WriteExecutable(third + "/xdg-open", "#!/bin/sh\n"));
+
+    // Empty entries are skipped; the first folder with a runnable file wins
+    ScopedEnv path("PATH", (first + "::" + second + ":" + third).c_str());
+    MISE_CHECK_EQUAL(FindOnPath("steam"), third + "/steam");
+    MISE_CHECK_EQUAL(FindOnPath("xdg-open"), first + "/xdg-open");
+    MISE_CHECK_EQUAL(FindOnPath("missing"), "");
+}
+
+MISE_TEST(LinuxPlatform, NoSteam) {
+    TestScratchDir dir("mise_test_platform_nosteam");
+    fs::create_directories(dir / "home");
+    fs::create_directories(dir / "bin");
+    ScopedEnv home("HOME", (dir / "home").c_str());
+    ScopedEnv data("XDG_DATA_HOME", nullptr);
+    ScopedEnv path("PATH", (dir / "bin").c_str());
+
+    std::unique_ptr<GamePlatform> platform = CreateSystemPlatform();
+    std::string steamRoot, steamExe, error;
+    MISE_CHECK(!platform->SteamPaths(steamRoot, steamExe, error));
+    MISE_CHECK(error.find(dir / "home") != std::string::npos);
+    MISE_CHECK_EQUAL(platform->SettingsPath(), "");
+}
+
+MISE_TEST(LinuxPlatform, SettingsPathPrefixChoice) {
+    TestScratchDir dir("mise_test_platform_prefix");
+    const std::string base = RealPath(dir);
+    const std::string home = base + "/home";
+    const std::string data = base + "/data";
+    // The native client's ~/.steam/steam is a link to the real folder in XDG_DATA_HOME
+    const std::string steam = data + "/Steam";
+    const std::string library = base + "/Games";
+    WriteTestFile(steam + "/steamapps/libraryfolders.vdf",
+                  "\"libraryfolders\"\n{\n"
+                  "\t\"0\"\n\t{\n\t\t\"path\"\t\t\"" + steam + "\"\n\t}\n"
+                  "\t\"1\"\n\t{\n\t\t\"path\"\t\t\"" + library + "\"\n\t\t\"apps\"\n\t\t{\n\t\t\t\"32360\"\t\t\"1\"\n\t\t}\n\t}\n}\n");
+    fs::create_directories(home + "/.steam");
+    fs::create_symlink(steam, home + "/.steam/steam");
+    // A Flatpak Steam folder further down the list is never looked at
+    fs::create_directories(home + "/.var/app/com.valvesoftware.Steam/.local/share/Steam/steamapps");
+    fs::create_directories(ProtonPrefixPath(steam, gameAppId));
+    fs::create_directories(ProtonPrefixPath(library, gameAppId));
+    fs::create_directories(base + "/bin");
+    MISE_CHECK(WriteExecutable(base + "/bin/steam", "#!/bin/sh\n"));
+
+    ScopedEnv homeEnv("HOME", home.c_str());
+    ScopedEnv dataEnv("XDG_DATA_HOME", data.c_str());
+    ScopedEnv path("PATH", (base + "/bin").c_str());
+    std::unique_ptr<GamePlatform> platform = CreateSystemPlatform();
+
+    std::string steamRoot, steamExe, error;
+    MISE_CHECK(platform->SteamPaths(steamRoot, steamExe, error));
+    MISE_CHECK_EQUAL(steamRoot, steam);
+    MISE_CHECK_EQUAL(steamExe, base + "/bin/steam");
+
+    // The game hasn't run yet: the prefix in the game's own library comes first
+    MISE_CHECK_EQUAL(platform->SettingsPath(), PrefixSettingsPath(library));
+
+    // A settings.ini the game already wrote wins, even in a prefix left behind in another library
+    MISE_CHECK(WriteTestFile(PrefixSettingsPath(steam), "[audio]\r\nmusic=70\r\n"));
+    MISE_CHECK_EQUAL(platform->SettingsPath(), PrefixSettingsPath(steam));
+    MISE_CHECK(WriteTestFile(PrefixSettingsPath(library), "[audio]\r\nmusic=70\r\n"));
+    MISE_CHECK_EQUAL(platform->SettingsPath(), PrefixSettingsPath(library));
+}
+
+MISE_TEST(LinuxPlatform, SpawnReportsExecFailure) {
+    TestScratchDir dir("mise_test_platform_spawn");
+    std::string error;
+
+    // The grandchild's execv fails; its errno comes back through the pipe
+    MISE_CHECK(!SpawnDetached({dir / "missing"}, error));
+    MISE_CHECK_EQUAL(error, "Failed to start " + (dir / "missing") + ": " + strerror(ENOENT));
+
+    // Executable, but not something the kernel can run
+    const std::string garbage = dir / "garbage";
+    MISE_CHECK(WriteExecutable(garbage, std::string("\x7f" "ELF garbage", 12)));
+    error.clear();
+    MISE_CHECK(!SpawnDetached({garbage}, error));
+    MISE_CHECK_EQUAL(error, "Failed to start " + garbage + ": " + strerror(ENOEXEC));
+}
+
+MISE_TEST(LinuxPlatform, SpawnStartsTheProgram) {
+    TestScratchDir dir("mise_test_platform_started");
+    const std::string marker = dir / "started";
+    std::string error;
+    MISE_CHECK(SpawnDetached({"/bin/sh", "-c", "echo $0 > \"$1\"", "detached", marker}, error));
+    MISE_CHECK_EQUAL(error, "");
+
+    // Nothing waits for the detached program, so give it a moment to write
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (ReadTestFile(marker) != "detached\n" && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    MISE_CHECK_EQUAL(ReadTestFile(marker), "detached\n");
+}
+
+#endif
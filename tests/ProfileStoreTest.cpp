@@ -0,0 +1,92 @@
+/*
+ * ProfileStoreTest.cpp
+ * Profiles saved, found, listed and removed, and two launchers sharing one
+ * profiles.dat without losing each other's profiles.
+ */
+
+#include "Test.h"
+
+#include "../core/ProfileStore.h"
+
+MISE_TEST(ProfileStore, PutFindRemove) {
+    TestScratchDir dir("mise_test_profiles");
+    const std::string path = dir / "profiles.dat";
+    ProfileStore store;
+    std::string error;
+    MISE_CHECK(store.Open(path, error));
+    MISE_CHECK_EQUAL(store.Count(), size_t(0));
+
+    for (int i = 0; i < 20; ++i) {
+        MISE_CHECK(store.Put("profile " + std::to_string(i), "[display]\nwindowed=" + std::to_string(i % 2) + "\n", error));
+    }
+    MISE_CHECK(store.Put("profile 3", "[audio]\nmusic=0\n", error));
+    MISE_CHECK_EQUAL(store.Count(), size_t(20));
+    std::string_view settings;
+    MISE_CHECK(store.Find("profile 3", settings));
+    MISE_CHECK_EQUAL(std::string(settings), "[audio]\nmusic=0\n");
+    MISE_CHECK(!store.Find("profile 20", settings));
+    std::vector<std::string_view> names = store.Names();
+    MISE_CHECK_EQUAL(names.size(), size_t(20));
+    if (!names.empty()) MISE_CHECK_EQUAL(std::string(names.front()), "profile 0");
+
+    MISE_CHECK(store.Remove("profile 3", error));
+    MISE_CHECK(!store.Remove("profile 3", error));
+    MISE_CHECK(error.empty());
+    MISE_CHECK(!store.Find("profile 3", settings));
+
+    // What's on disk is what the store holds
+    ProfileStore reopened;
+    MISE_CHECK(reopened.Open(path, error));
+    MISE_CHECK_EQUAL(reopened.Count(), size_t(19));
+    MISE_CHECK(reopened.Find("profile 7", settings));
+    MISE_CHECK_EQUAL(std::string(settings), "[display]\nwindowed=1\n");
+}
+
+MISE_TEST(ProfileStore, PutFromItsOwnViews) {
+    TestScratchDir dir("mise_test_profiles");
+    ProfileStore store;
+    std::string error;
+    store.Open(dir / "profiles.dat", error);
+    store.Put("original", "language=3\n", error);
+    std::string_view settings;
+    store.Find("original", settings);
+    MISE_CHECK(store.Put(store.Names().front(), settings, error));
+    MISE_CHECK(store.Find("original", settings));
+    MISE_CHECK_EQUAL(std::string(settings), "language=3\n");
+    MISE_CHECK_EQUAL(store.Count(), size_t(1));
+}
+
+MISE_TEST(ProfileStore, TwoWritersKeepEachOthersProfiles) {
+    // The window has the store open while --save-profile runs in another process
+    TestScratchDir dir("mise_test_profiles");
+    const std::string path = dir / "profiles.dat";
+    ProfileStore window, cli;
+    std::string error;
+    window.Open(path, error);
+    MISE_CHECK(window.Put("from window", "a=1\n", error));
+    cli.Open(path, error);
+    MISE_CHECK(cli.Put("from cli", "b=2\n", error));
+
+    MISE_CHECK(window.Put("second from window", "c=3\n", error));
+    std::string_view settings;
+    MISE_CHECK(window.Find("from cli", settings));
+    MISE_CHECK_EQUAL(window.Count(), size_t(3));
+
+    MISE_CHECK(cli.Remove("from window", error));
+    ProfileStore check;
+    check.Open(path, error);
+    MISE_CHECK_EQUAL(check.Count(), size_t(2));
+    MISE_CHECK(check.Find("second from window", settings));
+}
+
+MISE_TEST(ProfileStore, NotAStore) {
+    TestScratchDir dir("mise_test_profiles");
+    const std::string path = dir / "profiles.dat";
+    WriteTestFile(path, "[display]\nwindowed=1\n");
+    ProfileStore store;
+    std::string error;
+    MISE_CHECK(!store.Open(path, error));
+    MISE_CHECK(error.find("not a launcher profile store") != std::string::npos);
+    MISE_CHECK_EQUAL(store.Count(), size_t(0));
+    MISE_CHECK(store.Names().empty());
+}
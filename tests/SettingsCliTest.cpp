@@ -0,0 +1,44 @@
+/*
+ * SettingsCliTest.cpp
+ * The command-line mode run against a scratch settings.ini.
+ */
+
+#include "Test.h"
+
+#include "../core/IniDocument.h"
+#include "../core/SettingsCli.h"
+
+#include <sstream>
+
+namespace {
+
+const char* const settingsText = "[display]\r\nwindowed=1\r\n[audio]\r\nmusic=70\r\n";
+
+CliHooks ScratchHooks(const std::string& iniPath) {
+    CliHooks hooks;
+    hooks.iniPath = [iniPath] { return iniPath; };
+    return hooks;
+}
+
+} // namespace
+
+MISE_TEST(SettingsCli, SetWritesTheValue) {
+    TestScratchDir dir("mise_test_cli");
+    const std::string path = dir / "settings.ini";
+    WriteTestFile(path, settingsText);
+    std::ostringstream out, err;
+    MISE_CHECK_EQUAL(RunSettingsCli({"--set", "audio.music=40"}, ScratchHooks(path), out, err), 0);
+    MISE_CHECK_EQUAL(IniDocument(ReadTestFile(path)).Value("audio", "music"), "40");
+}
+
+MISE_TEST(SettingsCli, SetRefusesLineBreaks) {
+    TestScratchDir dir("mise_test_cli");
+    const std::string path = dir / "settings.ini";
+    WriteTestFile(path, settingsText);
+    for (const char* assignment : {"audio.music=40\r\n[cheats]\r\ngodmode=1", "audio.subtitles=1\ngodmode=1"}) {
+        std::ostringstream out, err;
+        MISE_CHECK(RunSettingsCli({"--force", "--set", assignment}, ScratchHooks(path), out, err) != 0);
+        MISE_CHECK(err.str().find("line breaks") != std::string::npos);
+    }
+    MISE_CHECK_EQUAL(ReadTestFile(path), settingsText);
+}
@@ -0,0 +1,92 @@
+/*
+ * SettingsValidatorTest.cpp
+ * Validating edit by edit must end with exactly what checking the whole
+ * text from scratch finds: 20,000 random edit sequences over fragments
+ * that make section changes, bad values, unknown keys and line breaks.
+ */
+
+#include "Test.h"
+
+#include "../core/PieceTable.h"
+#include "../core/SettingsValidator.h"
+
+#include <random>
+
+namespace {
+
+const char* const fragments[] = {
+    "[display]", "[audio]", "[localization]", "[bogus]", "windowed=1", "windowed=7", "music=70", "music=400",
+    "language=2", "language=x", "resolution=1920x1080", "resolution=big", "nokey=1", "; comment", "stray",
+    "=", "[", "]", "\r\n", "\n", "\r", " ", "1", "0", "s", "e",
+};
+
+std::string RandomText(std::mt19937& random, size_t pieces) {
+    std::string text;
+    for (size_t i = 0; i < pieces; ++i) {
+        text += fragments[random() % (sizeof(fragments) / sizeof(fragments[0]))];
+        if (random() % 2) text += "\r\n";
+    }
+    return text;
+}
+
+bool SameDiagnostics(const std::vector<SettingDiagnostic>& a, const std::vector<SettingDiagnostic>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].line != b[i].line || a[i].severity != b[i].severity || a[i].message != b[i].message) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+MISE_TEST(SettingsValidator, FindsProblems) {
+    SettingsValidator validator;
+    validator.Reset("[display]\r\nwindowed=7\r\nnokey=1\r\n[audio]\r\nmusic=70\r\n");
+    std::vector<SettingDiagnostic> diagnostics = validator.Diagnostics();
+    MISE_CHECK_EQUAL(diagnostics.size(), size_t(2));
+    MISE_CHECK_EQUAL(validator.ErrorCount(), size_t(1));
+    MISE_CHECK_EQUAL(validator.WarningCount(), size_t(1));
+    if (diagnostics.size() == 2) {
+        MISE_CHECK_EQUAL(diagnostics[0].line, size_t(1));
+        MISE_CHECK(diagnostics[0].severity == SettingSeverity::Error);
+        MISE_CHECK_EQUAL(diagnostics[1].line, size_t(2));
+    }
+}
+
+MISE_TEST(SettingsValidator, IncrementalMatchesReset) {
+    std::mt19937 random(32360);
+    size_t mismatches = 0;
+    for (int sequence = 0; sequence < 20000 && mismatches < 5; ++sequence) {
+        std::string text = RandomText(random, random() % 12);
+        SettingsValidator incremental;
+        incremental.Reset(text);
+        PieceTable table(text);
+
+        for (size_t edits = 1 + random() % 8; edits > 0; --edits) {
+            size_t start = text.empty() ? 0 : random() % (text.size() + 1);
+            size_t removed = start == text.size() ? 0 : random() % std::min<size_t>(text.size() - start + 1, 16);
+            std::string inserted = random() % 4 ? RandomText(random, random() % 3) : "";
+            text.replace(start, removed, inserted);
+            table.Replace(start, start + removed, inserted);
+            incremental.Edit(start, removed, inserted);
+            // Sometimes several edits pile up before a check, the way fast typing does
+            if (random() % 3 == 0) {
+                if (random() % 2) {
+                    incremental.Revalidate(text);
+                } else {
+                    incremental.Revalidate(table);
+                }
+            }
+        }
+        incremental.Revalidate(text);
+
+        SettingsValidator fresh;
+        fresh.Reset(text);
+        if (!SameDiagnostics(incremental.Diagnostics(), fresh.Diagnostics()) ||
+            incremental.LineCount() != fresh.LineCount() || incremental.ErrorCount() != fresh.ErrorCount() ||
+            incremental.WarningCount() != fresh.WarningCount()) {
+            ++mismatches;
+            ReportTestFailure(__FILE__, __LINE__, "sequence " + std::to_string(sequence) + " differs from Reset() on:\n" + text);
+        }
+    }
+}
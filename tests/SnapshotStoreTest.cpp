@@ -0,0 +1,204 @@
+/*
+ * SnapshotStoreTest.cpp
+ * Backing up a fixture data folder and putting it back: the bytes and the
+ * times come back, an unchanged folder makes no new snapshot, a chunk cut
+ * short by a crash is written again, pruning removes the chunks nothing
+ * uses, and the launcher's own files are never touched. A restore that
+ * can't write a file aside changes nothing; one that can't replace a file
+ * still restores the rest.
+ */
+
+#include "Test.h"
+
+#include "../core/SnapshotStore.h"
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A data folder: settings.ini, a few saves (one big enough for many chunks) and the launcher's files
+struct DataFolder {
+    TestScratchDir scratch{"mise_test_snapshot"};
+    std::string data = scratch / "Data";
+    std::string ini = scratch / "Data/settings.ini";
+    std::string big;
+
+    DataFolder() {
+        for (size_t i = 0; i < 300000; ++i) big += static_cast<char>('a' + (i * 7919 % 26));
+        WriteTestFile(ini, "[display]\r\nwindowed=1\r\n");
+        WriteTestFile(data + "/Saves/slot1.sav", "slot one");
+        WriteTestFile(data + "/Saves/slot2.sav", big);
+        for (const std::string& name : SnapshotExcludedFiles(ini)) WriteTestFile(data + "/" + name, "launcher state");
+    }
+
+    SnapshotStore Store() const { return SnapshotStore(SnapshotStorePath(ini), SnapshotExcludedFiles(ini)); }
+};
+
+size_t CountChunks(const std::string& storeDir) {
+    size_t chunks = 0;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(fs::path(storeDir) / "chunks", ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file()) ++chunks;
+    }
+    return chunks;
+}
+
+} // namespace
+
+MISE_TEST(SnapshotStore, TakeAndRestore) {
+    DataFolder folder;
+    SnapshotStore store = folder.Store();
+    std::string id, error;
+    SnapshotStats stats;
+    MISE_CHECK(store.Take(folder.data, id, stats, error));
+    MISE_CHECK_EQUAL(stats.files, size_t(3));  // settings.ini and two saves; not the launcher's files
+    fs::file_time_type slot2Time = fs::last_write_time(folder.data + "/Saves/slot2.sav");
+
+    // Change one save in the middle, delete the other, change settings
+    std::string changed = folder.big;
+    changed.replace(150000, 5, "XXXXX");
+    WriteTestFile(folder.data + "/Saves/slot2.sav", changed);
+    fs::remove(folder.data + "/Saves/slot1.sav");
+    WriteTestFile(folder.ini, "[display]\r\nwindowed=0\r\n");
+    WriteTestFile(folder.data + "/Saves/slot3.sav", "new");
+    WriteTestFile(folder.data + "/profiles.dat", "profiles saved after the snapshot");
+
+    RestoreStats restored;
+    MISE_CHECK(store.Restore(id, folder.data, restored, error));
+    MISE_CHECK_EQUAL(restored.filesWritten, size_t(3));
+    MISE_CHECK_EQUAL(restored.filesNotInSnapshot, size_t(1));  // slot3.sav; the launcher's files don't count
+    MISE_CHECK(restored.failed.empty());
+    MISE_CHECK_EQUAL(ReadTestFile(folder.data + "/Saves/slot1.sav"), "slot one");
+    MISE_CHECK(ReadTestFile(folder.data + "/Saves/slot2.sav") == folder.big);
+    MISE_CHECK_EQUAL(ReadTestFile(folder.ini), "[display]\r\nwindowed=1\r\n");
+    MISE_CHECK(fs::last_write_time(folder.data + "/Saves/slot2.sav") == slot2Time);
+    MISE_CHECK_EQUAL(ReadTestFile(folder.data + "/Saves/slot3.sav"), "new");
+    MISE_CHECK_EQUAL(ReadTestFile(folder.data + "/profiles.dat"), "profiles saved after the snapshot");
+
+    // Restored times mean the next snapshot reads nothing: only slot3.sav is new
+    std::string nextId;
+    MISE_CHECK(store.Take(folder.data, nextId, stats, error));
+    MISE_CHECK_EQUAL(stats.filesRead, size_t(1));
+}
+
+MISE_TEST(SnapshotStore, UnchangedFolderMakesNoSnapshot) {
+    DataFolder folder;
+    SnapshotStore store = folder.Store();
+    std::string first, second, error;
+    SnapshotStats stats;
+    MISE_CHECK(store.Take(folder.data, first, stats, error));
+    // The launcher's own files changing doesn't count either
+    WriteTestFile(folder.data + "/sessions.log", "another session");
+    MISE_CHECK(store.Take(folder.data, second, stats, error));
+    MISE_CHECK(stats.unchanged);
+    MISE_CHECK_EQUAL(stats.filesRead, size_t(0));
+    MISE_CHECK_EQUAL(second, first);
+    std::vector<SnapshotInfo> list;
+    MISE_CHECK(store.List(list, error));
+    MISE_CHECK_EQUAL(list.size(), size_t(1));
+}
+
+MISE_TEST(SnapshotStore, ShortChunksAreWrittenAgain) {
+    // A crash after the chunks were written but before the manifest: some chunk files came back cut short
+    DataFolder folder;
+    SnapshotStore store = folder.Store();
+    std::string id, error;
+    SnapshotStats stats;
+    MISE_CHECK(store.Take(folder.data, id, stats, error));
+    const size_t chunks = CountChunks(SnapshotStorePath(folder.ini));
+    fs::remove(fs::path(SnapshotStorePath(folder.ini)) / "snapshots" / (id + ".snap"));
+    size_t cut = 0;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(fs::path(SnapshotStorePath(folder.ini)) / "chunks")) {
+        if (entry.is_regular_file() && cut++ % 2 == 0) fs::resize_file(entry.path(), entry.file_size() / 2);
+    }
+
+    // The next snapshot writes those again instead of trusting them, and restores byte for byte
+    MISE_CHECK(store.Take(folder.data, id, stats, error));
+    MISE_CHECK_EQUAL(stats.chunksWritten, (cut + 1) / 2);
+    MISE_CHECK_EQUAL(CountChunks(SnapshotStorePath(folder.ini)), chunks);
+    const std::string target = folder.scratch / "Restored";
+    RestoreStats restored;
+    MISE_CHECK(store.Restore(id, target, restored, error));
+    MISE_CHECK_EQUAL(error, "");
+    MISE_CHECK(ReadTestFile(target + "/Saves/slot2.sav") == folder.big);
+}
+
+MISE_TEST(SnapshotStore, PruneCollectsChunks) {
+    DataFolder folder;
+    SnapshotStore store = folder.Store();
+    std::string first, second, error;
+    SnapshotStats stats;
+    MISE_CHECK(store.Take(folder.data, first, stats, error));
+    size_t firstChunks = CountChunks(store.Dir());
+
+    // A whole new big save: its chunks are shared with nothing
+    std::string other;
+    for (size_t i = 0; i < folder.big.size(); ++i) other += static_cast<char>('A' + (i * 104729 % 26));
+    WriteTestFile(folder.data + "/Saves/slot2.sav", other);
+    MISE_CHECK(store.Take(folder.data, second, stats, error));
+    MISE_CHECK(second != first);
+    size_t bothChunks = CountChunks(store.Dir());
+    MISE_CHECK(bothChunks > firstChunks);
+
+    MISE_CHECK(store.Prune(1, error));
+    std::vector<SnapshotInfo> list;
+    MISE_CHECK(store.List(list, error));
+    MISE_CHECK_EQUAL(list.size(), size_t(1));
+    if (!list.empty()) MISE_CHECK_EQUAL(list[0].id, second);
+    size_t keptChunks = CountChunks(store.Dir());
+    MISE_CHECK(keptChunks < bothChunks);
+
+    // What's left still restores
+    fs::remove(folder.data + "/Saves/slot2.sav");
+    RestoreStats restored;
+    MISE_CHECK(store.Restore(second, folder.data, restored, error));
+    MISE_CHECK(ReadTestFile(folder.data + "/Saves/slot2.sav") == other);
+}
+
+MISE_TEST(SnapshotStore, FailedStagingChangesNothing) {
+    DataFolder folder;
+    WriteTestFile(folder.data + "/video/config.txt", "vsync=1");
+    SnapshotStore store = folder.Store();
+    std::string id, error;
+    SnapshotStats stats;
+    MISE_CHECK(store.Take(folder.data, id, stats, error));
+    WriteTestFile(folder.ini, "[display]\r\nwindowed=0\r\n");
+    WriteTestFile(folder.data + "/Saves/slot2.sav", "overwritten");
+
+    // video is now a file, so video/config.txt can't be written aside (settings.ini already was): nothing may be replaced
+    fs::remove_all(folder.data + "/video");
+    WriteTestFile(folder.data + "/video", "not a folder");
+    RestoreStats restored;
+    MISE_CHECK(!store.Restore(id, folder.data, restored, error));
+    MISE_CHECK(error.find("video/config.txt") != std::string::npos);
+    MISE_CHECK_EQUAL(restored.filesWritten, size_t(0));
+    MISE_CHECK_EQUAL(ReadTestFile(folder.ini), "[display]\r\nwindowed=0\r\n");
+    MISE_CHECK_EQUAL(ReadTestFile(folder.data + "/Saves/slot2.sav"), "overwritten");
+    // The staged copies didn't stay behind
+    size_t leftovers = 0;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(folder.data)) {
+        if (entry.path().extension() == ".tmp") ++leftovers;
+    }
+    MISE_CHECK_EQUAL(leftovers, size_t(0));
+}
+
+MISE_TEST(SnapshotStore, FailedReplaceRestoresTheRest) {
+    DataFolder folder;
+    SnapshotStore store = folder.Store();
+    std::string id, error;
+    SnapshotStats stats;
+    MISE_CHECK(store.Take(folder.data, id, stats, error));
+    WriteTestFile(folder.ini, "[display]\r\nwindowed=0\r\n");
+
+    // slot1.sav is now a folder with something in it: it can't be replaced by a file
+    fs::remove(folder.data + "/Saves/slot1.sav");
+    WriteTestFile(folder.data + "/Saves/slot1.sav/inside", "x");
+    RestoreStats restored;
+    MISE_CHECK(!store.Restore(id, folder.data, restored, error));
+    MISE_CHECK_EQUAL(restored.failed.size(), size_t(1));
+    if (!restored.failed.empty()) MISE_CHECK(restored.failed[0].find("Saves/slot1.sav") == 0);
+    MISE_CHECK_EQUAL(restored.filesWritten, size_t(1));
+    MISE_CHECK_EQUAL(ReadTestFile(folder.ini), "[display]\r\nwindowed=1\r\n");
+}
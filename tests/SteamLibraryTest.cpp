@@ -0,0 +1,153 @@
+/*
+ * SteamLibraryTest.cpp
+ * Finding the game in fixture Steam trees: both libraryfolders.vdf
+ * layouts, a byte order mark and escapes, a missing appmanifest, and the
+ * locator's cache noticing when Steam's files change.
+ */
+
+#include "Test.h"
+
+#include "../core/LauncherSettings.h"
+#include "../core/SteamLibrary.h"
+#include "../core/Vdf.h"
+
+#include <chrono>
+#include <filesystem>
+
+namespace {
+
+std::string Manifest(const std::string& installDir, const std::string& buildId = "7") {
+    return "\"AppState\"\n{\n\t\"appid\"\t\t\"32360\"\n\t\"name\"\t\t\"The Secret of Monkey Island: Special Edition\"\n"
+           "\t\"installdir\"\t\t\"" + installDir + "\"\n\t\"buildid\"\t\t\"" + buildId + "\"\n}\n";
+}
+
+// VDF spelling of a path: backslashes doubled, as Steam writes Windows paths
+std::string Escaped(const std::string& path) {
+    std::string text;
+    for (char c : path) {
+        if (c == '\\') text += '\\';
+        text += c;
+    }
+    return text;
+}
+
+} // namespace
+
+MISE_TEST(SteamLibrary, CurrentLayout) {
+    TestScratchDir dir("mise_test_steam_current");
+    const std::string steam = dir / "Steam";
+    const std::string library = dir / "Games";
+    WriteTestFile(steam + "/steamapps/libraryfolders.vdf",
+                  "\xEF\xBB\xBF\"libraryfolders\"\n{\n"
+                  "\t\"contentstatsid\"\t\t\"-123\"\n"
+                  "\t\"0\"\n\t{\n\t\t\"path\"\t\t\"" + Escaped(steam) + "\"\n\t\t\"apps\"\n\t\t{\n\t\t\t\"228980\"\t\t\"1\"\n\t\t}\n\t}\n"
+                  "\t\"1\"\n\t{\n\t\t\"path\"\t\t\"" + Escaped(library) + "\"\n\t\t\"apps\"\n\t\t{\n\t\t\t\"32360\"\t\t\"2\"\n\t\t}\n\t}\n}\n");
+    WriteTestFile(library + "/steamapps/appmanifest_32360.acf", Manifest("Monkey Island SE"));
+
+    std::string error;
+    std::vector<SteamLibraryFolder> libraries = ReadSteamLibraryFolders(steam, error);
+    MISE_CHECK_EQUAL(libraries.size(), size_t(2));
+    if (libraries.size() == 2) {
+        MISE_CHECK_EQUAL(libraries[0].path, steam);
+        MISE_CHECK_EQUAL(libraries[1].path, library);
+        MISE_CHECK(libraries[1].apps == std::vector<int>{gameAppId});
+    }
+
+    SteamAppInstall install;
+    MISE_CHECK(FindSteamApp(steam, gameAppId, install, error));
+    MISE_CHECK_EQUAL(install.libraryPath, library);
+    MISE_CHECK_EQUAL(install.installPath, JoinPath(JoinPath(JoinPath(library, "steamapps"), "common"), "Monkey Island SE"));
+    MISE_CHECK_EQUAL(install.name, "The Secret of Monkey Island: Special Edition");
+    MISE_CHECK_EQUAL(install.buildId, "7");
+}
+
+MISE_TEST(SteamLibrary, OldLayout) {
+    TestScratchDir dir("mise_test_steam_old");
+    const std::string steam = dir / "Steam";
+    const std::string library = dir / "Games";
+    WriteTestFile(steam + "/steamapps/libraryfolders.vdf",
+                  "\"LibraryFolders\"\n{\n\t\"TimeNextStatsReport\"\t\t\"1700000000\"\n\t\"1\"\t\t\"" + Escaped(library) + "\"\n}\n");
+    WriteTestFile(library + "/steamapps/appmanifest_32360.acf", Manifest("MISE"));
+
+    std::string error;
+    std::vector<SteamLibraryFolder> libraries = ReadSteamLibraryFolders(steam, error);
+    MISE_CHECK_EQUAL(libraries.size(), size_t(2));
+    SteamAppInstall install;
+    MISE_CHECK(FindSteamApp(steam, gameAppId, install, error));
+    MISE_CHECK_EQUAL(install.libraryPath, library);
+}
+
+MISE_TEST(SteamLibrary, Escapes) {
+    VdfNode root;
+    std::string error;
+    MISE_CHECK(ParseVdf("\xEF\xBB\xBF// comment\n\"a\"\n{\n\t\"path\"\t\"D:\\\\Steam \\\"Games\\\"\"\n\tbare\ttoken\n}\n", root, error));
+    const VdfNode* a = root.Find("A");
+    MISE_CHECK(a != nullptr);
+    if (a) {
+        MISE_CHECK_EQUAL(a->Get("PATH"), "D:\\Steam \"Games\"");
+        MISE_CHECK_EQUAL(a->Get("bare"), "token");
+    }
+    MISE_CHECK(!ParseVdf("\"a\"\n{\n\t\"b\"\t\"c\"\n", root, error));
+    MISE_CHECK(!error.empty());
+}
+
+MISE_TEST(SteamLibrary, MissingManifest) {
+    TestScratchDir dir("mise_test_steam_missing");
+    const std::string steam = dir / "Steam";
+    WriteTestFile(steam + "/steamapps/libraryfolders.vdf", "\"libraryfolders\"\n{\n}\n");
+    WriteTestFile(steam + "/steamapps/appmanifest_228980.acf", Manifest("Other"));
+
+    SteamAppInstall install;
+    std::string error;
+    MISE_CHECK(!FindSteamApp(steam, gameAppId, install, error));
+    MISE_CHECK(error.find("not installed") != std::string::npos);
+
+    // A manifest without installdir is an error about that file
+    WriteTestFile(steam + "/steamapps/appmanifest_32360.acf", "\"AppState\"\n{\n\t\"appid\"\t\"32360\"\n}\n");
+    error.clear();
+    MISE_CHECK(!FindSteamApp(steam, gameAppId, install, error));
+    MISE_CHECK(error.find("installdir") != std::string::npos);
+}
+
+MISE_TEST(SteamLibrary, LocatorNoticesChanges) {
+    TestScratchDir dir("mise_test_steam_locator");
+    const std::string steam = dir / "Steam";
+    const std::string manifest = steam + "/steamapps/appmanifest_32360.acf";
+    WriteTestFile(steam + "/steamapps/libraryfolders.vdf", "\"libraryfolders\"\n{\n}\n");
+    WriteTestFile(manifest, Manifest("MISE"));
+
+    SteamAppLocator locator;
+    SteamAppInstall install;
+    std::string error;
+    MISE_CHECK(locator.Locate(steam, gameAppId, install, error));
+    MISE_CHECK(locator.Locate(steam, gameAppId, install, error));
+    MISE_CHECK_EQUAL(locator.ResolveCount(), size_t(1));
+
+    // A Steam update: the manifest grows
+    WriteTestFile(manifest, Manifest("MISE", "12345"));
+    MISE_CHECK(locator.Locate(steam, gameAppId, install, error));
+    MISE_CHECK_EQUAL(locator.ResolveCount(), size_t(2));
+    MISE_CHECK_EQUAL(install.buildId, "12345");
+
+    // Same size, newer time
+    WriteTestFile(manifest, Manifest("MISE", "54321"));
+    std::filesystem::last_write_time(manifest, std::filesystem::last_write_time(manifest) + std::chrono::seconds(10));
+    MISE_CHECK(locator.Locate(steam, gameAppId, install, error));
+    MISE_CHECK_EQUAL(locator.ResolveCount(), size_t(3));
+    MISE_CHECK_EQUAL(install.buildId, "54321");
+
+    // The game moved to another library: libraryfolders.vdf changes
+    const std::string library = dir / "Games";
+    WriteTestFile(library + "/steamapps/appmanifest_32360.acf", Manifest("MISE"));
+    std::filesystem::remove(manifest);
+    WriteTestFile(steam + "/steamapps/libraryfolders.vdf",
+                  "\"libraryfolders\"\n{\n\t\"1\"\n\t{\n\t\t\"path\"\t\t\"" + Escaped(library) + "\"\n\t}\n}\n");
+    MISE_CHECK(locator.Locate(steam, gameAppId, install, error));
+    MISE_CHECK_EQUAL(install.libraryPath, library);
+    MISE_CHECK_EQUAL(locator.ResolveCount(), size_t(4));
+
+    // Uninstalled: not cached, and an error each time
+    std::filesystem::remove(library + "/steamapps/appmanifest_32360.acf");
+    MISE_CHECK(!locator.Locate(steam, gameAppId, install, error));
+    MISE_CHECK(!locator.Locate(steam, gameAppId, install, error));
+}
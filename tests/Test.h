@@ -0,0 +1,80 @@
+/*
+ * Test.h
+ * A pocket-sized test harness for the portable core.
+ * "Prepare to be tested, you scurvy dog!"
+ *
+ * Each MISE_TEST body runs once; MISE_CHECK and MISE_CHECK_EQUAL record a
+ * failure (with file, line and the values involved) and carry on, so one
+ * run reports everything that's wrong. MISETests exits with 1 if anything
+ * failed; ctest runs it once per group.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+
+using TestFunction = std::function<void()>;
+
+// Adds a test to the global list; called by MISE_TEST at static-init time
+bool RegisterTest(const char* group, const char* name, TestFunction function);
+
+// Counts a failed check against the running test and prints why
+void ReportTestFailure(const char* file, int line, const std::string& what);
+
+// A folder of its own under the temp directory, named after the process so two runs can't collide;
+// removed with everything in it when it goes out of scope
+class TestScratchDir {
+public:
+    explicit TestScratchDir(const char* name);
+    ~TestScratchDir();
+    TestScratchDir(const TestScratchDir&) = delete;
+    TestScratchDir& operator=(const TestScratchDir&) = delete;
+
+    const std::string& Path() const { return path_; }
+
+    // Path() joined with a '/'-separated relative path
+    std::string operator/(const std::string& relative) const;
+
+private:
+    std::string path_;
+};
+
+// Write bytes exactly as given (no newline handling), creating folders on the way; false if it couldn't
+bool WriteTestFile(const std::string& path, const std::string& bytes);
+
+// The file's bytes, or "<missing>" if it can't be read
+std::string ReadTestFile(const std::string& path);
+
+template <typename T>
+std::string TestValueText(const T& value) {
+    std::ostringstream text;
+    text << value;
+    return text.str();
+}
+
+#define MISE_TEST_CONCAT_(a, b) a##b
+#define MISE_TEST_CONCAT(a, b) MISE_TEST_CONCAT_(a, b)
+
+#define MISE_TEST(group, name)                                                   \
+    static void MISE_TEST_CONCAT(Test_, MISE_TEST_CONCAT(group, name))();          \
+    static const bool MISE_TEST_CONCAT(testRegistered_, MISE_TEST_CONCAT(group, name)) = \
+        RegisterTest(#group, #name, MISE_TEST_CONCAT(Test_, MISE_TEST_CONCAT(group, name))); \
+    static void MISE_TEST_CONCAT(Test_, MISE_TEST_CONCAT(group, name))()
+
+#define MISE_CHECK(condition)                                                    \
+    do {                                                                         \
+        if (!(condition)) ReportTestFailure(__FILE__, __LINE__, #condition);     \
+    } while (0)
+
+#define MISE_CHECK_EQUAL(actual, expected)                                       \
+    do {                                                                         \
+        const auto& actual_ = (actual);                                          \
+        const auto& expected_ = (expected);                                      \
+        if (!(actual_ == expected_)) {                                           \
+            ReportTestFailure(__FILE__, __LINE__, std::string(#actual " == " #expected "\n    got:      ") + \
+                                  TestValueText(actual_) + "\n    expected: " + TestValueText(expected_)); \
+        }                                                                        \
+    } while (0)
@@ -0,0 +1,106 @@
+// TestMain.cpp
+// Runs every registered test, or only those whose "group/name" contains
+// one of the filters given on the command line; exits with 1 if a check
+// failed. CMake registers one ctest entry per group ("MISETests IniDocument/").
+//
+// Build (from the repo root):
+//   g++ -std=c++17 -O2 tests/*.cpp core/*.cpp -o MISETests -pthread
+
+#include "Test.h"
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct TestEntry {
+    std::string name;
+    TestFunction function;
+};
+
+std::vector<TestEntry>& Registry() {
+    static std::vector<TestEntry> registry;
+    return registry;
+}
+
+std::atomic<unsigned> failures{0};
+
+int ProcessId() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+}
+
+} // namespace
+
+bool RegisterTest(const char* group, const char* name, TestFunction function) {
+    Registry().push_back({std::string(group) + "/" + name, std::move(function)});
+    return true;
+}
+
+void ReportTestFailure(const char* file, int line, const std::string& what) {
+    failures.fetch_add(1, std::memory_order_relaxed);
+    std::fprintf(stderr, "  %s:%d: check failed: %s\n", file, line, what.c_str());
+}
+
+TestScratchDir::TestScratchDir(const char* name) {
+    path_ = (std::filesystem::temp_directory_path() / (std::string(name) + "_" + std::to_string(ProcessId()))).string();
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+    std::filesystem::create_directories(path_, error);
+}
+
+TestScratchDir::~TestScratchDir() {
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+}
+
+std::string TestScratchDir::operator/(const std::string& relative) const {
+    return (std::filesystem::path(path_) / std::filesystem::path(relative)).string();
+}
+
+bool WriteTestFile(const std::string& path, const std::string& bytes) {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+std::string ReadTestFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return "<missing>";
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char** argv) {
+    size_t run = 0;
+    size_t failed = 0;
+    for (const TestEntry& entry : Registry()) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; ++i) {
+            selected = entry.name.find(argv[i]) != std::string::npos;
+        }
+        if (!selected) continue;
+
+        unsigned before = failures.load();
+        entry.function();
+        ++run;
+        bool passed = failures.load() == before;
+        if (!passed) ++failed;
+        std::printf("%-48s %s\n", entry.name.c_str(), passed ? "ok" : "FAILED");
+    }
+    std::printf("\n%zu tests, %zu failed\n", run, failed);
+    return failed || run == 0 ? 1 : 0;
+}
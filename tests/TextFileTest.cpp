@@ -0,0 +1,50 @@
+/*
+ * TextFileTest.cpp
+ * Newline conversion both ways, and Trim.
+ */
+
+#include "Test.h"
+
+#include "../core/TextFile.h"
+
+MISE_TEST(TextFile, NormalizeNewlines) {
+    MISE_CHECK_EQUAL(normalizeWindowsNewlines("a\r\nb\rc\nd"), "a\nb\nc\nd");
+    MISE_CHECK_EQUAL(normalizeWindowsNewlines("\r\n\r\n"), "\n\n");
+    MISE_CHECK_EQUAL(normalizeWindowsNewlines(""), "");
+
+    std::string inPlace = "x\r\ny\r";
+    normalizeNewlinesInPlace(inPlace);
+    MISE_CHECK_EQUAL(inPlace, "x\ny\n");
+}
+
+MISE_TEST(TextFile, ToWindowsNewlines) {
+    MISE_CHECK_EQUAL(toWindowsNewlines("a\nb\r\nc"), "a\r\nb\r\nc");
+    MISE_CHECK_EQUAL(toWindowsNewlines("\n"), "\r\n");
+    MISE_CHECK_EQUAL(toWindowsNewlines("no newline"), "no newline");
+    // Round trip
+    MISE_CHECK_EQUAL(normalizeWindowsNewlines(toWindowsNewlines("1\n2\n")), "1\n2\n");
+}
+
+MISE_TEST(TextFile, Trim) {
+    MISE_CHECK_EQUAL(Trim("  value \t\r\n"), "value");
+    MISE_CHECK_EQUAL(Trim("a b"), "a b");
+    MISE_CHECK_EQUAL(Trim(" \r\n\t "), "");
+    MISE_CHECK_EQUAL(Trim(""), "");
+}
+
+MISE_TEST(TextFile, ReadFileBytes) {
+    TestScratchDir dir("mise_test_textfile");
+    std::string content;
+    WriteTestFile(dir / "settings.ini", "a\r\nb");
+    MISE_CHECK(ReadFileBytes(dir / "settings.ini", content));
+    MISE_CHECK_EQUAL(content, "a\r\nb");
+    MISE_CHECK(ReadTextFile(dir / "settings.ini", content));
+    MISE_CHECK_EQUAL(content, "a\nb");
+    WriteTestFile(dir / "empty.ini", "");
+    MISE_CHECK(ReadFileBytes(dir / "empty.ini", content));
+    MISE_CHECK_EQUAL(content, "");
+
+    // Missing files and folders are not files
+    MISE_CHECK(!ReadFileBytes(dir / "missing.ini", content));
+    MISE_CHECK(!ReadFileBytes(dir.Path(), content));
+}
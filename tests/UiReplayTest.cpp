@@ -0,0 +1,110 @@
+/*
+ * UiReplayTest.cpp
+ * The recorded sessions in bench/sessions, replayed once each: every
+ * expect line holds, and the text box and the saved settings.ini end up
+ * exactly where the user left them. Also a profile applied over edits
+ * that weren't saved, which Undo brings back.
+ */
+
+#include "Test.h"
+
+#include "../core/UiReplay.h"
+
+#include <algorithm>
+
+// CMake points this at the source tree; a hand build runs from the repo root
+#ifndef MISE_TEST_SESSIONS_DIR
+#define MISE_TEST_SESSIONS_DIR "bench/sessions"
+#endif
+
+namespace {
+
+// The file with its line endings made '\n', since Save writes the platform's
+std::string ReadSavedText(const std::string& path) {
+    std::string text = ReadTestFile(path);
+    text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+    return text;
+}
+
+// Replay bench/sessions/<name>.uirec against a scratch settings.ini and check where it ends up
+void CheckSession(const char* name, const std::string& expectedText, const std::string& expectedDisk) {
+    TestScratchDir scratch("uireplay");
+    UiRecording recording;
+    std::string error;
+    bool read = ReadUiRecording(std::string(MISE_TEST_SESSIONS_DIR) + "/" + name + ".uirec", recording, error);
+    MISE_CHECK_EQUAL(error, "");
+    if (!read) return;
+
+    UiReplayOptions options;
+    options.iniPath = scratch / "settings.ini";
+    UiReplayResult result = ReplayUiRecording(recording, options);
+    MISE_CHECK(result.ok);
+    for (const std::string& failure : result.failures) MISE_CHECK_EQUAL(failure, "");
+    MISE_CHECK_EQUAL(result.timings.empty(), false);
+    MISE_CHECK_EQUAL(result.text, expectedText);
+    MISE_CHECK_EQUAL(ReadSavedText(options.iniPath), expectedDisk);
+}
+
+} // namespace
+
+MISE_TEST(UiReplay, Everyday) {
+    // Saved with the new language and window mode, then undone in the box (but not on disk) and reset and undone
+    CheckSession("everyday",
+                 "[localization]\r\nlanguage=0\r\n[display]\r\nwindowed=0\r\nshaders=0\r\nresolution=2560x1440\r\n"
+                 "[audio]\r\nmusic=40\r\nvoice=55\r\nsfx=70\r\nsubtitles=1\r\n",
+                 "[localization]\nlanguage=2\n[display]\nwindowed=1\nshaders=0\nresolution=2560x1440\n"
+                 "[audio]\nmusic=40\nvoice=55\nsfx=70\nsubtitles=1\n");
+}
+
+MISE_TEST(UiReplay, Conflict) {
+    // The game's music volume is kept; the user's sfx and subtitles go over the game's file
+    CheckSession("conflict",
+                 "[localization]\r\nlanguage=0\r\n[display]\r\nwindowed=0\r\nshaders=1\r\nresolution=3840x2160\r\n"
+                 "[audio]\r\nmusic=95\r\nvoice=80\r\nsfx=50\r\nsubtitles=0\r\n",
+                 "[localization]\nlanguage=0\n[display]\nwindowed=0\nshaders=1\nresolution=3840x2160\n"
+                 "[audio]\nmusic=95\nvoice=80\nsfx=50\nsubtitles=0\n");
+}
+
+MISE_TEST(UiReplay, Typing) {
+    // The typo never reaches the disk; the fixed value and the typed-in line do
+    CheckSession("typing",
+                 "[localization]\r\nlanguage=0\r\n[display]\r\nwindowed=0\r\nshaders=1\r\nresolution=3840x2160\r\n"
+                 "[audio]\r\nambience=30\r\nmusic=70\r\nvoice=80\r\nsfx=75\r\nsubtitles=1\r\n",
+                 "[localization]\nlanguage=0\n[display]\nwindowed=0\nshaders=1\nresolution=3840x2160\n"
+                 "[audio]\nambience=30\nmusic=70\nvoice=80\nsfx=75\nsubtitles=1\n");
+}
+
+MISE_TEST(UiReplay, ProfileIsOneUndoStep) {
+    TestScratchDir scratch("uireplay_profile");
+    UiRecording recording;
+    std::string error;
+    MISE_CHECK(ParseUiRecording(
+        "MISE-UI 1\n"
+        "load \"[display]\\r\\nwindowed=0\\r\\n[audio]\\r\\nmusic=70\\r\\nsfx=70\\r\\n\"\n"
+        "resolutions\n"
+        "slide 2005 40\n"
+        "profile \"[display]\\r\\nwindowed=1\\r\\n[audio]\\r\\nmusic=10\\r\\nsfx=10\\r\\n\"\n"
+        "expect audio.music=10\n"
+        "expect-disk audio.music=10\n"
+        "expect-disk display.windowed=1\n"
+        "undo\n"
+        "expect audio.music=40\n"
+        "expect display.windowed=0\n"
+        "expect-disk audio.music=10\n"
+        "redo\n"
+        "expect audio.sfx=10\n",
+        recording, error));
+    MISE_CHECK_EQUAL(error, "");
+
+    // The profile survives a round trip through the file format
+    UiRecording reread;
+    MISE_CHECK(ParseUiRecording(FormatUiRecording(recording), reread, error));
+    MISE_CHECK_EQUAL(FormatUiRecording(reread), FormatUiRecording(recording));
+
+    UiReplayOptions options;
+    options.iniPath = scratch / "settings.ini";
+    UiReplayResult result = ReplayUiRecording(recording, options);
+    for (const std::string& failure : result.failures) MISE_CHECK_EQUAL(failure, "");
+    MISE_CHECK(result.ok);
+    MISE_CHECK_EQUAL(result.text, "[display]\r\nwindowed=1\r\n[audio]\r\nmusic=10\r\nsfx=10\r\n");
+}